@@ -122,6 +122,35 @@ if(BUILD_PNG)
   set(SPARTA_DEFAULT_CXX_COMPILE_FLAGS -DSPARTA_PNG
                                        ${SPARTA_DEFAULT_CXX_COMPILE_FLAGS})
 endif()
+
+if(BUILD_ZLIB)
+  find_package(ZLIB REQUIRED)
+  set(TARGET_SPARTA_BUILD_ZLIB ZLIB::ZLIB)
+  list(APPEND TARGET_SPARTA_BUILD_TPLS ${TARGET_SPARTA_BUILD_ZLIB})
+  set(SPARTA_DEFAULT_CXX_COMPILE_FLAGS -DSPARTA_ZLIB
+                                       ${SPARTA_DEFAULT_CXX_COMPILE_FLAGS})
+endif()
+
+if(BUILD_ASYNC)
+  find_package(Threads REQUIRED)
+  set(TARGET_SPARTA_BUILD_ASYNC Threads::Threads)
+  list(APPEND TARGET_SPARTA_BUILD_TPLS ${TARGET_SPARTA_BUILD_ASYNC})
+  set(SPARTA_DEFAULT_CXX_COMPILE_FLAGS -DSPARTA_ASYNC
+                                       ${SPARTA_DEFAULT_CXX_COMPILE_FLAGS})
+endif()
+
+if(BUILD_OPENMP)
+  find_package(OpenMP REQUIRED)
+  set(TARGET_SPARTA_BUILD_OPENMP OpenMP::OpenMP_CXX)
+  list(APPEND TARGET_SPARTA_BUILD_TPLS ${TARGET_SPARTA_BUILD_OPENMP})
+
+  # thread FFTW3 plans if the FFTW3 OpenMP library is installed
+  if(FFT STREQUAL "FFTW3" AND TARGET FFTW3::FFTW3_OMP)
+    list(APPEND TARGET_SPARTA_BUILD_TPLS FFTW3::FFTW3_OMP)
+    set(SPARTA_DEFAULT_CXX_COMPILE_FLAGS -DFFT_FFTW_THREADS
+                                         ${SPARTA_DEFAULT_CXX_COMPILE_FLAGS})
+  endif()
+endif()
 # ################### END PROCESS TPLS ####################
 
 # ################### BEGIN COMBINE CXX FLAGS ####################
@@ -42,6 +42,21 @@ sparta_option(BUILD_JPEG "Enable or disable JPEG TPL. Default: OFF." OFF
 sparta_option(BUILD_PNG "Enable or disable PNG TPL. Default: OFF." OFF
               SPARTA_BUILD_TPL_LIST)
 
+sparta_option(BUILD_ZLIB "Enable or disable ZLIB TPL. Default: OFF." OFF
+              SPARTA_BUILD_TPL_LIST)
+
+sparta_option(
+  BUILD_ASYNC
+  "Enable or disable background dump writing via POSIX threads. Default: ON."
+  ON
+  SPARTA_BUILD_TPL_LIST)
+
+sparta_option(
+  BUILD_OPENMP
+  "Enable or disable OpenMP threading of surface/grid cutting. Default: OFF."
+  OFF
+  SPARTA_BUILD_TPL_LIST)
+
 option(FFT "Select a FFT TPL from FFTW2, FFTW3, and MKL. Default: OFF." OFF)
 # ######### END   SPARTA TPL DEPENDENCIES ##########
 
@@ -29,7 +29,7 @@ class sparta:
     except:
       type,value,tb = sys.exc_info()
       traceback.print_exception(type,value,tb)
-      raise OSError,"Could not load SPARTA dynamic library"
+      raise OSError("Could not load SPARTA dynamic library")
 
     # create an instance of SPARTA
     # don't know how to pass an MPI communicator from PyPar
@@ -104,7 +104,75 @@ class sparta:
       result = (c_double*nlocal)()
       self.lib.sparta_extract_variable.restype = POINTER(c_double)
       ptr = self.lib.sparta_extract_variable(self.spa,name)
-      for i in xrange(nlocal): result[i] = ptr[i]
+      for i in range(nlocal): result[i] = ptr[i]
       self.lib.sparta_free(ptr)
       return result
     return None
+
+  # return a NumPy array which is a view of per-particle or per-grid data
+  # no data is copied, so changes to the array change SPARTA's data
+  # name = field or custom attribute or c_ID, f_ID, see src/library.cpp
+  # array is only valid until SPARTA next reallocates or reorders the data,
+  #   e.g. by a run, so extract it again after each run
+  # returns None if name is not recognized
+
+  def extract_particle(self,name):
+    return self.numpy_view(self.lib.sparta_extract_particle,name)
+
+  def extract_grid(self,name):
+    return self.numpy_view(self.lib.sparta_extract_grid,name)
+
+  # gather per-particle (style = 0) or per-grid (style = 1) data
+  #   from all procs into a new NumPy array, ordered by proc
+  # scatter is the inverse, data must have the same global length
+
+  def gather(self,style,name):
+    import numpy as np
+    info = self.numpy_info(style,name)
+    if info[0] < 0: return None
+    n = self.lib.sparta_gather(self.spa,style,name,None)
+    data = np.zeros(self.numpy_shape(n,info[2]),self.numpy_dtype(info[0]))
+    self.lib.sparta_gather(self.spa,style,name,data.ctypes.data_as(c_void_p))
+    return data
+
+  def scatter(self,style,name,data):
+    import numpy as np
+    info = self.numpy_info(style,name)
+    if info[0] < 0: return -1
+    data = np.ascontiguousarray(data,self.numpy_dtype(info[0]))
+    return self.lib.sparta_scatter(self.spa,style,name,
+                                   data.ctypes.data_as(c_void_p))
+
+  # helper methods for NumPy access
+
+  def numpy_info(self,style,name):
+    info = (c_int*4)()
+    if style == 0: func = self.lib.sparta_extract_particle
+    else: func = self.lib.sparta_extract_grid
+    func.restype = c_void_p
+    func(self.spa,name,info)
+    return info
+
+  def numpy_dtype(self,type):
+    import numpy as np
+    return np.dtype([np.int32,np.float64,np.int64,np.uint32,np.uint64][type])
+
+  def numpy_shape(self,nrows,ncols):
+    if ncols == 1: return (nrows,)
+    return (nrows,ncols)
+
+  def numpy_view(self,func,name):
+    import numpy as np
+    info = (c_int*4)()
+    func.restype = c_void_p
+    ptr = func(self.spa,name,info)
+    type,nrows,ncols,stride = info[0],info[1],info[2],info[3]
+    if type < 0: return None
+    dtype = self.numpy_dtype(type)
+    shape = self.numpy_shape(nrows,ncols)
+    if nrows == 0 or not ptr: return np.zeros(shape,dtype)
+    nbytes = (nrows-1)*stride + ncols*dtype.itemsize
+    buf = (c_char*nbytes).from_address(ptr)
+    if ncols == 1: strides = (stride,)
+    else: strides = (stride,dtype.itemsize)
+    return np.ndarray(shape,dtype,buffer=buf,strides=strides)
@@ -253,6 +253,8 @@ ComputeFFTGrid::ComputeFFTGrid(SPARTA *sparta, int narg, char **arg) :
 
   irregular1 = irregular2 = NULL;
   map1 = map2 = NULL;
+  mapcells = NULL;
+  nmapcells = 0;
   ingrid = gridwork = NULL;
   gridworkcomplex = NULL;
   vector_grid = NULL;
@@ -289,6 +291,7 @@ ComputeFFTGrid::~ComputeFFTGrid()
   delete irregular2;
   memory->destroy(map1);
   memory->destroy(map2);
+  memory->destroy(mapcells);
 }
 
 /* ---------------------------------------------------------------------- */
@@ -305,7 +308,7 @@ void ComputeFFTGrid::init()
 
   // create two irregular comm patterns for moving data
   //   from/to SPARTA grid to/from FFT grid
-  // do this at each init in case grid partitioning has changed
+  // check at each init in case grid partitioning has changed
   // also reallocate grid-based memory if needed
 
   reallocate();
@@ -529,10 +532,14 @@ void ComputeFFTGrid::compute_per_grid()
 /* ----------------------------------------------------------------------
    reallocate irregular comm patterns if local grid storage changes
    called by init() and whenever grid is rebalanced
+   patterns are kept if no proc's owned cells have changed since they
+     were created, since the remap of grid values would be identical
 ------------------------------------------------------------------------- */
 
 void ComputeFFTGrid::reallocate()
 {
+  if (irregular1 && !cells_changed()) return;
+
   delete irregular1;
   delete irregular2;
   memory->destroy(map1);
@@ -540,29 +547,30 @@ void ComputeFFTGrid::reallocate()
 
   irregular_create();
 
-  if (grid->nlocal == nglocal) return;
-
-  memory->destroy(ingrid);
-  memory->destroy(gridwork);
-  memory->destroy(gridworkcomplex);
-  memory->destroy(vector_grid);
-  memory->destroy(array_grid);
+  if (grid->nlocal != nglocal) {
+    memory->destroy(ingrid);
+    memory->destroy(gridwork);
+    memory->destroy(gridworkcomplex);
+    memory->destroy(vector_grid);
+    memory->destroy(array_grid);
 
-  nglocal = grid->nlocal;
+    nglocal = grid->nlocal;
 
-  memory->create(ingrid,nglocal,"fft/grid:ingrid");
-  gridwork = NULL;
-  gridworkcomplex = NULL;
+    memory->create(ingrid,nglocal,"fft/grid:ingrid");
+    gridwork = NULL;
+    gridworkcomplex = NULL;
 
-  if (startcol || conjugate)
-    memory->create(gridwork,nglocal,"fft/grid:gridwork");
-  if (!conjugate) memory->create(gridworkcomplex,2*nglocal,
-                                 "fft/grid:gridworkcomplex");
+    if (startcol || conjugate)
+      memory->create(gridwork,nglocal,"fft/grid:gridwork");
+    if (!conjugate) memory->create(gridworkcomplex,2*nglocal,
+                                   "fft/grid:gridworkcomplex");
 
-  if (ncol == 1) memory->create(vector_grid,nglocal,"fft/grid:vector_grid");
-  else memory->create(array_grid,nglocal,ncol,"fft/grid:array_grid");
+    if (ncol == 1) memory->create(vector_grid,nglocal,"fft/grid:vector_grid");
+    else memory->create(array_grid,nglocal,ncol,"fft/grid:array_grid");
+  }
 
-  // one-time setup of vector of K-space vector magnitudes if requested
+  // setup of vector of K-space vector magnitudes if requested
+  // redone whenever map2 changes, since owned cells may be reordered
   // compute values in K-space, irregular comm to grid decomposition
   // kx,ky,kz = indices of FFT grid cell in K-space
   // convert to distance from (0,0,0) cell using PBC
@@ -618,6 +626,31 @@ void ComputeFFTGrid::reallocate()
   }
 }
 
+/* ----------------------------------------------------------------------
+   return 1 if any proc's list of owned cells differs from the one
+     irregular comm patterns and map1,map2 were created for, else 0
+------------------------------------------------------------------------- */
+
+int ComputeFFTGrid::cells_changed()
+{
+  Grid::ChildCell *cells = grid->cells;
+  int n = grid->nlocal;
+
+  int flag = 0;
+  if (n != nmapcells) flag = 1;
+  else {
+    for (int i = 0; i < n; i++)
+      if (cells[i].id != mapcells[i]) {
+        flag = 1;
+        break;
+      }
+  }
+
+  int flagall;
+  MPI_Allreduce(&flag,&flagall,1,MPI_INT,MPI_MAX,world);
+  return flagall;
+}
+
 /* ----------------------------------------------------------------------
    memory usage of local data
 ------------------------------------------------------------------------- */
@@ -632,6 +665,7 @@ bigint ComputeFFTGrid::memory_usage()
   else bytes += 2*nglocal * sizeof(FFT_SCALAR);           // gridworkcomplex
   bytes += ncol*nglocal * sizeof(double);     // vector/array grid
   bytes += (nfft+nglocal) * sizeof(int);      // map1,map2
+  bytes += nmapcells * sizeof(cellint);       // mapcells
   return bytes;
 }
 
@@ -783,6 +817,13 @@ void ComputeFFTGrid::irregular_create()
   cellint *idsend = (cellint *) sbuf1;
   for (i = 0; i < nglocal; i++) idsend[i] = cells[i].id;
 
+  // save cell IDs so later calls can detect if owned cells changed
+
+  memory->destroy(mapcells);
+  memory->create(mapcells,nglocal,"fft/grid:mapcells");
+  for (i = 0; i < nglocal; i++) mapcells[i] = cells[i].id;
+  nmapcells = nglocal;
+
   irregular1->exchange_uniform(sbuf1,sizeof(cellint),rbuf1);
 
   memory->create(map1,nfft,"fft/grid:map1");
@@ -77,12 +77,16 @@ class ComputeFFTGrid : public Compute {
                         //           in buffer received from FFT decomp via
                         //           irregular comm
 
+  cellint *mapcells;    // IDs of owned grid cells when map1,map2 were created
+  int nmapcells;        // # of IDs in mapcells
+
   class FFT3D *fft3d;
   class FFT2D *fft2d;
   class Irregular *irregular1,*irregular2;
 
   void fft_create();
   void irregular_create();
+  int cells_changed();
   void procs2grid2d(int, int, int, int &, int &);
   int factorable(int);
   void debug(const char *, int, double *, int *, cellint *, int stride=1);
@@ -24,6 +24,10 @@
 #include "kissfft.h"
 #endif
 
+#if defined(FFT_FFTW_THREADS) && defined(_OPENMP)
+#include <omp.h>
+#endif
+
 #define MIN(A,B) ((A) < (B)) ? (A) : (B)
 #define MAX(A,B) ((A) > (B)) ? (A) : (B)
 
@@ -59,7 +63,7 @@
 
 void fft_2d(FFT_DATA *in, FFT_DATA *out, int flag, struct fft_plan_2d *plan)
 {
-  int i,total,length,offset,num;
+  int i,total,length,num;
   FFT_SCALAR norm;
 #if defined(FFT_FFTW3)
   FFT_SCALAR *out_ptr;
@@ -108,11 +112,9 @@ void fft_2d(FFT_DATA *in, FFT_DATA *out, int flag, struct fft_plan_2d *plan)
   FFTW_API(execute_dft)(theplan,data,data);
 #else
   if (flag == 1)
-    for (offset = 0; offset < total; offset += length)
-      kiss_fft(plan->cfg_fast_forward,&data[offset],&data[offset]);
+    kiss_fft_many(plan->cfg_fast_forward,data,total,length);
   else
-    for (offset = 0; offset < total; offset += length)
-      kiss_fft(plan->cfg_fast_backward,&data[offset],&data[offset]);
+    kiss_fft_many(plan->cfg_fast_backward,data,total,length);
 #endif
 
   // mid-remap to prepare for 2nd FFTs
@@ -147,11 +149,9 @@ void fft_2d(FFT_DATA *in, FFT_DATA *out, int flag, struct fft_plan_2d *plan)
   FFTW_API(execute_dft)(theplan,data,data);
 #else
   if (flag == 1)
-    for (offset = 0; offset < total; offset += length)
-      kiss_fft(plan->cfg_slow_forward,&data[offset],&data[offset]);
+    kiss_fft_many(plan->cfg_slow_forward,data,total,length);
   else
-    for (offset = 0; offset < total; offset += length)
-      kiss_fft(plan->cfg_slow_backward,&data[offset],&data[offset]);
+    kiss_fft_many(plan->cfg_slow_backward,data,total,length);
 #endif
 
   // post-remap to put data in output format if needed
@@ -402,6 +402,11 @@ struct fft_plan_2d *fft_2d_create_plan(
   }
 
 #elif defined(FFT_FFTW3)
+#if defined(FFT_FFTW_THREADS) && defined(_OPENMP)
+  // 1d FFTs of each plan are threaded over OpenMP threads of this proc
+  FFTW_API(init_threads)();
+  FFTW_API(plan_with_nthreads)(omp_get_max_threads());
+#endif
   plan->plan_fast_forward =
     FFTW_API(plan_many_dft)(1, &nfast,plan->total1/plan->length1,
                             NULL,&nfast,1,plan->length1,
@@ -548,7 +553,7 @@ void factor_2d(int n, int *num, int *list)
 void fft_2d_1d_only(FFT_DATA *data, int nsize, int flag,
                     struct fft_plan_2d *plan)
 {
-  int i,total,length,offset,num;
+  int i,total,length,num;
   FFT_SCALAR norm;
 #if defined(FFT_FFTW3)
   FFT_SCALAR *data_ptr;
@@ -609,15 +614,11 @@ void fft_2d_1d_only(FFT_DATA *data, int nsize, int flag,
 
 #else
   if (flag == 1) {
-    for (offset = 0; offset < total1; offset += length1)
-      kiss_fft(plan->cfg_fast_forward,&data[offset],&data[offset]);
-    for (offset = 0; offset < total2; offset += length2)
-      kiss_fft(plan->cfg_slow_forward,&data[offset],&data[offset]);
+    kiss_fft_many(plan->cfg_fast_forward,data,total1,length1);
+    kiss_fft_many(plan->cfg_slow_forward,data,total2,length2);
   } else {
-    for (offset = 0; offset < total1; offset += length1)
-      kiss_fft(plan->cfg_fast_backward,&data[offset],&data[offset]);
-    for (offset = 0; offset < total2; offset += length2)
-      kiss_fft(plan->cfg_slow_backward,&data[offset],&data[offset]);
+    kiss_fft_many(plan->cfg_fast_backward,data,total1,length1);
+    kiss_fft_many(plan->cfg_slow_backward,data,total2,length2);
   }
 #endif
 
@@ -25,6 +25,10 @@
 #include "kissfft.h"
 #endif
 
+#if defined(FFT_FFTW_THREADS) && defined(_OPENMP)
+#include <omp.h>
+#endif
+
 #define MIN(A,B) ((A) < (B) ? (A) : (B))
 #define MAX(A,B) ((A) > (B) ? (A) : (B))
 
@@ -60,7 +64,7 @@
 
 void fft_3d(FFT_DATA *in, FFT_DATA *out, int flag, struct fft_plan_3d *plan)
 {
-  int i,total,length,offset,num;
+  int i,total,length,num;
   FFT_SCALAR norm;
 #if defined(FFT_FFTW3)
   FFT_SCALAR *out_ptr;
@@ -111,11 +115,9 @@ void fft_3d(FFT_DATA *in, FFT_DATA *out, int flag, struct fft_plan_3d *plan)
   FFTW_API(execute_dft)(theplan,data,data);
 #else
   if (flag == 1)
-    for (offset = 0; offset < total; offset += length)
-      kiss_fft(plan->cfg_fast_forward,&data[offset],&data[offset]);
+    kiss_fft_many(plan->cfg_fast_forward,data,total,length);
   else
-    for (offset = 0; offset < total; offset += length)
-      kiss_fft(plan->cfg_fast_backward,&data[offset],&data[offset]);
+    kiss_fft_many(plan->cfg_fast_backward,data,total,length);
 #endif
 
   // 1st mid-remap to prepare for 2nd FFTs
@@ -150,11 +152,9 @@ void fft_3d(FFT_DATA *in, FFT_DATA *out, int flag, struct fft_plan_3d *plan)
   FFTW_API(execute_dft)(theplan,data,data);
 #else
   if (flag == 1)
-    for (offset = 0; offset < total; offset += length)
-      kiss_fft(plan->cfg_mid_forward,&data[offset],&data[offset]);
+    kiss_fft_many(plan->cfg_mid_forward,data,total,length);
   else
-    for (offset = 0; offset < total; offset += length)
-      kiss_fft(plan->cfg_mid_backward,&data[offset],&data[offset]);
+    kiss_fft_many(plan->cfg_mid_backward,data,total,length);
 #endif
 
   // 2nd mid-remap to prepare for 3rd FFTs
@@ -189,11 +189,9 @@ void fft_3d(FFT_DATA *in, FFT_DATA *out, int flag, struct fft_plan_3d *plan)
   FFTW_API(execute_dft)(theplan,data,data);
 #else
   if (flag == 1)
-    for (offset = 0; offset < total; offset += length)
-      kiss_fft(plan->cfg_slow_forward,&data[offset],&data[offset]);
+    kiss_fft_many(plan->cfg_slow_forward,data,total,length);
   else
-    for (offset = 0; offset < total; offset += length)
-      kiss_fft(plan->cfg_slow_backward,&data[offset],&data[offset]);
+    kiss_fft_many(plan->cfg_slow_backward,data,total,length);
 #endif
 
   // post-remap to put data in output format if needed
@@ -539,6 +537,11 @@ struct fft_plan_3d *fft_3d_create_plan(
   }
 
 #elif defined(FFT_FFTW3)
+#if defined(FFT_FFTW_THREADS) && defined(_OPENMP)
+  // 1d FFTs of each plan are threaded over OpenMP threads of this proc
+  FFTW_API(init_threads)();
+  FFTW_API(plan_with_nthreads)(omp_get_max_threads());
+#endif
   plan->plan_fast_forward =
     FFTW_API(plan_many_dft)(1, &nfast,plan->total1/plan->length1,
                             NULL,&nfast,1,plan->length1,
@@ -807,19 +810,13 @@ void fft_3d_1d_only(FFT_DATA *data, int nsize, int flag,
   FFTW_API(execute_dft)(theplan,data,data);
 #else
   if (flag == 1) {
-    for (int offset = 0; offset < total1; offset += length1)
-      kiss_fft(plan->cfg_fast_forward,&data[offset],&data[offset]);
-    for (int offset = 0; offset < total2; offset += length2)
-      kiss_fft(plan->cfg_mid_forward,&data[offset],&data[offset]);
-    for (int offset = 0; offset < total3; offset += length3)
-      kiss_fft(plan->cfg_slow_forward,&data[offset],&data[offset]);
+    kiss_fft_many(plan->cfg_fast_forward,data,total1,length1);
+    kiss_fft_many(plan->cfg_mid_forward,data,total2,length2);
+    kiss_fft_many(plan->cfg_slow_forward,data,total3,length3);
   } else {
-    for (int offset = 0; offset < total1; offset += length1)
-      kiss_fft(plan->cfg_fast_backward,&data[offset],&data[offset]);
-    for (int offset = 0; offset < total2; offset += length2)
-      kiss_fft(plan->cfg_mid_backward,&data[offset],&data[offset]);
-    for (int offset = 0; offset < total3; offset += length3)
-      kiss_fft(plan->cfg_slow_backward,&data[offset],&data[offset]);
+    kiss_fft_many(plan->cfg_fast_backward,data,total1,length1);
+    kiss_fft_many(plan->cfg_mid_backward,data,total2,length2);
+    kiss_fft_many(plan->cfg_slow_backward,data,total3,length3);
   }
 #endif
 
@@ -96,6 +96,7 @@ struct kiss_fft_state {
 
 static kiss_fft_cfg kiss_fft_alloc(int,int,void *,size_t *);
 static void kiss_fft(kiss_fft_cfg,const FFT_DATA *,FFT_DATA *);
+static void kiss_fft_many(kiss_fft_cfg,FFT_DATA *,int,int);
 
 /*
   Explanation of macros dealing with complex math:
@@ -472,4 +473,18 @@ static void kiss_fft(kiss_fft_cfg cfg, const FFT_DATA *fin, FFT_DATA *fout)
     kiss_fft_stride(cfg,fin,fout,1);
 }
 
+/* perform total/length independent in-place FFTs of size length
+   stored contiguously in data, threaded over the FFTs with OpenMP.
+   the cfg is read-only and temporary buffers are allocated per call,
+   so each thread can use the same cfg */
+static void kiss_fft_many(kiss_fft_cfg cfg, FFT_DATA *data, int total, int length)
+{
+    int nset = total/length;
+#if defined(_OPENMP)
+#pragma omp parallel for schedule(static)
+#endif
+    for (int m = 0; m < nset; m++)
+        kiss_fft(cfg,&data[m*length],&data[m*length]);
+}
+
 #endif
@@ -42,10 +42,11 @@ ComputeSurfKokkos::ComputeSurfKokkos(SPARTA *sparta, int narg, char **arg) :
 ComputeSurfKokkos::ComputeSurfKokkos(SPARTA *sparta) :
   ComputeSurf(sparta)
 {
-  hash = NULL;
   which = NULL;
   array_surf_tally = NULL;
   tally2surf = NULL;
+  tally2local = NULL;
+  surf2tally = NULL;
   array_surf = NULL;
   vector_surf = NULL;
   normflux = NULL;
@@ -52,6 +52,8 @@ FixAveGridKokkos::FixAveGridKokkos(SPARTA *sparta, int narg, char **arg) :
 
   if (flavor == PERGRIDSURF)
     error->all(FLERR,"Cannot yet use Kokkos with fix ave/grid for grid/surf inputs");
+  if (varflag)
+    error->all(FLERR,"Cannot yet use Kokkos with fix ave/grid variance");
 
   nglocal = maxgrid = grid->nlocal;
 
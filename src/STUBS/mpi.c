@@ -20,6 +20,7 @@
 #include <stdio.h>
 #include <stdint.h>
 #include <sys/time.h>
+#include <unistd.h>
 #include <mpi.h>
 
 /* data structure for double/int */
@@ -371,6 +372,19 @@ int MPI_Cart_rank(MPI_Comm comm, int *coords, int *rank)
 
 /* ---------------------------------------------------------------------- */
 
+int MPI_Dist_graph_create_adjacent(MPI_Comm comm_old, int indegree,
+                                   const int *sources,
+                                   const int *sourceweights,
+                                   int outdegree, const int *destinations,
+                                   const int *destweights, MPI_Info info,
+                                   int reorder, MPI_Comm *comm_dist_graph)
+{
+  *comm_dist_graph = comm_old;
+  return 0;
+}
+
+/* ---------------------------------------------------------------------- */
+
 /* store size of user datatype in extra lists */
 
 int MPI_Type_contiguous(int count, MPI_Datatype oldtype,
@@ -617,3 +631,106 @@ int MPI_Alltoallv(void *sendbuf, int *sendcounts, int *sdispls,
 }
 
 /* ---------------------------------------------------------------------- */
+
+/* only one proc, so it has no neighbors to send to or receive from */
+
+int MPI_Neighbor_alltoall(void *sendbuf, int sendcount, MPI_Datatype sendtype,
+                          void *recvbuf, int recvcount, MPI_Datatype recvtype,
+                          MPI_Comm comm)
+{
+  return 0;
+}
+
+/* ---------------------------------------------------------------------- */
+
+int MPI_Neighbor_alltoallv(void *sendbuf, int *sendcounts, int *sdispls,
+                           MPI_Datatype sendtype,
+                           void *recvbuf, int *recvcounts, int *rdispls,
+                           MPI_Datatype recvtype, MPI_Comm comm)
+{
+  return 0;
+}
+
+/* ---------------------------------------------------------------------- */
+
+/* MPI-IO stubs map onto stdio, there is only one proc */
+
+int MPI_File_open(MPI_Comm comm, const char *filename, int amode,
+                  MPI_Info info, MPI_File *fh)
+{
+  if (amode & MPI_MODE_RDONLY) *fh = fopen(filename,"rb");
+  else {
+    *fh = fopen(filename,"r+b");
+    if (*fh == NULL && (amode & MPI_MODE_CREATE)) *fh = fopen(filename,"w+b");
+  }
+  if (*fh == NULL) return MPI_ERR_ARG;
+  return 0;
+}
+
+/* ---------------------------------------------------------------------- */
+
+int MPI_File_close(MPI_File *fh)
+{
+  if (*fh) fclose(*fh);
+  *fh = NULL;
+  return 0;
+}
+
+/* ---------------------------------------------------------------------- */
+
+int MPI_File_set_size(MPI_File fh, MPI_Offset size)
+{
+  if (size != 0) return MPI_ERR_ARG;
+  fflush(fh);
+  if (ftruncate(fileno(fh),0)) return MPI_ERR_ARG;
+  return 0;
+}
+
+/* ---------------------------------------------------------------------- */
+
+int MPI_File_get_size(MPI_File fh, MPI_Offset *size)
+{
+  fseek(fh,0,SEEK_END);
+  *size = ftell(fh);
+  return 0;
+}
+
+/* ---------------------------------------------------------------------- */
+
+int MPI_File_write_at(MPI_File fh, MPI_Offset offset, const void *buf,
+                      int count, MPI_Datatype datatype, MPI_Status *status)
+{
+  int n = stubtypesize(datatype);
+  if (fseek(fh,offset,SEEK_SET)) return MPI_ERR_ARG;
+  if (fwrite(buf,n,count,fh) != count) return MPI_ERR_ARG;
+  return 0;
+}
+
+/* ---------------------------------------------------------------------- */
+
+int MPI_File_write_at_all(MPI_File fh, MPI_Offset offset, const void *buf,
+                          int count, MPI_Datatype datatype,
+                          MPI_Status *status)
+{
+  return MPI_File_write_at(fh,offset,buf,count,datatype,status);
+}
+
+/* ---------------------------------------------------------------------- */
+
+int MPI_File_read_at(MPI_File fh, MPI_Offset offset, void *buf,
+                     int count, MPI_Datatype datatype, MPI_Status *status)
+{
+  int n = stubtypesize(datatype);
+  if (fseek(fh,offset,SEEK_SET)) return MPI_ERR_ARG;
+  if (fread(buf,n,count,fh) != count) return MPI_ERR_ARG;
+  return 0;
+}
+
+/* ---------------------------------------------------------------------- */
+
+int MPI_File_read_at_all(MPI_File fh, MPI_Offset offset, void *buf,
+                         int count, MPI_Datatype datatype,
+                         MPI_Status *status)
+{
+  return MPI_File_read_at(fh,offset,buf,count,datatype,status);
+}
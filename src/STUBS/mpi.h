@@ -16,6 +16,7 @@
 #define MPI_STUBS
 
 #include <stdlib.h>
+#include <stdio.h>
 
 /* use C bindings for MPI interface */
 
@@ -60,6 +61,14 @@ extern "C" {
 #define MPI_Fint int
 #define MPI_Group int
 #define MPI_Offset long
+#define MPI_File FILE*
+#define MPI_Info int
+
+#define MPI_INFO_NULL 0
+#define MPI_UNWEIGHTED ((int *) 0)
+#define MPI_MODE_RDONLY 2
+#define MPI_MODE_WRONLY 4
+#define MPI_MODE_CREATE 1
 
 #define MPI_IN_PLACE NULL
 
@@ -128,6 +137,13 @@ int MPI_Cart_shift(MPI_Comm comm, int direction, int displ,
                    int *source, int *dest);
 int MPI_Cart_rank(MPI_Comm comm, int *coords, int *rank);
 
+int MPI_Dist_graph_create_adjacent(MPI_Comm comm_old, int indegree,
+                                   const int *sources,
+                                   const int *sourceweights,
+                                   int outdegree, const int *destinations,
+                                   const int *destweights, MPI_Info info,
+                                   int reorder, MPI_Comm *comm_dist_graph);
+
 int MPI_Type_contiguous(int count, MPI_Datatype oldtype,
                         MPI_Datatype *newtype);
 int MPI_Type_commit(MPI_Datatype *datatype);
@@ -172,6 +188,29 @@ int MPI_Alltoallv(void *sendbuf, int *sendcounts, int *sdispls,
                   MPI_Datatype sendtype,
                   void *recvbuf, int *recvcounts, int *rdispls,
                   MPI_Datatype recvtype, MPI_Comm comm);
+int MPI_Neighbor_alltoall(void *sendbuf, int sendcount, MPI_Datatype sendtype,
+                          void *recvbuf, int recvcount, MPI_Datatype recvtype,
+                          MPI_Comm comm);
+int MPI_Neighbor_alltoallv(void *sendbuf, int *sendcounts, int *sdispls,
+                           MPI_Datatype sendtype,
+                           void *recvbuf, int *recvcounts, int *rdispls,
+                           MPI_Datatype recvtype, MPI_Comm comm);
+
+int MPI_File_open(MPI_Comm comm, const char *filename, int amode,
+                  MPI_Info info, MPI_File *fh);
+int MPI_File_close(MPI_File *fh);
+int MPI_File_set_size(MPI_File fh, MPI_Offset size);
+int MPI_File_get_size(MPI_File fh, MPI_Offset *size);
+int MPI_File_write_at(MPI_File fh, MPI_Offset offset, const void *buf,
+                      int count, MPI_Datatype datatype, MPI_Status *status);
+int MPI_File_write_at_all(MPI_File fh, MPI_Offset offset, const void *buf,
+                          int count, MPI_Datatype datatype,
+                          MPI_Status *status);
+int MPI_File_read_at(MPI_File fh, MPI_Offset offset, void *buf,
+                     int count, MPI_Datatype datatype, MPI_Status *status);
+int MPI_File_read_at_all(MPI_File fh, MPI_Offset offset, void *buf,
+                         int count, MPI_Datatype datatype,
+                         MPI_Status *status);
 /* ---------------------------------------------------------------------- */
 
 #ifdef __cplusplus
@@ -102,8 +102,10 @@ void AdaptGrid::command(int narg, char **arg)
 
   // invoke init()
   // so all grid cell info including collide & fixes is ready to migrate
+  // stash ghosts so they can be patched after adaptation, not re-acquired
 
   sparta->init();
+  grid->stash_ghosts();
   grid->remove_ghosts();
 
   // iterate over refinement and coarsening actions
@@ -1593,6 +1595,9 @@ void AdaptGrid::particle_surf_comm()
       }
       sadapt[i].np = np;
     }
+    sadapt[i].wsum = 0.0;
+    if (grid->cellweightflag)
+      sadapt[i].wsum = sadapt[i].np * grid->weight_ratio(icell);
   }
 
   memory->sfree(outbuf);
@@ -1637,6 +1642,7 @@ void AdaptGrid::particle_surf_comm()
       alist[m].parentID = s->parentID;
       alist[m].plevel = s->plevel;
       alist[m].anyinside = 0;
+      alist[m].npall = alist[m].wsum = 0.0;
       nchild = plevels[s->plevel].nxyz;
       alist[m].nchild = nchild;
       alist[m].index = new int[nchild];
@@ -1647,6 +1653,8 @@ void AdaptGrid::particle_surf_comm()
     } else m = (*alhash)[parentID];
 
     if (s->type == INSIDE) alist[m].anyinside = 1;
+    alist[m].npall += s->np;
+    alist[m].wsum += s->wsum;
 
     ichild = s->ichild;
     if (s->proc == me) alist[m].index[ichild] = s->icell;
@@ -1731,12 +1739,21 @@ int AdaptGrid::perform_coarsen()
     if (cells[newcell].nsurf == 0 && alist[i].anyinside)
       cinfo[newcell].type = INSIDE;
 
+    // weight of new child is its base weight times the particle-weighted
+    //   mean of its children's ratios of weight to base weight
+    // conserves # of molecules when merged children are coarsened
+
+    double wratio = 1.0;
+    if (grid->cellweightflag && alist[i].npall > 0.0)
+      wratio = alist[i].wsum / alist[i].npall;
+
     // set group mask of new child and its sub-cells to groupbit + all
     // NOTE: could set mask to intersection of all old children
     //       to attempt to preserve other group settings
 
     mask = groupbit | 1;
     cinfo[newcell].mask = mask;
+    cinfo[newcell].weight *= wratio;
 
     if (cells[newcell].nsplit > 1) {
       sinfo = grid->sinfo;
@@ -1745,6 +1762,7 @@ int AdaptGrid::perform_coarsen()
       for (int j = 0; j < nsplit; j++) {
         jcell = csubs[j];
         cinfo[jcell].mask = mask;
+        cinfo[jcell].weight *= wratio;
       }
     }
 
@@ -42,6 +42,7 @@ class AdaptGrid : protected Pointers {
     int ichild;             // which child within parent cell (0 to Nxyz-1)
     int nsurf;              // # of surfs in child cell
     int np;                 // # of particles in child cell or all its sub cells
+    double wsum;            // np times ratio of cell weight to base weight
   };
 
   AdaptGrid(class SPARTA *);
@@ -105,6 +106,7 @@ class AdaptGrid : protected Pointers {
     int *np;                // # of particles in each child cell
     void **surfs;           // list of surf info per cell (indices or lines/tris)
     char **particles;       // list of particles in each child cell
+    double npall,wsum;      // sums of SendAdapt np and wsum over children
   };
 
   struct CList *clist;
@@ -22,6 +22,7 @@
 #include "modify.h"
 #include "comm.h"
 #include "rcb.h"
+#include "sfc.h"
 #include "output.h"
 #include "dump.h"
 #include "random_mars.h"
@@ -34,7 +35,7 @@ using namespace SPARTA_NS;
 
 //#define RCB_DEBUG 1     // un-comment to include RCB proc boxes in image
 
-enum{NONE,STRIDE,CLUMP,BLOCK,RANDOM,PROC,BISECTION};
+enum{NONE,STRIDE,CLUMP,BLOCK,RANDOM,PROC,BISECTION,SFCURVE};
 enum{XYZ,XZY,YXZ,YZX,ZXY,ZYX};
 enum{CELL,PARTICLE,TIME};
 
@@ -58,6 +59,7 @@ void BalanceGrid::command(int narg, char **arg, int outflag)
   int bstyle,order;
   int px,py,pz;
   int rcbwt;
+  int curve = SFC::HILBERT;
   int iarg;
 
   if (strcmp(arg[0],"none") == 0) {
@@ -117,7 +119,19 @@ void BalanceGrid::command(int narg, char **arg, int outflag)
     else if (strcmp(arg[1],"time") == 0) rcbwt = TIME;
     else error->all(FLERR,"Illegal balance_grid command");
     iarg = 2;
-  }
+
+  } else if (strcmp(arg[0],"sfc") == 0) {
+    if (narg < 3) error->all(FLERR,"Illegal balance_grid command");
+    bstyle = SFCURVE;
+    if (strcmp(arg[1],"hilbert") == 0) curve = SFC::HILBERT;
+    else if (strcmp(arg[1],"morton") == 0) curve = SFC::MORTON;
+    else error->all(FLERR,"Illegal balance_grid command");
+    if (strcmp(arg[2],"cell") == 0) rcbwt = CELL;
+    else if (strcmp(arg[2],"part") == 0) rcbwt = PARTICLE;
+    else if (strcmp(arg[2],"time") == 0) rcbwt = TIME;
+    else error->all(FLERR,"Illegal balance_grid command");
+    iarg = 3;
+  } else error->all(FLERR,"Illegal balance_grid command");
 
   // optional args
 
@@ -288,9 +302,7 @@ void BalanceGrid::command(int narg, char **arg, int outflag)
 
     delete random;
 
-  } else if (bstyle == BISECTION) {
-    RCB *rcb = new RCB(sparta);
-
+  } else if (bstyle == BISECTION || bstyle == SFCURVE) {
     double **x;
     memory->create(x,nglocal,3,"balance_grid:x");
 
@@ -328,32 +340,53 @@ void BalanceGrid::command(int narg, char **arg, int outflag)
       timer_cell_weights(wt);
     }
 
-    rcb->compute(nbalance,x,wt,eligible,rcbflip);
+    // RCB returns new owners via invert(), SFC assigns them in place
+
+    if (bstyle == BISECTION) {
+      RCB *rcb = new RCB(sparta);
+      rcb->compute(nbalance,x,wt,eligible,rcbflip);
 
-    // DEBUG info for dump image
+      // DEBUG info for dump image
 
 #ifdef RCB_DEBUG
 
-    update->rcblo[0] = rcb->lo[0];
-    update->rcblo[1] = rcb->lo[1];
-    update->rcblo[2] = rcb->lo[2];
-    update->rcbhi[0] = rcb->hi[0];
-    update->rcbhi[1] = rcb->hi[1];
-    update->rcbhi[2] = rcb->hi[2];
+      update->rcblo[0] = rcb->lo[0];
+      update->rcblo[1] = rcb->lo[1];
+      update->rcblo[2] = rcb->lo[2];
+      update->rcbhi[0] = rcb->hi[0];
+      update->rcbhi[1] = rcb->hi[1];
+      update->rcbhi[2] = rcb->hi[2];
 
 #endif
 
-    rcb->invert();
+      rcb->invert();
 
-    nbalance = 0;
-    int *sendproc = rcb->sendproc;
-    for (int icell = 0; icell < nglocal; icell++) {
-      if (cells[icell].nsplit <= 0) continue;
-      cells[icell].proc = sendproc[nbalance++];
+      nbalance = 0;
+      int *sendproc = rcb->sendproc;
+      for (int icell = 0; icell < nglocal; icell++) {
+        if (cells[icell].nsplit <= 0) continue;
+        cells[icell].proc = sendproc[nbalance++];
+      }
+      nmigrate = nbalance - rcb->nkeep;
+
+      delete rcb;
+
+    } else {
+      SFC *sfc = new SFC(sparta,curve);
+      sfc->compute(nbalance,x,wt);
+
+      nbalance = 0;
+      int *sfcproc = sfc->proc;
+      for (int icell = 0; icell < nglocal; icell++) {
+        if (cells[icell].nsplit <= 0) continue;
+        newproc = sfcproc[nbalance++];
+        if (newproc != cells[icell].proc) nmigrate++;
+        cells[icell].proc = newproc;
+      }
+
+      delete sfc;
     }
-    nmigrate = nbalance - rcb->nkeep;
 
-    delete rcb;
     memory->destroy(x);
     memory->destroy(wt);
   }
@@ -361,7 +394,8 @@ void BalanceGrid::command(int narg, char **arg, int outflag)
   // set clumped or not, depending on style
   // NONE style does not change clumping
 
-  if (nprocs == 1 || bstyle == CLUMP || bstyle == BLOCK || bstyle == BISECTION)
+  if (nprocs == 1 || bstyle == CLUMP || bstyle == BLOCK ||
+      bstyle == BISECTION || bstyle == SFCURVE)
     grid->clumped = 1;
   else if (bstyle != NONE) grid->clumped = 0;
 
@@ -439,10 +473,20 @@ void BalanceGrid::command(int narg, char **arg, int outflag)
   MPI_Allreduce(&count,&nmigrate_all,1,MPI_SPARTA_BIGINT,MPI_SUM,world);
   double time_total = time5-time1;
 
+  // ghost cell count is a measure of per-step ghost/macro exchange volume
+  //   for the new decomposition, useful for comparing balance styles
+
+  count = grid->nghost;
+  bigint nghost_all,nghost_max;
+  MPI_Allreduce(&count,&nghost_all,1,MPI_SPARTA_BIGINT,MPI_SUM,world);
+  MPI_Allreduce(&count,&nghost_max,1,MPI_SPARTA_BIGINT,MPI_MAX,world);
+
   if (comm->me == 0 && outflag) {
     if (screen) {
       fprintf(screen,"Balance grid migrated " BIGINT_FORMAT " cells\n",
               nmigrate_all);
+      fprintf(screen,"  ghost cells = " BIGINT_FORMAT " total, "
+              BIGINT_FORMAT " max per proc\n",nghost_all,nghost_max);
       fprintf(screen,"  CPU time = %g secs\n",time_total);
       fprintf(screen,"  reassign/sort/migrate/ghost percent = %g %g %g %g\n",
               100.0*(time2-time1)/time_total,100.0*(time3-time2)/time_total,
@@ -451,6 +495,8 @@ void BalanceGrid::command(int narg, char **arg, int outflag)
     if (logfile) {
       fprintf(logfile,"Balance grid migrated " BIGINT_FORMAT " cells\n",
               nmigrate_all);
+      fprintf(logfile,"  ghost cells = " BIGINT_FORMAT " total, "
+              BIGINT_FORMAT " max per proc\n",nghost_all,nghost_max);
       fprintf(logfile,"  CPU time = %g secs\n",time_total);
       fprintf(logfile,"  reassign/sort/migrate/ghost percent = %g %g %g %g\n",
               100.0*(time2-time1)/time_total,100.0*(time3-time2)/time_total,
@@ -36,6 +36,8 @@ enum{NONE,DISCRETE,SMOOTH};            // several files
 enum{CONSTANT,VARIABLE};
 
 #define MAXLINE 1024
+#define NBATCH 64             // # of collision attempts per batch
+#define DELTAMARK 128
 
 /* ---------------------------------------------------------------------- */
 
@@ -47,6 +49,7 @@ CollideVSS::CollideVSS(SPARTA *sparta, int narg, char **arg) :
   // optional args
 
   relaxflag = CONSTANT;
+  batchflag = 1;
 
   int iarg = 3;
   while (iarg < narg) {
@@ -56,9 +59,19 @@ CollideVSS::CollideVSS(SPARTA *sparta, int narg, char **arg) :
       else if (strcmp(arg[iarg+1],"variable") == 0) relaxflag = VARIABLE;
       else error->all(FLERR,"Illegal collide command");
       iarg += 2;
+    } else if (strcmp(arg[iarg],"batch") == 0) {
+      if (iarg+2 > narg) error->all(FLERR,"Illegal collide command");
+      if (strcmp(arg[iarg+1],"yes") == 0) batchflag = 1;
+      else if (strcmp(arg[iarg+1],"no") == 0) batchflag = 0;
+      else error->all(FLERR,"Illegal collide command");
+      iarg += 2;
     } else error->all(FLERR,"Illegal collide command");
   }
 
+  batch_active = 0;
+  maxmark = 0;
+  pmark = NULL;
+
   // proc 0 reads file to extract params for current species
   // broadcasts params to all procs
 
@@ -83,6 +96,7 @@ CollideVSS::~CollideVSS()
 
   memory->destroy(params);
   memory->destroy(prefactor);
+  memory->destroy(pmark);
 }
 
 /* ---------------------------------------------------------------------- */
@@ -95,6 +109,253 @@ void CollideVSS::init()
     error->all(FLERR,"VSS parameters do not match current species");
 
   Collide::init();
+
+  // batched kernel is selected for a single monatomic species
+  //   with no chemistry, no ambipolar, and no near-neighbor collisions
+  // in that case every collision is a pure elastic VSS scattering
+
+  batch_active = 0;
+  if (batchflag && !kokkos_flag && ngroups == 1 && particle->nspecies == 1 &&
+      !react && !ambiflag && !nearcp) {
+    Particle::Species *species = particle->species;
+    if (species[0].rotdof == 0 && species[0].vibdof == 0) batch_active = 1;
+  }
+
+  if (batch_active) {
+    double alpha_r = 1.0 / params[0][0].alpha;
+    if (fabs(alpha_r - 1.0) < 0.001) batch_isotropic = 1;
+    else batch_isotropic = 0;
+  }
+}
+
+/* ----------------------------------------------------------------------
+   NTC algorithm, use batched kernel if init() selected it
+------------------------------------------------------------------------- */
+
+void CollideVSS::collisions()
+{
+  if (!batch_active) {
+    Collide::collisions();
+    return;
+  }
+
+  // if requested, reset vrwmax & remain
+
+  if (update->ntimestep == vre_next) {
+    reset_vremax();
+    vre_next += vre_every;
+  }
+
+  ncollide_one = nattempt_one = nreact_one = 0;
+  ndelete = 0;
+
+  if (batch_isotropic) collisions_one_batch<1>();
+  else collisions_one_batch<0>();
+
+  nattempt_running += nattempt_one;
+  ncollide_running += ncollide_one;
+}
+
+/* ----------------------------------------------------------------------
+   NTC algorithm for a single monatomic species without chemistry
+   attempts are processed in batches of NBATCH:
+     pair selection and RNs are drawn up front,
+     vr2 and collision rate are evaluated for the whole batch,
+     acceptance is tested in attempt order,
+     accepted pairs are scattered together
+   pmark stamps detect a particle reused within a batch:
+     its precomputed vr2 is stale and is recomputed,
+     if its previous collision is still pending, pending pairs are
+     scattered first so attempt-order semantics are preserved
+------------------------------------------------------------------------- */
+
+template < int ISOTROPIC > void CollideVSS::collisions_one_batch()
+{
+  int i,j,k,n,ip,np,nb,npend,stamp_batch,stamp_pend;
+  int nattempt;
+  double attempt,volume,vre,du,dv,dw;
+  double *vi,*vj;
+
+  int ibatch[NBATCH],jbatch[NBATCH];
+  int ipend[NBATCH],jpend[NBATCH];
+  double vr2batch[NBATCH],vrebatch[NBATCH];
+  double vr2pend[NBATCH],ueps[NBATCH],ucos[NBATCH];
+
+  Grid::ChildInfo *cinfo = grid->cinfo;
+
+  Particle::OnePart *particles = particle->particles;
+  int *next = particle->next;
+
+  double omega1 = 1.0 - params[0][0].omega;
+  double pre = prefactor[0][0];
+
+  for (int icell = 0; icell < nglocal; icell++) {
+    np = cinfo[icell].count;
+    if (np <= 1) continue;
+
+    ip = cinfo[icell].first;
+    volume = cinfo[icell].volume / cinfo[icell].weight * grid->cells[icell].dt_weight;
+    if (volume == 0.0) error->one(FLERR,"Collision cell volume is zero");
+
+    // setup particle list for this cell
+
+    if (np > npmax) {
+      while (np > npmax) npmax += DELTAPART;
+      memory->destroy(plist);
+      memory->create(plist,npmax,"collide:plist");
+    }
+
+    n = 0;
+    while (ip >= 0) {
+      plist[n++] = ip;
+      ip = next[ip];
+    }
+
+    attempt = CollideVSS::attempt_collision(icell,np,volume);
+    nattempt = static_cast<int> (attempt);
+
+    if (!nattempt) continue;
+    nattempt_one += nattempt;
+
+    if (np > maxmark) {
+      while (np > maxmark) maxmark += DELTAMARK;
+      memory->destroy(pmark);
+      memory->create(pmark,maxmark,"collide:pmark");
+    }
+    memset(pmark,0,np*sizeof(int));
+    stamp_pend = 0;
+
+    double *vremax_cell = &vremax[icell][0][0];
+
+    for (int ifirst = 0; ifirst < nattempt; ifirst += NBATCH) {
+      nb = MIN(NBATCH,nattempt-ifirst);
+
+      // select random pairs of particles, cannot be same
+
+      for (k = 0; k < nb; k++) {
+        i = np * random->uniform();
+        j = np * random->uniform();
+        while (i == j) j = np * random->uniform();
+        ibatch[k] = i;
+        jbatch[k] = j;
+      }
+
+      // relative velocity and collision rate for entire batch
+
+      for (k = 0; k < nb; k++) {
+        vi = particles[plist[ibatch[k]]].v;
+        vj = particles[plist[jbatch[k]]].v;
+        du = vi[0] - vj[0];
+        dv = vi[1] - vj[1];
+        dw = vi[2] - vj[2];
+        vr2batch[k] = du*du + dv*dv + dw*dw;
+      }
+
+      for (k = 0; k < nb; k++)
+        vrebatch[k] = pre * pow(vr2batch[k],omega1);
+
+      // test each attempt in order, same criterion as test_collision()
+
+      stamp_batch = ++stamp_pend;
+      npend = 0;
+
+      for (k = 0; k < nb; k++) {
+        i = ibatch[k];
+        j = jbatch[k];
+
+        if (pmark[i] >= stamp_batch || pmark[j] >= stamp_batch) {
+          if (pmark[i] == stamp_pend || pmark[j] == stamp_pend) {
+            batch_scatter<ISOTROPIC>(npend,ipend,jpend,vr2pend,ueps,ucos);
+            npend = 0;
+            stamp_pend++;
+          }
+          vi = particles[plist[i]].v;
+          vj = particles[plist[j]].v;
+          du = vi[0] - vj[0];
+          dv = vi[1] - vj[1];
+          dw = vi[2] - vj[2];
+          vr2batch[k] = du*du + dv*dv + dw*dw;
+          vrebatch[k] = pre * pow(vr2batch[k],omega1);
+        }
+
+        vre = vrebatch[k];
+        *vremax_cell = MAX(vre,*vremax_cell);
+        if (vre / *vremax_cell < random->uniform()) continue;
+
+        ipend[npend] = plist[i];
+        jpend[npend] = plist[j];
+        vr2pend[npend] = vr2batch[k];
+        ueps[npend] = random->uniform();
+        ucos[npend] = random->uniform();
+        npend++;
+        pmark[i] = pmark[j] = stamp_pend;
+        ncollide_one++;
+      }
+
+      batch_scatter<ISOTROPIC>(npend,ipend,jpend,vr2pend,ueps,ucos);
+      stamp_pend++;
+    }
+  }
+}
+
+/* ----------------------------------------------------------------------
+   elastic VSS scattering for N accepted pairs of equal-mass particles
+   no particle appears in more than one pair, so loop is vectorizable
+   same math as SCATTER_TwoBodyScattering() with postcoln.etrans =
+     precoln.etrans, i.e. scale factor = 1 and unchanged |vr|
+------------------------------------------------------------------------- */
+
+template < int ISOTROPIC >
+void CollideVSS::batch_scatter(int n, int *ilist, int *jlist, double *vr2,
+                               double *ueps, double *ucos)
+{
+  double ua,vb,wc,vr,eps,cosX,sinX,ucm,vcm,wcm,d;
+  double vrc[3];
+  double *vi,*vj;
+
+  Particle::OnePart *particles = particle->particles;
+  double alpha_r = 1.0 / params[0][0].alpha;
+
+  for (int k = 0; k < n; k++) {
+    vi = particles[ilist[k]].v;
+    vj = particles[jlist[k]].v;
+    eps = ueps[k] * 2*MY_PI;
+    vr = sqrt(vr2[k]);
+
+    if (ISOTROPIC) {
+      cosX = 2.0*ucos[k] - 1.0;
+      sinX = sqrt(1.0 - cosX*cosX);
+      ua = vr*cosX;
+      vb = vr*sinX*cos(eps);
+      wc = vr*sinX*sin(eps);
+    } else {
+      cosX = 2.0*pow(ucos[k],alpha_r) - 1.0;
+      sinX = sqrt(1.0 - cosX*cosX);
+      vrc[0] = vi[0]-vj[0];
+      vrc[1] = vi[1]-vj[1];
+      vrc[2] = vi[2]-vj[2];
+      d = sqrt(vrc[1]*vrc[1]+vrc[2]*vrc[2]);
+      if (d > 1.0e-6) {
+        ua = cosX*vrc[0] + sinX*d*sin(eps);
+        vb = cosX*vrc[1] + sinX*(vr*vrc[2]*cos(eps) - vrc[0]*vrc[1]*sin(eps))/d;
+        wc = cosX*vrc[2] - sinX*(vr*vrc[1]*cos(eps) + vrc[0]*vrc[2]*sin(eps))/d;
+      } else {
+        ua = cosX*vrc[0];
+        vb = sinX*vrc[0]*cos(eps);
+        wc = sinX*vrc[0]*sin(eps);
+      }
+    }
+
+    ucm = 0.5 * (vi[0]+vj[0]);
+    vcm = 0.5 * (vi[1]+vj[1]);
+    wcm = 0.5 * (vi[2]+vj[2]);
+    vi[0] = ucm + 0.5*ua;
+    vi[1] = vcm + 0.5*vb;
+    vi[2] = wcm + 0.5*wc;
+    vj[0] = ucm - 0.5*ua;
+    vj[1] = vcm - 0.5*vb;
+    vj[2] = wcm - 0.5*wc;
+  }
 }
 
 /* ----------------------------------------------------------------------
@@ -31,6 +31,7 @@ class CollideVSS : public Collide {
   CollideVSS(class SPARTA *, int, char **);
   virtual ~CollideVSS();
   virtual void init();
+  virtual void collisions();
 
   double vremax_init(int, int);
   virtual double attempt_collision(int, int, double);
@@ -75,6 +76,12 @@ class CollideVSS : public Collide {
  protected:
   int relaxflag,eng_exchange;
   double vr_indice;
+
+  int batchflag;              // 1 if batched kernel is allowed, 0 if not
+  int batch_active;           // 1 if batched kernel was selected by init()
+  int batch_isotropic;        // 1 if VHS (alpha = 1), 0 if VSS scattering
+  int maxmark;                // allocated size of pmark
+  int *pmark;                 // per-plist stamp of last batch touching it
   double **prefactor; // static portion of collision attempt frequency
 
   struct State precoln;       // state before collision
@@ -94,6 +101,10 @@ class CollideVSS : public Collide {
                                    Particle::OnePart *,
                                    Particle::OnePart *);
 
+  template < int > void collisions_one_batch();
+  template < int > void batch_scatter(int, int *, int *, double *,
+                                      double *, double *);
+
   double sample_bl(RanPark *, double, double);
   double rotrel (int, double);
   double vibrel (int, double);
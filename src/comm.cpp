@@ -43,6 +43,14 @@ Comm::Comm(SPARTA *sparta) : Pointers(sparta)
 
   neighflag = 0;
   neighlist = NULL;
+  neighsortflag = 0;
+
+  graphflag = 0;
+  graphcomm = MPI_COMM_NULL;
+  nsource = 0;
+  sourcelist = graphindex = NULL;
+  gscount = grcount = NULL;
+  gsbytes = gsdispls = grbytes = grdispls = goffset = NULL;
 
   iparticle = new Irregular(sparta);
   igrid = NULL;
@@ -75,6 +83,7 @@ Comm::~Comm()
   memory->destroy(rbuf);
 
   memory->destroy(neighlist);
+  destroy_graph();
 }
 
 /* ----------------------------------------------------------------------
@@ -82,31 +91,161 @@ Comm::~Comm()
    invoked after grid decomposition changes
    no-op if commpartstyle not set or grid decomposition not clumped
      since different mode of irregular comm will be done
+   for commpartstyle = 2, also rebuild graph topology of neighbor procs
+   existing plan is kept if no proc's neighbor procs changed,
+     e.g. after grid adaptation with ghosts from all procs
 ------------------------------------------------------------------------- */
 
 void Comm::reset_neighbors()
 {
+  int oldflag = neighflag;
   neighflag = 0;
-  if (!commpartstyle || !grid->clumped) return;
+  if (!commpartstyle || !grid->clumped) {
+    if (graphflag) destroy_graph();
+    return;
+  }
   neighflag = 1;
 
-  if (neighlist == NULL)
-    memory->create(neighlist,nprocs,"comm:neighlist");
-  for (int i = 0; i < nprocs; i++) neighlist[i] = 0;
+  // flag = procs I own ghost cells of
+
+  int *flag;
+  memory->create(flag,nprocs,"comm:flag");
+  for (int i = 0; i < nprocs; i++) flag[i] = 0;
 
   Grid::ChildCell *cells = grid->cells;
   int nglocal = grid->nlocal;
   int ntotal = nglocal + grid->nghost;
 
   for (int icell = nglocal; icell < ntotal; icell++)
-    neighlist[cells[icell].proc] = 1;
-  neighlist[me] = 0;
+    flag[cells[icell].proc] = 1;
+  flag[me] = 0;
+
+  // same = 1 if my neighbor list and its comm settings are unchanged
+
+  int same = 0;
+  if (oldflag && neighlist && neighsortflag == commsortflag &&
+      graphflag == (commpartstyle == 2)) {
+    int n = 0;
+    for (int i = 0; i < nprocs; i++)
+      if (flag[i]) n++;
+    same = (n == nneigh);
+    for (int i = 0; i < nneigh && same; i++)
+      if (!flag[neighlist[i]]) same = 0;
+  }
+
+  int allsame;
+  MPI_Allreduce(&same,&allsame,1,MPI_INT,MPI_MIN,world);
+  if (allsame) {
+    memory->destroy(flag);
+    return;
+  }
+
+  if (graphflag) destroy_graph();
+
+  if (neighlist == NULL)
+    memory->create(neighlist,nprocs,"comm:neighlist");
 
   nneigh = 0;
   for (int i = 0; i < nprocs; i++)
-    if (neighlist[i]) neighlist[nneigh++] = i;
+    if (flag[i]) neighlist[nneigh++] = i;
+  memory->destroy(flag);
 
   iparticle->create_procs(nneigh,neighlist,commsortflag);
+  neighsortflag = commsortflag;
+
+  if (commpartstyle == 2) create_graph();
+}
+
+/* ----------------------------------------------------------------------
+   create distributed graph topology for particle comm
+   destinations = my neighbor procs, sources = procs I am a neighbor of
+   the two lists differ if ghost cell extents differ between procs
+   both lists are in ascending proc order,
+     so recv particles are always appended in the same order
+------------------------------------------------------------------------- */
+
+void Comm::create_graph()
+{
+  int i;
+
+  memory->create(sourcelist,nprocs,"comm:sourcelist");
+  memory->create(graphindex,nprocs,"comm:graphindex");
+
+  // nsource = # of procs that have me as a neighbor
+
+  int *counts;
+  memory->create(counts,nprocs,"comm:counts");
+  for (i = 0; i < nprocs; i++) {
+    graphindex[i] = 0;
+    counts[i] = 1;
+  }
+  for (i = 0; i < nneigh; i++) graphindex[neighlist[i]] = 1;
+
+  MPI_Reduce_scatter(graphindex,&nsource,counts,MPI_INT,MPI_SUM,world);
+  memory->destroy(counts);
+
+  // send my proc ID to each neighbor, recv IDs of source procs
+
+  MPI_Request *request = new MPI_Request[nsource];
+  for (i = 0; i < nsource; i++)
+    MPI_Irecv(&sourcelist[i],1,MPI_INT,MPI_ANY_SOURCE,0,world,&request[i]);
+  for (i = 0; i < nneigh; i++)
+    MPI_Send(&me,1,MPI_INT,neighlist[i],0,world);
+  if (nsource) MPI_Waitall(nsource,request,MPI_STATUS_IGNORE);
+  delete [] request;
+
+  // sort sources by flagging them in graphindex
+
+  for (i = 0; i < nprocs; i++) graphindex[i] = 0;
+  for (i = 0; i < nsource; i++) graphindex[sourcelist[i]] = 1;
+  nsource = 0;
+  for (i = 0; i < nprocs; i++)
+    if (graphindex[i]) sourcelist[nsource++] = i;
+
+  // graphindex = index of each proc in neighlist, -1 if not a neighbor
+
+  for (i = 0; i < nprocs; i++) graphindex[i] = -1;
+  for (i = 0; i < nneigh; i++) graphindex[neighlist[i]] = i;
+
+  MPI_Dist_graph_create_adjacent(world,nsource,sourcelist,MPI_UNWEIGHTED,
+                                 nneigh,neighlist,MPI_UNWEIGHTED,
+                                 MPI_INFO_NULL,0,&graphcomm);
+
+  memory->create(gscount,nneigh+1,"comm:gscount");
+  memory->create(gsbytes,nneigh+1,"comm:gsbytes");
+  memory->create(gsdispls,nneigh+1,"comm:gsdispls");
+  memory->create(goffset,nneigh+1,"comm:goffset");
+  memory->create(grcount,nsource+1,"comm:grcount");
+  memory->create(grbytes,nsource+1,"comm:grbytes");
+  memory->create(grdispls,nsource+1,"comm:grdispls");
+
+  graphflag = 1;
+}
+
+/* ----------------------------------------------------------------------
+   free graph topology and its per-proc arrays
+------------------------------------------------------------------------- */
+
+void Comm::destroy_graph()
+{
+  if (graphcomm != MPI_COMM_NULL) MPI_Comm_free(&graphcomm);
+  graphcomm = MPI_COMM_NULL;
+
+  memory->destroy(sourcelist);
+  memory->destroy(graphindex);
+  memory->destroy(gscount);
+  memory->destroy(grcount);
+  memory->destroy(gsbytes);
+  memory->destroy(gsdispls);
+  memory->destroy(grbytes);
+  memory->destroy(grdispls);
+  memory->destroy(goffset);
+
+  sourcelist = graphindex = NULL;
+  gscount = grcount = NULL;
+  gsbytes = gsdispls = grbytes = grdispls = goffset = NULL;
+  nsource = 0;
+  graphflag = 0;
 }
 
 /* ----------------------------------------------------------------------
@@ -117,6 +256,8 @@ void Comm::reset_neighbors()
 
 int Comm::migrate_particles(int nmigrate, int *plist)
 {
+  if (graphflag) return migrate_particles_graph(nmigrate,plist);
+
   int i,j;
 
   Grid::ChildCell *cells = grid->cells;
@@ -225,6 +366,136 @@ int Comm::migrate_particles(int nmigrate, int *plist)
   return ncompress;
 }
 
+/* ----------------------------------------------------------------------
+   migrate particles via neighbor collectives on graph topology
+   particles are packed directly into per-destination segments of sbuf,
+     so no irregular plan or extra copy into a send buffer is needed
+   one neighbor alltoall for counts, one neighbor alltoallv for particles
+   return particle nlocal after compression
+------------------------------------------------------------------------- */
+
+int Comm::migrate_particles_graph(int nmigrate, int *plist)
+{
+  int i,j,k;
+
+  Grid::ChildCell *cells = grid->cells;
+  Particle::OnePart *particles = particle->particles;
+
+  int ncustom = particle->ncustom;
+  int nbytes_particle = sizeof(Particle::OnePart);
+  int nbytes_custom = particle->sizeof_custom();
+  int nbytes = nbytes_particle + nbytes_custom;
+
+  if (nmigrate > maxpproc) {
+    maxpproc = nmigrate;
+    memory->destroy(pproc);
+    memory->create(pproc,maxpproc,"comm:pproc");
+  }
+
+  // pproc = index of neighbor proc each particle goes to, -1 if PDISCARD
+  // gscount = # of particles to send to each neighbor
+
+  for (k = 0; k < nneigh; k++) gscount[k] = 0;
+
+  for (i = 0; i < nmigrate; i++) {
+    j = plist[i];
+    if (particles[j].flag == PDISCARD) {
+      pproc[i] = -1;
+      continue;
+    }
+    k = graphindex[cells[particles[j].icell].proc];
+    if (k < 0)
+      error->one(FLERR,"Migrating particle to proc that is not a neighbor");
+    pproc[i] = k;
+    gscount[k]++;
+  }
+
+  int nsend = 0;
+  for (k = 0; k < nneigh; k++) {
+    gsbytes[k] = gscount[k]*nbytes;
+    gsdispls[k] = nsend*nbytes;
+    goffset[k] = gsdispls[k];
+    nsend += gscount[k];
+  }
+
+  if (nsend*nbytes > maxsendbuf) {
+    maxsendbuf = nsend*nbytes;
+    memory->destroy(sbuf);
+    memory->create(sbuf,maxsendbuf,"comm:sbuf");
+  }
+
+  // pack each particle into segment of sbuf for its destination proc
+  // change icell of migrated particle to owning cell on receiving proc
+
+  for (i = 0; i < nmigrate; i++) {
+    k = pproc[i];
+    if (k < 0) continue;
+    j = plist[i];
+    particles[j].icell = cells[particles[j].icell].ilocal;
+    memcpy(&sbuf[goffset[k]],&particles[j],nbytes_particle);
+    goffset[k] += nbytes_particle;
+    if (ncustom) {
+      particle->pack_custom(j,&sbuf[goffset[k]]);
+      goffset[k] += nbytes_custom;
+    }
+  }
+
+  // compress my list of particles
+
+  particle->compress_migrate(nmigrate,plist);
+  int ncompress = particle->nlocal;
+
+  // exchange counts with neighbors
+  // nrecv = # of incoming particles
+
+  MPI_Neighbor_alltoall(gscount,1,MPI_INT,grcount,1,MPI_INT,graphcomm);
+
+  int nrecv = 0;
+  for (k = 0; k < nsource; k++) {
+    grbytes[k] = grcount[k]*nbytes;
+    grdispls[k] = nrecv*nbytes;
+    nrecv += grcount[k];
+  }
+
+  // extend particle list if necessary
+
+  particle->grow(nrecv);
+
+  // exchange particles with neighbors
+  // if no custom attributes, recv particles directly into particle list
+  // else receive into rbuf, unpack particles one by one via unpack_custom()
+
+  if (!ncustom)
+    MPI_Neighbor_alltoallv(sbuf,gsbytes,gsdispls,MPI_CHAR,
+                           &particle->particles[particle->nlocal],
+                           grbytes,grdispls,MPI_CHAR,graphcomm);
+
+  else {
+    if (nrecv*nbytes > maxrecvbuf) {
+      maxrecvbuf = nrecv*nbytes;
+      memory->destroy(rbuf);
+      memory->create(rbuf,maxrecvbuf,"comm:rbuf");
+    }
+
+    MPI_Neighbor_alltoallv(sbuf,gsbytes,gsdispls,MPI_CHAR,
+                           rbuf,grbytes,grdispls,MPI_CHAR,graphcomm);
+
+    int offset = 0;
+    int nlocal = particle->nlocal;
+    for (i = 0; i < nrecv; i++) {
+      memcpy(&particle->particles[nlocal],&rbuf[offset],nbytes_particle);
+      offset += nbytes_particle;
+      particle->unpack_custom(&rbuf[offset],nlocal);
+      offset += nbytes_custom;
+      nlocal++;
+    }
+  }
+
+  particle->nlocal += nrecv;
+  ncomm += nsend;
+  return ncompress;
+}
+
 /* ----------------------------------------------------------------------
    migrate grid cells with their particles to new procs
    called from BalanceGrid and FixBalance
@@ -27,7 +27,8 @@ class Comm : protected Pointers {
   int commsortflag;                 // 1 to force sort in all irregular comms
                                     //   useful for debugging to insure
                                     //   reproducible ordering of recv datums
-  int commpartstyle;                // 1 for neighbor, 0 for all
+  int commpartstyle;                // 1 for neighbor, 0 for all,
+                                    //   2 for neighbor graph topology
                                     //   changes how irregular comm for
                                     //   particles is performed
 
@@ -57,11 +58,25 @@ class Comm : protected Pointers {
   int neighflag;                    // 1 if nearest-neighbor particle comm
   int nneigh;                       // # of procs I own ghost cells of
   int *neighlist;                   // list of ghost procs
+  int neighsortflag;                // commsortflag when neighlist was set
+
+  int graphflag;                    // 1 if particle comm via graphcomm
+  MPI_Comm graphcomm;               // graph topology of neighbor procs
+  int nsource;                      // # of procs that send particles to me
+  int *sourcelist;                  // list of procs that send to me
+  int *graphindex;                  // index of each proc in neighlist, or -1
+  int *gscount,*grcount;            // # of particles to send/recv per proc
+  int *gsbytes,*gsdispls;           // send byte count/offset per neigh proc
+  int *grbytes,*grdispls;           // recv byte count/offset per source proc
+  int *goffset;                     // current pack offset per neigh proc
 
   int copymode;                 // 1 if copy of class (prevents deallocation of
                                 // base class when child copy is destroyed)
 
   void migrate_cells_less_memory(int);  // small memory version of migrate_cells
+  void create_graph();
+  void destroy_graph();
+  int migrate_particles_graph(int, int *);
   int rendezvous_irregular(int, char *, int, int, int *,
                            int (*)(int, char *, int &, int *&, char *&, void *),
                            int, char *&, int, void *, int);
@@ -77,6 +92,11 @@ class Comm : protected Pointers {
 
 /* ERROR/WARNING messages:
 
+E: Migrating particle to proc that is not a neighbor
+
+A particle moved into a ghost cell owned by a proc that is not in
+the neighbor graph.  This should not happen.
+
 E: Migrate cells send buffer exceeds 2 GB
 
 MPI does not support a communication buffer that exceeds a 4-byte
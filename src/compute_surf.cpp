@@ -85,14 +85,16 @@ ComputeSurf::ComputeSurf(SPARTA *sparta, int narg, char **arg) :
   ntally = maxtally = 0;
   array_surf_tally = NULL;
   tally2surf = NULL;
+  tally2local = NULL;
+
+  maxlocal = 0;
+  surf2tally = NULL;
 
   maxsurf = 0;
   array_surf = NULL;
   normflux = NULL;
   combined = 0;
 
-  hash = new MyHash;
-
   dim = domain->dimension;
 }
 
@@ -105,9 +107,10 @@ ComputeSurf::~ComputeSurf()
   delete [] which;
   memory->destroy(array_surf_tally);
   memory->destroy(tally2surf);
+  memory->destroy(tally2local);
+  memory->destroy(surf2tally);
   memory->destroy(array_surf);
   memory->destroy(normflux);
-  delete hash;
 }
 
 /* ---------------------------------------------------------------------- */
@@ -194,12 +197,21 @@ void ComputeSurf::clear()
   lines = surf->lines;
   tris = surf->tris;
 
-  // clear hash of tallied surf IDs
+  // reset surf2tally for surfs tallied on previous step
   // called by Update at beginning of timesteps surf tallying is done
 
-  hash->clear();
+  for (int i = 0; i < ntally; i++) surf2tally[tally2local[i]] = -1;
   ntally = 0;
   combined = 0;
+
+  // grow surf2tally if # of surfs I store has increased
+
+  int nsurf = surf->nlocal + surf->nghost;
+  if (nsurf > maxlocal) {
+    memory->grow(surf2tally,nsurf,"surf:surf2tally");
+    for (int i = maxlocal; i < nsurf; i++) surf2tally[i] = -1;
+    maxlocal = nsurf;
+  }
 }
 
 /* ----------------------------------------------------------------------
@@ -231,7 +243,7 @@ void ComputeSurf::surf_tally(int isurf, int icell, int reaction,
   if (igroup < 0) return;
 
   // itally = tally index of isurf
-  // if 1st particle hitting isurf, add surf ID to hash
+  // if 1st particle hitting isurf, add it to surf2tally
   // grow tally list if needed
 
   int itally,transparent;
@@ -246,12 +258,13 @@ void ComputeSurf::surf_tally(int isurf, int icell, int reaction,
     transparent = tris[isurf].transparent;
   }
 
-  if (hash->find(surfID) != hash->end()) itally = (*hash)[surfID];
-  else {
+  itally = surf2tally[isurf];
+  if (itally < 0) {
     if (ntally == maxtally) grow_tally();
     itally = ntally;
-    (*hash)[surfID] = itally;
+    surf2tally[isurf] = itally;
     tally2surf[itally] = surfID;
+    tally2local[itally] = isurf;
     vec = array_surf_tally[itally];
     for (int i = 0; i < ntotal; i++) vec[i] = 0.0;
     ntally++;
@@ -509,6 +522,7 @@ void ComputeSurf::grow_tally()
 {
   maxtally += DELTA;
   memory->grow(tally2surf,maxtally,"surf:tally2surf");
+  memory->grow(tally2local,maxtally,"surf:tally2local");
   memory->grow(array_surf_tally,maxtally,ntotal,"surf:array_surf_tally");
 }
 
@@ -531,5 +545,7 @@ bigint ComputeSurf::memory_usage()
   bigint bytes = 0;
   bytes += ntotal*maxtally * sizeof(double);    // array_surf_tally
   bytes += maxtally * sizeof(surfint);          // tally2surf
+  bytes += maxtally * sizeof(int);              // tally2local
+  bytes += maxlocal * sizeof(int);              // surf2tally
   return bytes;
 }
@@ -23,7 +23,6 @@ ComputeStyle(surf,ComputeSurf)
 
 #include "compute.h"
 #include "surf.h"
-#include "hash3.h"
 
 namespace SPARTA_NS {
 
@@ -51,18 +50,13 @@ class ComputeSurf : public Compute {
   int ntally;              // # of surfs I have tallied for
   int maxtally;            // # of tallies currently allocated
   surfint *tally2surf;     // tally2surf[I] = surf ID of Ith tally
+  int *tally2local;        // tally2local[I] = local index of surf of Ith tally
 
-  // hash for surf IDs
+  // dense map of local surfs (owned + ghost) to tallies
 
-#ifdef SPARTA_MAP
-  typedef std::map<surfint,int> MyHash;
-#elif defined SPARTA_UNORDERED_MAP
-  typedef std::unordered_map<surfint,int> MyHash;
-#else
-  typedef std::tr1::unordered_map<surfint,int> MyHash;
-#endif
-
-  MyHash *hash;
+  int maxlocal;            // length of surf2tally
+  int *surf2tally;         // surf2tally[I] = tally index of local surf I
+                           // -1 if surf I has not been tallied
 
   int dim;                 // local copies
   Surf::Line *lines;
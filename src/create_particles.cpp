@@ -28,6 +28,7 @@
 #include "variable.h"
 #include "random_mars.h"
 #include "random_park.h"
+#include "random_counter.h"
 #include "math_const.h"
 #include "memory.h"
 #include "error.h"
@@ -36,8 +37,16 @@ using namespace SPARTA_NS;
 using namespace MathConst;
 
 enum{UNKNOWN,OUTSIDE,INSIDE,OVERLAP};   // same as Grid
+enum{PKEEP,PINSERT,PDONE,PDISCARD,PENTRY,PEXIT,PSURF};   // several files
 
 #define EPSZERO 1.0e-14
+#define CHUNK_THREAD 64
+
+// bins for exact sum of doubles, each bin holds 32 bits
+// EXPONENT_EXACT = offset so lowest bit of smallest denormal is bit 0
+
+#define NBIN_EXACT 70
+#define EXPONENT_EXACT 1126
 
 /* ---------------------------------------------------------------------- */
 
@@ -88,6 +97,7 @@ void CreateParticles::command(int narg, char **arg)
 
   int globalflag = 0;
   twopass = 0;
+  counterflag = 0;
   region = NULL;
   speciesflag = densflag = velflag = tempflag = 0;
   sstr = sxstr = systr = szstr = NULL;
@@ -162,11 +172,20 @@ void CreateParticles::command(int narg, char **arg)
       if (iarg+1 > narg) error->all(FLERR,"Illegal create_particles command");
       twopass = 1;
       iarg += 1;
+    } else if (strcmp(arg[iarg],"rng") == 0) {
+      if (iarg+2 > narg) error->all(FLERR,"Illegal create_particles command");
+      if (strcmp(arg[iarg+1],"park") == 0) counterflag = 0;
+      else if (strcmp(arg[iarg+1],"counter") == 0) counterflag = 1;
+      else error->all(FLERR,"Illegal create_particles command");
+      iarg += 2;
     } else error->all(FLERR,"Illegal create_particles command");
   }
 
   if (globalflag)
     error->all(FLERR,"Create_particles global option not yet implemented");
+  if (counterflag && sparta->kokkos)
+    error->all(FLERR,"Create_particles rng counter is not yet supported "
+               "with Kokkos");
 
   // error checks and further setup for variables
 
@@ -333,7 +352,8 @@ void CreateParticles::command(int narg, char **arg)
   bigint nprevious = particle->nglobal;
   if (single) create_single();
   else if (!globalflag) {
-    if (twopass) create_local_twopass(np);
+    if (counterflag) create_local_counter(np);
+    else if (twopass) create_local_twopass(np);
     else create_local(np);
   }
   //else create_global(np);
@@ -343,11 +363,13 @@ void CreateParticles::command(int narg, char **arg)
 
   // error check
   // only if no region and no variable species/density specified
+  // counter RNG rounds each cell independently, so Np is only matched
+  //   in a statistical sense
 
   bigint nglobal;
   bigint nme = particle->nlocal;
   MPI_Allreduce(&nme,&nglobal,1,MPI_SPARTA_BIGINT,MPI_SUM,world);
-  if (!region && !speciesflag && !densflag && !tempflag &&
+  if (!region && !speciesflag && !densflag && !tempflag && !counterflag &&
       nglobal-nprevious != np) {
     char str[128];
     sprintf(str,"Created incorrect # of particles: "
@@ -833,6 +855,299 @@ void CreateParticles::create_local_twopass(bigint np)
   delete random;
 }
 
+/* ----------------------------------------------------------------------
+   create Np particles in parallel with a counter-based RNG
+   each cell's count and particle attributes are a function of
+     seed, cell ID, and particle index within the cell
+   so the created particles do not depend on number of procs
+     or on how cells are assigned to procs
+   first pass sets per-cell counts so particle list is grown once,
+     second pass fills each cell independently of the others
+   only insert in cells uncut by surfs
+   account for cell weighting
+------------------------------------------------------------------------- */
+
+void CreateParticles::create_local_counter(bigint np)
+{
+  int dimension = domain->dimension;
+
+  RanCounter *random = new RanCounter(update->ranmaster->uniform());
+
+  Grid::ChildCell *cells = grid->cells;
+  Grid::ChildInfo *cinfo = grid->cinfo;
+  int nglocal = grid->nlocal;
+
+  // volone = weighted volume of each grid cell I own that is OUTSIDE surfs
+  // skip cells entirely outside region
+  // volall = global weighted volume, so per-cell target is Np*volone/volall
+  // volall is summed exactly so it does not depend on
+  //   how cells are assigned to procs
+
+  double *lo,*hi;
+  double volone;
+
+  double *vols;
+  memory->create(vols,nglocal,"create_particles:vols");
+
+  for (int i = 0; i < nglocal; i++) {
+    vols[i] = 0.0;
+    if (cinfo[i].type != OUTSIDE) continue;
+    lo = cells[i].lo;
+    hi = cells[i].hi;
+    if (region && region->bboxflag && outside_region(dimension,lo,hi))
+      continue;
+
+    if (dimension == 3) volone = (hi[0]-lo[0]) * (hi[1]-lo[1]) * (hi[2]-lo[2]);
+    else if (domain->axisymmetric)
+      volone = (hi[0]-lo[0]) * (hi[1]*hi[1]-lo[1]*lo[1])*MY_PI;
+    else volone = (hi[0]-lo[0]) * (hi[1]-lo[1]);
+    vols[i] = volone / cinfo[i].weight * grid->cells[i].dt_weight;
+  }
+
+  double volall = sum_exact(vols,nglocal);
+
+  // density, species, temperature, velocity variables are evaluated
+  //   by the Variable class which is not thread-safe
+  // loops below only run threaded when the variables they use are not set
+
+  int threadcount = !densflag;
+  int threadcreate = !speciesflag && !tempflag && !velflag;
+
+  // first pass: ncreate = # of particles to create in each cell
+  // index 0 of each cell's stream is reserved for its count
+
+  int *ncreate;
+  memory->create(ncreate,nglocal,"create_particles:ncreate");
+
+  bigint ntotal = 0;
+
+#if defined(_OPENMP)
+#pragma omp parallel if(threadcount) reduction(+:ntotal)
+#endif
+  {
+    RanCounter rng(*random);
+    double ntarget;
+
+#if defined(_OPENMP)
+#pragma omp for schedule(static)
+#endif
+    for (int i = 0; i < nglocal; i++) {
+      ncreate[i] = 0;
+      if (vols[i] == 0.0) continue;
+      rng.reset(0,cells[i].id,0);
+
+      ntarget = np * vols[i]/volall;
+      if (densflag) ntarget *= density_variable(cells[i].lo,cells[i].hi);
+      ncreate[i] = static_cast<int> (ntarget);
+      if (rng.uniform() < ntarget-ncreate[i]) ncreate[i]++;
+      ntotal += ncreate[i];
+    }
+  }
+
+  memory->destroy(vols);
+
+  if (particle->nlocal + ntotal > MAXSMALLINT)
+    error->one(FLERR,"Per-processor particle count is too big");
+  particle->grow(static_cast<int> (ntotal));
+
+  // offset = first slot of each cell's particles, after existing particles
+
+  int *offset;
+  memory->create(offset,nglocal,"create_particles:offset");
+
+  int nstart = particle->nlocal;
+  int n = nstart;
+  for (int i = 0; i < nglocal; i++) {
+    offset[i] = n;
+    n += ncreate[i];
+  }
+  int nend = n;
+
+  // second pass: each particle has its own stream at index m+1
+  // particle species = random value based on mixture fractions
+  // particle velocity = stream velocity + thermal velocity
+  // each cell fills its own slots, so cells can be done in any order
+  // particles rejected by region or species variable are flagged
+  //   with ispecies = -1 and squeezed out below
+
+  Particle::OnePart *particles = particle->particles;
+
+  int *species = particle->mixture[imix]->species;
+  double *cummulative = particle->mixture[imix]->cummulative;
+  double *vstream = particle->mixture[imix]->vstream;
+  double *vscale = particle->mixture[imix]->vscale;
+  int nspecies = particle->mixture[imix]->nspecies;
+  double temp_thermal = particle->mixture[imix]->temp_thermal;
+  double temp_rot = particle->mixture[imix]->temp_rot;
+  double temp_vib = particle->mixture[imix]->temp_vib;
+
+#if defined(_OPENMP)
+#pragma omp parallel if(threadcreate)
+#endif
+  {
+    RanCounter rng(*random);
+
+    int isp,ispecies;
+    double *lo,*hi;
+    double x[3],v[3],vstream_variable[3];
+    double rn,vn,vr,theta1,theta2;
+    Particle::OnePart *p;
+
+    double tempscale = 1.0;
+    double sqrttempscale = 1.0;
+
+#if defined(_OPENMP)
+#pragma omp for schedule(dynamic,CHUNK_THREAD)
+#endif
+    for (int i = 0; i < nglocal; i++) {
+      if (ncreate[i] == 0) continue;
+      lo = cells[i].lo;
+      hi = cells[i].hi;
+
+      for (int m = 0; m < ncreate[i]; m++) {
+        p = &particles[offset[i]+m];
+        p->ispecies = -1;
+
+        rng.reset(0,cells[i].id,m+1);
+        rn = rng.uniform();
+
+        isp = 0;
+        while (cummulative[isp] < rn) isp++;
+        ispecies = species[isp];
+
+        x[0] = lo[0] + rng.uniform() * (hi[0]-lo[0]);
+        x[1] = lo[1] + rng.uniform() * (hi[1]-lo[1]);
+        x[2] = lo[2] + rng.uniform() * (hi[2]-lo[2]);
+        if (dimension == 2) x[2] = 0.0;
+
+        if (region && !region->match(x)) continue;
+        if (speciesflag) {
+          isp = species_variable(x) - 1;
+          if (isp < 0 || isp >= nspecies) continue;
+          ispecies = species[isp];
+        }
+
+        if (tempflag) {
+          tempscale = temperature_variable(x);
+          sqrttempscale = sqrt(tempscale);
+        }
+
+        vn = vscale[isp] * sqrttempscale * sqrt(-log(rng.uniform()));
+        vr = vscale[isp] * sqrttempscale * sqrt(-log(rng.uniform()));
+        theta1 = MY_2PI * rng.uniform();
+        theta2 = MY_2PI * rng.uniform();
+
+        if (velflag) {
+          velocity_variable(x,vstream,vstream_variable);
+          v[0] = vstream_variable[0] + vn*cos(theta1);
+          v[1] = vstream_variable[1] + vr*cos(theta2);
+          v[2] = vstream_variable[2] + vr*sin(theta2);
+        } else {
+          v[0] = vstream[0] + vn*cos(theta1);
+          v[1] = vstream[1] + vr*cos(theta2);
+          v[2] = vstream[2] + vr*sin(theta2);
+        }
+
+        p->erot = particle->erot(ispecies,temp_rot*tempscale,&rng);
+        p->evib = particle->evib(ispecies,temp_vib*tempscale,&rng);
+        p->id = MAXSMALLINT*rng.uniform();
+        p->ispecies = ispecies;
+        p->icell = i;
+        p->x[0] = x[0];
+        p->x[1] = x[1];
+        p->x[2] = x[2];
+        p->v[0] = v[0];
+        p->v[1] = v[1];
+        p->v[2] = v[2];
+        p->flag = PKEEP;
+        p->dt_weight = 1;
+      }
+    }
+  }
+
+  memory->destroy(offset);
+  memory->destroy(ncreate);
+
+  // compress out rejected particles in slot order
+  // zero vacated slots, since add_particle() relies on grow() zeroing them
+  // fixes with add_particle() method are invoked in the same order
+  //   as for a serial run, since they may use their own RNG
+
+  particle->error_custom();
+  modify->list_init_fixes();
+  int nfix_add_particle = modify->n_add_particle;
+
+  n = nstart;
+  for (int j = nstart; j < nend; j++) {
+    if (particles[j].ispecies < 0) continue;
+    if (j != n) memcpy(&particles[n],&particles[j],sizeof(Particle::OnePart));
+    n++;
+  }
+  if (n < nend)
+    memset(&particles[n],0,(nend-n)*sizeof(Particle::OnePart));
+  particle->nlocal = n;
+
+  if (nfix_add_particle)
+    for (int j = nstart; j < n; j++)
+      modify->add_particle(j,temp_thermal,temp_rot,temp_vib,vstream);
+
+  delete random;
+}
+
+/* ----------------------------------------------------------------------
+   return sum of N non-negative values across all procs
+   result does not depend on how values are distributed across procs
+     or on their order, since it is accumulated in integer bins
+   each value is split into 32-bit pieces of its mantissa,
+     each added to the bin for its power of 2
+   carries are propagated before and after the MPI sum
+     so bins cannot overflow
+------------------------------------------------------------------------- */
+
+double CreateParticles::sum_exact(double *values, int n)
+{
+  bigint bins[NBIN_EXACT],allbins[NBIN_EXACT];
+  for (int k = 0; k < NBIN_EXACT; k++) bins[k] = 0;
+
+  int exponent,lsb,k,shift;
+  uint64_t mantissa;
+
+  for (int i = 0; i < n; i++) {
+    if (values[i] <= 0.0) continue;
+    mantissa = static_cast<uint64_t>
+      (ldexp(frexp(values[i],&exponent),53));
+    lsb = exponent - 53 + EXPONENT_EXACT;
+    k = lsb / 32;
+    shift = lsb % 32;
+    bins[k] += (mantissa << shift) & 0xFFFFFFFFULL;
+    bins[k+1] += (mantissa >> (32-shift)) & 0xFFFFFFFFULL;
+    if (shift) bins[k+2] += mantissa >> (64-shift);
+
+    if (i % 0x40000000 == 0x3FFFFFFF) carry_exact(bins);
+  }
+
+  carry_exact(bins);
+  MPI_Allreduce(bins,allbins,NBIN_EXACT,MPI_SPARTA_BIGINT,MPI_SUM,world);
+  carry_exact(allbins);
+
+  double sum = 0.0;
+  for (k = 0; k < NBIN_EXACT; k++)
+    sum += ldexp(static_cast<double> (allbins[k]),32*k-EXPONENT_EXACT);
+  return sum;
+}
+
+/* ----------------------------------------------------------------------
+   propagate carries so each bin but the last holds 32 bits
+------------------------------------------------------------------------- */
+
+void CreateParticles::carry_exact(bigint *bins)
+{
+  for (int k = 0; k < NBIN_EXACT-1; k++) {
+    bins[k+1] += bins[k] >> 32;
+    bins[k] &= 0xFFFFFFFFLL;
+  }
+}
+
 /* ----------------------------------------------------------------------
    return 1 if grid cell with lo/hi is entirely outside region bounding box
    else return 0
@@ -34,7 +34,7 @@ class CreateParticles : protected Pointers {
   double erot(int);
 
  protected:
-  int imix,single,mspecies,twopass;
+  int imix,single,mspecies,twopass,counterflag;
   double xp,yp,zp,vx,vy,vz;
   class Region *region;
 
@@ -55,11 +55,14 @@ class CreateParticles : protected Pointers {
   virtual void create_single();
   virtual void create_local(bigint);
   virtual void create_local_twopass(bigint);
+  virtual void create_local_counter(bigint);
   int species_variable(double *);
   double density_variable(double *, double *);
   double temperature_variable(double *);
   void velocity_variable(double *, double *, double *);
   int outside_region(int, double *, double *);
+  double sum_exact(double *, int);
+  void carry_exact(bigint *);
 };
 
 }
@@ -77,6 +80,10 @@ E: Cannot create particles before grid is defined
 
 Self-explanatory.
 
+E: Create_particles rng counter is not yet supported with Kokkos
+
+Use the default rng park option when running with Kokkos.
+
 E: Illegal ... command
 
 Self-explanatory.  Check the input script syntax and compare to the
@@ -17,6 +17,7 @@
 #include "stdlib.h"
 #include "string.h"
 #include "stdio.h"
+#include "unistd.h"
 #include "dump.h"
 #include "domain.h"
 #include "update.h"
@@ -26,6 +27,10 @@
 #include "memory.h"
 #include "error.h"
 
+#ifdef SPARTA_ZLIB
+#include "zlib.h"
+#endif
+
 using namespace SPARTA_NS;
 
 #define BIG 1.0e20
@@ -33,6 +38,7 @@ using namespace SPARTA_NS;
 #define EPSILON 1.0e-6
 
 #define ONEFIELD 32
+#define ZCOMPRESSLEVEL 6       // same as gzip -6 used for piped output
 #define DELTA 1048576
 
 enum{INT,DOUBLE,BIGINT,STRING};    // many dump files
@@ -74,11 +80,26 @@ Dump::Dump(SPARTA *sparta, int, char **arg) : Pointers(sparta)
   buffer_allow = 0;
   buffer_flag = 0;
   padflag = 0;
+  async_flag = 0;
+  async_max = 256 * 1024*1024;
 
   maxbuf = 0;
   buf = NULL;
   maxsbuf = 0;
   sbuf = NULL;
+  maxzbuf = 0;
+  zbuf = NULL;
+  maxhdrbuf = 0;
+  hdrbuf = NULL;
+  nhdrbuf = 0;
+  async_active = 0;
+  async_error = 0;
+  nabuf = maxabuf = 0;
+  abuf = NULL;
+  acount = NULL;
+
+  itemname = NULL;
+  columns = NULL;
 
   // parse filename for special syntax
   // if contains '%', write one file per proc and replace % with proc-ID
@@ -86,13 +107,18 @@ Dump::Dump(SPARTA *sparta, int, char **arg) : Pointers(sparta)
   // check file suffixes
   //   if ends in .bin = binary file
   //   else if ends in .gz = gzipped text file
+  //   else if ends in .mpiio = binary file written collectively by all procs
   //   else ASCII text file
 
   fp = NULL;
   singlefile_opened = 0;
   compressed = 0;
   binary = 0;
+  zflag = 0;
+  mpiio = 0;
   multifile = 0;
+  mpifile_opened = 0;
+  mpioffset = 0;
 
   multiproc = 0;
   nclusterprocs = nprocs;
@@ -120,12 +146,21 @@ Dump::Dump(SPARTA *sparta, int, char **arg) : Pointers(sparta)
   if (suffix > filename && strcmp(suffix,".bin") == 0) binary = 1;
   suffix = filename + strlen(filename) - strlen(".gz");
   if (suffix > filename && strcmp(suffix,".gz") == 0) compressed = 1;
+  suffix = filename + strlen(filename) - strlen(".bin.gz");
+  if (suffix > filename && strcmp(suffix,".bin.gz") == 0) binary = 1;
+  suffix = filename + strlen(filename) - strlen(".mpiio");
+  if (suffix > filename && strcmp(suffix,".mpiio") == 0) mpiio = 1;
+
+  if (mpiio && multiproc)
+    error->all(FLERR,"Dump file with .mpiio suffix cannot use % in its name");
 }
 
 /* ---------------------------------------------------------------------- */
 
 Dump::~Dump()
 {
+  async_wait();
+
   delete [] id;
   delete [] style;
   delete [] filename;
@@ -142,11 +177,17 @@ Dump::~Dump()
 
   memory->destroy(buf);
   memory->destroy(sbuf);
+  memory->destroy(zbuf);
+  memory->destroy(hdrbuf);
+  memory->destroy(abuf);
+  memory->destroy(acount);
 
   if (multiproc) MPI_Comm_free(&clustercomm);
 
+  if (mpifile_opened) closefile_mpiio();
+
   if (multifile == 0 && fp != NULL) {
-    if (compressed) {
+    if (compressed && !zflag) {
       if (filewriter) pclose(fp);
     } else {
       if (filewriter) fclose(fp);
@@ -158,6 +199,9 @@ Dump::~Dump()
 
 void Dump::init()
 {
+  async_wait();
+  async_check();
+
   // format = copy of default or user-specified line format
 
   delete [] format;
@@ -216,15 +260,38 @@ void Dump::init()
   }
   boundstr[8] = '\0';
 
+  // compress in-process if zlib is available and the style supports it
+  // each proc then deflates its own strings or binary values
+  // otherwise a .gz file is written thru a pipe to gzip by filewriter
+
+  int zflag_new = 0;
+#ifdef SPARTA_ZLIB
+  if (compressed && itemname && (binary || buffer_flag)) zflag_new = 1;
+#endif
+  if (singlefile_opened && zflag_new != zflag)
+    error->all(FLERR,"Cannot change dump_modify buffer for "
+               "compressed dump file once it is open");
+  zflag = zflag_new;
+
   // style-specific initialization
 
   init_style();
+
+  if (mpiio && (itemname == NULL || columns == NULL))
+    error->all(FLERR,"Dump style does not support .mpiio files");
+  if (async_flag && (mpiio || strcmp(style,"image") == 0))
+    error->all(FLERR,"Dump_modify async cannot be used with this dump");
 }
 
 /* ---------------------------------------------------------------------- */
 
 void Dump::write()
 {
+  // previous snapshot must be on disk before fp or box bounds are reset
+
+  if (async_active) async_wait();
+  if (async_flag) async_check();
+
   // if file per timestep, open new file
 
   if (multifile) openfile();
@@ -237,6 +304,7 @@ void Dump::write()
   boxyhi = domain->boxhi[1];
   boxzlo = domain->boxlo[2];
   boxzhi = domain->boxhi[2];
+  snapstep = update->ntimestep;
 
   // nme = # of dump lines this proc will contribute to dump
 
@@ -260,7 +328,23 @@ void Dump::write()
   if (multiproc)
     MPI_Allreduce(&bnme,&nheader,1,MPI_SPARTA_BIGINT,MPI_SUM,clustercomm);
 
-  if (filewriter) write_header(nheader);
+  // async = 1 if filewriters gather snapshot and write it in background
+  // all procs must agree, so test largest file of any cluster
+  // too-large snapshots are written directly to bound memory use
+
+  int async = 0;
+  if (async_flag) {
+    bigint nbig = nheader;
+    if (multiproc)
+      MPI_Allreduce(&nheader,&nbig,1,MPI_SPARTA_BIGINT,MPI_MAX,world);
+    if (nbig*size_one*((bigint) sizeof(double)) <= async_max &&
+        nbig*size_one*ONEFIELD <= MAXSMALLINT) async = 1;
+  }
+
+  if (filewriter && !mpiio && !async) {
+    if (zflag) write_header_compressed(nheader);
+    else write_header(nheader);
+  }
 
   // insure buf is sized for packing and communicating
   // use nmax to insure filewriter proc can receive info from others
@@ -278,6 +362,19 @@ void Dump::write()
 
   pack();
 
+  // MPI-IO output bypasses the gather to filewriter procs
+
+  if (mpiio) {
+    write_mpiio();
+    if (multifile) closefile_mpiio();
+    return;
+  }
+
+  if (async) {
+    write_async(nheader);
+    return;
+  }
+
  // if buffering, convert doubles into strings
   // insure sbuf is sized for communicating
   // cannot buffer if output is to binary file
@@ -290,12 +387,38 @@ void Dump::write()
     if (multiproc != nprocs)
       MPI_Allreduce(&nsme,&nsmax,1,MPI_INT,MPI_MAX,world);
     else nsmax = nsme;
-    if (nsmax > maxsbuf) {
+    if (nsmax > maxsbuf && !zflag) {
       maxsbuf = nsmax;
       memory->grow(sbuf,maxsbuf,"dump:sbuf");
     }
   }
 
+  // if compressing, each proc deflates its strings or binary chunk
+  //   into one gzip member in zbuf, filewriter just concatenates them
+  // insure zbuf is sized for communicating
+
+  int nzme = 0;
+  if (zflag) {
+    if (binary) {
+      int nvalues = nme*size_one;
+      compress_reserve(sizeof(int) + (bigint) nvalues*sizeof(double));
+      nzme = compress_block((char *) &nvalues,sizeof(int),(char *) buf,
+                            (bigint) nvalues*sizeof(double));
+    } else {
+      compress_reserve(nsme);
+      nzme = compress_block(NULL,0,sbuf,nsme);
+    }
+    if (nzme < 0) error->one(FLERR,"Dump compression failed");
+    int nzmax;
+    if (multiproc != nprocs)
+      MPI_Allreduce(&nzme,&nzmax,1,MPI_INT,MPI_MAX,world);
+    else nzmax = nzme;
+    if (nzmax > maxzbuf) {
+      maxzbuf = nzmax;
+      memory->grow(zbuf,maxzbuf,"dump:zbuf");
+    }
+  }
+
   // filewriter = 1 = this proc writes to file
   // ping each proc in my cluster, receive its data, write data to file
   // else wait for ping from fileproc, send my data to fileproc
@@ -304,9 +427,30 @@ void Dump::write()
   MPI_Status status;
   MPI_Request request;
 
+  // comm and output zbuf = one gzip member per proc
+
+  if (zflag) {
+    if (filewriter) {
+      for (int iproc = 0; iproc < nclusterprocs; iproc++) {
+        if (iproc) {
+          MPI_Irecv(zbuf,maxzbuf,MPI_CHAR,me+iproc,0,world,&request);
+          MPI_Send(&tmp,0,MPI_INT,me+iproc,0,world);
+          MPI_Wait(&request,&status);
+          MPI_Get_count(&status,MPI_CHAR,&nchars);
+        } else nchars = nzme;
+
+        fwrite(zbuf,sizeof(char),nchars,fp);
+      }
+      if (flush_flag) fflush(fp);
+
+    } else {
+      MPI_Recv(&tmp,0,MPI_INT,fileproc,0,world,&status);
+      MPI_Rsend(zbuf,nzme,MPI_CHAR,fileproc,0,world);
+    }
+
   // comm and output buf of doubles
 
-  if (buffer_flag == 0 || binary) {
+  } else if (buffer_flag == 0 || binary) {
     if (filewriter) {
       for (int iproc = 0; iproc < nclusterprocs; iproc++) {
         if (iproc) {
@@ -351,7 +495,7 @@ void Dump::write()
   // if file per timestep, close file if I am filewriter
 
   if (multifile) {
-    if (compressed) {
+    if (compressed && !zflag) {
       if (filewriter) pclose(fp);
     } else {
       if (filewriter) fclose(fp);
@@ -394,10 +538,21 @@ void Dump::openfile()
     *ptr = '*';
   }
 
+  // MPI-IO file is opened collectively by all procs
+
+  if (mpiio) {
+    openfile_mpiio(filecurrent);
+    if (multifile) delete [] filecurrent;
+    return;
+  }
+
   // each proc with filewriter = 1 opens a file
 
   if (filewriter) {
-    if (compressed) {
+    if (zflag) {
+      if (append_flag) fp = fopen(filecurrent,"ab");
+      else fp = fopen(filecurrent,"wb");
+    } else if (compressed) {
 #ifdef SPARTA_GZIP
       char gzip[128];
       sprintf(gzip,"gzip -6 > %s",filecurrent);
@@ -425,9 +580,455 @@ void Dump::openfile()
   if (multifile) delete [] filecurrent;
 }
 
+/* ----------------------------------------------------------------------
+   open MPI-IO dump file collectively
+   truncate it unless appending, else start writing at its end
+------------------------------------------------------------------------- */
+
+void Dump::openfile_mpiio(char *file)
+{
+  int err = MPI_File_open(world,file,MPI_MODE_CREATE | MPI_MODE_WRONLY,
+                          MPI_INFO_NULL,&mpifh);
+  if (err != MPI_SUCCESS) error->all(FLERR,"Cannot open dump file");
+
+  if (append_flag && !multifile) MPI_File_get_size(mpifh,&mpioffset);
+  else {
+    MPI_File_set_size(mpifh,0);
+    mpioffset = 0;
+  }
+  mpifile_opened = 1;
+}
+
+/* ---------------------------------------------------------------------- */
+
+void Dump::closefile_mpiio()
+{
+  MPI_File_close(&mpifh);
+  mpifile_opened = 0;
+}
+
+/* ----------------------------------------------------------------------
+   write one snapshot to MPI-IO file
+   proc 0 writes self-describing header, see header_mpiio()
+   each proc writes its packed buf at offset set by scan of per-proc counts
+   snapshot size is known on all procs, so no other communication is needed
+------------------------------------------------------------------------- */
+
+void Dump::write_mpiio()
+{
+  int nheader = header_mpiio(NULL);
+
+  if (me == 0) {
+    char *hbuf = new char[nheader];
+    header_mpiio(hbuf);
+    MPI_File_write_at(mpifh,mpioffset,hbuf,nheader,MPI_CHAR,
+                      MPI_STATUS_IGNORE);
+    delete [] hbuf;
+  }
+
+  bigint nbefore,nupto;
+  bigint bnme = nme;
+  MPI_Scan(&bnme,&nupto,1,MPI_SPARTA_BIGINT,MPI_SUM,world);
+  nbefore = nupto - bnme;
+
+  MPI_Offset offset = mpioffset + nheader +
+    (MPI_Offset) nbefore * size_one * sizeof(double);
+  int err = MPI_File_write_at_all(mpifh,offset,buf,nme*size_one,MPI_DOUBLE,
+                                  MPI_STATUS_IGNORE);
+  if (err != MPI_SUCCESS) error->one(FLERR,"Cannot write MPI-IO dump file");
+
+  mpioffset += nheader + (MPI_Offset) ntotal * size_one * sizeof(double);
+}
+
+/* ----------------------------------------------------------------------
+   fill hbuf with MPI-IO snapshot header, if hbuf is not NULL
+   return # of bytes in header
+   layout, all native-endian:
+     char[8] magic = SPARTAIO, int version,
+     int n + n chars of item name, int n + n chars of column labels,
+     bigint timestep, bigint # of rows, char[8] boundary string,
+     double[6] box bounds, int size_one, int[size_one] column types,
+     int nlevels + int[nlevels] bits per grid level (for cell ID strings)
+   followed by # of rows * size_one doubles in proc order
+------------------------------------------------------------------------- */
+
+int Dump::header_mpiio(char *hbuf)
+{
+  int nitem = strlen(itemname);
+  int ncolumns = strlen(columns);
+  int nlevels = grid->maxlevel;
+  if (!grid->exist) nlevels = 0;
+
+  int n = 8 + sizeof(int) + sizeof(int) + nitem + sizeof(int) + ncolumns +
+    2*sizeof(bigint) + 8 + 6*sizeof(double) + sizeof(int) +
+    size_one*sizeof(int) + sizeof(int) + nlevels*sizeof(int);
+  if (hbuf == NULL) return n;
+
+  char *ptr = hbuf;
+  memcpy(ptr,"SPARTAIO",8);
+  ptr += 8;
+  int version = 1;
+  memcpy(ptr,&version,sizeof(int));
+  ptr += sizeof(int);
+  memcpy(ptr,&nitem,sizeof(int));
+  ptr += sizeof(int);
+  memcpy(ptr,itemname,nitem);
+  ptr += nitem;
+  memcpy(ptr,&ncolumns,sizeof(int));
+  ptr += sizeof(int);
+  memcpy(ptr,columns,ncolumns);
+  ptr += ncolumns;
+  memcpy(ptr,&update->ntimestep,sizeof(bigint));
+  ptr += sizeof(bigint);
+  memcpy(ptr,&ntotal,sizeof(bigint));
+  ptr += sizeof(bigint);
+  memcpy(ptr,boundstr,8);
+  ptr += 8;
+  double box[6];
+  box[0] = boxxlo; box[1] = boxxhi;
+  box[2] = boxylo; box[3] = boxyhi;
+  box[4] = boxzlo; box[5] = boxzhi;
+  memcpy(ptr,box,6*sizeof(double));
+  ptr += 6*sizeof(double);
+  memcpy(ptr,&size_one,sizeof(int));
+  ptr += sizeof(int);
+  memcpy(ptr,vtype,size_one*sizeof(int));
+  ptr += size_one*sizeof(int);
+  memcpy(ptr,&nlevels,sizeof(int));
+  ptr += sizeof(int);
+  for (int i = 0; i < nlevels; i++) {
+    memcpy(ptr,&grid->plevels[i].newbits,sizeof(int));
+    ptr += sizeof(int);
+  }
+
+  return n;
+}
+
+/* ----------------------------------------------------------------------
+   gather snapshot of nlines into abuf on filewriter procs
+   filewriter then formats and writes it in a background thread,
+     so simulation continues while output is converted and written
+   without SPARTA_ASYNC or if thread cannot be started, write it now
+------------------------------------------------------------------------- */
+
+void Dump::write_async(bigint nlines)
+{
+  int tmp,nrecv;
+  MPI_Status status;
+  MPI_Request request;
+
+  if (filewriter) {
+    if (nlines > maxabuf) {
+      maxabuf = nlines;
+      memory->destroy(abuf);
+      memory->create(abuf,maxabuf*size_one,"dump:abuf");
+    }
+    memory->grow(acount,nclusterprocs,"dump:acount");
+
+    bigint offset = 0;
+    for (int iproc = 0; iproc < nclusterprocs; iproc++) {
+      if (iproc) {
+        int nmax = MIN(maxbuf,maxabuf-offset) * size_one;
+        MPI_Irecv(&abuf[offset*size_one],nmax,MPI_DOUBLE,me+iproc,0,
+                  world,&request);
+        MPI_Send(&tmp,0,MPI_INT,me+iproc,0,world);
+        MPI_Wait(&request,&status);
+        MPI_Get_count(&status,MPI_DOUBLE,&nrecv);
+        acount[iproc] = nrecv/size_one;
+      } else {
+        memcpy(abuf,buf,nme*size_one*sizeof(double));
+        acount[iproc] = nme;
+      }
+      offset += acount[iproc];
+    }
+    nabuf = offset;
+
+    // background thread cannot allocate memory or call error methods
+    // so capture header and size sbuf,zbuf for largest chunk here
+    // convert_string() needs at most size_one*ONEFIELD chars per line
+    // write() insured nabuf*size_one*ONEFIELD fits in an int
+
+    bigint nchunk = 0;
+    for (int iproc = 0; iproc < nclusterprocs; iproc++)
+      nchunk = MAX(nchunk,acount[iproc]);
+
+    if (!binary && (zflag || buffer_flag)) {
+      bigint nchars = nchunk*size_one*ONEFIELD;
+      if (nchars > maxsbuf) {
+        maxsbuf = nchars;
+        memory->grow(sbuf,maxsbuf,"dump:sbuf");
+      }
+    }
+
+    if (zflag) {
+      bigint nbytes = capture_header(nabuf);
+      if (binary)
+        nbytes = MAX(nbytes,nchunk*size_one*((bigint) sizeof(double)) +
+                     (bigint) sizeof(int));
+      else nbytes = MAX(nbytes,nchunk*size_one*ONEFIELD);
+      compress_reserve(nbytes);
+    }
+
+#ifdef SPARTA_ASYNC
+    async_active = 1;
+    if (pthread_create(&async_thread,NULL,async_loop,this) != 0) {
+      async_active = 0;
+      write_snapshot();
+    }
+#else
+    write_snapshot();
+#endif
+
+  } else {
+    MPI_Recv(&tmp,0,MPI_INT,fileproc,0,world,&status);
+    MPI_Rsend(buf,nme*size_one,MPI_DOUBLE,fileproc,0,world);
+  }
+}
+
+/* ----------------------------------------------------------------------
+   body of background thread, makes no MPI or other collective calls
+   and does not allocate memory or call error methods
+------------------------------------------------------------------------- */
+
+void *Dump::async_loop(void *ptr)
+{
+  Dump *dump = (Dump *) ptr;
+  dump->write_snapshot();
+  return NULL;
+}
+
+/* ----------------------------------------------------------------------
+   write header and gathered abuf to file, close file if one per snapshot
+   one chunk per sending proc, so binary files match synchronous output
+   only uses state that write() does not change until async_wait()
+   only uses hdrbuf,sbuf,zbuf as sized by write_async()
+   failures set async_error, which async_check() reports on all procs
+------------------------------------------------------------------------- */
+
+void Dump::write_snapshot()
+{
+  int nz,nchars;
+
+  if (zflag) {
+    nz = compress_block(NULL,0,hdrbuf,nhdrbuf);
+    if (nz < 0) async_error = 1;
+    else fwrite(zbuf,sizeof(char),nz,fp);
+  } else write_header(nabuf);
+
+  double *mybuf = abuf;
+  for (int iproc = 0; iproc < nclusterprocs && !async_error; iproc++) {
+    if (zflag) {
+      if (binary) {
+        int nvalues = acount[iproc]*size_one;
+        nz = compress_block((char *) &nvalues,sizeof(int),(char *) mybuf,
+                            (bigint) nvalues*sizeof(double));
+      } else {
+        nchars = convert_string(acount[iproc],mybuf);
+        if (nchars < 0) nz = -1;
+        else nz = compress_block(NULL,0,sbuf,nchars);
+      }
+      if (nz < 0) async_error = 1;
+      else fwrite(zbuf,sizeof(char),nz,fp);
+    } else if (buffer_flag && !binary) {
+      nchars = convert_string(acount[iproc],mybuf);
+      if (nchars < 0) async_error = 1;
+      else write_data(nchars,(double *) sbuf);
+    } else write_data(acount[iproc],mybuf);
+    mybuf += (bigint) acount[iproc] * size_one;
+  }
+
+  if (flush_flag) fflush(fp);
+
+  if (multifile) {
+    if (compressed && !zflag) pclose(fp);
+    else fclose(fp);
+  }
+}
+
+/* ----------------------------------------------------------------------
+   block until background write of previous snapshot is complete
+------------------------------------------------------------------------- */
+
+void Dump::async_wait()
+{
+#ifdef SPARTA_ASYNC
+  if (!async_active) return;
+  pthread_join(async_thread,NULL);
+  async_active = 0;
+#endif
+}
+
+/* ----------------------------------------------------------------------
+   error on all procs if a background write failed on any filewriter
+   must be called by all procs after async_wait()
+------------------------------------------------------------------------- */
+
+void Dump::async_check()
+{
+  int flagall;
+  MPI_Allreduce(&async_error,&flagall,1,MPI_INT,MPI_MAX,world);
+  async_error = 0;
+  if (flagall) error->all(FLERR,"Dump background write failed");
+}
+
+/* ----------------------------------------------------------------------
+   insure zbuf can hold one gzip member of up to n uncompressed bytes
+------------------------------------------------------------------------- */
+
+void Dump::compress_reserve(bigint n)
+{
+#ifdef SPARTA_ZLIB
+  z_stream zs;
+  zs.zalloc = Z_NULL;
+  zs.zfree = Z_NULL;
+  zs.opaque = Z_NULL;
+
+  if (deflateInit2(&zs,ZCOMPRESSLEVEL,Z_DEFLATED,15+16,8,
+                   Z_DEFAULT_STRATEGY) != Z_OK)
+    error->one(FLERR,"Dump compression failed");
+  bigint bound = deflateBound(&zs,n) + 64;
+  deflateEnd(&zs);
+
+  if (bound > MAXSMALLINT)
+    error->one(FLERR,"Too much compressed per-proc info for dump");
+  if (bound > maxzbuf) {
+    maxzbuf = bound;
+    memory->grow(zbuf,maxzbuf,"dump:zbuf");
+  }
+#endif
+}
+
+/* ----------------------------------------------------------------------
+   deflate n1 bytes of str1 followed by n2 bytes of str2
+     into one complete gzip member in zbuf
+   concatenated members form a valid .gz file, so each proc can
+     compress its own chunk and filewriter just writes them in order
+   zbuf must be sized by compress_reserve(), so can be called by
+     background thread
+   return # of bytes in zbuf, -1 if compression failed
+------------------------------------------------------------------------- */
+
+int Dump::compress_block(char *str1, int n1, char *str2, bigint n2)
+{
+#ifdef SPARTA_ZLIB
+  z_stream zs;
+  zs.zalloc = Z_NULL;
+  zs.zfree = Z_NULL;
+  zs.opaque = Z_NULL;
+
+  // windowBits + 16 = gzip wrapper instead of zlib
+
+  if (deflateInit2(&zs,ZCOMPRESSLEVEL,Z_DEFLATED,15+16,8,
+                   Z_DEFAULT_STRATEGY) != Z_OK) return -1;
+
+  bigint bound = deflateBound(&zs,n1+n2) + 64;
+  if (bound > maxzbuf) {
+    deflateEnd(&zs);
+    return -1;
+  }
+
+  zs.next_out = (Bytef *) zbuf;
+  zs.avail_out = maxzbuf;
+
+  if (n1) {
+    zs.next_in = (Bytef *) str1;
+    zs.avail_in = n1;
+    deflate(&zs,Z_NO_FLUSH);
+  }
+
+  // feed str2 in pieces so avail_in (unsigned int) cannot overflow
+
+  bigint nleft = n2;
+  char *ptr = str2;
+  int zerr;
+  while (1) {
+    int nfeed = MIN(nleft,MAXSMALLINT);
+    zs.next_in = (Bytef *) ptr;
+    zs.avail_in = nfeed;
+    ptr += nfeed;
+    nleft -= nfeed;
+    zerr = deflate(&zs,nleft ? Z_NO_FLUSH : Z_FINISH);
+    if (nleft == 0) break;
+  }
+
+  int nbytes = maxzbuf - zs.avail_out;
+  deflateEnd(&zs);
+  if (zerr != Z_STREAM_END) return -1;
+  return nbytes;
+#else
+  return 0;
+#endif
+}
+
+/* ----------------------------------------------------------------------
+   write snapshot header as its own gzip member
+------------------------------------------------------------------------- */
+
+void Dump::write_header_compressed(bigint ndump)
+{
+#ifdef SPARTA_ZLIB
+  int n = capture_header(ndump);
+  compress_reserve(n);
+  int nz = compress_block(NULL,0,hdrbuf,n);
+  if (nz < 0) error->one(FLERR,"Dump compression failed");
+  fwrite(zbuf,sizeof(char),nz,fp);
+#endif
+}
+
+/* ----------------------------------------------------------------------
+   write snapshot header into hdrbuf, return # of bytes
+   style header methods print to fp, so point fp at a memory stream
+     if open_memstream() from POSIX 2008 is available,
+     else at a temporary file which is then read back
+------------------------------------------------------------------------- */
+
+int Dump::capture_header(bigint ndump)
+{
+  int n;
+  FILE *fpfile = fp;
+
+#if defined(_POSIX_VERSION) && _POSIX_VERSION >= 200809L
+  char *mbuf = NULL;
+  size_t msize = 0;
+  fp = open_memstream(&mbuf,&msize);
+  if (fp == NULL) error->one(FLERR,"Cannot write dump header to memory");
+  write_header(ndump);
+  fclose(fp);
+  fp = fpfile;
+
+  n = msize;
+  if (n > maxhdrbuf) {
+    maxhdrbuf = n;
+    memory->grow(hdrbuf,maxhdrbuf,"dump:hdrbuf");
+  }
+  memcpy(hdrbuf,mbuf,n);
+  free(mbuf);
+  nhdrbuf = n;
+#else
+  fp = tmpfile();
+  if (fp == NULL) error->one(FLERR,"Cannot write dump header to memory");
+  write_header(ndump);
+  n = ftell(fp);
+  rewind(fp);
+
+  if (n > maxhdrbuf) {
+    maxhdrbuf = n;
+    memory->grow(hdrbuf,maxhdrbuf,"dump:hdrbuf");
+  }
+  int nread = fread(hdrbuf,sizeof(char),n,fp);
+  fclose(fp);
+  fp = fpfile;
+  if (nread != n) error->one(FLERR,"Cannot write dump header to memory");
+  nhdrbuf = n;
+#endif
+
+  return n;
+}
+
 /* ----------------------------------------------------------------------
    convert mybuf of doubles to one big formatted string in sbuf
    return -1 if strlen exceeds an int, since used as arg in MPI calls in Dump
+   return -1 if sbuf must grow while a background write is in progress
 ------------------------------------------------------------------------- */
 
 int Dump::convert_string(int n, double *mybuf)
@@ -439,6 +1040,7 @@ int Dump::convert_string(int n, double *mybuf)
   int m = 0;
   for (i = 0; i < n; i++) {
     if (offset + size_one*ONEFIELD > maxsbuf) {
+      if (async_active) return -1;
       if ((bigint) maxsbuf + DELTA > MAXSMALLINT) return -1;
       maxsbuf += DELTA;
       memory->grow(sbuf,maxsbuf,"dump:sbuf");
@@ -478,6 +1080,8 @@ void Dump::modify_params(int narg, char **arg)
 {
   if (narg == 0) error->all(FLERR,"Illegal dump_modify command");
 
+  async_wait();
+
   int iarg = 0;
   while (iarg < narg) {
     if (strcmp(arg[iarg],"append") == 0) {
@@ -487,6 +1091,25 @@ void Dump::modify_params(int narg, char **arg)
       else error->all(FLERR,"Illegal dump_modify command");
       iarg += 2;
 
+    } else if (strcmp(arg[iarg],"async") == 0) {
+      if (iarg+2 > narg) error->all(FLERR,"Illegal dump_modify command");
+      if (strcmp(arg[iarg+1],"yes") == 0) async_flag = 1;
+      else if (strcmp(arg[iarg+1],"no") == 0) async_flag = 0;
+      else error->all(FLERR,"Illegal dump_modify command");
+#ifndef SPARTA_ASYNC
+      if (async_flag)
+        error->all(FLERR,"Dump_modify async requires SPARTA "
+                   "be built with -DSPARTA_ASYNC");
+#endif
+      iarg += 2;
+
+    } else if (strcmp(arg[iarg],"async/memory") == 0) {
+      if (iarg+2 > narg) error->all(FLERR,"Illegal dump_modify command");
+      double mbytes = atof(arg[iarg+1]);
+      if (mbytes < 0.0) error->all(FLERR,"Illegal dump_modify command");
+      async_max = static_cast<bigint> (mbytes*1024*1024);
+      iarg += 2;
+
     } else if (strcmp(arg[iarg],"buffer") == 0) {
       if (iarg+2 > narg) error->all(FLERR,"Illegal dump_modify command");
       if (strcmp(arg[iarg+1],"yes") == 0) buffer_flag = 1;
@@ -672,5 +1295,6 @@ void Dump::modify_params(int narg, char **arg)
 bigint Dump::memory_usage()
 {
   bigint bytes = memory->usage(buf,size_one*maxbuf);
+  bytes += memory->usage(abuf,size_one*maxabuf);
   return bytes;
 }
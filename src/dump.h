@@ -18,6 +18,10 @@
 #include "stdio.h"
 #include "pointers.h"
 
+#ifdef SPARTA_ASYNC
+#include "pthread.h"
+#endif
+
 namespace SPARTA_NS {
 
 class Dump : protected Pointers {
@@ -37,6 +41,7 @@ class Dump : protected Pointers {
   virtual void write();
   virtual void reset_grid_count() {}
   void modify_params(int, char **);
+  void async_wait();
   virtual bigint memory_usage();
 
  protected:
@@ -45,6 +50,8 @@ class Dump : protected Pointers {
   char *filename;            // user-specified file
   int compressed;            // 1 if dump file is written compressed, 0 no
   int binary;                // 1 if dump file is written binary, 0 no
+  int zflag;                 // 1 if each proc compresses its own data
+  int mpiio;                 // 1 if dump file is written with MPI-IO, 0 no
   int multifile;             // 0 = one big file, 1 = one file per timestep
   int multiproc;             // 0 = proc 0 writes for all, 1 = one file/proc
                              // else # of procs writing files
@@ -60,6 +67,8 @@ class Dump : protected Pointers {
   int buffer_allow;          // 1 if style allows for buffer_flag, 0 if not
   int buffer_flag;           // 1 if buffer output as one big string, 0 if not
   int padflag;               // timestep padding in filename
+  int async_flag;            // 1 if filewriter writes in background thread
+  bigint async_max;          // max bytes of one background snapshot
   int singlefile_opened;     // 1 = one big file, already opened, else 0
 
   char boundstr[9];          // encoding of boundary flags
@@ -74,6 +83,12 @@ class Dump : protected Pointers {
   char **format_column_user;
 
   FILE *fp;                  // file to write dump to
+  MPI_File mpifh;            // MPI-IO file handle, if mpiio set
+  MPI_Offset mpioffset;      // end of last snapshot in MPI-IO file
+  int mpifile_opened;        // 1 if MPI-IO file is open
+
+  const char *itemname;      // ATOMS, CELLS, SURFS for header
+  char *columns;             // column labels
   int size_one;              // # of quantities for one entity
   int nme;                   // # of entities in this dump from me
   int nsme;                  // # of chars in string output from me
@@ -83,16 +98,44 @@ class Dump : protected Pointers {
   double boxzlo,boxzhi;
 
   bigint ntotal;             // # of per-atom lines in snapshot
+  bigint snapstep;           // timestep of snapshot being written
+
+  int async_active;          // 1 if background write is in progress
+  int async_error;           // 1 if background write failed
+  bigint nabuf;              // # of lines in abuf
+  bigint maxabuf;            // size of abuf in lines
+  double *abuf;              // gathered snapshot for background write
+  int *acount;               // # of lines in abuf from each proc in cluster
+#ifdef SPARTA_ASYNC
+  pthread_t async_thread;
+#endif
 
   int maxbuf;                // size of buf
   double *buf;               // memory for dumped quantities
   int maxsbuf;               // size of sbuf
   char *sbuf;                // memory for atom quantities in string format
+  int maxzbuf;               // size of zbuf
+  char *zbuf;                // memory for one compressed gzip member
+  int maxhdrbuf;             // size of hdrbuf
+  char *hdrbuf;              // snapshot header captured for compression
+  int nhdrbuf;               // # of bytes in hdrbuf
 
   int *vtype;                // type of each field (INT, DOUBLE, etc)
   char **vformat;            // format string for each field
 
   int convert_string(int, double *);
+  void compress_reserve(bigint);
+  int compress_block(char *, int, char *, bigint);
+  void write_header_compressed(bigint);
+  int capture_header(bigint);
+  void openfile_mpiio(char *);
+  void closefile_mpiio();
+  void write_mpiio();
+  int header_mpiio(char *);
+  void write_async(bigint);
+  static void *async_loop(void *);
+  void write_snapshot();
+  void async_check();
 
   virtual void init_style() = 0;
   virtual void openfile();
@@ -124,11 +167,60 @@ E: Cannot open gzipped file
 SPARTA was compiled without support for reading and writing gzipped
 files through a pipeline to the gzip program with -DSPARTA_GZIP.
 
+E: Cannot change dump_modify buffer for compressed dump file once it is open
+
+In-process compression of a .gz dump file requires buffered output,
+so the buffer setting cannot be switched once the file is written.
+
+E: Dump compression failed
+
+The zlib library returned an error while compressing dump output.
+
+E: Cannot write dump header to memory
+
+The snapshot header of a compressed dump could not be captured in
+a memory stream or temporary file before compressing it.
+
+E: Too much compressed per-proc info for dump
+
+The compressed data of one processor for one snapshot must fit in a
+buffer of at most 2 GB.
+
 E: Cannot open dump file
 
 The output file for the dump command cannot be opened.  Check that the
 path and name are correct.
 
+E: Dump file with .mpiio suffix cannot use % in its name
+
+MPI-IO dump files are written collectively by all processors into a
+single file.
+
+E: Dump style does not support .mpiio files
+
+Only the particle, grid, and surf dump styles can write MPI-IO files.
+
+E: Cannot write MPI-IO dump file
+
+A collective write to the MPI-IO dump file failed.  Check that the file
+system has space and supports MPI-IO.
+
+E: Dump_modify async requires SPARTA be built with -DSPARTA_ASYNC
+
+Background writing of dump snapshots uses POSIX threads, which must
+be enabled at compile time.
+
+E: Dump background write failed
+
+Compressing or formatting a snapshot failed in the background thread
+of a dump with dump_modify async yes.  The error is reported at the
+next snapshot or when a run is set up.
+
+E: Dump_modify async cannot be used with this dump
+
+It is not supported for dump image or for .mpiio files, which are
+already written in parallel by all processors.
+
 E: Illegal ... command
 
 Self-explanatory.  Check the input script syntax and compare to the
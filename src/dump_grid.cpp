@@ -133,6 +133,7 @@ DumpGrid::DumpGrid(SPARTA *sparta, int narg, char **arg) :
 
   int n = 0;
   for (int iarg = 0; iarg < nfield; iarg++) n += strlen(earg[iarg]) + 2;
+  itemname = "CELLS";
   columns = new char[n];
   columns[0] = '\0';
   for (int iarg = 0; iarg < nfield; iarg++) {
@@ -245,7 +246,7 @@ void DumpGrid::write_header(bigint ndump)
 
 void DumpGrid::header_binary(bigint ndump)
 {
-  fwrite(&update->ntimestep,sizeof(bigint),1,fp);
+  fwrite(&snapstep,sizeof(bigint),1,fp);
   fwrite(&ndump,sizeof(bigint),1,fp);
   fwrite(domain->bflag,6*sizeof(int),1,fp);
   fwrite(&boxxlo,sizeof(double),1,fp);
@@ -264,7 +265,7 @@ void DumpGrid::header_binary(bigint ndump)
 void DumpGrid::header_item(bigint ndump)
 {
   fprintf(fp,"ITEM: TIMESTEP\n");
-  fprintf(fp,BIGINT_FORMAT "\n",update->ntimestep);
+  fprintf(fp,BIGINT_FORMAT "\n",snapstep);
   fprintf(fp,"ITEM: NUMBER OF CELLS\n");
   fprintf(fp,BIGINT_FORMAT "\n",ndump);
   fprintf(fp,"ITEM: BOX BOUNDS %s\n",boundstr);
@@ -36,8 +36,6 @@ class DumpGrid : public Dump {
   int nevery;                // dump frequency to check Fix against
   int groupbit;              // mask for grid group
 
-  char *columns;             // column labels
-
   int nfield;                // # of keywords listed by user
   int ioptional;             // index of start of optional args
 
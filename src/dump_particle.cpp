@@ -157,6 +157,7 @@ DumpParticle::DumpParticle(SPARTA *sparta, int narg, char **arg) :
 
   int n = 0;
   for (int iarg = 0; iarg < nfield; iarg++) n += strlen(earg[iarg]) + 2;
+  itemname = "ATOMS";
   columns = new char[n];
   columns[0] = '\0';
   for (int iarg = 0; iarg < nfield; iarg++) {
@@ -288,7 +289,7 @@ void DumpParticle::write_header(bigint ndump)
 
 void DumpParticle::header_binary(bigint ndump)
 {
-  fwrite(&update->ntimestep,sizeof(bigint),1,fp);
+  fwrite(&snapstep,sizeof(bigint),1,fp);
   fwrite(&ndump,sizeof(bigint),1,fp);
   fwrite(domain->bflag,6*sizeof(int),1,fp);
   fwrite(&boxxlo,sizeof(double),1,fp);
@@ -307,7 +308,7 @@ void DumpParticle::header_binary(bigint ndump)
 void DumpParticle::header_item(bigint ndump)
 {
   fprintf(fp,"ITEM: TIMESTEP\n");
-  fprintf(fp,BIGINT_FORMAT "\n",update->ntimestep);
+  fprintf(fp,BIGINT_FORMAT "\n",snapstep);
   fprintf(fp,"ITEM: NUMBER OF ATOMS\n");
   fprintf(fp,BIGINT_FORMAT "\n",ndump);
   fprintf(fp,"ITEM: BOX BOUNDS %s\n",boundstr);
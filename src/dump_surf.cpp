@@ -130,6 +130,7 @@ DumpSurf::DumpSurf(SPARTA *sparta, int narg, char **arg) :
 
   int n = 0;
   for (int iarg = 0; iarg < nfield; iarg++) n += strlen(earg[iarg]) + 2;
+  itemname = "SURFS";
   columns = new char[n];
   columns[0] = '\0';
   for (int iarg = 0; iarg < nfield; iarg++) {
@@ -304,7 +305,7 @@ void DumpSurf::write_header(bigint ndump)
 
 void DumpSurf::header_binary(bigint ndump)
 {
-  fwrite(&update->ntimestep,sizeof(bigint),1,fp);
+  fwrite(&snapstep,sizeof(bigint),1,fp);
   fwrite(&ndump,sizeof(bigint),1,fp);
   fwrite(domain->bflag,6*sizeof(int),1,fp);
   fwrite(&boxxlo,sizeof(double),1,fp);
@@ -323,7 +324,7 @@ void DumpSurf::header_binary(bigint ndump)
 void DumpSurf::header_item(bigint ndump)
 {
   fprintf(fp,"ITEM: TIMESTEP\n");
-  fprintf(fp,BIGINT_FORMAT "\n",update->ntimestep);
+  fprintf(fp,BIGINT_FORMAT "\n",snapstep);
   fprintf(fp,"ITEM: NUMBER OF SURFS\n");
   fprintf(fp,BIGINT_FORMAT "\n",ndump);
   fprintf(fp,"ITEM: BOX BOUNDS %s\n",boundstr);
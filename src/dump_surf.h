@@ -34,8 +34,6 @@ class DumpSurf : public Dump {
   int nevery;                // dump frequency to check Fix against
   int groupbit;              // mask for surface group
 
-  char *columns;             // column labels
-
   int nfield;                // # of keywords listed by user
   int ioptional;             // index of start of optional args
 
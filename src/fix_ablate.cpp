@@ -38,10 +38,12 @@ using namespace SPARTA_NS;
 
 enum{COMPUTE,FIX,RANDOM};
 enum{CVALUE,CDELTA};
+enum{UNKNOWN,OUTSIDE,INSIDE,OVERLAP};           // several files
 
 #define INVOKED_PER_GRID 16
 #define DELTAGRID 1024            // must be bigger than split cells per cell
 #define DELTASEND 1024
+#define DELTASTASH 1024
 #define EPSILON 1.0e-4            // this is on a scale of 0 to 255
 
 enum{XLO,XHI,YLO,YHI,ZLO,ZHI,INTERIOR};         // same as Domain
@@ -106,12 +108,29 @@ FixAblate::FixAblate(SPARTA *sparta, int narg, char **arg) :
     delete [] suffix;
 
   } else if (strcmp(arg[5],"random") == 0) {
-    if (narg != 7) error->all(FLERR,"Illegal fix ablate command");
+    if (narg < 7) error->all(FLERR,"Illegal fix ablate command");
     which = RANDOM;
     maxrandom = atoi(arg[6]);
 
   } else error->all(FLERR,"Illegal fix ablate command");
 
+  // optional args
+
+  incremental = 0;
+
+  int iarg = 6;
+  if (which == RANDOM) iarg = 7;
+
+  while (iarg < narg) {
+    if (strcmp(arg[iarg],"incremental") == 0) {
+      if (iarg+2 > narg) error->all(FLERR,"Illegal fix ablate command");
+      if (strcmp(arg[iarg+1],"yes") == 0) incremental = 1;
+      else if (strcmp(arg[iarg+1],"no") == 0) incremental = 0;
+      else error->all(FLERR,"Illegal fix ablate command");
+      iarg += 2;
+    } else error->all(FLERR,"Illegal fix ablate command");
+  }
+
   // error check
 
   if (which == COMPUTE) {
@@ -165,10 +184,11 @@ FixAblate::FixAblate(SPARTA *sparta, int narg, char **arg) :
 
   scalar_flag = 1;
   vector_flag = 1;
-  size_vector = 2;
+  size_vector = 3;
   global_freq = 1;
   sum_delta = 0.0;
   ndelete = 0;
+  nrecut = 0;
 
   storeflag = 0;
   array_grid = cvalues = NULL;
@@ -192,6 +212,20 @@ FixAblate::FixAblate(SPARTA *sparta, int narg, char **arg) :
   sbuf = NULL;
   maxbuf = 0;
 
+  cchanged = NULL;
+  cstash = NULL;
+  stash = NULL;
+  nstash = maxstash = 0;
+  spts = NULL;
+  smap = NULL;
+  maxssurf = 0;
+  svols = NULL;
+  maxsvol = 0;
+  craw = cnraw = NULL;
+  rawpts = NULL;
+  maxraw = 0;
+  cfaceproc = NULL;
+
   ms = NULL;
   mc = NULL;
 
@@ -238,6 +272,17 @@ FixAblate::~FixAblate()
 
   memory->destroy(sbuf);
 
+  memory->destroy(cchanged);
+  memory->destroy(cstash);
+  memory->sfree(stash);
+  memory->destroy(spts);
+  memory->destroy(smap);
+  memory->destroy(svols);
+  memory->destroy(craw);
+  memory->destroy(cnraw);
+  memory->destroy(rawpts);
+  memory->destroy(cfaceproc);
+
   delete ms;
   delete mc;
 
@@ -306,8 +351,12 @@ void FixAblate::store_corners(int nx_caller, int ny_caller, int nz_caller,
   // set ix,iy,iz indices from 1 to Nxyz for each of my owned grid cells
   // same logic as ReadIsurf::create_hash()
 
-  for (int i = 0; i < nglocal; i++)
+  for (int i = 0; i < nglocal; i++) {
     ixyz[i][0] = ixyz[i][1] = ixyz[i][2] = 0;
+    cchanged[i] = 1;
+    cstash[i] = -1;
+    craw[i] = -1;
+  }
 
   for (int icell = 0; icell < nglocal; icell++) {
     if (!(cinfo[icell].mask & groupbit)) continue;
@@ -407,6 +456,22 @@ void FixAblate::create_surfs(int outflag)
 	grid->combine_split_cell_particles(icell,1);
   }
 
+  // for incremental ablation, save surfs and cut info of each cell
+  //   before they are cleared, so cells whose surfs end up the same
+  //   do not need to be re-cut
+  // not done for initial surf creation, since no cut info exists
+
+  int incflag = 0;
+  if (incremental && !outflag && surf->exist) incflag = 1;
+  if (incflag) stash_cells();
+
+  // for incremental 3d, save owning proc of neighbor across each cell face
+  //   while ghosts still exist, so MC->cleanup() below does not need them
+
+  int faceflag = 0;
+  if (incremental && dim == 3 && grid->exist_ghost) faceflag = 1;
+  if (faceflag) set_faceproc();
+
   // call clear_surf before create new surfs, so cell/corner flags are all set
 
   grid->unset_neighbors();
@@ -417,9 +482,39 @@ void FixAblate::create_surfs(int outflag)
   // perform Marching Squares/Cubes to create new implicit surfs
   // cvalues = corner point values
   // tvalues = surf type for surfs in each grid cell
+  // for incremental, skip cells whose corner pts did not change
+  //   and restore their saved lines or tris instead
+  // 3d restores the raw tris saved before the last MC->cleanup(),
+  //   since cleanup below needs the uncleaned tris of all cells,
+  //   then saves the raw tris of all cells for the next ablation
+
+  int nparent = grid->nlocal;
+  int *skip = NULL;
+  if (incflag) {
+    memory->create(skip,nparent,"ablate:skip");
+    if (dim == 2) {
+      for (int icell = 0; icell < nparent; icell++)
+        skip[icell] = (cstash[icell] >= 0 && !stash[cstash[icell]].changed);
+    } else {
+      for (int icell = 0; icell < nparent; icell++)
+        skip[icell] = (craw[icell] >= 0 && !cchanged[icell]);
+    }
+  }
 
-  if (dim == 2) ms->invoke(cvalues,tvalues);
-  else mc->invoke(cvalues,tvalues,mcflags);
+  if (dim == 2) {
+    ms->invoke(cvalues,tvalues,skip);
+    if (incflag) restore_lines(skip);
+  } else {
+    mc->invoke(cvalues,tvalues,mcflags,skip);
+    if (incflag) {
+      restore_tris(skip);
+      for (int icell = 0; icell < nparent; icell++) {
+        if (!skip[icell]) continue;
+        for (int m = 0; m < 4; m++) mcflags[icell][m] = mcflags_old[icell][m];
+      }
+    }
+    if (incremental) save_raw();
+  }
 
   // set surf->nsurf and surf->nown
 
@@ -444,8 +539,10 @@ void FixAblate::create_surfs(int outflag)
   // it requires neighbor indices and ghost cell info
   // so first acquire ghosts (which will also grab surfs),
   //   then remove ghost surfs and ghost grid cells again
+  // for incremental, cleanup uses the face procs saved above instead
 
-  if (dim == 3) {
+  if (dim == 3 && faceflag) mc->cleanup(cfaceproc);
+  else if (dim == 3) {
     grid->acquire_ghosts(0);
     grid->reset_neighbors();
     mc->cleanup();
@@ -512,8 +609,41 @@ void FixAblate::create_surfs(int outflag)
 
   // surfs are already assigned to grid cells
   // create split cells due to new surfs
+  // for incremental, skip cut of cells whose surfs are identical to
+  //   ones saved before ablation, then restore their saved cut info
+
+  Grid::ChildCell *cells = grid->cells;
+  Grid::ChildInfo *cinfo = grid->cinfo;
+
+  int ncut = 0;
+
+  if (incflag) {
+    for (int icell = 0; icell < nparent; icell++) {
+      skip[icell] = 0;
+      if (cinfo[icell].type != OVERLAP) continue;
+      if (cstash[icell] >= 0 && same_surfs(icell,&stash[cstash[icell]]))
+        skip[icell] = 1;
+      else ncut++;
+    }
 
-  grid->surf2grid_implicit(1,outflag);
+    grid->surf2grid_implicit(1,outflag,skip);
+
+    Stash *st;
+    for (int icell = 0; icell < nparent; icell++) {
+      if (!skip[icell]) continue;
+      st = &stash[cstash[icell]];
+      grid->surf2grid_restore_one(icell,st->nsplit,&svols[st->ivol],
+                                  &smap[st->isurf],st->corner,
+                                  st->xsub,st->xsplit);
+    }
+
+  } else {
+    for (int icell = 0; icell < nparent; icell++)
+      if (cinfo[icell].type == OVERLAP) ncut++;
+    grid->surf2grid_implicit(1,outflag);
+  }
+
+  MPI_Allreduce(&ncut,&nrecut,1,MPI_INT,MPI_SUM,world);
 
   // re-setup grid ghosts and neighbors
 
@@ -548,6 +678,7 @@ void FixAblate::create_surfs(int outflag)
 
   if (dim == 2) {
     memory->destroy(mcflags_old);
+    memory->destroy(skip);
     return;
   }
 
@@ -573,8 +704,8 @@ void FixAblate::create_surfs(int outflag)
   Cut3d *cut3d = new Cut3d(sparta);
   Cut2d *cut2d = NULL;
 
-  Grid::ChildCell *cells = grid->cells;
-  Grid::ChildInfo *cinfo = grid->cinfo;
+  cells = grid->cells;
+  cinfo = grid->cinfo;
   Grid::SplitInfo *sinfo = grid->sinfo;
   Particle::OnePart *particles = particle->particles;
   int pnlocal = particle->nlocal;
@@ -590,10 +721,16 @@ void FixAblate::create_surfs(int outflag)
     if (cells[icell].nsurf == 0) continue;
 
     int mcell = icell;
+    if (cells[icell].nsplit <= 0) mcell = sinfo[cells[icell].isplit].icell;
+
+    // surfs did not change in cells whose cut was skipped
+
+    if (skip && skip[mcell]) continue;
+
     x = particles[i].x;
     flag = 1;
     if (cells[icell].nsplit <= 0) {
-      mcell = splitcell = sinfo[cells[icell].isplit].icell;
+      splitcell = mcell;
       flag = grid->outside_surfs(splitcell,x,cut3d,cut2d);
     } else flag = grid->outside_surfs(icell,x,cut3d,cut2d);
 
@@ -629,6 +766,7 @@ void FixAblate::create_surfs(int outflag)
 
   delete cut3d;
   memory->destroy(mcflags_old);
+  memory->destroy(skip);
 
   // compress out the deleted particles
   // NOTE: if end up keeping this section, need logic for custom particle vectors
@@ -831,7 +969,7 @@ void FixAblate::sync()
 {
   int i,ix,iy,iz,jx,jy,jz,ixfirst,iyfirst,izfirst,jcorner;
   int icell,jcell;
-  double total;
+  double total,oldvalue;
 
   comm_neigh_corners(CDELTA);
 
@@ -850,6 +988,7 @@ void FixAblate::sync()
     ix = ixyz[icell][0];
     iy = ixyz[icell][1];
     iz = ixyz[icell][2];
+    cchanged[icell] = 0;
 
     // loop over corner points
 
@@ -893,8 +1032,10 @@ void FixAblate::sync()
         }
       }
 
+      oldvalue = cvalues[icell][i];
       if (total > cvalues[icell][i]) cvalues[icell][i] = 0.0;
       else cvalues[icell][i] -= total;
+      if (cvalues[icell][i] != oldvalue) cchanged[icell] = 1;
     }
   }
 }
@@ -1321,6 +1462,10 @@ int FixAblate::unpack_grid_one(int icell, char *buf)
   mcflags[icell][3] = static_cast<int> (dbuf[3]);
   ptr += 4*sizeof(double);
 
+  cchanged[icell] = 1;
+  cstash[icell] = -1;
+  craw[icell] = -1;
+
   nglocal++;
 
  if (cells[icell].nsplit > 1) {
@@ -1357,6 +1502,13 @@ void FixAblate::copy_grid_one(int icell, int jcell)
   mcflags[jcell][1] = mcflags[icell][1];
   mcflags[jcell][2] = mcflags[icell][2];
   mcflags[jcell][3] = mcflags[icell][3];
+
+  cchanged[jcell] = cchanged[icell];
+  cstash[jcell] = cstash[icell];
+  craw[jcell] = craw[icell];
+  cnraw[jcell] = cnraw[icell];
+  if (cfaceproc)
+    for (int i = 0; i < 6; i++) cfaceproc[jcell][i] = cfaceproc[icell][i];
 }
 
 /* ----------------------------------------------------------------------
@@ -1380,6 +1532,10 @@ void FixAblate::add_grid_one()
   mcflags[nglocal][2] = -1;
   mcflags[nglocal][3] = -1;
 
+  cchanged[nglocal] = 1;
+  cstash[nglocal] = -1;
+  craw[nglocal] = -1;
+
   nglocal++;
 }
 
@@ -1408,6 +1564,12 @@ void FixAblate::grow_percell(int nnew)
   memory->grow(celldelta,maxgrid,"ablate:celldelta");
   memory->grow(cdelta,maxgrid,ncorner,"ablate:celldelta");
   memory->grow(numsend,maxgrid,"ablate:numsend");
+  memory->grow(cchanged,maxgrid,"ablate:cchanged");
+  memory->grow(cstash,maxgrid,"ablate:cstash");
+  memory->grow(craw,maxgrid,"ablate:craw");
+  memory->grow(cnraw,maxgrid,"ablate:cnraw");
+  if (dim == 3 && incremental)
+    memory->grow(cfaceproc,maxgrid,6,"ablate:cfaceproc");
 
   array_grid = cvalues;
 }
@@ -1423,6 +1585,267 @@ void FixAblate::grow_send()
   memory->grow(locallist,maxsend,"ablate:locallist");
 }
 
+/* ----------------------------------------------------------------------
+   save surfs and cut info of each owned cell in group with surfs
+   called before surfs and split cells are cleared
+   cstash = index of saved info for each cell, -1 if none
+------------------------------------------------------------------------- */
+
+void FixAblate::stash_cells()
+{
+  int i,m,isurf,nsurf,nsplit;
+  double *pts;
+  Stash *st;
+
+  Grid::ChildCell *cells = grid->cells;
+  Grid::ChildInfo *cinfo = grid->cinfo;
+  Grid::SplitInfo *sinfo = grid->sinfo;
+  Surf::Line *lines = surf->lines;
+  Surf::Tri *tris = surf->tris;
+  int nper = 3*dim;
+
+  nstash = 0;
+  int nssurf = 0;
+  int nsvol = 0;
+
+  for (int icell = 0; icell < nglocal; icell++) {
+    cstash[icell] = -1;
+    if (!(cinfo[icell].mask & groupbit)) continue;
+    if (cells[icell].nsplit <= 0) continue;
+    nsurf = cells[icell].nsurf;
+    if (nsurf == 0) continue;
+    nsplit = cells[icell].nsplit;
+
+    if (nstash == maxstash) {
+      maxstash += DELTASTASH;
+      stash = (Stash *)
+        memory->srealloc(stash,maxstash*sizeof(Stash),"ablate:stash");
+    }
+    if (nssurf+nsurf > maxssurf) {
+      while (nssurf+nsurf > maxssurf) maxssurf += DELTASTASH;
+      memory->grow(spts,maxssurf*nper,"ablate:spts");
+      memory->grow(smap,maxssurf,"ablate:smap");
+    }
+    if (nsvol+nsplit > maxsvol) {
+      while (nsvol+nsplit > maxsvol) maxsvol += DELTASTASH;
+      memory->grow(svols,maxsvol,"ablate:svols");
+    }
+
+    st = &stash[nstash];
+    st->changed = cchanged[icell];
+    st->nsurf = nsurf;
+    st->isurf = nssurf;
+    st->nsplit = nsplit;
+    st->ivol = nsvol;
+    for (m = 0; m < ncorner; m++) st->corner[m] = cinfo[icell].corner[m];
+
+    if (nsplit == 1) {
+      st->xsub = 0;
+      st->xsplit[0] = st->xsplit[1] = st->xsplit[2] = 0.0;
+      svols[nsvol] = cinfo[icell].volume;
+    } else {
+      Grid::SplitInfo *s = &sinfo[cells[icell].isplit];
+      st->xsub = s->xsub;
+      st->xsplit[0] = s->xsplit[0];
+      st->xsplit[1] = s->xsplit[1];
+      st->xsplit[2] = s->xsplit[2];
+      for (i = 0; i < nsplit; i++)
+        svols[nsvol+i] = cinfo[s->csubs[i]].volume;
+      for (i = 0; i < nsurf; i++)
+        smap[nssurf+i] = s->csplits[i];
+    }
+
+    for (i = 0; i < nsurf; i++) {
+      isurf = cells[icell].csurfs[i];
+      pts = &spts[(nssurf+i)*nper];
+      if (dim == 2) {
+        memcpy(&pts[0],lines[isurf].p1,3*sizeof(double));
+        memcpy(&pts[3],lines[isurf].p2,3*sizeof(double));
+      } else {
+        memcpy(&pts[0],tris[isurf].p1,3*sizeof(double));
+        memcpy(&pts[3],tris[isurf].p2,3*sizeof(double));
+        memcpy(&pts[6],tris[isurf].p3,3*sizeof(double));
+      }
+    }
+
+    nssurf += nsurf;
+    nsvol += nsplit;
+    cstash[icell] = nstash++;
+  }
+}
+
+/* ----------------------------------------------------------------------
+   re-create saved lines for 2d cells skipped by marching squares
+   same as MarchingSquares::invoke() does for a cell
+------------------------------------------------------------------------- */
+
+void FixAblate::restore_lines(int *skip)
+{
+  int i,nsurf;
+  double *pts;
+  surfint *ptr;
+  Stash *st;
+
+  Grid::ChildCell *cells = grid->cells;
+  Grid::ChildInfo *cinfo = grid->cinfo;
+  MyPage<surfint> *csurfs = grid->csurfs;
+  int nparent = grid->nlocal;
+
+  for (int icell = 0; icell < nparent; icell++) {
+    if (!skip[icell]) continue;
+    st = &stash[cstash[icell]];
+    nsurf = st->nsurf;
+
+    ptr = csurfs->get(nsurf);
+    for (i = 0; i < nsurf; i++) {
+      pts = &spts[(st->isurf+i)*6];
+      if (tvalues) surf->add_line(cells[icell].id,tvalues[icell],
+                                  &pts[0],&pts[3]);
+      else surf->add_line(cells[icell].id,1,&pts[0],&pts[3]);
+      ptr[i] = surf->nlocal - 1;
+    }
+
+    cells[icell].nsurf = nsurf;
+    cells[icell].csurfs = ptr;
+    cinfo[icell].type = OVERLAP;
+  }
+}
+
+/* ----------------------------------------------------------------------
+   re-create saved raw tris for 3d cells skipped by marching cubes
+   same as MarchingCubes::invoke() does for a cell
+------------------------------------------------------------------------- */
+
+void FixAblate::restore_tris(int *skip)
+{
+  int i,nsurf;
+  double *pts;
+  surfint *ptr;
+
+  Grid::ChildCell *cells = grid->cells;
+  Grid::ChildInfo *cinfo = grid->cinfo;
+  MyPage<surfint> *csurfs = grid->csurfs;
+  int nparent = grid->nlocal;
+
+  for (int icell = 0; icell < nparent; icell++) {
+    if (!skip[icell]) continue;
+    nsurf = cnraw[icell];
+
+    ptr = csurfs->get(nsurf);
+    for (i = 0; i < nsurf; i++) {
+      pts = &rawpts[(craw[icell]+i)*9];
+      if (tvalues) surf->add_tri(cells[icell].id,tvalues[icell],
+                                 &pts[0],&pts[3],&pts[6]);
+      else surf->add_tri(cells[icell].id,1,&pts[0],&pts[3],&pts[6]);
+      ptr[i] = surf->nlocal - 1;
+    }
+
+    cells[icell].nsurf = nsurf;
+    if (nsurf) {
+      cells[icell].csurfs = ptr;
+      cinfo[icell].type = OVERLAP;
+    }
+  }
+}
+
+/* ----------------------------------------------------------------------
+   save raw tris of each 3d cell as created by marching cubes
+   called before MC->cleanup() moves or deletes tris on cell faces
+   craw = index of 1st saved tri for each cell, -1 if none
+------------------------------------------------------------------------- */
+
+void FixAblate::save_raw()
+{
+  int i,isurf,nsurf;
+  double *pts;
+
+  Grid::ChildCell *cells = grid->cells;
+  Grid::ChildInfo *cinfo = grid->cinfo;
+  Surf::Tri *tris = surf->tris;
+
+  int nraw = 0;
+
+  for (int icell = 0; icell < nglocal; icell++) {
+    craw[icell] = -1;
+    if (!(cinfo[icell].mask & groupbit)) continue;
+    if (cells[icell].nsplit <= 0) continue;
+    nsurf = cells[icell].nsurf;
+
+    if (nraw+nsurf > maxraw) {
+      while (nraw+nsurf > maxraw) maxraw += DELTASTASH;
+      memory->grow(rawpts,maxraw*9,"ablate:rawpts");
+    }
+
+    for (i = 0; i < nsurf; i++) {
+      isurf = cells[icell].csurfs[i];
+      pts = &rawpts[(nraw+i)*9];
+      memcpy(&pts[0],tris[isurf].p1,3*sizeof(double));
+      memcpy(&pts[3],tris[isurf].p2,3*sizeof(double));
+      memcpy(&pts[6],tris[isurf].p3,3*sizeof(double));
+    }
+
+    craw[icell] = nraw;
+    cnraw[icell] = nsurf;
+    nraw += nsurf;
+  }
+}
+
+/* ----------------------------------------------------------------------
+   save owning proc of neighbor cell across each face of my 3d cells
+   called while neighbor indices and ghost cells still exist
+   cfaceproc = -1 if neighbor is not a child cell
+------------------------------------------------------------------------- */
+
+void FixAblate::set_faceproc()
+{
+  int i,nflag;
+
+  Grid::ChildCell *cells = grid->cells;
+
+  for (int icell = 0; icell < nglocal; icell++) {
+    for (i = 0; i < 6; i++) {
+      nflag = grid->neigh_decode(cells[icell].nmask,i);
+      if (nflag == NCHILD || nflag == NPBCHILD)
+        cfaceproc[icell][i] = cells[cells[icell].neigh[i]].proc;
+      else cfaceproc[icell][i] = -1;
+    }
+  }
+}
+
+/* ----------------------------------------------------------------------
+   return 1 if surfs now in icell are identical to saved ones, else 0
+   same surfs in same order with bitwise identical end points
+------------------------------------------------------------------------- */
+
+int FixAblate::same_surfs(int icell, Stash *st)
+{
+  int i,isurf;
+  double *pts;
+
+  Grid::ChildCell *cells = grid->cells;
+  int nsurf = cells[icell].nsurf;
+  if (nsurf != st->nsurf) return 0;
+
+  Surf::Line *lines = surf->lines;
+  Surf::Tri *tris = surf->tris;
+  int nper = 3*dim;
+
+  for (i = 0; i < nsurf; i++) {
+    isurf = cells[icell].csurfs[i];
+    pts = &spts[(st->isurf+i)*nper];
+    if (dim == 2) {
+      if (memcmp(&pts[0],lines[isurf].p1,3*sizeof(double))) return 0;
+      if (memcmp(&pts[3],lines[isurf].p2,3*sizeof(double))) return 0;
+    } else {
+      if (memcmp(&pts[0],tris[isurf].p1,3*sizeof(double))) return 0;
+      if (memcmp(&pts[3],tris[isurf].p2,3*sizeof(double))) return 0;
+      if (memcmp(&pts[6],tris[isurf].p3,3*sizeof(double))) return 0;
+    }
+  }
+
+  return 1;
+}
+
 /* ----------------------------------------------------------------------
    output sum of grid cell corner point values
    assume boundary corner points have value = 0.0
@@ -1459,12 +1882,14 @@ double FixAblate::compute_scalar()
    vector outputs
    1 = last ablation decrement
    2 = # of deleted inside particles at last ablation
+   3 = # of cells whose surfs were cut at last ablation
 ------------------------------------------------------------------------- */
 
 double FixAblate::compute_vector(int i)
 {
   if (i == 0) return sum_delta;
   if (i == 1) return 1.0*ndelete;
+  if (i == 2) return 1.0*nrecut;
   return 0.0;
 }
 
@@ -1484,5 +1909,12 @@ double FixAblate::memory_usage()
   bytes += maxghost*ncorner * sizeof(double);  // cdelta_ghost
   bytes += 3*maxsend * sizeof(int);            // proclist,locallist,numsend
   bytes += maxbuf * sizeof(double);            // sbuf
+  bytes += 4*maxgrid * sizeof(int);            // cchanged,cstash,craw,cnraw
+  if (cfaceproc) bytes += 6*maxgrid * sizeof(int);   // cfaceproc
+  bytes += maxstash * sizeof(Stash);           // stash
+  bytes += maxssurf*dim*3 * sizeof(double);    // spts
+  bytes += maxssurf * sizeof(int);             // smap
+  bytes += maxsvol * sizeof(double);           // svols
+  bytes += maxraw*9 * sizeof(double);          // rawpts
   return bytes;
 }
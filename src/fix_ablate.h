@@ -62,6 +62,8 @@ class FixAblate : public Fix {
   double thresh;
   double sum_delta;
   int ndelete;
+  int incremental;        // 1 to reuse surfs/cuts of cells that did not change
+  int nrecut;             // # of cells cut at last ablation
 
   int nglocal;            // # of owned grid cells
 
@@ -88,6 +90,44 @@ class FixAblate : public Fix {
   double *sbuf;
   int maxbuf;
 
+  // surf and cut info of each owned cell with surfs, saved before
+  //   an incremental ablation clears all surfs and split cells
+  // cstash is a per-cell vector so it is carried along when
+  //   clear_surf() compresses the cell list
+
+  struct Stash {
+    int changed;          // 1 if corner pt values changed in this ablation
+    int nsurf;            // # of surfs in cell
+    int isurf;            // index of 1st surf in spts and smap
+    int nsplit;           // # of sub cells, 1 if unsplit
+    int ivol;             // index of 1st volume in svols
+    int xsub;             // sub cell containing xsplit
+    double xsplit[3];     // point in split cell
+    int corner[8];        // corner flags of cell
+  };
+
+  int *cchanged;          // per-cell flag, 1 if corner pts changed in sync()
+  int *cstash;            // per-cell index into stash, -1 if none
+  Stash *stash;
+  int nstash,maxstash;
+  double *spts;           // end points of each saved surf
+  int *smap;              // sub cell of each saved surf in a split cell
+  int maxssurf;
+  double *svols;          // volume of cell or each of its sub cells
+  int maxsvol;
+
+  // 3d incremental ablation saves the raw marching cubes tris of each
+  //   owned cell before MC cleanup, cells whose corner pts did not change
+  //   get them back instead of being re-triangulated
+  // cfaceproc is set before ghosts are removed, so MC cleanup
+  //   does not need ghost cells
+
+  int *craw;              // per-cell index of 1st raw tri, -1 if none saved
+  int *cnraw;             // per-cell # of raw tris
+  double *rawpts;         // 3 corner pts of each raw tri
+  int maxraw;
+  int **cfaceproc;        // per-cell owner of neighbor across each face
+
   class MarchingSquares *ms;
   class MarchingCubes *mc;
   class RanPark *random;
@@ -103,6 +143,12 @@ class FixAblate : public Fix {
   int walk_to_neigh(int, int, int, int);
   void grow_percell(int);
   void grow_send();
+  void stash_cells();
+  void restore_lines(int *);
+  void restore_tris(int *);
+  void save_raw();
+  void set_faceproc();
+  int same_surfs(int, Stash *);
 };
 
 }
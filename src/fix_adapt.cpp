@@ -119,6 +119,7 @@ void FixAdapt::end_of_step()
 
   // same operations as in AdaptGrid single invocation
 
+  grid->stash_ghosts();
   grid->remove_ghosts();
 
   // memory allocation in AdaptGrid class
@@ -206,12 +206,18 @@ FixAveGrid::FixAveGrid(SPARTA *sparta, int narg, char **arg) :
 
   if (flavor == PERGRIDSURF && ave == RUNNING)
     error->all(FLERR,"Fix ave/grid for grid/surf inputs cannot use ave running");
+  if (flavor == PERGRIDSURF && varflag)
+    error->all(FLERR,"Fix ave/grid for grid/surf inputs cannot use variance");
 
   // this fix produces either a per-grid vector or array
+  // if varflag, variance of each value follows the Nvalues averages
+
+  if (varflag) nout = 2*nvalues;
+  else nout = nvalues;
 
   per_grid_flag = 1;
-  if (nvalues == 1) size_per_grid_cols = 0;
-  else size_per_grid_cols = nvalues;
+  if (nout == 1) size_per_grid_cols = 0;
+  else size_per_grid_cols = nout;
 
   nglocal = maxgrid = grid->nlocal;
 
@@ -221,13 +227,22 @@ FixAveGrid::FixAveGrid(SPARTA *sparta, int narg, char **arg) :
   vector_grid = NULL;
   array_grid = NULL;
 
-  if (nvalues == 1) {
+  if (nout == 1) {
     memory->create(vector_grid,nglocal,"ave/grid:vector_grid");
     for (int i = 0; i < nglocal; i++) vector_grid[i] = 0.0;
   } else {
-    memory->create(array_grid,nglocal,nvalues,"ave/grid:array_grid");
+    memory->create(array_grid,nglocal,nout,"ave/grid:array_grid");
+    for (int i = 0; i < nglocal; i++)
+      for (int m = 0; m < nout; m++) array_grid[i][m] = 0.0;
+  }
+
+  moments = NULL;
+  sample = NULL;
+  if (varflag) {
+    memory->create(moments,nglocal,2*nvalues,"ave/grid:moments");
+    memory->create(sample,nglocal,nvalues,"ave/grid:sample");
     for (int i = 0; i < nglocal; i++)
-      for (int m = 0; m < nvalues; m++) array_grid[i][m] = 0.0;
+      for (int m = 0; m < 2*nvalues; m++) moments[i][m] = 0.0;
   }
 
   // nvalid = next step on which end_of_step does something
@@ -337,6 +352,15 @@ FixAveGrid::FixAveGrid(SPARTA *sparta, int narg, char **arg) :
         tally[i][j] = 0.0;
   } else tally = NULL;
 
+  // lists of sources for single-pass accumulation into tally
+  // each tally column is accumulated from at most one source
+
+  accdest = new int[ntotal];
+  accsrc = new double**[ntotal];
+  acccol = new int[ntotal];
+  vaccdest = new int[ntotal];
+  vaccsrc = new double*[ntotal];
+
   // tally accumulators for flavor = PERGRIDSURF
 
   ntallyID = maxtallyID = 0;
@@ -368,10 +392,18 @@ FixAveGrid::~FixAveGrid()
   memory->destroy(umap);
   memory->destroy(uomap);
 
-  if (nvalues == 1) memory->destroy(vector_grid);
+  if (nout == 1) memory->destroy(vector_grid);
   else memory->destroy(array_grid);
 
   memory->destroy(tally);
+  memory->destroy(moments);
+  memory->destroy(sample);
+
+  delete [] accdest;
+  delete [] accsrc;
+  delete [] acccol;
+  delete [] vaccdest;
+  delete [] vaccsrc;
 
   memory->destroy(tally2cell);
   memory->destroy(vec_tally);
@@ -437,7 +469,7 @@ void FixAveGrid::setup()
 void FixAveGrid::end_of_step()
 {
   int i,j,k,m,n,itally;
-  int ntally_col,kk;
+  int ntally_col;
   cellint cellID;
   int *itmp;
   double *vec;
@@ -455,6 +487,10 @@ void FixAveGrid::end_of_step()
     for (i = 0; i < nglocal; i++)
       for (j = 0; j < ntotal; j++)
         tally[i][j] = 0.0;
+    if (varflag)
+      for (i = 0; i < nglocal; i++)
+        for (j = 0; j < 2*nvalues; j++)
+          moments[i][j] = 0.0;
   }
 
   // clear hash of cellID tallies if ave = ONE and first sample
@@ -474,6 +510,11 @@ void FixAveGrid::end_of_step()
 
   if (flavor == PERGRID) {
 
+    // invoke computes and evaluate variables
+    // build list of per-grid vectors and array columns to sum into tally
+
+    nacc = nvacc = 0;
+
     for (m = 0; m < nvalues; m++) {
       n = value2index[m];
       j = argindex[m];
@@ -494,49 +535,64 @@ void FixAveGrid::end_of_step()
         if (post_process[m]) {
           ntally_col = numap[m];
           compute->query_tally_grid(j,ctally,itmp);
-          for (i = 0; i < nglocal; i++)
-            for (itally = 0; itally < ntally_col; itally++) {
-              k = umap[m][itally];
-              kk = uomap[m][itally];
-              tally[i][k] += ctally[i][kk];
-            }
-        } else {
-          k = umap[m][0];
-          if (j == 0) {
-            double *compute_vector = compute->vector_grid;
-            for (i = 0; i < nglocal; i++)
-              tally[i][k] += compute_vector[i];
-          } else {
-            int jm1 = j - 1;
-            double **compute_array = compute->array_grid;
-            for (i = 0; i < nglocal; i++)
-              tally[i][k] += compute_array[i][jm1];
+          for (itally = 0; itally < ntally_col; itally++) {
+            accdest[nacc] = umap[m][itally];
+            accsrc[nacc] = ctally;
+            acccol[nacc++] = uomap[m][itally];
+          }
+          if (varflag) {
+            compute->post_process_grid(j,1,NULL,NULL,NULL,1);
+            vec = compute->vector_grid;
+            for (i = 0; i < nglocal; i++) sample[i][m] = vec[i];
           }
+        } else if (j == 0) {
+          vaccdest[nvacc] = umap[m][0];
+          vaccsrc[nvacc++] = compute->vector_grid;
+        } else {
+          accdest[nacc] = umap[m][0];
+          accsrc[nacc] = compute->array_grid;
+          acccol[nacc++] = j-1;
         }
 
       // access fix fields, guaranteed to be ready
 
       } else if (which[m] == FIX) {
-        k = umap[m][0];
         if (j == 0) {
-          double *fix_vector = modify->fix[n]->vector_grid;
-          for (i = 0; i < nglocal; i++)
-            tally[i][k] += fix_vector[i];
+          vaccdest[nvacc] = umap[m][0];
+          vaccsrc[nvacc++] = modify->fix[n]->vector_grid;
         } else {
-          int jm1 = j - 1;
-        double **fix_array = modify->fix[n]->array_grid;
-	for (i = 0; i < nglocal; i++)
-	  tally[i][k] += fix_array[i][jm1];
+          accdest[nacc] = umap[m][0];
+          accsrc[nacc] = modify->fix[n]->array_grid;
+          acccol[nacc++] = j-1;
         }
 
       // evaluate grid-style variable, sum values to Kth column of tally array
+      // if varflag, store values in sample and accumulate from there
 
       } else if (which[m] == VARIABLE) {
         k = umap[m][0];
-        input->variable->compute_grid(n,&tally[0][k],ntotal,1);
+        if (varflag) {
+          input->variable->compute_grid(n,&sample[0][m],nvalues,0);
+          accdest[nacc] = k;
+          accsrc[nacc] = sample;
+          acccol[nacc++] = m;
+        } else input->variable->compute_grid(n,&tally[0][k],ntotal,1);
       }
     }
 
+    // single pass over owned cells to accumulate all tallies
+
+    double *onetally;
+    for (i = 0; i < nglocal; i++) {
+      onetally = tally[i];
+      for (k = 0; k < nacc; k++)
+        onetally[accdest[k]] += accsrc[k][i][acccol[k]];
+      for (k = 0; k < nvacc; k++)
+        onetally[vaccdest[k]] += vaccsrc[k][i];
+    }
+
+    if (varflag) accumulate_moments();
+
   // PERGRIDSURF = all values are computes which tally info on collisions
   //               with implicit surfs and store them as per-grid-cell tallies
 
@@ -651,7 +707,7 @@ void FixAveGrid::end_of_step()
   // else just divide by nsample
 
   if (flavor == PERGRID) {
-    if (nvalues == 1) {
+    if (nout == 1) {
       if (post_process[0]) {
         n = value2index[0];
         j = argindex[0];
@@ -668,7 +724,7 @@ void FixAveGrid::end_of_step()
           j = argindex[m];
           Compute *c = modify->compute[n];
           if (array_grid) c->post_process_grid(j,nsample,tally,map[m],
-                                               &array_grid[0][m],nvalues);
+                                               &array_grid[0][m],nout);
         } else {
           k = map[m][0];
           for (i = 0; i < nglocal; i++) array_grid[i][m] = tally[i][k] / nsample;
@@ -676,6 +732,16 @@ void FixAveGrid::end_of_step()
       }
     }
 
+    // unbiased variance of samples from running M2 of each value
+
+    if (varflag) {
+      double norm = 0.0;
+      if (nsample > 1) norm = 1.0/(nsample-1);
+      for (i = 0; i < nglocal; i++)
+        for (m = 0; m < nvalues; m++)
+          array_grid[i][nvalues+m] = moments[i][2*m+1] * norm;
+    }
+
   // final PERGRIDSURF values for output
   // invoke surf->collate() on cellID tallies this fix stores for multiple steps
   //   this merges tallies to owned grid cells
@@ -727,13 +793,13 @@ void FixAveGrid::end_of_step()
 
   if (groupbit != 1) {
     Grid::ChildInfo *cinfo = grid->cinfo;
-    if (nvalues == 1) {
+    if (nout == 1) {
       for (i = 0; i < nglocal; i++)
         if (!(cinfo[i].mask & groupbit)) vector_grid[i] = 0.0;
     } else {
       for (i = 0; i < nglocal; i++)
         if (!(cinfo[i].mask & groupbit))
-          for (m = 0; m < nvalues; m++) array_grid[i][m] = 0.0;
+          for (m = 0; m < nout; m++) array_grid[i][m] = 0.0;
     }
   }
 
@@ -777,16 +843,21 @@ int FixAveGrid::pack_one(int icell, char *buf, int memflag)
   char *ptr = buf;
 
   if (memflag) {
-    if (nvalues == 1) *((double *) ptr) = vector_grid[icell];
-    else memcpy(ptr,array_grid[icell],nvalues*sizeof(double));
+    if (nout == 1) *((double *) ptr) = vector_grid[icell];
+    else memcpy(ptr,array_grid[icell],nout*sizeof(double));
   }
-  ptr += nvalues*sizeof(double);
+  ptr += nout*sizeof(double);
 
   if (flavor == PERGRID) {
     if (memflag) memcpy(ptr,tally[icell],ntotal*sizeof(double));
     ptr += ntotal*sizeof(double);
   }
 
+  if (varflag) {
+    if (memflag) memcpy(ptr,moments[icell],2*nvalues*sizeof(double));
+    ptr += 2*nvalues*sizeof(double);
+  }
+
   return ptr-buf;
 }
 
@@ -828,15 +899,20 @@ int FixAveGrid::unpack_one(char *buf, int icell)
 {
   char *ptr = buf;
 
-  if (nvalues == 1) vector_grid[icell] = *((double *) ptr);
-  else memcpy(array_grid[icell],ptr,nvalues*sizeof(double));
-  ptr += nvalues*sizeof(double);
+  if (nout == 1) vector_grid[icell] = *((double *) ptr);
+  else memcpy(array_grid[icell],ptr,nout*sizeof(double));
+  ptr += nout*sizeof(double);
 
   if (flavor == PERGRID) {
     memcpy(tally[icell],ptr,ntotal*sizeof(double));
     ptr += ntotal*sizeof(double);
   }
 
+  if (varflag) {
+    memcpy(moments[icell],ptr,2*nvalues*sizeof(double));
+    ptr += 2*nvalues*sizeof(double);
+  }
+
   return ptr-buf;
 }
 
@@ -848,10 +924,12 @@ int FixAveGrid::unpack_one(char *buf, int icell)
 
 void FixAveGrid::copy_grid_one(int icell, int jcell)
 {
-  if (nvalues == 1) vector_grid[jcell] = vector_grid[icell];
-  else memcpy(array_grid[jcell],array_grid[icell],nvalues*sizeof(double));
+  if (nout == 1) vector_grid[jcell] = vector_grid[icell];
+  else memcpy(array_grid[jcell],array_grid[icell],nout*sizeof(double));
   if (flavor == PERGRID)
     memcpy(tally[jcell],tally[icell],ntotal*sizeof(double));
+  if (varflag)
+    memcpy(moments[jcell],moments[icell],2*nvalues*sizeof(double));
 }
 
 /* ----------------------------------------------------------------------
@@ -864,13 +942,16 @@ void FixAveGrid::add_grid_one()
 {
   grow_percell(1);
 
-  if (nvalues == 1) vector_grid[nglocal] = 0.0;
+  if (nout == 1) vector_grid[nglocal] = 0.0;
   else
-    for (int i = 0; i < nvalues; i++) array_grid[nglocal][i] = 0.0;
+    for (int i = 0; i < nout; i++) array_grid[nglocal][i] = 0.0;
 
   if (flavor == PERGRID)
     for (int i = 0; i < ntotal; i++) tally[nglocal][i] = 0.0;
 
+  if (varflag)
+    for (int i = 0; i < 2*nvalues; i++) moments[nglocal][i] = 0.0;
+
   nglocal++;
 }
 
@@ -892,6 +973,7 @@ void FixAveGrid::options(int iarg, int narg, char **arg)
   // option defaults
 
   ave = ONE;
+  varflag = 0;
 
   // optional args
 
@@ -902,6 +984,12 @@ void FixAveGrid::options(int iarg, int narg, char **arg)
       else if (strcmp(arg[iarg+1],"running") == 0) ave = RUNNING;
       else error->all(FLERR,"Illegal fix ave/grid command");
       iarg += 2;
+    } else if (strcmp(arg[iarg],"variance") == 0) {
+      if (iarg+2 > narg) error->all(FLERR,"Illegal fix ave/grid command");
+      if (strcmp(arg[iarg+1],"yes") == 0) varflag = 1;
+      else if (strcmp(arg[iarg+1],"no") == 0) varflag = 0;
+      else error->all(FLERR,"Illegal fix ave/grid command");
+      iarg += 2;
     } else error->all(FLERR,"Illegal fix ave/grid command");
   }
 }
@@ -935,16 +1023,20 @@ void FixAveGrid::grow_percell(int nnew)
   int maxgridold = maxgrid;
   while (maxgrid < nglocal+nnew) maxgrid += DELTAGRID;
 
-  if (nvalues == 1) memory->grow(vector_grid,maxgrid,"ave/grid:vector_grid");
-  else memory->grow(array_grid,maxgrid,nvalues,"ave/grid:array_grid");
+  if (nout == 1) memory->grow(vector_grid,maxgrid,"ave/grid:vector_grid");
+  else memory->grow(array_grid,maxgrid,nout,"ave/grid:array_grid");
   if (flavor == PERGRID) memory->grow(tally,maxgrid,ntotal,"ave/grid:tally");
+  if (varflag) {
+    memory->grow(moments,maxgrid,2*nvalues,"ave/grid:moments");
+    memory->grow(sample,maxgrid,nvalues,"ave/grid:sample");
+  }
 
-  if (nvalues == 1)
+  if (nout == 1)
     for (int i = maxgridold; i < maxgrid; i++)
       vector_grid[i] = 0.0;
   else
     for (int i = maxgridold; i < maxgrid; i++)
-      for (int j = 0; j < nvalues; j++)
+      for (int j = 0; j < nout; j++)
         array_grid[i][j] = 0.0;
 }
 
@@ -960,6 +1052,57 @@ void FixAveGrid::grow_tally()
     memory->grow(array_tally,maxtallyID,nvalues,"ave/grid:array_tally");
 }
 
+/* ----------------------------------------------------------------------
+   update running mean and M2 of each value with current sample
+   Welford's algorithm, so variance is accurate for many samples
+   sample values for computes and fixes which are not post-processed
+     are accessed directly, others were stored in sample by end_of_step()
+------------------------------------------------------------------------- */
+
+void FixAveGrid::accumulate_moments()
+{
+  int i,j,m,n;
+  double x,delta,mean;
+
+  for (m = 0; m < nvalues; m++) {
+    if (which[m] == VARIABLE || post_process[m]) continue;
+    n = value2index[m];
+    j = argindex[m];
+
+    double *vec = NULL;
+    double **array = NULL;
+    if (which[m] == COMPUTE) {
+      vec = modify->compute[n]->vector_grid;
+      array = modify->compute[n]->array_grid;
+    } else {
+      vec = modify->fix[n]->vector_grid;
+      array = modify->fix[n]->array_grid;
+    }
+
+    if (j == 0)
+      for (i = 0; i < nglocal; i++) sample[i][m] = vec[i];
+    else
+      for (i = 0; i < nglocal; i++) sample[i][m] = array[i][j-1];
+  }
+
+  // nsample has not yet been incremented for this sample
+
+  double invcount = 1.0/(nsample+1);
+
+  for (i = 0; i < nglocal; i++) {
+    double *onesample = sample[i];
+    double *onemoment = moments[i];
+    for (m = 0; m < nvalues; m++) {
+      x = onesample[m];
+      mean = onemoment[2*m];
+      delta = x - mean;
+      mean += delta*invcount;
+      onemoment[2*m] = mean;
+      onemoment[2*m+1] += delta*(x - mean);
+    }
+  }
+}
+
 /* ----------------------------------------------------------------------
    memory usage of accumulators
 ------------------------------------------------------------------------- */
@@ -967,8 +1110,9 @@ void FixAveGrid::grow_tally()
 double FixAveGrid::memory_usage()
 {
   double bytes = 0.0;
-  bytes += maxgrid*nvalues * sizeof(double);    // vector or array grid
+  bytes += maxgrid*nout * sizeof(double);       // vector or array grid
   if (flavor == PERGRID) bytes += ntotal*maxgrid * sizeof(double);
+  if (varflag) bytes += 3*nvalues*maxgrid * sizeof(double);
   if (flavor == PERGRIDSURF) {
     bytes += maxtallyID * sizeof(cellint);
     bytes += nvalues*maxtallyID * sizeof(double);
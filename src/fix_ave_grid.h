@@ -49,6 +49,8 @@ class FixAveGrid : public Fix {
   int groupbit,nvalues,maxvalues;
   int nrepeat,irepeat,nsample;
   bigint nvalid;
+  int varflag;               // 1 if also computing variance of samples
+  int nout;                  // # of output columns, nvalues or 2*nvalues
 
   char **ids;                // ID/name of compute,fix,variable to access
   int *which;                // COMPUTE or FIX or VARIABLE
@@ -77,6 +79,19 @@ class FixAveGrid : public Fix {
   int nglocal;               // # of owned grid cells
   int maxgrid;               // max size of per-cell vectors/arrays
 
+                             // used to accumulate all tallies in one pass
+  int nacc;                  // # of tally columns accumulated from arrays
+  int *accdest;              // tally column for each
+  double ***accsrc;          // per-grid array to accumulate from for each
+  int *acccol;               // column of that array
+  int nvacc;                 // # of tally columns accumulated from vectors
+  int *vaccdest;             // tally column for each
+  double **vaccsrc;          // per-grid vector to accumulate from for each
+
+                             // used when varflag is set
+  double **moments;          // running mean and M2 of samples, 2 per value
+  double **sample;           // value of current sample, cells by nvalues
+
   // for PERGRIDSURF tallies for implicit surf collisions on per-cell basis
 
   int ntallyID;            // # of cells I have tallies for
@@ -104,6 +119,7 @@ class FixAveGrid : public Fix {
   bigint nextvalid();
   virtual void grow_percell(int);
   void grow_tally();
+  void accumulate_moments();
 };
 
 }
@@ -172,4 +188,9 @@ E: Fix ave/grid variable is not grid-style variable
 
 Self-explanatory.
 
+E: Fix ave/grid for grid/surf inputs cannot use variance
+
+Per-sample values are not available for computes which tally
+collisions with implicit surfaces.
+
 */
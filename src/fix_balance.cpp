@@ -22,6 +22,7 @@
 #include "domain.h"
 #include "comm.h"
 #include "rcb.h"
+#include "sfc.h"
 #include "modify.h"
 #include "compute.h"
 #include "output.h"
@@ -34,7 +35,7 @@
 
 using namespace SPARTA_NS;
 
-enum{RANDOM,PROC,BISECTION};
+enum{RANDOM,PROC,BISECTION,SFCURVE};
 enum{CELL,PARTICLE,TIME};
 
 #define ZEROPARTICLE 0.1
@@ -48,7 +49,7 @@ FixBalance::FixBalance(SPARTA *sparta, int narg, char **arg) :
 
   scalar_flag = 1;
   vector_flag = 1;
-  size_vector = 2;
+  size_vector = 5;
   global_freq = 1;
 
   // parse arguments
@@ -71,12 +72,24 @@ FixBalance::FixBalance(SPARTA *sparta, int narg, char **arg) :
     else if (strcmp(arg[5],"time") == 0) rcbwt = TIME;
     else error->all(FLERR,"Illegal fix balance command");
     iarg = 6;
+  } else if (strcmp(arg[4],"sfc") == 0) {
+    if (narg < 7) error->all(FLERR,"Illegal fix balance command");
+    bstyle = SFCURVE;
+    if (strcmp(arg[5],"hilbert") == 0) curve = SFC::HILBERT;
+    else if (strcmp(arg[5],"morton") == 0) curve = SFC::MORTON;
+    else error->all(FLERR,"Illegal fix balance command");
+    if (strcmp(arg[6],"cell") == 0) rcbwt = CELL;
+    else if (strcmp(arg[6],"part") == 0) rcbwt = PARTICLE;
+    else if (strcmp(arg[6],"time") == 0) rcbwt = TIME;
+    else error->all(FLERR,"Illegal fix balance command");
+    iarg = 7;
   } else error->all(FLERR,"Illegal fix balance command");
 
   // optional args
 
   strcpy(eligible,"xyz");
   rcbflip = 0;
+  incremental = 0;
 
   while (iarg < narg) {
     if (strcmp(arg[iarg],"axes") == 0) {
@@ -101,6 +114,12 @@ FixBalance::FixBalance(SPARTA *sparta, int narg, char **arg) :
       else if (strcmp(arg[iarg+1],"no") == 0) rcbflip = 0;
       else error->all(FLERR,"Illegal fix balance command");
       iarg += 2;
+    } else if (strcmp(arg[iarg],"incremental") == 0) {
+      if (iarg+2 > narg) error->all(FLERR,"Illegal fix balance command");
+      if (strcmp(arg[iarg+1],"yes") == 0) incremental = 1;
+      else if (strcmp(arg[iarg+1],"no") == 0) incremental = 0;
+      else error->all(FLERR,"Illegal fix balance command");
+      iarg += 2;
     } else error->all(FLERR,"Illegal fix balance command");
   }
 
@@ -112,19 +131,26 @@ FixBalance::FixBalance(SPARTA *sparta, int narg, char **arg) :
   me = comm->me;
   nprocs = comm->nprocs;
 
-  // create instance of RNG or RCB
+  // create instance of RNG or RCB or SFC
+  // SFC instance persists so each rebalance can start from previous cuts
 
   random = NULL;
   rcb = NULL;
+  sfc = NULL;
 
   if (bstyle == RANDOM || bstyle == PROC)
     random = new RanPark(update->ranmaster->uniform());
-  if (bstyle == BISECTION) rcb = new RCB(sparta);
+  if (bstyle == BISECTION) {
+    rcb = new RCB(sparta);
+    rcb->keeptree = incremental;
+  }
+  if (bstyle == SFCURVE) sfc = new SFC(sparta,curve);
 
   // compute initial outputs
 
   last = 0.0;
   imbfinal = imbprev = imbalance_factor(maxperproc);
+  nmigrate_last = nghost_last = npmigrate_last = 0;
 }
 
 /* ---------------------------------------------------------------------- */
@@ -133,6 +159,7 @@ FixBalance::~FixBalance()
 {
   delete random;
   delete rcb;
+  delete sfc;
 }
 
 /* ---------------------------------------------------------------------- */
@@ -150,7 +177,7 @@ void FixBalance::init()
 {
   // error b/c acquire_ghosts() is a no-op in this case
 
-  if (bstyle != BISECTION && grid->cutoff >= 0.0)
+  if (bstyle != BISECTION && bstyle != SFCURVE && grid->cutoff >= 0.0)
     error->all(FLERR,"Cannot use non-rcb fix balance with a grid cutoff");
 
   last = 0.0;
@@ -200,7 +227,7 @@ void FixBalance::end_of_step()
       if (newproc == nprocs) newproc = 0;
     }
 
-  } else if (bstyle == BISECTION) {
+  } else if (bstyle == BISECTION || bstyle == SFCURVE) {
     double **x;
     memory->create(x,nglocal,3,"balance:x");
 
@@ -234,28 +261,63 @@ void FixBalance::end_of_step()
       timer_cell_weights(wt);
     }
 
-    rcb->compute(nbalance,x,wt,eligible,rcbflip);
-    rcb->invert();
+    // incremental RCB moves the cuts of the previous RCB in place
+    // 1st rebalance has no previous cuts and does a full RCB
 
-    nbalance = 0;
-    int *sendproc = rcb->sendproc;
-    for (int icell = 0; icell < nglocal; icell++) {
-      if (cells[icell].nsplit <= 0) continue;
-      cells[icell].proc = sendproc[nbalance++];
+    if (bstyle == BISECTION) {
+      if (incremental && rcb->treeflag) rcb->adjust(nbalance,x,wt);
+      else {
+        rcb->compute(nbalance,x,wt,eligible,rcbflip);
+        rcb->invert();
+      }
+
+      nbalance = 0;
+      int *sendproc = rcb->sendproc;
+      for (int icell = 0; icell < nglocal; icell++) {
+        if (cells[icell].nsplit <= 0) continue;
+        cells[icell].proc = sendproc[nbalance++];
+      }
+      nmigrate = nbalance - rcb->nkeep;
+
+    } else {
+      sfc->compute(nbalance,x,wt);
+
+      int newproc;
+      nbalance = 0;
+      int *sfcproc = sfc->proc;
+      for (int icell = 0; icell < nglocal; icell++) {
+        if (cells[icell].nsplit <= 0) continue;
+        newproc = sfcproc[nbalance++];
+        if (newproc != cells[icell].proc) nmigrate++;
+        cells[icell].proc = newproc;
+      }
     }
-    nmigrate = nbalance - rcb->nkeep;
 
     memory->destroy(x);
     memory->destroy(wt);
   }
 
-  if (nprocs == 1 || bstyle == BISECTION) grid->clumped = 1;
+  if (nprocs == 1 || bstyle == BISECTION || bstyle == SFCURVE)
+    grid->clumped = 1;
   else grid->clumped = 0;
 
   // sort particles
+  // count particles in migrating cells, sub cells go with their split cell
 
   if (!particle->sorted) particle->sort();
 
+  Particle::OnePart *particles = particle->particles;
+  Grid::SplitInfo *sinfo = grid->sinfo;
+  int nplocal = particle->nlocal;
+  bigint npmigrate = 0;
+  int icell;
+
+  for (int i = 0; i < nplocal; i++) {
+    icell = particles[i].icell;
+    if (cells[icell].nsplit <= 0) icell = sinfo[cells[icell].isplit].icell;
+    if (cells[icell].proc != me) npmigrate++;
+  }
+
   // migrate grid cells and their particles to new owners
   // invoke grid methods to complete grid setup
   // some fixes have post migration operations to perform
@@ -276,9 +338,18 @@ void FixBalance::end_of_step()
 
   grid->notify_changed();
 
+  // migration and ghost counts for this rebalance
+  // cells and particles migrated measure the data volume moved
+
+  bigint count = nmigrate;
+  MPI_Allreduce(&count,&nmigrate_last,1,MPI_SPARTA_BIGINT,MPI_SUM,world);
+  count = grid->nghost;
+  MPI_Allreduce(&count,&nghost_last,1,MPI_SPARTA_BIGINT,MPI_SUM,world);
+  MPI_Allreduce(&npmigrate,&npmigrate_last,1,MPI_SPARTA_BIGINT,MPI_SUM,world);
+
   // final imbalance factor
 
-  if (bstyle == BISECTION && rcbwt == TIME)
+  if ((bstyle == BISECTION || bstyle == SFCURVE) && rcbwt == TIME)
     imbfinal = 0.0; // can't compute imbalance from timers since grid cells moved
   else
     imbfinal = imbalance_factor(maxperproc);
@@ -295,7 +366,7 @@ double FixBalance::imbalance_factor(double &maxcost)
   double mycost,totalcost;
   double mycost_proc_weighted,maxcost_proc_weighted,nprocs_weighted;
 
-  if (bstyle == BISECTION && rcbwt == TIME) {
+  if ((bstyle == BISECTION || bstyle == SFCURVE) && rcbwt == TIME) {
     timer_cost();
     mycost = my_timer_cost;
   } else mycost = particle->nlocal;
@@ -324,7 +395,10 @@ double FixBalance::compute_scalar()
 double FixBalance::compute_vector(int i)
 {
   if (i == 0) return maxperproc;
-  return imbprev;
+  if (i == 1) return imbprev;
+  if (i == 2) return (double) nmigrate_last;
+  if (i == 3) return (double) nghost_last;
+  return (double) npmigrate_last;
 }
 
 /* -------------------------------------------------------------------- */
@@ -39,7 +39,8 @@ class FixBalance : public Fix {
  private:
   int me,nprocs;
   double thresh;
-  int bstyle,rcbwt,rcbflip;
+  int bstyle,rcbwt,rcbflip,curve;
+  int incremental;              // 1 to adjust previous RCB cuts
   char eligible[4];
   double last,my_timer_cost;
 
@@ -47,9 +48,13 @@ class FixBalance : public Fix {
   double imbprev;               // imbalance factor before last rebalancing
   double imbfinal;              // imbalance factor after last rebalancing
   double maxperproc;            // max atoms or CPU cost on any processor
+  bigint nmigrate_last;         // # of cells migrated by last rebalancing
+  bigint nghost_last;           // # of ghost cells after last rebalancing
+  bigint npmigrate_last;        // # of particles migrated by last rebalancing
 
   class RanPark *random;
   class RCB *rcb;
+  class SFC *sfc;
 
   double imbalance_factor(double &);
   void timer_cost();
@@ -73,6 +78,6 @@ E: Cannot use non-rcb fix balance with a grid cutoff
 
 This is because the load-balancing will generate a partitioning
 of cells to processors that is dispersed and which will not work
-with a grid cutoff >= 0.0.
+with a grid cutoff >= 0.0.  The rcb and sfc styles can be used.
 
 */
@@ -17,6 +17,8 @@
 #include "fix_emit.h"
 #include "update.h"
 #include "domain.h"
+#include "particle.h"
+#include "modify.h"
 #include "region.h"
 #include "grid.h"
 #include "comm.h"
@@ -33,6 +35,7 @@ enum{UNKNOWN,OUTSIDE,INSIDE,OVERLAP};           // same as Grid
 
 #define DELTAGRID 1024
 #define DELTACELL 1024
+#define DELTABATCH 1024
 
 /* ---------------------------------------------------------------------- */
 
@@ -54,6 +57,13 @@ FixEmit::FixEmit(SPARTA *sparta, int narg, char **arg) :
   // counters common to all emit styles for output from fix
 
   nsingle = ntotal = 0;
+
+  // batch insertion vectors
+
+  maxbatch = 0;
+  bisp = bpend = NULL;
+  bx = bv = NULL;
+  bscosine = bbeta = bprob = bva = bvb = NULL;
 }
 
 /* ---------------------------------------------------------------------- */
@@ -63,6 +73,16 @@ FixEmit::~FixEmit()
   if (copymode) return;
 
   delete random;
+
+  memory->destroy(bisp);
+  memory->destroy(bpend);
+  memory->destroy(bx);
+  memory->destroy(bv);
+  memory->destroy(bscosine);
+  memory->destroy(bbeta);
+  memory->destroy(bprob);
+  memory->destroy(bva);
+  memory->destroy(bvb);
 }
 
 /* ---------------------------------------------------------------------- */
@@ -256,3 +276,167 @@ double FixEmit::compute_vector(int i)
   MPI_Allreduce(&one,&all,1,MPI_DOUBLE,MPI_SUM,world);
   return all;
 }
+
+/* ----------------------------------------------------------------------
+   insure batch vectors can hold N particles
+------------------------------------------------------------------------- */
+
+void FixEmit::grow_batch(int n)
+{
+  if (n <= maxbatch) return;
+  while (maxbatch < n) maxbatch += DELTABATCH;
+
+  memory->destroy(bisp);
+  memory->destroy(bpend);
+  memory->destroy(bx);
+  memory->destroy(bv);
+  memory->destroy(bscosine);
+  memory->destroy(bbeta);
+  memory->destroy(bprob);
+  memory->destroy(bva);
+  memory->destroy(bvb);
+
+  memory->create(bisp,maxbatch,"emit:bisp");
+  memory->create(bpend,maxbatch,"emit:bpend");
+  memory->create(bx,maxbatch,3,"emit:bx");
+  memory->create(bv,maxbatch,3,"emit:bv");
+  memory->create(bscosine,maxbatch,"emit:bscosine");
+  memory->create(bbeta,maxbatch,"emit:bbeta");
+  memory->create(bprob,maxbatch,"emit:bprob");
+  memory->create(bva,maxbatch,"emit:bva");
+  memory->create(bvb,maxbatch,"emit:bvb");
+}
+
+/* ----------------------------------------------------------------------
+   remove batch particles whose coords are outside region
+   compress bx and bisp in place
+   return # of remaining particles
+------------------------------------------------------------------------- */
+
+int FixEmit::batch_region(int n)
+{
+  if (!region) return n;
+
+  int m = 0;
+  for (int i = 0; i < n; i++) {
+    if (!region->match(bx[i])) continue;
+    if (m < i) {
+      bx[m][0] = bx[i][0];
+      bx[m][1] = bx[i][1];
+      bx[m][2] = bx[i][2];
+      bisp[m] = bisp[i];
+    }
+    m++;
+  }
+  return m;
+}
+
+/* ----------------------------------------------------------------------
+   set bbeta for N batch particles from their bscosine
+   sample normal thermal speed ratio into simulation box,
+     for Maxwellian shifted by stream velocity component
+     see Bird 1994, p 425 and p 259, eq 12.5
+   rejection sampling is done for all pending particles at once,
+     candidates are drawn, acceptance evaluated in a vectorizable loop,
+     rejected particles remain pending for the next round
+------------------------------------------------------------------------- */
+
+void FixEmit::batch_inflow(int n)
+{
+  int i,k,npend,nkeep;
+  double beta_un,scosine,root;
+
+  for (k = 0; k < n; k++) bpend[k] = k;
+  npend = n;
+
+  while (npend) {
+    for (k = 0; k < npend; k++) {
+      scosine = bscosine[bpend[k]];
+      do beta_un = (6.0*random->uniform() - 3.0);
+      while (beta_un + scosine < 0.0);
+      bbeta[bpend[k]] = beta_un;
+    }
+
+    for (k = 0; k < npend; k++) {
+      i = bpend[k];
+      scosine = bscosine[i];
+      beta_un = bbeta[i];
+      root = sqrt(scosine*scosine + 2.0);
+      bprob[k] = 2.0 * (beta_un + scosine) / (scosine + root) *
+        exp(0.5 + (0.5*scosine)*(scosine-root) - beta_un*beta_un);
+    }
+
+    nkeep = 0;
+    for (k = 0; k < npend; k++)
+      if (bprob[k] < random->uniform()) bpend[nkeep++] = bpend[k];
+    npend = nkeep;
+  }
+}
+
+/* ----------------------------------------------------------------------
+   set bva,bvb for N batch particles
+   thermal velocity components in 2 directions tangential to insertion face
+   vscale = thermal speed for each mixture species
+------------------------------------------------------------------------- */
+
+void FixEmit::batch_thermal(int n, double *vscale)
+{
+  int k;
+
+  for (k = 0; k < n; k++) {
+    bva[k] = random->uniform();
+    bvb[k] = random->uniform();
+  }
+
+  for (k = 0; k < n; k++) {
+    double theta = MY_2PI * bva[k];
+    double vr = vscale[bisp[k]] * sqrt(-log(bvb[k]));
+    bva[k] = vr * sin(theta);
+    bvb[k] = vr * cos(theta);
+  }
+}
+
+/* ----------------------------------------------------------------------
+   append N batch particles with coords bx and velocities bv to particle list
+   species = mixture species list, pflag = particle flag for new particles
+   particle list is grown once for entire batch
+   temps and vstream are passed to fixes that set custom particle values
+------------------------------------------------------------------------- */
+
+void FixEmit::batch_add(int n, int *species, int pcell, int pflag,
+                        double temp_thermal, double temp_rot, double temp_vib,
+                        double *vstream)
+{
+  if (n == 0) return;
+
+  particle->grow(n);
+
+  Particle::OnePart *particles = particle->particles;
+  int nlocal = particle->nlocal;
+  double dt = update->dt;
+
+  for (int k = 0; k < n; k++) {
+    Particle::OnePart *p = &particles[nlocal+k];
+    int ispecies = species[bisp[k]];
+    p->erot = particle->erot(ispecies,temp_rot,random);
+    p->evib = particle->evib(ispecies,temp_vib,random);
+    p->id = MAXSMALLINT*random->uniform();
+    p->ispecies = ispecies;
+    p->icell = pcell;
+    p->x[0] = bx[k][0];
+    p->x[1] = bx[k][1];
+    p->x[2] = bx[k][2];
+    p->v[0] = bv[k][0];
+    p->v[1] = bv[k][1];
+    p->v[2] = bv[k][2];
+    p->flag = pflag;
+    p->dtremain = dt * random->uniform();
+    p->dt_weight = 1;
+  }
+
+  particle->nlocal += n;
+
+  if (modify->n_add_particle)
+    for (int k = 0; k < n; k++)
+      modify->add_particle(nlocal+k,temp_thermal,temp_rot,temp_vib,vstream);
+}
@@ -41,9 +41,26 @@ class FixEmit : public Fix {
   int active_current;  // set to 0 if grid cell data struct changes
                        // triggers rebuild of active cell list in child classes
 
+  // scratch vectors for inserting a batch of particles in one task
+
+  int maxbatch;        // allocated length of batch vectors
+  int *bisp;           // mixture species index of each particle
+  int *bpend;          // particles still pending in inflow rejection
+  double **bx,**bv;    // coords and velocity of each particle
+  double *bscosine;    // stream speed ratio normal to insertion face
+  double *bbeta;       // thermal speed ratio normal to insertion face
+  double *bprob;       // acceptance probability for bbeta
+  double *bva,*bvb;    // thermal velocity in 2 tangential directions
+
   virtual void create_task(int) = 0;
   virtual void perform_task() = 0;
 
+  void grow_batch(int);
+  int batch_region(int);
+  void batch_inflow(int);
+  void batch_thermal(int, double *);
+  void batch_add(int, int *, int, int, double, double, double, double *);
+
   void create_tasks();
   double mol_inflow(double, double, double);
   int subsonic_temperature_check(int, double);
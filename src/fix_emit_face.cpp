@@ -26,7 +26,9 @@
 #include "modify.h"
 #include "geometry.h"
 #include "input.h"
+#include "random_mars.h"
 #include "random_park.h"
+#include "random_counter.h"
 #include "math_const.h"
 #include "memory.h"
 #include "error.h"
@@ -43,6 +45,7 @@ enum{NOSUBSONIC,PTBOTH,PONLY};
 
 #define DELTATASK 256
 #define TEMPLIMIT 1.0e5
+#define CHUNK_THREAD 16
 
 /* ---------------------------------------------------------------------- */
 
@@ -83,6 +86,8 @@ FixEmitFace::FixEmitFace(SPARTA *sparta, int narg, char **arg) :
   subsonic_style = NOSUBSONIC;
   subsonic_warning = 0;
   twopass = 0;
+  counterflag = 0;
+  crandom = NULL;
 
   options(narg-iarg,&arg[iarg]);
 
@@ -98,6 +103,17 @@ FixEmitFace::FixEmitFace(SPARTA *sparta, int narg, char **arg) :
     error->all(FLERR,"Cannot use fix emit/face n > 0 with perspecies yes");
   if (np > 0 && subsonic)
     error->all(FLERR,"Cannot use fix emit/face n > 0 with subsonic");
+  if (np > 0 && counterflag)
+    error->all(FLERR,"Cannot use fix emit/face n > 0 with rng counter");
+  if (twopass && counterflag)
+    error->all(FLERR,"Cannot use fix emit/face twopass with rng counter");
+  if (counterflag && sparta->kokkos)
+    error->all(FLERR,"Fix emit/face rng counter is not yet supported "
+               "with Kokkos");
+
+  // counter RNG seed is the same on all procs
+
+  if (counterflag) crandom = new RanCounter(update->ranmaster->uniform());
 
   // task list and subsonic data structs
 
@@ -122,6 +138,7 @@ FixEmitFace::~FixEmitFace()
     memory->sfree(tasks);
   }
   memory->destroy(activecell);
+  delete crandom;
 }
 
 /* ---------------------------------------------------------------------- */
@@ -438,28 +455,24 @@ void FixEmitFace::create_task(int icell)
 
 void FixEmitFace::perform_task()
 {
-  if (!twopass) perform_task_onepass();
+  if (counterflag) perform_task_counter();
+  else if (!twopass) perform_task_onepass();
   else perform_task_twopass();
 }
 
 /* ----------------------------------------------------------------------
    perform insertion in one pass thru tasks
    this is simpler, somewhat faster code
+   particles are generated and appended in batches, one per task
    but uses random #s differently than Kokkos, so insertions are different
 ------------------------------------------------------------------------- */
 
 void FixEmitFace::perform_task_onepass()
 {
-  int pcell,ninsert,nactual,isp,ispecies,ndim,pdim,qdim,id;
-  double indot,scosine,rn,ntarget,vr;
-  double beta_un,normalized_distbn_fn,theta,erot,evib;
-  double temp_thermal,temp_rot,temp_vib;
-  double x[3],v[3];
-  double *lo,*hi,*normal,*vstream,*vscale;
-  Particle::OnePart *p;
+  int ninsert,isp;
+  double rn,ntarget;
 
   dt = update->dt;
-  int *species = particle->mixture[imix]->species;
 
   // if subsonic, re-compute particle inflow counts for each task
   // also computes current per-task temp_thermal and vstream
@@ -468,90 +481,17 @@ void FixEmitFace::perform_task_onepass()
 
   // insert particles for each task = cell/face pair
   // ntarget/ninsert is either perspecies or for all species
-  // for one particle:
-  //   x = random position on face
-  //   v = randomized thermal velocity + vstream
-  //       first stage: normal dimension (ndim)
-  //       second stage: parallel dimensions (pdim,qdim)
-
-  // double while loop until randomized particle velocity meets 2 criteria
-  // inner do-while loop:
-  //   v = vstream-component + vthermal is into simulation box
-  //   see Bird 1994, p 425
-  // outer do-while loop:
-  //   shift Maxwellian distribution by stream velocity component
-  //   see Bird 1994, p 259, eq 12.5
-
-  int nfix_add_particle = modify->n_add_particle;
+  // particles of one task (and species if perspecies) are a batch,
+  //   see insert_batch()
 
   for (int i = 0; i < ntask; i++) {
-    pcell = tasks[i].pcell;
-    ndim = tasks[i].ndim;
-    pdim = tasks[i].pdim;
-    qdim = tasks[i].qdim;
-    lo = tasks[i].lo;
-    hi = tasks[i].hi;
-    normal = tasks[i].normal;
-
-    temp_thermal = tasks[i].temp_thermal;
-    temp_rot = tasks[i].temp_rot;
-    temp_vib = tasks[i].temp_vib;
-    vstream = tasks[i].vstream;
-
-    if (subsonic_style == PONLY) vscale = tasks[i].vscale;
-    else vscale = particle->mixture[imix]->vscale;
-
-    indot = vstream[0]*normal[0] + vstream[1]*normal[1] + vstream[2]*normal[2];
-
     if (perspecies) {
       for (isp = 0; isp < nspecies; isp++) {
-        ispecies = species[isp];
 	ntarget = tasks[i].ntargetsp[isp]+random->uniform();
 	ninsert = static_cast<int> (ntarget);
-        scosine = indot / vscale[isp];
-
-        nactual = 0;
-	for (int m = 0; m < ninsert; m++) {
-	  x[0] = lo[0] + random->uniform() * (hi[0]-lo[0]);
-	  x[1] = lo[1] + random->uniform() * (hi[1]-lo[1]);
-	  if (dimension == 3) x[2] = lo[2] + random->uniform() * (hi[2]-lo[2]);
-          else x[2] = 0.0;
-
-          if (region && !region->match(x)) continue;
-
-	  do {
-	    do beta_un = (6.0*random->uniform() - 3.0);
-	    while (beta_un + scosine < 0.0);
-	    normalized_distbn_fn = 2.0 * (beta_un + scosine) /
-	      (scosine + sqrt(scosine*scosine + 2.0)) *
-	      exp(0.5 + (0.5*scosine)*(scosine-sqrt(scosine*scosine + 2.0)) -
-		  beta_un*beta_un);
-	  } while (normalized_distbn_fn < random->uniform());
-	
-          v[ndim] = beta_un*vscale[isp]*normal[ndim] + vstream[ndim];
-
-          theta = MY_2PI * random->uniform();
-          vr = vscale[isp] * sqrt(-log(random->uniform()));
-          v[pdim] = vr * sin(theta) + vstream[pdim];
-          v[qdim] = vr * cos(theta) + vstream[qdim];
-          erot = particle->erot(ispecies,temp_rot,random);
-          evib = particle->evib(ispecies,temp_vib,random);
-          id = MAXSMALLINT*random->uniform();
-
-	  particle->add_particle(id,ispecies,pcell,x,v,erot,evib);
-          nactual++;
-
-          p = &particle->particles[particle->nlocal-1];
-          p->flag = PINSERT;
-          p->dtremain = dt * random->uniform();
-          p->dt_weight = 1;
-
-          if (nfix_add_particle)
-            modify->add_particle(particle->nlocal-1,temp_thermal,
-                                 temp_rot,temp_vib,vstream);
-	}
-
-	nsingle += nactual;
+        grow_batch(ninsert);
+        for (int m = 0; m < ninsert; m++) bisp[m] = isp;
+        nsingle += insert_batch(i,ninsert);
       }
 
     } else {
@@ -563,57 +503,71 @@ void FixEmitFace::perform_task_onepass()
 	if (i >= nthresh) ninsert++;
       }
 
-      nactual = 0;
+      grow_batch(ninsert);
       for (int m = 0; m < ninsert; m++) {
 	rn = random->uniform();
 	isp = 0;
 	while (cummulative[isp] < rn) isp++;
-        ispecies = species[isp];
-        scosine = indot / vscale[isp];
-
-	x[0] = lo[0] + random->uniform() * (hi[0]-lo[0]);
-	x[1] = lo[1] + random->uniform() * (hi[1]-lo[1]);
-        if (dimension == 3) x[2] = lo[2] + random->uniform() * (hi[2]-lo[2]);
-        else x[2] = 0.0;
+        bisp[m] = isp;
+      }
+      nsingle += insert_batch(i,ninsert);
+    }
+  }
+}
 
-        if (region && !region->match(x)) continue;
+/* ----------------------------------------------------------------------
+   insert N particles for task I with mixture species already set in bisp
+   for each particle:
+     x = random position on face
+     v = randomized thermal velocity + vstream
+         first stage: normal dimension (ndim)
+         second stage: parallel dimensions (pdim,qdim)
+   each stage is done for all N particles at once
+   return # of particles inserted, can be < N if region is used
+------------------------------------------------------------------------- */
 
-	do {
-	  do {
-	    beta_un = (6.0*random->uniform() - 3.0);
-	  } while (beta_un + scosine < 0.0);
-	  normalized_distbn_fn = 2.0 * (beta_un + scosine) /
-	    (scosine + sqrt(scosine*scosine + 2.0)) *
-	    exp(0.5 + (0.5*scosine)*(scosine-sqrt(scosine*scosine + 2.0)) -
-		beta_un*beta_un);
-	} while (normalized_distbn_fn < random->uniform());
-	
-        v[ndim] = beta_un*vscale[isp]*normal[ndim] + vstream[ndim];
+int FixEmitFace::insert_batch(int i, int n)
+{
+  int m;
+
+  int ndim = tasks[i].ndim;
+  int pdim = tasks[i].pdim;
+  int qdim = tasks[i].qdim;
+  double *lo = tasks[i].lo;
+  double *hi = tasks[i].hi;
+  double *normal = tasks[i].normal;
+  double *vstream = tasks[i].vstream;
+
+  double *vscale;
+  if (subsonic_style == PONLY) vscale = tasks[i].vscale;
+  else vscale = particle->mixture[imix]->vscale;
+
+  double indot = vstream[0]*normal[0] + vstream[1]*normal[1] +
+    vstream[2]*normal[2];
+
+  for (m = 0; m < n; m++) {
+    bx[m][0] = lo[0] + random->uniform() * (hi[0]-lo[0]);
+    bx[m][1] = lo[1] + random->uniform() * (hi[1]-lo[1]);
+    if (dimension == 3) bx[m][2] = lo[2] + random->uniform() * (hi[2]-lo[2]);
+    else bx[m][2] = 0.0;
+  }
 
-        theta = MY_2PI * random->uniform();
-        vr = vscale[isp] * sqrt(-log(random->uniform()));
-        v[pdim] = vr * sin(theta) + vstream[pdim];
-        v[qdim] = vr * cos(theta) + vstream[qdim];
-        erot = particle->erot(ispecies,temp_rot,random);
-        evib = particle->evib(ispecies,temp_vib,random);
-        id = MAXSMALLINT*random->uniform();
+  n = batch_region(n);
 
-	particle->add_particle(id,ispecies,pcell,x,v,erot,evib);
-        nactual++;
+  for (m = 0; m < n; m++) bscosine[m] = indot / vscale[bisp[m]];
+  batch_inflow(n);
+  batch_thermal(n,vscale);
 
-        p = &particle->particles[particle->nlocal-1];
-        p->flag = PINSERT;
-        p->dtremain = dt * random->uniform();
-        p->dt_weight = 1;
+  for (m = 0; m < n; m++) {
+    bv[m][ndim] = bbeta[m]*vscale[bisp[m]]*normal[ndim] + vstream[ndim];
+    bv[m][pdim] = bva[m] + vstream[pdim];
+    bv[m][qdim] = bvb[m] + vstream[qdim];
+  }
 
-        if (nfix_add_particle)
-          modify->add_particle(particle->nlocal-1,temp_thermal,
-                               temp_rot,temp_vib,vstream);
-      }
+  batch_add(n,particle->mixture[imix]->species,tasks[i].pcell,PINSERT,
+            tasks[i].temp_thermal,tasks[i].temp_rot,tasks[i].temp_vib,vstream);
 
-      nsingle += nactual;
-    }
-  }
+  return n;
 }
 
 /* ----------------------------------------------------------------------
@@ -807,6 +761,201 @@ void FixEmitFace::perform_task_twopass()
   memory->destroy(ninsert_values);
 }
 
+/* ----------------------------------------------------------------------
+   perform insertion with a counter-based RNG
+   random #s for each task are keyed by timestep, face, species, cell ID
+     and particle index, so insertions do not depend on number of procs
+     or on the order of tasks
+   first pass sets per-task counts so particle list is grown once,
+     second pass fills each task independently of the others
+------------------------------------------------------------------------- */
+
+void FixEmitFace::perform_task_counter()
+{
+  int isp;
+  double ntarget;
+
+  dt = update->dt;
+  int *species = particle->mixture[imix]->species;
+  Grid::ChildCell *cells = grid->cells;
+
+  if (subsonic) subsonic_inflow();
+
+  // stream for one task and species = timestep, face, species (0 = mixture)
+  // index 0 of each stream is reserved for the insertion count
+
+  int nsub = nspecies+1;
+  uint64_t stream0 = (uint64_t) update->ntimestep * 6*nsub;
+
+  int nfix_add_particle = modify->n_add_particle;
+
+  int ninsert_dim1 = perspecies ? nspecies : 1;
+  int **ninsert_values,**offset_values;
+  memory->create(ninsert_values,ntask,ninsert_dim1,"fix_emit_face:ninsert");
+  memory->create(offset_values,ntask,ninsert_dim1,"fix_emit_face:offset");
+
+  bigint ntotal = 0;
+  for (int i = 0; i < ntask; i++) {
+    uint64_t stream = stream0 + tasks[i].iface*nsub;
+    if (perspecies) {
+      for (isp = 0; isp < nspecies; isp++) {
+        crandom->reset(stream+isp+1,cells[tasks[i].icell].id,0);
+        ntarget = tasks[i].ntargetsp[isp]+crandom->uniform();
+        ninsert_values[i][isp] = static_cast<int> (ntarget);
+        ntotal += ninsert_values[i][isp];
+      }
+    } else {
+      crandom->reset(stream,cells[tasks[i].icell].id,0);
+      ntarget = tasks[i].ntarget+crandom->uniform();
+      ninsert_values[i][0] = static_cast<int> (ntarget);
+      ntotal += ninsert_values[i][0];
+    }
+  }
+
+  if (particle->nlocal + ntotal > MAXSMALLINT)
+    error->one(FLERR,"Per-processor particle count is too big");
+  particle->grow(static_cast<int> (ntotal));
+
+  // offset = first slot of each task's particles, after existing particles
+
+  int nstart = particle->nlocal;
+  int n = nstart;
+  for (int i = 0; i < ntask; i++)
+    for (int j = 0; j < ninsert_dim1; j++) {
+      offset_values[i][j] = n;
+      n += ninsert_values[i][j];
+    }
+
+  // same sampling as perform_task_twopass(), one stream per particle
+  // each task fills its own slots, so tasks can be done in any order
+  // particles rejected by region are flagged with ispecies = -1
+  //   and squeezed out below
+
+  Particle::OnePart *particles = particle->particles;
+
+#if defined(_OPENMP)
+#pragma omp parallel private(isp)
+#endif
+  {
+    RanCounter rng(*crandom);
+
+    int pcell,ninsert,ispecies,ndim,pdim,qdim;
+    double indot,scosine,rn,vr;
+    double beta_un,normalized_distbn_fn,theta;
+    double x[3],v[3];
+    double *lo,*hi,*normal,*vstream,*vscale;
+    Particle::OnePart *p;
+
+#if defined(_OPENMP)
+#pragma omp for schedule(dynamic,CHUNK_THREAD)
+#endif
+    for (int i = 0; i < ntask; i++) {
+      pcell = tasks[i].pcell;
+      ndim = tasks[i].ndim;
+      pdim = tasks[i].pdim;
+      qdim = tasks[i].qdim;
+      lo = tasks[i].lo;
+      hi = tasks[i].hi;
+      normal = tasks[i].normal;
+      cellint cellID = cells[tasks[i].icell].id;
+      uint64_t stream = stream0 + tasks[i].iface*nsub;
+
+      vstream = tasks[i].vstream;
+
+      if (subsonic_style == PONLY) vscale = tasks[i].vscale;
+      else vscale = particle->mixture[imix]->vscale;
+
+      indot = vstream[0]*normal[0] + vstream[1]*normal[1] +
+        vstream[2]*normal[2];
+
+      for (int j = 0; j < ninsert_dim1; j++) {
+        ninsert = ninsert_values[i][j];
+
+        for (int m = 0; m < ninsert; m++) {
+          p = &particles[offset_values[i][j]+m];
+          p->ispecies = -1;
+
+          if (perspecies) {
+            rng.reset(stream+j+1,cellID,m+1);
+            isp = j;
+          } else {
+            rng.reset(stream,cellID,m+1);
+            rn = rng.uniform();
+            isp = 0;
+            while (cummulative[isp] < rn) isp++;
+          }
+          ispecies = species[isp];
+          scosine = indot / vscale[isp];
+
+          x[0] = lo[0] + rng.uniform() * (hi[0]-lo[0]);
+          x[1] = lo[1] + rng.uniform() * (hi[1]-lo[1]);
+          if (dimension == 3) x[2] = lo[2] + rng.uniform() * (hi[2]-lo[2]);
+          else x[2] = 0.0;
+
+          if (region && !region->match(x)) continue;
+
+          do {
+            do beta_un = (6.0*rng.uniform() - 3.0);
+            while (beta_un + scosine < 0.0);
+            normalized_distbn_fn = 2.0 * (beta_un + scosine) /
+              (scosine + sqrt(scosine*scosine + 2.0)) *
+              exp(0.5 + (0.5*scosine)*(scosine-sqrt(scosine*scosine + 2.0)) -
+                  beta_un*beta_un);
+          } while (normalized_distbn_fn < rng.uniform());
+
+          v[ndim] = beta_un*vscale[isp]*normal[ndim] + vstream[ndim];
+
+          theta = MY_2PI * rng.uniform();
+          vr = vscale[isp] * sqrt(-log(rng.uniform()));
+          v[pdim] = vr * sin(theta) + vstream[pdim];
+          v[qdim] = vr * cos(theta) + vstream[qdim];
+          p->erot = particle->erot(ispecies,tasks[i].temp_rot,&rng);
+          p->evib = particle->evib(ispecies,tasks[i].temp_vib,&rng);
+          p->id = MAXSMALLINT*rng.uniform();
+
+          p->ispecies = ispecies;
+          p->icell = pcell;
+          p->x[0] = x[0];
+          p->x[1] = x[1];
+          p->x[2] = x[2];
+          p->v[0] = v[0];
+          p->v[1] = v[1];
+          p->v[2] = v[2];
+          p->flag = PINSERT;
+          p->dtremain = dt * rng.uniform();
+          p->dt_weight = 1;
+        }
+      }
+    }
+  }
+
+  // compress out rejected particles in task order
+  // zero vacated slots, since add_particle() relies on grow() zeroing them
+  // fixes with add_particle() method are invoked in the same order
+  //   as for a serial run, since they may use their own RNG
+
+  int k = nstart;
+  n = nstart;
+  for (int i = 0; i < ntask; i++)
+    for (int j = 0; j < ninsert_dim1; j++)
+      for (int m = 0; m < ninsert_values[i][j]; m++, k++) {
+        if (particles[k].ispecies < 0) continue;
+        if (k != n)
+          memcpy(&particles[n],&particles[k],sizeof(Particle::OnePart));
+        if (nfix_add_particle)
+          modify->add_particle(n,tasks[i].temp_thermal,tasks[i].temp_rot,
+                               tasks[i].temp_vib,tasks[i].vstream);
+        n++;
+      }
+
+  if (n < k) memset(&particles[n],0,(k-n)*sizeof(Particle::OnePart));
+  particle->nlocal = n;
+  nsingle += n - nstart;
+
+  memory->destroy(ninsert_values);
+  memory->destroy(offset_values);
+}
+
 /* ----------------------------------------------------------------------
    inserting into split cell icell on face iface
    determine which sub cell the face is part of
@@ -1150,6 +1299,14 @@ int FixEmitFace::option(int narg, char **arg)
     return 1;
   }
 
+  if (strcmp(arg[0],"rng") == 0) {
+    if (2 > narg) error->all(FLERR,"Illegal fix emit/face command");
+    if (strcmp(arg[1],"park") == 0) counterflag = 0;
+    else if (strcmp(arg[1],"counter") == 0) counterflag = 1;
+    else error->all(FLERR,"Illegal fix emit/face command");
+    return 2;
+  }
+
   error->all(FLERR,"Illegal fix emit/face command");
   return 0;
 }
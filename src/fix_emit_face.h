@@ -62,7 +62,8 @@ class FixEmitFace : public FixEmit {
  protected:
   int imix,np,subsonic,subsonic_style,subsonic_warning;
   int faces[6];
-  int npertask,nthresh,twopass;
+  int npertask,nthresh,twopass,counterflag;
+  class RanCounter *crandom;   // counter-based RNG for rng counter option
   double psubsonic,tsubsonic,nsubsonic;
   double tprefactor,soundspeed_mixture;
 
@@ -86,7 +87,9 @@ class FixEmitFace : public FixEmit {
   virtual void create_task(int);
   virtual void perform_task();
   void perform_task_onepass();
+  int insert_batch(int, int);
   virtual void perform_task_twopass();
+  void perform_task_counter();
   virtual void grow_task();
 
   int split(int, int);
@@ -106,6 +109,19 @@ class FixEmitFace : public FixEmit {
 
 /* ERROR/WARNING messages:
 
+E: Cannot use fix emit/face n > 0 with rng counter
+
+The counter RNG sets each task's insertion count independently,
+so a fixed total count per timestep cannot be honored.
+
+E: Cannot use fix emit/face twopass with rng counter
+
+Only one of these insertion algorithms can be used.
+
+E: Fix emit/face rng counter is not yet supported with Kokkos
+
+Use the default rng park option when running with Kokkos.
+
 E: Illegal ... command
 
 Self-explanatory.  Check the input script syntax and compare to the
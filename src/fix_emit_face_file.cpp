@@ -345,16 +345,9 @@ void FixEmitFaceFile::create_task(int icell)
 
 void FixEmitFaceFile::perform_task()
 {
-  int pcell,ninsert,nactual,isp,ispecies,id;
-  double temp_thermal,temp_rot,temp_vib;
-  double indot,scosine,rn,ntarget,vr;
-  double beta_un,normalized_distbn_fn,theta,erot,evib;
-  double x[3],v[3];
-  double *lo,*hi,*vstream,*cummulative,*vscale;
-  Particle::OnePart *p;
-
-  double dt = update->dt;
-  int *species = particle->mixture[imix]->species;
+  int ninsert,isp;
+  double rn,ntarget;
+  double *cummulative;
 
   // if subsonic, re-compute particle inflow counts for each task
   // also computes current temp_thermal and vstream in insertion cells
@@ -363,84 +356,17 @@ void FixEmitFaceFile::perform_task()
 
   // insert particles for each task = cell
   // ntarget/ninsert is either perspecies or for all species
-  // for one particle:
-  //   x = random position on subset of face that overlaps with file grid
-  //   v = randomized thermal velocity + vstream
-  //       first stage: normal dimension (ndim)
-  //       second stage: parallel dimensions (pdim1,pdim2)
-
-  // double while loop until randomized particle velocity meets 2 criteria
-  // inner do-while loop:
-  //   v = vstream-component + vthermal is into simulation box
-  //   see Bird 1994, p 425
-  // outer do-while loop:
-  //   shift Maxwellian distribution by stream velocity component
-  //   see Bird 1994, p 259, eq 12.5
-
-  int nfix_add_particle = modify->n_add_particle;
+  // particles of one task (and species if perspecies) are a batch,
+  //   see insert_batch()
 
   for (int i = 0; i < ntask; i++) {
-    pcell = tasks[i].pcell;
-    lo = tasks[i].lo;
-    hi = tasks[i].hi;
-
-    temp_thermal = tasks[i].temp_thermal;
-    temp_rot = tasks[i].temp_rot;
-    temp_vib = tasks[i].temp_vib;
-    vscale = tasks[i].vscale;
-    vstream = tasks[i].vstream;
-
-    indot = vstream[0]*normal[0] + vstream[1]*normal[1] + vstream[2]*normal[2];
-
     if (perspecies) {
       for (isp = 0; isp < nspecies; isp++) {
-        ispecies = species[isp];
 	ntarget = tasks[i].ntargetsp[isp]+random->uniform();
 	ninsert = static_cast<int> (ntarget);
-        scosine = indot / vscale[isp];
-
-        nactual = 0;
-	for (int m = 0; m < ninsert; m++) {
-	  x[0] = lo[0] + random->uniform() * (hi[0]-lo[0]);
-	  x[1] = lo[1] + random->uniform() * (hi[1]-lo[1]);
-	  if (dimension == 3) x[2] = lo[2] + random->uniform() * (hi[2]-lo[2]);
-          else x[2] = 0.0;
-
-          if (region && !region->match(x)) continue;
-
-	  do {
-	    do beta_un = (6.0*random->uniform() - 3.0);
-	    while (beta_un + scosine < 0.0);
-	    normalized_distbn_fn = 2.0 * (beta_un + scosine) /
-	      (scosine + sqrt(scosine*scosine + 2.0)) *
-	      exp(0.5 + (0.5*scosine)*(scosine-sqrt(scosine*scosine + 2.0)) -
-		  beta_un*beta_un);
-	  } while (normalized_distbn_fn < random->uniform());
-	
-          v[ndim] = beta_un*vscale[isp]*normal[ndim] + vstream[ndim];
-
-          theta = MY_2PI * random->uniform();
-          vr = vscale[isp] * sqrt(-log(random->uniform()));
-          v[pdim] = vr * sin(theta) + vstream[pdim];
-          v[qdim] = vr * cos(theta) + vstream[qdim];
-          erot = particle->erot(ispecies,temp_rot,random);
-          evib = particle->evib(ispecies,temp_vib,random);
-          id = MAXSMALLINT*random->uniform();
-
-	  particle->add_particle(id,ispecies,pcell,x,v,erot,evib);
-          nactual++;
-
-          p = &particle->particles[particle->nlocal-1];
-          p->flag = PINSERT;
-          p->dtremain = dt * random->uniform();
-          p->dt_weight = 1;
-
-          if (nfix_add_particle)
-            modify->add_particle(particle->nlocal-1,temp_thermal,
-                                 temp_rot,temp_vib,vstream);
-	}
-
-	nsingle += nactual;
+        grow_batch(ninsert);
+        for (int m = 0; m < ninsert; m++) bisp[m] = isp;
+        nsingle += insert_batch(i,ninsert);
       }
 
     } else {
@@ -448,58 +374,66 @@ void FixEmitFaceFile::perform_task()
       ntarget = tasks[i].ntarget+random->uniform();
       ninsert = static_cast<int> (ntarget);
 
-      nactual = 0;
+      grow_batch(ninsert);
       for (int m = 0; m < ninsert; m++) {
 	rn = random->uniform();
 	isp = 0;
 	while (cummulative[isp] < rn) isp++;
-        ispecies = species[isp];
-        scosine = indot / vscale[isp];
-
-	x[0] = lo[0] + random->uniform() * (hi[0]-lo[0]);
-	x[1] = lo[1] + random->uniform() * (hi[1]-lo[1]);
-	if (dimension == 3) x[2] = lo[2] + random->uniform() * (hi[2]-lo[2]);
-        else x[2] = 0.0;
-
-        if (region && !region->match(x)) continue;
-
-	do {
-	  do beta_un = (6.0*random->uniform() - 3.0);
-	  while (beta_un + scosine < 0.0);
-	  normalized_distbn_fn = 2.0 * (beta_un + scosine) /
-	    (scosine + sqrt(scosine*scosine + 2.0)) *
-	    exp(0.5 + (0.5*scosine)*(scosine-sqrt(scosine*scosine + 2.0)) -
-		beta_un*beta_un);
-	} while (normalized_distbn_fn < random->uniform());
-	
-        v[ndim] = beta_un*vscale[isp]*normal[ndim] + vstream[ndim];
-
-        theta = MY_PI * random->uniform();
-        vr = vscale[isp] * sqrt(-log(random->uniform()));
-        v[pdim] = vr * sin(theta) + vstream[pdim];
-        v[qdim] = vr * cos(theta) + vstream[qdim];
-        erot = particle->erot(ispecies,temp_rot,random);
-        evib = particle->evib(ispecies,temp_vib,random);
-        id = MAXSMALLINT*random->uniform();
-
-	particle->add_particle(id,ispecies,pcell,x,v,erot,evib);
-        nactual++;
-
-        p = &particle->particles[particle->nlocal-1];
-        p->flag = PINSERT;
-        p->dtremain = dt * random->uniform();
-        p->dt_weight = 1;
-
-        if (nfix_add_particle)
-          modify->add_particle(particle->nlocal-1,temp_thermal,
-                               temp_rot,temp_vib,vstream);
+        bisp[m] = isp;
       }
-
-      nsingle += nactual;
+      nsingle += insert_batch(i,ninsert);
     }
   }
 }
 
+/* ----------------------------------------------------------------------
+   insert N particles for task I with mixture species already set in bisp
+   for each particle:
+     x = random position on subset of face that overlaps with file grid
+     v = randomized thermal velocity + vstream
+         first stage: normal dimension (ndim)
+         second stage: parallel dimensions (pdim,qdim)
+   each stage is done for all N particles at once
+   return # of particles inserted, can be < N if region is used
+------------------------------------------------------------------------- */
+
+int FixEmitFaceFile::insert_batch(int i, int n)
+{
+  int m;
+
+  double *lo = tasks[i].lo;
+  double *hi = tasks[i].hi;
+  double *vscale = tasks[i].vscale;
+  double *vstream = tasks[i].vstream;
+
+  double indot = vstream[0]*normal[0] + vstream[1]*normal[1] +
+    vstream[2]*normal[2];
+
+  for (m = 0; m < n; m++) {
+    bx[m][0] = lo[0] + random->uniform() * (hi[0]-lo[0]);
+    bx[m][1] = lo[1] + random->uniform() * (hi[1]-lo[1]);
+    if (dimension == 3) bx[m][2] = lo[2] + random->uniform() * (hi[2]-lo[2]);
+    else bx[m][2] = 0.0;
+  }
+
+  n = batch_region(n);
+
+  for (m = 0; m < n; m++) bscosine[m] = indot / vscale[bisp[m]];
+  batch_inflow(n);
+  batch_thermal(n,vscale);
+
+  for (m = 0; m < n; m++) {
+    bv[m][ndim] = bbeta[m]*vscale[bisp[m]]*normal[ndim] + vstream[ndim];
+    bv[m][pdim] = bva[m] + vstream[pdim];
+    bv[m][qdim] = bvb[m] + vstream[qdim];
+  }
+
+  batch_add(n,particle->mixture[imix]->species,tasks[i].pcell,PINSERT,
+            tasks[i].temp_thermal,tasks[i].temp_rot,tasks[i].temp_vib,vstream);
+
+  return n;
+}
+
 /* ----------------------------------------------------------------------
    scan file for section-ID, read regular grid of values into Mesh data struct
    only called by proc 0
@@ -127,6 +127,7 @@ class FixEmitFaceFile : public FixEmit {
 
   void create_task(int);
   void perform_task();
+  int insert_batch(int, int);
   void grow_task();
 
   int option(int, char **);
@@ -412,16 +412,8 @@ void FixEmitSurf::create_task(int icell)
 
 void FixEmitSurf::perform_task()
 {
-  int i,m,n,pcell,isurf,ninsert,nactual,isp,ispecies,ntri,id;
-  double indot,scosine,rn,ntarget,vr,alpha,beta;
-  double beta_un,normalized_distbn_fn,theta,erot,evib;
-  double vnmag,vamag,vbmag;
-  double *normal,*p1,*p2,*p3,*atan,*btan,*vstream,*vscale;
-  double x[3],v[3],e1[3],e2[3];
-  Particle::OnePart *p;
-
-  double dt = update->dt;
-  int *species = particle->mixture[imix]->species;
+  int i,ninsert,isp;
+  double rn,ntarget;
 
   // if subsonic, re-compute particle inflow counts for each task
   // also computes current per-task temp_thermal and vstream
@@ -430,129 +422,19 @@ void FixEmitSurf::perform_task()
 
   // insert particles for each task = cell/surf pair
   // ntarget/ninsert is either perspecies or for all species
-  // for one particle:
-  //   x = random position with overlap of surf with cell
-  //   v = randomized thermal velocity + vstream
-  //       if normalflag, mag of vstream is applied to surf normal dir
-  //       first stage: normal dimension (normal)
-  //       second stage: parallel dimensions (tan1,tan2)
-
-  // double while loop until randomized particle velocity meets 2 criteria
-  // inner do-while loop:
-  //   v = vstream-component + vthermal is into simulation box
-  //   see Bird 1994, p 425
-  // outer do-while loop:
-  //   shift Maxwellian distribution by stream velocity component
-  //   see Bird 1994, p 259, eq 12.5
-
-  Surf::Line *lines = surf->lines;
-  Surf::Tri *tris = surf->tris;
-
-  int nfix_add_particle = modify->n_add_particle;
-  indot = magvstream;
+  // particles of one task (and species if perspecies) are a batch,
+  //   see insert_batch()
 
   for (i = 0; i < ntask; i++) {
-    pcell = tasks[i].pcell;
-    isurf = tasks[i].isurf;
-    if (isurf >= surf->nlocal) error->one(FLERR,"BAD surf index\n");
-    if (dimension == 2) normal = lines[isurf].norm;
-    else normal = tris[isurf].norm;
-    atan = tasks[i].tan1;
-    btan = tasks[i].tan2;
-
-    temp_thermal = tasks[i].temp_thermal;
-    temp_rot = tasks[i].temp_rot;
-    temp_vib = tasks[i].temp_vib;
-    vstream = tasks[i].vstream;
-
-    if (subsonic_style == PONLY) vscale = tasks[i].vscale;
-    else vscale = particle->mixture[imix]->vscale;
-    if (!normalflag) indot = vstream[0]*normal[0] + vstream[1]*normal[1] +
-                       vstream[2]*normal[2];
+    if (tasks[i].isurf >= surf->nlocal) error->one(FLERR,"BAD surf index\n");
 
     if (perspecies) {
       for (isp = 0; isp < nspecies; isp++) {
-        ispecies = species[isp];
         ntarget = tasks[i].ntargetsp[isp]+random->uniform();
         ninsert = static_cast<int> (ntarget);
-        scosine = indot / vscale[isp];
-
-        nactual = 0;
-        for (m = 0; m < ninsert; m++) {
-          if (dimension == 2) {
-            rn = random->uniform();
-            p1 = &tasks[i].path[0];
-            p2 = &tasks[i].path[3];
-            x[0] = p1[0] + rn * (p2[0]-p1[0]);
-            x[1] = p1[1] + rn * (p2[1]-p1[1]);
-            x[2] = 0.0;
-          } else {
-            rn = random->uniform();
-            ntri = tasks[i].npoint - 2;
-            for (n = 0; n < ntri; n++)
-              if (rn < tasks[i].fracarea[n]) break;
-            p1 = &tasks[i].path[0];
-            p2 = &tasks[i].path[3*(n+1)];
-            p3 = &tasks[i].path[3*(n+2)];
-            MathExtra::sub3(p2,p1,e1);
-            MathExtra::sub3(p3,p1,e2);
-            alpha = random->uniform();
-            beta = random->uniform();
-            if (alpha+beta > 1.0) {
-              alpha = 1.0 - alpha;
-              beta = 1.0 - beta;
-            }
-            x[0] = p1[0] + alpha*e1[0] + beta*e2[0];
-            x[1] = p1[1] + alpha*e1[1] + beta*e2[1];
-            x[2] = p1[2] + alpha*e1[2] + beta*e2[2];
-          }
-
-          if (region && !region->match(x)) continue;
-
-          do {
-            do beta_un = (6.0*random->uniform() - 3.0);
-            while (beta_un + scosine < 0.0);
-            normalized_distbn_fn = 2.0 * (beta_un + scosine) /
-              (scosine + sqrt(scosine*scosine + 2.0)) *
-              exp(0.5 + (0.5*scosine)*(scosine-sqrt(scosine*scosine + 2.0)) -
-                  beta_un*beta_un);
-          } while (normalized_distbn_fn < random->uniform());
-
-          if (normalflag) vnmag = beta_un*vscale[isp] + magvstream;
-          else vnmag = beta_un*vscale[isp] + indot;
-
-          theta = MY_2PI * random->uniform();
-          vr = vscale[isp] * sqrt(-log(random->uniform()));
-          if (normalflag) {
-            vamag = vr * sin(theta);
-            vbmag = vr * cos(theta);
-          } else {
-            vamag = vr * sin(theta) + MathExtra::dot3(vstream,atan);
-            vbmag = vr * cos(theta) + MathExtra::dot3(vstream,btan);
-          }
-
-          v[0] = vnmag*normal[0] + vamag*atan[0] + vbmag*btan[0];
-          v[1] = vnmag*normal[1] + vamag*atan[1] + vbmag*btan[1];
-          v[2] = vnmag*normal[2] + vamag*atan[2] + vbmag*btan[2];
-
-          erot = particle->erot(ispecies,temp_rot,random);
-          evib = particle->evib(ispecies,temp_vib,random);
-          id = MAXSMALLINT*random->uniform();
-
-          particle->add_particle(id,ispecies,pcell,x,v,erot,evib);
-          nactual++;
-
-          p = &particle->particles[particle->nlocal-1];
-          p->flag = PSURF + 1 + isurf;
-          p->dtremain = dt * random->uniform();
-          p->dt_weight = 1;
-
-          if (nfix_add_particle)
-            modify->add_particle(particle->nlocal-1,temp_thermal,
-                                 temp_rot,temp_vib,vstream);
-        }
-
-        nsingle += nactual;
+        grow_batch(ninsert);
+        for (int m = 0; m < ninsert; m++) bisp[m] = isp;
+        nsingle += insert_batch(i,ninsert);
       }
 
     } else {
@@ -564,91 +446,110 @@ void FixEmitSurf::perform_task()
         if (i >= nthresh) ninsert++;
       }
 
-      nactual = 0;
+      grow_batch(ninsert);
       for (int m = 0; m < ninsert; m++) {
         rn = random->uniform();
         isp = 0;
         while (cummulative[isp] < rn) isp++;
-        ispecies = species[isp];
-        scosine = indot / vscale[isp];
-
-        if (dimension == 2) {
-          rn = random->uniform();
-          p1 = &tasks[i].path[0];
-          p2 = &tasks[i].path[3];
-          x[0] = p1[0] + rn * (p2[0]-p1[0]);
-          x[1] = p1[1] + rn * (p2[1]-p1[1]);
-          x[2] = 0.0;
-        } else {
-          rn = random->uniform();
-          ntri = tasks[i].npoint - 2;
-          for (n = 0; n < ntri; n++)
-            if (rn < tasks[i].fracarea[n]) break;
-          p1 = &tasks[i].path[0];
-          p2 = &tasks[i].path[3*(n+1)];
-          p3 = &tasks[i].path[3*(n+2)];
-          MathExtra::sub3(p2,p1,e1);
-          MathExtra::sub3(p3,p1,e2);
-          alpha = random->uniform();
-          beta = random->uniform();
-          if (alpha+beta > 1.0) {
-            alpha = 1.0 - alpha;
-            beta = 1.0 - beta;
-          }
-          x[0] = p1[0] + alpha*e1[0] + beta*e2[0];
-          x[1] = p1[1] + alpha*e1[1] + beta*e2[1];
-          x[2] = p1[2] + alpha*e1[2] + beta*e2[2];
-        }
-
-        if (region && !region->match(x)) continue;
-
-        do {
-          do {
-            beta_un = (6.0*random->uniform() - 3.0);
-          } while (beta_un + scosine < 0.0);
-          normalized_distbn_fn = 2.0 * (beta_un + scosine) /
-            (scosine + sqrt(scosine*scosine + 2.0)) *
-            exp(0.5 + (0.5*scosine)*(scosine-sqrt(scosine*scosine + 2.0)) -
-                beta_un*beta_un);
-        } while (normalized_distbn_fn < random->uniform());
-
-        if (normalflag) vnmag = beta_un*vscale[isp] + magvstream;
-        else vnmag = beta_un*vscale[isp] + indot;
-
-        theta = MY_2PI * random->uniform();
-        vr = vscale[isp] * sqrt(-log(random->uniform()));
-        if (normalflag) {
-          vamag = vr * sin(theta);
-          vbmag = vr * cos(theta);
-        } else {
-          vamag = vr * sin(theta) + MathExtra::dot3(vstream,atan);
-          vbmag = vr * cos(theta) + MathExtra::dot3(vstream,btan);
-        }
-
-        v[0] = vnmag*normal[0] + vamag*atan[0] + vbmag*btan[0];
-        v[1] = vnmag*normal[1] + vamag*atan[1] + vbmag*btan[1];
-        v[2] = vnmag*normal[2] + vamag*atan[2] + vbmag*btan[2];
-
-        erot = particle->erot(ispecies,temp_rot,random);
-        evib = particle->evib(ispecies,temp_vib,random);
-        id = MAXSMALLINT*random->uniform();
-
-        particle->add_particle(id,ispecies,pcell,x,v,erot,evib);
-        nactual++;
-
-        p = &particle->particles[particle->nlocal-1];
-        p->flag = PSURF + 1 + isurf;
-        p->dtremain = dt * random->uniform();
-        p->dt_weight = 1;
-
-        if (nfix_add_particle)
-          modify->add_particle(particle->nlocal-1,temp_thermal,
-                               temp_rot,temp_vib,vstream);
+        bisp[m] = isp;
       }
+      nsingle += insert_batch(i,ninsert);
+    }
+  }
+}
 
-      nsingle += nactual;
+/* ----------------------------------------------------------------------
+   insert N particles for task I with mixture species already set in bisp
+   for each particle:
+     x = random position with overlap of surf with cell
+     v = randomized thermal velocity + vstream
+         if normalflag, mag of vstream is applied to surf normal dir
+         first stage: normal dimension (normal)
+         second stage: parallel dimensions (tan1,tan2)
+   each stage is done for all N particles at once
+   return # of particles inserted, can be < N if region is used
+------------------------------------------------------------------------- */
+
+int FixEmitSurf::insert_batch(int i, int n)
+{
+  int m,k,ntri;
+  double rn,alpha,beta,vnmag,vamag,vbmag,vsa,vsb;
+  double *normal,*p1,*p2,*p3;
+  double e1[3],e2[3];
+
+  int isurf = tasks[i].isurf;
+  if (dimension == 2) normal = surf->lines[isurf].norm;
+  else normal = surf->tris[isurf].norm;
+  double *atan = tasks[i].tan1;
+  double *btan = tasks[i].tan2;
+  double *vstream = tasks[i].vstream;
+
+  double *vscale;
+  if (subsonic_style == PONLY) vscale = tasks[i].vscale;
+  else vscale = particle->mixture[imix]->vscale;
+
+  double indot;
+  if (normalflag) indot = magvstream;
+  else indot = vstream[0]*normal[0] + vstream[1]*normal[1] +
+         vstream[2]*normal[2];
+
+  if (dimension == 2) {
+    p1 = &tasks[i].path[0];
+    p2 = &tasks[i].path[3];
+    for (m = 0; m < n; m++) {
+      rn = random->uniform();
+      bx[m][0] = p1[0] + rn * (p2[0]-p1[0]);
+      bx[m][1] = p1[1] + rn * (p2[1]-p1[1]);
+      bx[m][2] = 0.0;
+    }
+  } else {
+    ntri = tasks[i].npoint - 2;
+    p1 = &tasks[i].path[0];
+    for (m = 0; m < n; m++) {
+      rn = random->uniform();
+      for (k = 0; k < ntri; k++)
+        if (rn < tasks[i].fracarea[k]) break;
+      p2 = &tasks[i].path[3*(k+1)];
+      p3 = &tasks[i].path[3*(k+2)];
+      MathExtra::sub3(p2,p1,e1);
+      MathExtra::sub3(p3,p1,e2);
+      alpha = random->uniform();
+      beta = random->uniform();
+      if (alpha+beta > 1.0) {
+        alpha = 1.0 - alpha;
+        beta = 1.0 - beta;
+      }
+      bx[m][0] = p1[0] + alpha*e1[0] + beta*e2[0];
+      bx[m][1] = p1[1] + alpha*e1[1] + beta*e2[1];
+      bx[m][2] = p1[2] + alpha*e1[2] + beta*e2[2];
     }
   }
+
+  n = batch_region(n);
+
+  for (m = 0; m < n; m++) bscosine[m] = indot / vscale[bisp[m]];
+  batch_inflow(n);
+  batch_thermal(n,vscale);
+
+  if (normalflag) vsa = vsb = 0.0;
+  else {
+    vsa = MathExtra::dot3(vstream,atan);
+    vsb = MathExtra::dot3(vstream,btan);
+  }
+
+  for (m = 0; m < n; m++) {
+    vnmag = bbeta[m]*vscale[bisp[m]] + indot;
+    vamag = bva[m] + vsa;
+    vbmag = bvb[m] + vsb;
+    bv[m][0] = vnmag*normal[0] + vamag*atan[0] + vbmag*btan[0];
+    bv[m][1] = vnmag*normal[1] + vamag*atan[1] + vbmag*btan[1];
+    bv[m][2] = vnmag*normal[2] + vamag*atan[2] + vbmag*btan[2];
+  }
+
+  batch_add(n,particle->mixture[imix]->species,tasks[i].pcell,PSURF+1+isurf,
+            tasks[i].temp_thermal,tasks[i].temp_rot,tasks[i].temp_vib,vstream);
+
+  return n;
 }
 
 /* ----------------------------------------------------------------------
@@ -92,6 +92,7 @@ class FixEmitSurf : public FixEmit {
 
   void create_task(int);
   void perform_task();
+  int insert_batch(int, int);
   void grow_task();
 
   void subsonic_inflow();
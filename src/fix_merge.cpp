@@ -0,0 +1,790 @@
+/* ----------------------------------------------------------------------
+   SPARTA - Stochastic PArallel Rarefied-gas Time-accurate Analyzer
+   http://sparta.sandia.gov
+   Steve Plimpton, sjplimp@sandia.gov, Michael Gallis, magalli@sandia.gov
+   Sandia National Laboratories
+
+   Copyright (2014) Sandia Corporation.  Under the terms of Contract
+   DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+   certain rights in this software.  This software is distributed under
+   the GNU General Public License.
+
+   See the README file in the top-level SPARTA directory.
+------------------------------------------------------------------------- */
+
+#include "math.h"
+#include "stdlib.h"
+#include "string.h"
+#include "fix_merge.h"
+#include "update.h"
+#include "grid.h"
+#include "particle.h"
+#include "collide.h"
+#include "comm.h"
+#include "modify.h"
+#include "random_mars.h"
+#include "random_park.h"
+#include "memory.h"
+#include "error.h"
+#include "math_const.h"
+
+using namespace SPARTA_NS;
+using namespace MathConst;
+
+enum{NONE,DISCRETE,SMOOTH};            // several files
+enum{ENERGY,STRESS};
+
+#define DELTALIST 256
+#define EPSWEIGHT 1.0e-10
+#define BIG 1.0e20
+#define EPSPIVOT 1.0e-12
+
+// prototype for non-class function
+
+int compare_vsort(const void *, const void *);
+
+/* ---------------------------------------------------------------------- */
+
+FixMerge::FixMerge(SPARTA *sparta, int narg, char **arg) :
+  Fix(sparta, narg, arg)
+{
+  if (narg < 5) error->all(FLERR,"Illegal fix merge command");
+
+  vector_flag = 1;
+  size_vector = 3;
+  global_freq = 1;
+
+  nevery = atoi(arg[2]);
+  nmax = atoi(arg[3]);
+  ntarget = atoi(arg[4]);
+
+  if (nevery <= 0) error->all(FLERR,"Illegal fix merge command");
+  if (ntarget < 2 || nmax < ntarget)
+    error->all(FLERR,"Illegal fix merge command");
+
+  // optional args
+
+  splitflag = 1;
+  momentflag = ENERGY;
+
+  int iarg = 5;
+  while (iarg < narg) {
+    if (strcmp(arg[iarg],"split") == 0) {
+      if (iarg+2 > narg) error->all(FLERR,"Illegal fix merge command");
+      if (strcmp(arg[iarg+1],"yes") == 0) splitflag = 1;
+      else if (strcmp(arg[iarg+1],"no") == 0) splitflag = 0;
+      else error->all(FLERR,"Illegal fix merge command");
+      iarg += 2;
+    } else if (strcmp(arg[iarg],"moments") == 0) {
+      if (iarg+2 > narg) error->all(FLERR,"Illegal fix merge command");
+      if (strcmp(arg[iarg+1],"energy") == 0) momentflag = ENERGY;
+      else if (strcmp(arg[iarg+1],"stress") == 0) momentflag = STRESS;
+      else error->all(FLERR,"Illegal fix merge command");
+      iarg += 2;
+    } else error->all(FLERR,"Illegal fix merge command");
+  }
+
+  // RNG for choice of surviving particles and IDs of cloned particles
+
+  random = new RanPark(update->ranmaster->uniform());
+  double seed = update->ranmaster->uniform();
+  random->reset(seed,comm->me,100);
+
+  maxlist = 0;
+  plist = pwork = NULL;
+  vsort = NULL;
+  maxspecies = 0;
+  spcount = spfirst = spleft = NULL;
+
+  nmerge = nremove = nadd = 0;
+}
+
+/* ---------------------------------------------------------------------- */
+
+FixMerge::~FixMerge()
+{
+  delete random;
+  memory->destroy(plist);
+  memory->destroy(pwork);
+  memory->sfree(vsort);
+  memory->destroy(spcount);
+  memory->destroy(spfirst);
+  memory->destroy(spleft);
+}
+
+/* ---------------------------------------------------------------------- */
+
+int FixMerge::setmask()
+{
+  int mask = 0;
+  mask |= END_OF_STEP;
+  return mask;
+}
+
+/* ---------------------------------------------------------------------- */
+
+void FixMerge::init()
+{
+  // merged cells have a larger weight than their neighbors
+  // requires particles to be cloned/deleted when they change cells
+
+  if (!grid->cellweightflag)
+    error->all(FLERR,"Fix merge requires per-cell weighting");
+  if (sparta->kokkos)
+    error->all(FLERR,"Fix merge is not yet supported with Kokkos");
+
+  // only continuous internal energies can be rescaled
+
+  rotflag = vibflag = 0;
+  if (collide && collide->rotstyle == SMOOTH) rotflag = 1;
+  if (collide && collide->vibstyle == SMOOTH &&
+      particle->find_custom((char *) "vibmode") < 0) vibflag = 1;
+
+  if (particle->nspecies > maxspecies) {
+    maxspecies = particle->nspecies;
+    memory->destroy(spcount);
+    memory->destroy(spfirst);
+    memory->destroy(spleft);
+    memory->create(spcount,maxspecies,"merge:spcount");
+    memory->create(spfirst,maxspecies,"merge:spfirst");
+    memory->create(spleft,maxspecies,"merge:spleft");
+  }
+}
+
+/* ----------------------------------------------------------------------
+   merge at start of run, e.g. after grid or dt_weight adaptation
+------------------------------------------------------------------------- */
+
+void FixMerge::setup()
+{
+  merge();
+}
+
+/* ---------------------------------------------------------------------- */
+
+void FixMerge::end_of_step()
+{
+  merge();
+}
+
+/* ----------------------------------------------------------------------
+   reduce each cell with more than Nmax particles to about Ntarget particles
+   if splitting enabled, restore weight of under-populated merged cells
+   cell weight is scaled so number of real molecules is unchanged
+------------------------------------------------------------------------- */
+
+void FixMerge::merge()
+{
+  if (!particle->sorted) particle->sort();
+
+  Grid::ChildCell *cells = grid->cells;
+  Grid::ChildInfo *cinfo = grid->cinfo;
+  int nglocal = grid->nlocal;
+
+  bigint stats[3];
+  stats[0] = stats[1] = stats[2] = 0;
+
+  int n;
+  for (int icell = 0; icell < nglocal; icell++) {
+    if (cells[icell].nsplit > 1) continue;
+    n = cinfo[icell].count;
+    if (n > nmax) {
+      stats[0]++;
+      stats[1] += merge_cell(icell,n);
+    } else if (splitflag && n > 0 && 2*n <= ntarget)
+      stats[2] += split_cell(icell,n);
+  }
+
+  if (stats[1]) particle->compress_rebalance();
+  else if (stats[2]) particle->sorted = 0;
+
+  bigint all[3];
+  MPI_Allreduce(stats,all,3,MPI_SPARTA_BIGINT,MPI_SUM,world);
+  nmerge = all[0];
+  nremove = all[1];
+  nadd = all[2];
+
+  if (nremove || nadd) {
+    bigint nme = particle->nlocal;
+    MPI_Allreduce(&nme,&particle->nglobal,1,MPI_SPARTA_BIGINT,MPI_SUM,world);
+  }
+
+  // emit fixes store per-task insertion counts scaled by cell weight
+
+  if (nmerge || nadd) {
+    for (int i = 0; i < modify->nfix; i++)
+      if (strncmp(modify->fix[i]->style,"emit",4) == 0)
+        modify->fix[i]->grid_changed();
+  }
+}
+
+/* ----------------------------------------------------------------------
+   merge the N particles in cell icell into about Ntarget particles
+   cell weight is multiplied by an integer ratio R near N/Ntarget
+   particles of each species are sorted into groups of R*K particles
+     which are close in velocity space, K = 2 or 6 (see merge_group)
+   each group is replaced by K of its particles, which conserves
+     species mass, momentum and energy of the group exactly,
+     and with moments = stress also its full stress tensor
+   leftover particles of a species, fewer than R, keep 0 or 1 particle
+     at random so the species mass is conserved on average,
+     then leftover survivors are shifted and scaled so the cell's
+     total momentum and energy are conserved exactly
+   removed particles are flagged with icell = -1 for compression
+   return # of particles removed
+------------------------------------------------------------------------- */
+
+int FixMerge::merge_cell(int icell, int n)
+{
+  int i,k,ip,isp,r,ns,nsurv,ngroup,nleft,nkeep;
+  double mass;
+
+  Particle::OnePart *particles = particle->particles;
+  Particle::Species *species = particle->species;
+  int *next = particle->next;
+  int nspecies = particle->nspecies;
+
+  int kgroup = 2;
+  if (momentflag == STRESS) kgroup = 6;
+
+  // bucket particle indices by species in pwork
+
+  grow_list(n);
+
+  for (isp = 0; isp < nspecies; isp++) spcount[isp] = 0;
+
+  k = 0;
+  ip = grid->cinfo[icell].first;
+  while (ip >= 0) {
+    plist[k++] = ip;
+    spcount[particles[ip].ispecies]++;
+    ip = next[ip];
+  }
+
+  spfirst[0] = 0;
+  for (isp = 1; isp < nspecies; isp++)
+    spfirst[isp] = spfirst[isp-1] + spcount[isp-1];
+  for (isp = 0; isp < nspecies; isp++) spleft[isp] = spfirst[isp];
+  for (k = 0; k < n; k++)
+    pwork[spleft[particles[plist[k]].ispecies]++] = plist[k];
+
+  // ratio R = floor or ceil of N/Ntarget, whichever leaves less mass
+  //   in leftover particles, ties go to the one closer to N/Ntarget
+
+  double rideal = (double) n / ntarget;
+  int rlo = MAX(2,static_cast<int> (rideal));
+  int rhi = MAX(2,static_cast<int> (ceil(rideal)));
+
+  int ratio = 0;
+  double left,leftbest = 0.0;
+  for (r = rlo; r <= rhi; r++) {
+    left = 0.0;
+    for (isp = 0; isp < nspecies; isp++)
+      if (spcount[isp] >= 2*r) left += (spcount[isp] % r) * species[isp].mass;
+      else left += spcount[isp] * species[isp].mass;
+    if (ratio == 0 || left < leftbest ||
+        (left == leftbest && fabs(r-rideal) < fabs(ratio-rideal))) {
+      ratio = r;
+      leftbest = left;
+    }
+  }
+
+  // cell totals of momentum and kinetic energy
+  // only needed if leftover particles exist
+
+  double pall[3],eall;
+  double *v;
+
+  pall[0] = pall[1] = pall[2] = eall = 0.0;
+  if (leftbest > 0.0) {
+    for (k = 0; k < n; k++) {
+      ip = plist[k];
+      mass = species[particles[ip].ispecies].mass;
+      v = particles[ip].v;
+      pall[0] += mass*v[0];
+      pall[1] += mass*v[1];
+      pall[2] += mass*v[2];
+      eall += mass*(v[0]*v[0] + v[1]*v[1] + v[2]*v[2]);
+    }
+  }
+
+  // merge groups of each species, then its leftover particles
+  // nsurv = # of survivors of species, at least 2 to form a group
+  // last group of species holds extra survivors if nsurv % K != 0
+  // nleft = # of leftover survivors of all species, stored in plist
+
+  int nsurvive = 0;
+  nleft = 0;
+
+  for (isp = 0; isp < nspecies; isp++) {
+    ns = spcount[isp];
+    if (ns == 0) continue;
+    int *bucket = &pwork[spfirst[isp]];
+
+    nsurv = ns / ratio;
+    if (nsurv >= 2) {
+      ngroup = MAX(1,nsurv/kgroup);
+      if (ngroup > 1) sort_groups(bucket,nsurv*ratio,kgroup*ratio);
+      for (i = 0; i < ngroup-1; i++)
+        merge_group(&bucket[i*kgroup*ratio],kgroup*ratio,kgroup);
+      k = nsurv - (ngroup-1)*kgroup;
+      merge_group(&bucket[(ngroup-1)*kgroup*ratio],k*ratio,k);
+      nsurvive += nsurv;
+      ns -= nsurv*ratio;
+      bucket += nsurv*ratio;
+    }
+
+    if (ns == 0) continue;
+    nkeep = static_cast<int> ((double) ns/ratio + random->uniform());
+    nkeep = MIN(nkeep,ns);
+    merge_leftover(bucket,ns,nkeep,ratio);
+    for (k = 0; k < nkeep; k++) plist[nleft++] = bucket[k];
+    nsurvive += nkeep;
+  }
+
+  // shift and scale leftover survivors so cell momentum and energy
+  //   are the same as before the merge
+  // if not possible, e.g. single leftover survivor, use all survivors
+
+  if (leftbest > 0.0) {
+    if (!conserve(plist,nleft,pwork,n,ratio,pall,eall)) {
+      k = 0;
+      for (i = 0; i < n; i++)
+        if (particles[pwork[i]].icell >= 0) plist[k++] = pwork[i];
+      conserve(plist,k,pwork,n,ratio,pall,eall);
+    }
+  }
+
+  grid->cinfo[icell].weight *= ratio;
+  return n - nsurvive;
+}
+
+/* ----------------------------------------------------------------------
+   order the N particles in list so each consecutive run of G particles
+     is a compact group in velocity space
+   last run holds the extra N % G particles
+   recursive bisection along the velocity component of largest spread,
+     each cut leaves a multiple of G particles on its lower side
+------------------------------------------------------------------------- */
+
+void FixMerge::sort_groups(int *list, int n, int g)
+{
+  if (n < 2*g) return;
+
+  Particle::OnePart *particles = particle->particles;
+
+  int i,dim;
+  double *v;
+  double lo[3],hi[3];
+
+  lo[0] = lo[1] = lo[2] = BIG;
+  hi[0] = hi[1] = hi[2] = -BIG;
+  for (i = 0; i < n; i++) {
+    v = particles[list[i]].v;
+    lo[0] = MIN(lo[0],v[0]); hi[0] = MAX(hi[0],v[0]);
+    lo[1] = MIN(lo[1],v[1]); hi[1] = MAX(hi[1],v[1]);
+    lo[2] = MIN(lo[2],v[2]); hi[2] = MAX(hi[2],v[2]);
+  }
+
+  dim = 0;
+  if (hi[1]-lo[1] > hi[dim]-lo[dim]) dim = 1;
+  if (hi[2]-lo[2] > hi[dim]-lo[dim]) dim = 2;
+
+  for (i = 0; i < n; i++) {
+    vsort[i].value = particles[list[i]].v[dim];
+    vsort[i].index = list[i];
+  }
+  qsort(vsort,n,sizeof(VSort),compare_vsort);
+  for (i = 0; i < n; i++) list[i] = vsort[i].index;
+
+  int nlower = (n/g)/2 * g;
+  sort_groups(list,nlower,g);
+  sort_groups(&list[nlower],n-nlower,g);
+}
+
+/* ----------------------------------------------------------------------
+   replace a group of G particles of one species by K of them
+   survivors are the first K particles after a partial shuffle
+   survivor velocities v are mapped to u + A (v - us)
+     u,C = mean and covariance of group, us,S = same for survivors
+   moments = energy: A = sqrt(trace C / trace S) times identity,
+     conserves mass, momentum and energy
+   moments = stress: A = Lc Ls^-1 with Cholesky factors C = Lc Lc^T,
+     S = Ls Ls^T, also conserves the stress tensor
+     if S is singular, e.g. K < 4, the energy mapping is used
+   continuous rotational/vibrational energies are set to the group mean
+   other particles are flagged with icell = -1
+------------------------------------------------------------------------- */
+
+void FixMerge::merge_group(int *list, int g, int nkeep)
+{
+  int i,k,ip;
+  double *v;
+
+  Particle::OnePart *particles = particle->particles;
+
+  shuffle(list,g,nkeep);
+
+  double u[3],c[6],us[3],cs[6];
+  double erot = 0.0, evib = 0.0;
+
+  moments(list,g,u,c);
+  moments(list,nkeep,us,cs);
+
+  for (k = 0; k < g; k++) {
+    erot += particles[list[k]].erot;
+    evib += particles[list[k]].evib;
+  }
+  erot /= g;
+  evib /= g;
+
+  double lc[6],ls[6];
+  int stressflag = 0;
+  if (momentflag == STRESS) {
+    cholesky(c,lc);
+    if (cholesky(cs,ls)) stressflag = 1;
+  }
+
+  double trace = c[0] + c[1] + c[2];
+  double traces = cs[0] + cs[1] + cs[2];
+  double scale = 0.0;
+  if (traces > 0.0) scale = sqrt(trace/traces);
+
+  // survivors with identical velocities get u +/- sqrt(trace C) e
+  //   for a random unit vector e, an odd last survivor gets u
+
+  double e[3];
+  if (!stressflag && traces <= 0.0) {
+    double z = 2.0*random->uniform() - 1.0;
+    double rxy = sqrt(MAX(1.0-z*z,0.0));
+    double phi = MY_2PI*random->uniform();
+    double s = sqrt(MAX(trace,0.0) * nkeep / (nkeep - nkeep%2));
+    e[0] = s*rxy*cos(phi);
+    e[1] = s*rxy*sin(phi);
+    e[2] = s*z;
+  }
+
+  double dv[3],w[3];
+
+  for (k = 0; k < nkeep; k++) {
+    ip = list[k];
+    v = particles[ip].v;
+    for (i = 0; i < 3; i++) dv[i] = v[i] - us[i];
+
+    if (stressflag) {
+      w[0] = dv[0]/ls[0];
+      w[1] = (dv[1] - ls[3]*w[0])/ls[1];
+      w[2] = (dv[2] - ls[4]*w[0] - ls[5]*w[1])/ls[2];
+      dv[0] = lc[0]*w[0];
+      dv[1] = lc[3]*w[0] + lc[1]*w[1];
+      dv[2] = lc[4]*w[0] + lc[5]*w[1] + lc[2]*w[2];
+    } else if (traces > 0.0) {
+      dv[0] *= scale;
+      dv[1] *= scale;
+      dv[2] *= scale;
+    } else {
+      double sign = (k % 2) ? -1.0 : 1.0;
+      if (k == nkeep-1 && nkeep % 2) sign = 0.0;
+      dv[0] = sign*e[0];
+      dv[1] = sign*e[1];
+      dv[2] = sign*e[2];
+    }
+
+    v[0] = u[0] + dv[0];
+    v[1] = u[1] + dv[1];
+    v[2] = u[2] + dv[2];
+    if (rotflag) particles[ip].erot = erot;
+    if (vibflag) particles[ip].evib = evib;
+  }
+
+  for (k = nkeep; k < g; k++) particles[list[k]].icell = -1;
+}
+
+/* ----------------------------------------------------------------------
+   mean velocity u and covariance c of the N particles in list
+   c = xx,yy,zz,xy,xz,yz
+------------------------------------------------------------------------- */
+
+void FixMerge::moments(int *list, int n, double *u, double *c)
+{
+  double *v;
+  Particle::OnePart *particles = particle->particles;
+
+  u[0] = u[1] = u[2] = 0.0;
+  for (int k = 0; k < n; k++) {
+    v = particles[list[k]].v;
+    u[0] += v[0];
+    u[1] += v[1];
+    u[2] += v[2];
+  }
+  u[0] /= n;
+  u[1] /= n;
+  u[2] /= n;
+
+  double dx,dy,dz;
+  c[0] = c[1] = c[2] = c[3] = c[4] = c[5] = 0.0;
+  for (int k = 0; k < n; k++) {
+    v = particles[list[k]].v;
+    dx = v[0] - u[0];
+    dy = v[1] - u[1];
+    dz = v[2] - u[2];
+    c[0] += dx*dx;
+    c[1] += dy*dy;
+    c[2] += dz*dz;
+    c[3] += dx*dy;
+    c[4] += dx*dz;
+    c[5] += dy*dz;
+  }
+  for (int i = 0; i < 6; i++) c[i] /= n;
+}
+
+/* ----------------------------------------------------------------------
+   lower-triangular Cholesky factor l of symmetric 3x3 matrix c
+   c and l are stored as xx,yy,zz,xy,xz,yz
+   non-positive pivots are set to 0 along with the rest of their column
+   return 1 if c is positive definite, else 0
+------------------------------------------------------------------------- */
+
+int FixMerge::cholesky(double *c, double *l)
+{
+  double d;
+  double tiny = EPSPIVOT*(c[0]+c[1]+c[2]);
+  int flag = 1;
+
+  d = c[0];
+  l[0] = (d > tiny) ? sqrt(d) : 0.0;
+  l[3] = (l[0] > 0.0) ? c[3]/l[0] : 0.0;
+  l[4] = (l[0] > 0.0) ? c[4]/l[0] : 0.0;
+
+  d = c[1] - l[3]*l[3];
+  l[1] = (d > tiny) ? sqrt(d) : 0.0;
+  l[5] = (l[1] > 0.0) ? (c[5] - l[4]*l[3])/l[1] : 0.0;
+
+  d = c[2] - l[4]*l[4] - l[5]*l[5];
+  l[2] = (d > tiny) ? sqrt(d) : 0.0;
+
+  if (l[0] == 0.0 || l[1] == 0.0 || l[2] == 0.0) flag = 0;
+  return flag;
+}
+
+/* ----------------------------------------------------------------------
+   keep Nkeep of the N leftover particles of one species
+   survivors are the first Nkeep particles after a partial shuffle
+   each survivor will represent ratio times more molecules
+   continuous rotational/vibrational energies are scaled so their
+     sum over the leftover particles is conserved
+   other particles are flagged with icell = -1
+------------------------------------------------------------------------- */
+
+void FixMerge::merge_leftover(int *list, int n, int nkeep, int ratio)
+{
+  Particle::OnePart *particles = particle->particles;
+
+  shuffle(list,n,nkeep);
+
+  if (nkeep && (rotflag || vibflag)) {
+    double erot = 0.0, evib = 0.0;
+    for (int k = 0; k < n; k++) {
+      erot += particles[list[k]].erot;
+      evib += particles[list[k]].evib;
+    }
+    erot /= nkeep*ratio;
+    evib /= nkeep*ratio;
+    for (int k = 0; k < nkeep; k++) {
+      if (rotflag) particles[list[k]].erot = erot;
+      if (vibflag) particles[list[k]].evib = evib;
+    }
+  }
+
+  for (int k = nkeep; k < n; k++) particles[list[k]].icell = -1;
+}
+
+/* ----------------------------------------------------------------------
+   shift and scale velocities of the N particles in list so that
+     momentum and kinetic energy of all survivors in the cell equal
+     ptarget and etarget, each survivor now representing ratio molecules
+   survivors are the particles in the cell list of Nall particles
+     not flagged with icell = -1, those not in list are unchanged
+   energies are summed as m v^2
+   return 1 if successful, 0 if not possible with these particles
+------------------------------------------------------------------------- */
+
+int FixMerge::conserve(int *list, int n, int *all, int nall, int ratio,
+                       double *ptarget, double etarget)
+{
+  int k,ip;
+  double mass,*v;
+
+  if (n < 2) return 0;
+
+  Particle::OnePart *particles = particle->particles;
+  Particle::Species *species = particle->species;
+
+  // sums over all survivors and over list
+
+  double pcell[3],ecell;
+  pcell[0] = pcell[1] = pcell[2] = ecell = 0.0;
+
+  for (k = 0; k < nall; k++) {
+    ip = all[k];
+    if (particles[ip].icell < 0) continue;
+    mass = ratio*species[particles[ip].ispecies].mass;
+    v = particles[ip].v;
+    pcell[0] += mass*v[0];
+    pcell[1] += mass*v[1];
+    pcell[2] += mass*v[2];
+    ecell += mass*(v[0]*v[0] + v[1]*v[1] + v[2]*v[2]);
+  }
+
+  double msum = 0.0;
+  double psum[3],esum;
+  psum[0] = psum[1] = psum[2] = esum = 0.0;
+
+  for (k = 0; k < n; k++) {
+    ip = list[k];
+    mass = ratio*species[particles[ip].ispecies].mass;
+    v = particles[ip].v;
+    msum += mass;
+    psum[0] += mass*v[0];
+    psum[1] += mass*v[1];
+    psum[2] += mass*v[2];
+    esum += mass*(v[0]*v[0] + v[1]*v[1] + v[2]*v[2]);
+  }
+
+  // new list velocities are unew + scale*(v - uold)
+  // unew gives target momentum, scale gives target energy
+
+  double uold[3],unew[3];
+  uold[0] = psum[0]/msum;
+  uold[1] = psum[1]/msum;
+  uold[2] = psum[2]/msum;
+  unew[0] = (ptarget[0] - pcell[0] + psum[0])/msum;
+  unew[1] = (ptarget[1] - pcell[1] + psum[1])/msum;
+  unew[2] = (ptarget[2] - pcell[2] + psum[2])/msum;
+
+  double thermal = esum - msum*(uold[0]*uold[0] + uold[1]*uold[1] +
+                                uold[2]*uold[2]);
+  double target = etarget - ecell + esum -
+    msum*(unew[0]*unew[0] + unew[1]*unew[1] + unew[2]*unew[2]);
+  if (thermal <= 0.0 || target < 0.0) return 0;
+
+  double scale = sqrt(target/thermal);
+
+  for (k = 0; k < n; k++) {
+    v = particles[list[k]].v;
+    v[0] = unew[0] + scale*(v[0]-uold[0]);
+    v[1] = unew[1] + scale*(v[1]-uold[1]);
+    v[2] = unew[2] + scale*(v[2]-uold[2]);
+  }
+
+  return 1;
+}
+
+/* ----------------------------------------------------------------------
+   split each of the N particles in cell icell into K identical copies
+   K is largest integer that keeps cell weight >= its base weight
+     and the cell count <= Ntarget
+   cell weight is divided by K, so all moments are conserved exactly
+   return # of particles added
+------------------------------------------------------------------------- */
+
+int FixMerge::split_cell(int icell, int n)
+{
+  Grid::ChildInfo *cinfo = grid->cinfo;
+
+  double wbase = grid->weight_base(icell);
+  double ratio = cinfo[icell].weight/wbase;
+  if (ratio < 2.0*(1.0-EPSWEIGHT)) return 0;
+
+  int nsplit = static_cast<int> (ratio*(1.0+EPSWEIGHT));
+  nsplit = MIN(nsplit,ntarget/n);
+  if (nsplit < 2) return 0;
+
+  // copy cell's particle list first, since clones extend particle list
+
+  grow_list(n);
+
+  int k = 0;
+  int ip = cinfo[icell].first;
+  while (ip >= 0) {
+    plist[k++] = ip;
+    ip = particle->next[ip];
+  }
+
+  for (k = 0; k < n; k++)
+    for (int m = 1; m < nsplit; m++) {
+      particle->clone_particle(plist[k]);
+      particle->particles[particle->nlocal-1].id = MAXSMALLINT*random->uniform();
+    }
+
+  cinfo[icell].weight /= nsplit;
+  return n*(nsplit-1);
+}
+
+/* ---------------------------------------------------------------------- */
+
+void FixMerge::grow_list(int n)
+{
+  if (n <= maxlist) return;
+  while (maxlist < n) maxlist += DELTALIST;
+  memory->destroy(plist);
+  memory->destroy(pwork);
+  memory->sfree(vsort);
+  memory->create(plist,maxlist,"merge:plist");
+  memory->create(pwork,maxlist,"merge:pwork");
+  vsort = (VSort *) memory->smalloc(maxlist*sizeof(VSort),"merge:vsort");
+}
+
+/* ----------------------------------------------------------------------
+   partial shuffle of the N indices in list
+   first M indices become a random subset of all N
+------------------------------------------------------------------------- */
+
+void FixMerge::shuffle(int *list, int n, int m)
+{
+  int j,tmp;
+  for (int k = 0; k < m; k++) {
+    j = k + static_cast<int> (random->uniform()*(n-k));
+    if (j >= n) j = n-1;
+    tmp = list[k];
+    list[k] = list[j];
+    list[j] = tmp;
+  }
+}
+
+/* ----------------------------------------------------------------------
+   return stats for most recent invocation
+   0 = # of merged cells, 1 = # of particles removed, 2 = # added by split
+------------------------------------------------------------------------- */
+
+double FixMerge::compute_vector(int i)
+{
+  if (i == 0) return (double) nmerge;
+  if (i == 1) return (double) nremove;
+  return (double) nadd;
+}
+
+/* ---------------------------------------------------------------------- */
+
+double FixMerge::memory_usage()
+{
+  double bytes = 2.0*maxlist * sizeof(int);
+  bytes += maxlist * sizeof(VSort);
+  bytes += 3.0*maxspecies * sizeof(int);
+  return bytes;
+}
+
+/* ----------------------------------------------------------------------
+   comparison function invoked by qsort() called by sort_groups()
+   sorts VSort entries by value, which is their first field
+   this is not a class method
+------------------------------------------------------------------------- */
+
+int compare_vsort(const void *iptr, const void *jptr)
+{
+  double i = *((double *) iptr);
+  double j = *((double *) jptr);
+  if (i < j) return -1;
+  if (i > j) return 1;
+  return 0;
+}
@@ -0,0 +1,93 @@
+/* ----------------------------------------------------------------------
+   SPARTA - Stochastic PArallel Rarefied-gas Time-accurate Analyzer
+   http://sparta.sandia.gov
+   Steve Plimpton, sjplimp@sandia.gov, Michael Gallis, magalli@sandia.gov
+   Sandia National Laboratories
+
+   Copyright (2014) Sandia Corporation.  Under the terms of Contract
+   DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+   certain rights in this software.  This software is distributed under
+   the GNU General Public License.
+
+   See the README file in the top-level SPARTA directory.
+------------------------------------------------------------------------- */
+
+#ifdef FIX_CLASS
+
+FixStyle(merge,FixMerge)
+
+#else
+
+#ifndef SPARTA_FIX_MERGE_H
+#define SPARTA_FIX_MERGE_H
+
+#include "fix.h"
+
+namespace SPARTA_NS {
+
+class FixMerge : public Fix {
+ public:
+  FixMerge(class SPARTA *, int, char **);
+  ~FixMerge();
+  int setmask();
+  void init();
+  void setup();
+  void end_of_step();
+  double compute_vector(int);
+  double memory_usage();
+
+ private:
+  int nmax,ntarget,splitflag,momentflag;
+  int rotflag,vibflag;
+  bigint nmerge,nremove,nadd;     // stats for most recent invocation
+
+  int maxlist;
+  int *plist,*pwork;              // particle indices of one cell
+  int maxspecies;
+  int *spcount,*spfirst,*spleft;  // per-species counts for one cell
+
+  struct VSort {                  // velocity component of one particle
+    double value;
+    int index;
+  };
+  VSort *vsort;
+
+  class RanPark *random;
+
+  void merge();
+  int merge_cell(int, int);
+  void sort_groups(int *, int, int);
+  void merge_group(int *, int, int);
+  void moments(int *, int, double *, double *);
+  int cholesky(double *, double *);
+  void merge_leftover(int *, int, int, int);
+  int conserve(int *, int, int *, int, int, double *, double);
+  void shuffle(int *, int, int);
+  int split_cell(int, int);
+  void grow_list(int);
+};
+
+}
+
+#endif
+#endif
+
+/* ERROR/WARNING messages:
+
+E: Illegal ... command
+
+Self-explanatory.  Check the input script syntax and compare to the
+documentation for the command.  You can use -echo screen as a
+command-line option when running SPARTA to see the offending line.
+
+E: Fix merge requires per-cell weighting
+
+Use the global weight cell command with a mode other than none,
+e.g. uniform, so that particles moving between cells of different
+weight are cloned or deleted.
+
+E: Fix merge is not yet supported with Kokkos
+
+Self-explanatory.
+
+*/
@@ -149,6 +149,7 @@ void FixMoveSurf::end_of_step()
 
   // assign split cell particles to parent split cell
   // assign surfs to grid cells
+  // only cells overlapping box swept by moved surfs are re-mapped and re-cut
 
   grid->unset_neighbors();
   grid->remove_ghosts();
@@ -161,9 +162,9 @@ void FixMoveSurf::end_of_step()
 	grid->combine_split_cell_particles(icell,1);
   }
 
+  movesurf->stash_cells();
   grid->clear_surf();
-
-  grid->surf2grid(1,0);
+  movesurf->surf2grid_local(0);
 
   // re-setup owned and ghost cell info
 
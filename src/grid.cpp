@@ -61,7 +61,7 @@ enum{PERAUTO,PERCELL,PERSURF};                  // several files
 
 enum{UNKNOWN,OUTSIDE,INSIDE,OVERLAP};           // several files
 enum{NCHILD,NPARENT,NUNKNOWN,NPBCHILD,NPBPARENT,NPBUNKNOWN,NBOUND};  // Update
-enum{NOWEIGHT,VOLWEIGHT,RADWEIGHT};
+enum{NOWEIGHT,VOLWEIGHT,RADWEIGHT,UNIFORMWEIGHT};
 
 // corners[i][j] = J corner points of face I of a grid cell
 // works for 2d quads and 3d hexes
@@ -128,6 +128,7 @@ Grid::Grid(SPARTA *sparta) : Pointers(sparta)
 
   cutoff = -1.0;
   cellweightflag = NOWEIGHT;
+  weightrestartflag = 0;
 
   // allocate hash for cell IDs
 
@@ -138,9 +139,29 @@ Grid::Grid(SPARTA *sparta) : Pointers(sparta)
 
   gridCommMacro = new GridCommMacro(sparta);
   is_dt_weight = 0;
+
+  tmap = tsplit = tcut = tsub = 0.0;
+  nthreads = 1;
+  cut2d_thread = NULL;
+  cut3d_thread = NULL;
+
+  allghost_surfflag = -1;
+  ghoststash = 0;
+  nstash = 0;
+  stashbuf = NULL;
+  stashoffset = stashilocal = stashicell = NULL;
+  stashfirst = stashcount = NULL;
+  origin = NULL;
+  ntrack = norigin = maxorigin = nprior = 0;
+  remap = NULL;
+  nremap = 0;
+  ghostneigh = 0;
   grad_l = new MyGradHash();
   grad_dt = new MyGradHash();
   gradhashfilled = 0;
+
+  findflag = 0;
+  findindex = NULL;
 }
 
 /* ---------------------------------------------------------------------- */
@@ -167,7 +188,11 @@ Grid::~Grid()
   delete hash;
   delete gridCommMacro;
   delete grad_l;
+
+  unstash_ghosts();
+  memory->destroy(remap);
   delete grad_dt;
+  memory->destroy(findindex);
 }
 
 /* ----------------------------------------------------------------------
@@ -196,6 +221,12 @@ void Grid::remove()
   hash->clear();
   hashfilled = 0;
 
+  unstash_ghosts();
+  allghost_surfflag = -1;
+  memory->destroy(remap);
+  remap = NULL;
+  nremap = 0;
+
   cells = NULL;
   cinfo = NULL;
   sinfo = NULL;
@@ -406,6 +437,11 @@ void Grid::remove_ghosts()
   exist_ghost = 0;
   nghost = nunsplitghost = nsplitghost = nsubghost = 0;
   surf->remove_ghosts();
+
+  memory->destroy(remap);
+  remap = NULL;
+  nremap = 0;
+  ghostneigh = 0;
 }
 
 /* ----------------------------------------------------------------------
@@ -414,19 +450,38 @@ void Grid::remove_ghosts()
      explicit distributed surfs require use of hash
    method used depends on ghost cutoff
    no-op if grid is not clumped and want to acquire only nearby ghosts
+   if ghosts were stashed before adaptation, patch them with the delta,
+     the hash and the macro comm plan are then patched as well
 ------------------------------------------------------------------------- */
 
 void Grid::acquire_ghosts(int surfflag)
 {
   if (surf->distributed && !surf->implicit) surf->rehash();
 
-  if (cutoff < 0.0) acquire_ghosts_all(surfflag);
-  else if (clumped) acquire_ghosts_near(surfflag);
+  memory->destroy(remap);
+  remap = NULL;
+  nremap = 0;
+  ghostneigh = 0;
+
+  int deltaflag = 0;
+  if (cutoff < 0.0) {
+    if (ghoststash && surfflag == allghost_surfflag) {
+      acquire_ghosts_delta(surfflag);
+      deltaflag = 1;
+    } else acquire_ghosts_all(surfflag);
+  } else if (clumped) acquire_ghosts_near(surfflag);
   else if (comm->me == 0)
     error->warning(FLERR,"Could not acquire nearby ghost cells b/c "
                    "grid partition is not clumped");
-  rehash();
-  grid->gridCommMacro->acquire_macro_comm_list_near(); // plan for routine macro comm
+  unstash_ghosts();
+
+  // plan for routine macro comm
+
+  if (deltaflag) grid->gridCommMacro->update_macro_comm_list();
+  else {
+    rehash();
+    grid->gridCommMacro->acquire_macro_comm_list_near();
+  }
   if (surf->distributed && !surf->implicit) {
     surf->hash->clear();
     surf->hashfilled = 0;
@@ -483,10 +538,289 @@ void Grid::acquire_ghosts_all(int surfflag)
 
   unpack_ghosts_surfflag = surfflag;
   comm->ring(sendsize,sizeof(char),sbuf,1,unpack_ghosts,NULL,0,(void *) this);
+  allghost_surfflag = surfflag;
 
   memory->destroy(sbuf);
 }
 
+/* ----------------------------------------------------------------------
+   stash packed copies of current ghost cells before AdaptGrid removes them
+   only for ghosts acquired from all procs, i.e. cutoff < 0.0
+   compress() then tracks what each owned cell was before adaptation,
+     so acquire_ghosts() can patch the stash with only the cells each
+     proc removed or created, instead of circulating the entire grid
+   stashed ghosts keep their neighbor indices, which find_neighbors()
+     remaps via stashicell and origin instead of searching all faces,
+     unless they were never set on this proc, e.g. by reset_neighbors()
+   cell dt_weights are safe to stash, adapt_dt_weight re-acquires ghosts
+     whenever it changes them
+------------------------------------------------------------------------- */
+
+void Grid::stash_ghosts()
+{
+  unstash_ghosts();
+
+  if (cutoff >= 0.0 || !exist_ghost || allghost_surfflag < 0) return;
+  if (comm->nprocs == 1) return;
+
+  int nprocs = comm->nprocs;
+  int surfflag = allghost_surfflag;
+  int nall = nlocal + nghost;
+
+  // ghost sinfo.csubs store local indices of ghost sub cells
+  // pack_one() needs indices on owning proc, as sent by the owner
+  // OK to overwrite since ghosts are about to be removed
+
+  for (int icell = nlocal; icell < nall; icell++) {
+    if (cells[icell].nsplit <= 1) continue;
+    int *csubs = sinfo[cells[icell].isplit].csubs;
+    int nsplit = cells[icell].nsplit;
+    for (int i = 0; i < nsplit; i++) csubs[i] = cells[csubs[i]].ilocal;
+  }
+
+  // pack each unsplit or split ghost cell, subcells are packed by split cell
+  // ghosts from each proc are contiguous, b/c they were unpacked in ring order
+
+  memory->create(stashoffset,nghost+1,"grid:stashoffset");
+  memory->create(stashilocal,nghost,"grid:stashilocal");
+  memory->create(stashicell,nghost,"grid:stashicell");
+  memory->create(stashfirst,nprocs,"grid:stashfirst");
+  memory->create(stashcount,nprocs,"grid:stashcount");
+  for (int i = 0; i < nprocs; i++) stashfirst[i] = stashcount[i] = 0;
+
+  nstash = 0;
+  int nbytes = 0;
+  for (int icell = nlocal; icell < nall; icell++) {
+    if (cells[icell].nsplit <= 0) continue;
+    if (stashcount[cells[icell].proc] == 0)
+      stashfirst[cells[icell].proc] = nstash;
+    stashcount[cells[icell].proc]++;
+    stashoffset[nstash] = nbytes;
+    stashilocal[nstash] = cells[icell].ilocal;
+    stashicell[nstash] = ghostneigh ? icell : -1;
+    nbytes += pack_one(icell,NULL,0,0,surfflag,0);
+    nstash++;
+  }
+  stashoffset[nstash] = nbytes;
+
+  memory->create(stashbuf,nbytes,"grid:stashbuf");
+  memset(stashbuf,0,nbytes);
+
+  nstash = 0;
+  for (int icell = nlocal; icell < nall; icell++) {
+    if (cells[icell].nsplit <= 0) continue;
+    pack_one(icell,&stashbuf[stashoffset[nstash++]],0,0,surfflag,1);
+  }
+
+  // initially every owned cell is its own origin
+
+  maxorigin = nlocal;
+  memory->create(origin,maxorigin,"grid:origin");
+  for (int icell = 0; icell < nlocal; icell++) origin[icell] = icell;
+  norigin = ntrack = nlocal;
+  nprior = nall;
+
+  ghoststash = 1;
+}
+
+/* ----------------------------------------------------------------------
+   free stashed ghost cells
+------------------------------------------------------------------------- */
+
+void Grid::unstash_ghosts()
+{
+  ghoststash = 0;
+  nstash = 0;
+  memory->destroy(stashbuf);
+  memory->destroy(stashoffset);
+  memory->destroy(stashilocal);
+  memory->destroy(stashicell);
+  memory->destroy(stashfirst);
+  memory->destroy(stashcount);
+  memory->destroy(origin);
+  stashbuf = NULL;
+  stashoffset = stashilocal = stashicell = NULL;
+  stashfirst = stashcount = NULL;
+  origin = NULL;
+  ntrack = norigin = maxorigin = nprior = 0;
+}
+
+/* ----------------------------------------------------------------------
+   acquire ghost cells from all other procs by patching stashed ghosts
+   each proc contributes a delta for its owned cells:
+     sorted indices (before adaptation) of its cells that were removed
+     packed copies of its unsplit and split cells created by adaptation
+   kept cells are compressed in order and new cells are appended,
+     so a kept cell's new index = old index - # of removed cells before it
+   deltas are allgathered and unpacked in same proc order as the ring
+     in acquire_ghosts_all(), so result is identical
+   hash is patched as cells are unpacked and remap is set for
+     find_neighbors(), faces of new cells are flagged UNKNOWN
+------------------------------------------------------------------------- */
+
+void Grid::acquire_ghosts_delta(int surfflag)
+{
+  int i,n,icell,proc,first;
+
+  exist_ghost = 1;
+  nempty = 0;
+
+  int me = comm->me;
+  int nprocs = comm->nprocs;
+
+  // same pre-allocation as acquire_ghosts_all()
+
+  int nghost_new;
+  MPI_Allreduce(&nlocal,&nghost_new,1,MPI_INT,MPI_SUM,world);
+  nghost_new -= nlocal;
+  grow_cells(nghost_new,0);
+
+  // hash my owned cells, ghosts are added as they are unpacked
+
+  rehash();
+
+  // remap = new index of each owned or ghost cell before adaptation
+  // nremove = # of my cells before adaptation that no longer exist
+  // kept cells have increasing origin, cells past ntrack are new
+
+  nremap = nprior;
+  memory->create(remap,nremap,"grid:remap");
+  for (i = 0; i < nremap; i++) remap[i] = -1;
+
+  int nkeep = 0;
+  for (icell = 0; icell < nlocal; icell++) {
+    if (icell < ntrack && origin[icell] >= 0) {
+      remap[origin[icell]] = icell;
+      nkeep++;
+    } else if (cells[icell].nsplit > 0) unknown_neighbors(icell);
+  }
+  int nremove = norigin - nkeep;
+
+  // delta = nremove, removed indices, padded to 8 bytes, new cells
+
+  int sendsize = (1+nremove)*sizeof(int);
+  sendsize = (sendsize+7)/8 * 8;
+  int nheader = sendsize;
+  for (icell = 0; icell < nlocal; icell++) {
+    if (cells[icell].nsplit <= 0) continue;
+    if (icell < ntrack && origin[icell] >= 0) continue;
+    sendsize += pack_one(icell,NULL,0,0,surfflag,0);
+  }
+
+  char *sbuf;
+  memory->create(sbuf,sendsize,"grid:sbuf");
+  memset(sbuf,0,sendsize);
+
+  int *ibuf = (int *) sbuf;
+  ibuf[0] = nremove;
+  n = 1;
+  int m = 0;
+  for (i = 0; i < norigin; i++) {
+    while (m < ntrack && origin[m] < i) m++;
+    if (m < ntrack && origin[m] == i) continue;
+    ibuf[n++] = i;
+  }
+
+  sendsize = nheader;
+  for (icell = 0; icell < nlocal; icell++) {
+    if (cells[icell].nsplit <= 0) continue;
+    if (icell < ntrack && origin[icell] >= 0) continue;
+    sendsize += pack_one(icell,&sbuf[sendsize],0,0,surfflag,1);
+  }
+
+  // allgather deltas from all procs
+
+  int *recvcounts,*displs;
+  memory->create(recvcounts,nprocs,"grid:recvcounts");
+  memory->create(displs,nprocs,"grid:displs");
+
+  MPI_Allgather(&sendsize,1,MPI_INT,recvcounts,1,MPI_INT,world);
+  displs[0] = 0;
+  for (i = 1; i < nprocs; i++) displs[i] = displs[i-1] + recvcounts[i-1];
+
+  char *rbuf;
+  memory->create(rbuf,displs[nprocs-1]+recvcounts[nprocs-1],"grid:rbuf");
+  MPI_Allgatherv(sbuf,sendsize,MPI_CHAR,rbuf,recvcounts,displs,MPI_CHAR,world);
+
+  memory->destroy(sbuf);
+
+  // loop over other procs in ring order: me-1, me-2, ...
+  // unpack stashed ghosts of proc that were not removed
+  // reset their ilocal, including for their sub cells
+  // then unpack new cells of proc
+
+  for (int iproc = 1; iproc < nprocs; iproc++) {
+    proc = me - iproc;
+    if (proc < 0) proc += nprocs;
+
+    char *buf = &rbuf[displs[proc]];
+    int *removed = (int *) buf;
+    nremove = removed[0];
+    removed++;
+
+    first = nlocal + nghost;
+    int last = stashfirst[proc] + stashcount[proc];
+    for (m = stashfirst[proc]; m < last; m++) {
+      n = nremove_below(stashilocal[m],nremove,removed);
+      if (n < nremove && removed[n] == stashilocal[m]) continue;
+      icell = nlocal + nghost;
+      unpack_one(&stashbuf[stashoffset[m]],0,0,surfflag);
+      if (stashicell[m] >= 0) remap[stashicell[m]] = icell;
+      else unknown_neighbors(icell);
+      (*hash)[cells[icell].id] = icell;
+    }
+
+    for (icell = first; icell < nlocal+nghost; icell++)
+      cells[icell].ilocal -= nremove_below(cells[icell].ilocal,nremove,removed);
+
+    n = (1+nremove)*sizeof(int);
+    n = (n+7)/8 * 8;
+    while (n < recvcounts[proc]) {
+      icell = nlocal + nghost;
+      n += unpack_one(&buf[n],0,0,surfflag);
+      unknown_neighbors(icell);
+      (*hash)[cells[icell].id] = icell;
+    }
+  }
+
+  memory->destroy(recvcounts);
+  memory->destroy(displs);
+  memory->destroy(rbuf);
+}
+
+/* ----------------------------------------------------------------------
+   flag all faces of cell created by adaptation as UNKNOWN
+   so find_neighbors() searches them instead of remapping its neigh
+------------------------------------------------------------------------- */
+
+void Grid::unknown_neighbors(int icell)
+{
+  int nmask = 0;
+  for (int iface = 0; iface < 6; iface++) {
+    cells[icell].neigh[iface] = 0;
+    nmask = neigh_encode(NUNKNOWN,nmask,iface);
+  }
+  cells[icell].nmask = nmask;
+}
+
+/* ----------------------------------------------------------------------
+   return # of values in sorted LIST of length N that are < VALUE
+------------------------------------------------------------------------- */
+
+int Grid::nremove_below(int value, int n, int *list)
+{
+  int lo = 0;
+  int hi = n;
+  int mid;
+
+  while (lo < hi) {
+    mid = (lo+hi)/2;
+    if (list[mid] < value) lo = mid+1;
+    else hi = mid;
+  }
+  return lo;
+}
+
 /* ----------------------------------------------------------------------
    acquire ghost cells from local cells of other procs
    use irregular comm to only get copy of nearby cells
@@ -496,6 +830,7 @@ void Grid::acquire_ghosts_all(int surfflag)
 void Grid::acquire_ghosts_near(int surfflag)
 {
   exist_ghost = 1;
+  allghost_surfflag = -1;
 
   // bb lo/hi = bounding box for my owned cells
 
@@ -812,32 +1147,29 @@ void Grid::rehash()
   }
 
   hashfilled = 1;
+  findflag = 0;
 }
 
 /* ----------------------------------------------------------------------
    find and set neighbor indices for all owned and ghost cells
    when done, hash table is valid for all owned and ghost cells
    no-op if ghosts don't exist
+   if acquire_ghosts() patched ghosts after adaptation, remap is set:
+     BOUND faces and CHILD neighbors that still exist are kept,
+     only other faces are searched, result is the same as a full search
 ------------------------------------------------------------------------- */
 
 void Grid::find_neighbors()
 {
-  int icell,idim,iface,ilevel,level,nmask,boundary,periodic;
-  int found,face_touching,unknownflag;
-  cellint id,neighID,refineID,coarsenID;
+  int icell,iface,index,nflag,nmask,oldmask,unknownflag;
   cellint *neigh;
-  double *lo,*hi;
 
   if (!exist_ghost) return;
 
-  int dimension = domain->dimension;
-  int *bflag = domain->bflag;
-  double *boxlo = domain->boxlo;
-  double *boxhi = domain->boxhi;
-
   // insure cell IDs (owned + ghost) are hashed
+  // acquire_ghosts_delta() already did if remap is set
 
-  rehash();
+  if (!remap) rehash();
 
   // clear parent cells data structure since will (re)build it here
 
@@ -851,111 +1183,45 @@ void Grid::find_neighbors()
   for (icell = 0; icell < nlocal+nghost; icell++) {
     if (cells[icell].nsplit <= 0) continue;
 
-    id = cells[icell].id;
-    level = cells[icell].level;
-    lo = cells[icell].lo;
-    hi = cells[icell].hi;
     neigh = cells[icell].neigh;
+    oldmask = cells[icell].nmask;
     nmask = 0;
     unknownflag = 0;
 
     for (iface = 0; iface < 6; iface++) {
-      idim = iface/2;
-
-      // set boundary and periodic flags for this face
-      // treat 2d Z boundaries as non-periodic
-
-      if (iface % 2 == 0 && lo[idim] == boxlo[idim]) boundary = 1;
-      else if (iface % 2 == 1 && hi[idim] == boxhi[idim]) boundary = 1;
-      else boundary = 0;
-      if (bflag[iface] == PERIODIC) periodic = 1;
-      else periodic = 0;
-      if (dimension == 2 && (iface == ZLO || iface == ZHI))
-	periodic = 0;
-
-      // face = non-periodic boundary, neighbor is BOUND
-
-      if (boundary && !periodic) {
-	neigh[iface] = 0;
-	nmask = neigh_encode(NBOUND,nmask,iface);
-	continue;
-      }
-
-      // neighID = ID of neighbor cell at same level as icell
-
-      neighID = id_neigh_same_parent(id,level,iface);
-      if (neighID == 0) neighID = id_neigh_same_level(id,level,iface);
-
-      // if in hash, neighbor is CHILD
 
-      if (hash->find(neighID) != hash->end()) {
-	neigh[iface] = (*hash)[neighID];
-	if (!boundary) nmask = neigh_encode(NCHILD,nmask,iface);
-	else nmask = neigh_encode(NPBCHILD,nmask,iface);
-	continue;
-      }
+      // remap neighbor that is unchanged by adaptation
+      // a CHILD neighbor that still exists is still the neighbor,
+      //   since any finer or coarser neighbor would have replaced it
 
-      // refine from neighID until reach maxlevel
-      // look for a child cell on touching face I do own (or ghost)
-      // if find one, neighbor is PARENT, add its ID and lo/hi to local pcells
-
-      face_touching = iface % 2 ? iface-1 : iface+1;
-      refineID = neighID;
-      ilevel = level;
-      found = 0;
-
-      while (ilevel < maxlevel) {
-	refineID = id_refine(refineID,ilevel,face_touching);
-	if (hash->find(refineID) != hash->end()) {
-	  neigh[iface] = nparent;
-	  if (!boundary) nmask = neigh_encode(NPARENT,nmask,iface);
-	  else nmask = neigh_encode(NPBPARENT,nmask,iface);
-	
-	  if (nparent == maxparent) grow_pcells();
-	  pcells[nparent].id = neighID;
-	  id_lohi(neighID,level,boxlo,boxhi,pcells[nparent].lo,pcells[nparent].hi);
-	  nparent++;
-	
-	  found = 1;
-	  break;
-	} else ilevel++;
-      }
-      if (found) continue;
-
-      // coarsen from neighID until reach top level
-      // if find one, neighbor is CHILD
-
-      coarsenID = neighID;
-      ilevel = level;
-      found = 0;
-
-      while (ilevel > 1) {
-	coarsenID = id_coarsen(coarsenID,ilevel);
-	if (hash->find(coarsenID) != hash->end()) {
-	  neigh[iface] = (*hash)[coarsenID];
-	  if (!boundary) nmask = neigh_encode(NCHILD,nmask,iface);
-	  else nmask = neigh_encode(NPBCHILD,nmask,iface);
-	  found = 1;
-	  break;
-	} else ilevel--;
+      if (remap) {
+        nflag = neigh_decode(oldmask,iface);
+        if (nflag == NBOUND) {
+          nmask = neigh_encode(NBOUND,nmask,iface);
+          continue;
+        }
+        if (nflag == NCHILD || nflag == NPBCHILD) {
+          index = neigh[iface];
+          if (index >= 0 && index < nremap && remap[index] >= 0) {
+            neigh[iface] = remap[index];
+            nmask = neigh_encode(nflag,nmask,iface);
+            continue;
+          }
+        }
       }
-      if (found) continue;
-
-      // found nothing, so UNKNOWN neighbor
-      // should never happend for an owned cell (error check below)
-      // can happen for a ghost cell
 
-      neigh[iface] = 0;
-      if (!boundary) nmask = neigh_encode(NUNKNOWN,nmask,iface);
-      else nmask = neigh_encode(NPBUNKNOWN,nmask,iface);
-
-      if (icell < nlocal) unknownflag = 1;
+      nmask = find_neighbor(icell,iface,nmask,unknownflag);
     }
 
     cells[icell].nmask = nmask;
     if (unknownflag) nunknown++;
   }
 
+  memory->destroy(remap);
+  remap = NULL;
+  nremap = 0;
+  ghostneigh = 1;
+
   // for sub cells, copy neighbor info from original split cell
 
   int m,splitcell;
@@ -981,6 +1247,109 @@ void Grid::find_neighbors()
   }
 }
 
+/* ----------------------------------------------------------------------
+   search hash for neighbor of cell icell across face iface
+   set neigh[iface] and return nmask with flag for iface added
+   set unknownflag if neighbor of an owned cell is UNKNOWN
+------------------------------------------------------------------------- */
+
+int Grid::find_neighbor(int icell, int iface, int nmask, int &unknownflag)
+{
+  int idim,ilevel,boundary,periodic,face_touching;
+  cellint neighID,refineID,coarsenID;
+
+  int dimension = domain->dimension;
+  int *bflag = domain->bflag;
+  double *boxlo = domain->boxlo;
+  double *boxhi = domain->boxhi;
+
+  cellint id = cells[icell].id;
+  int level = cells[icell].level;
+  double *lo = cells[icell].lo;
+  double *hi = cells[icell].hi;
+  cellint *neigh = cells[icell].neigh;
+
+  idim = iface/2;
+
+  // set boundary and periodic flags for this face
+  // treat 2d Z boundaries as non-periodic
+
+  if (iface % 2 == 0 && lo[idim] == boxlo[idim]) boundary = 1;
+  else if (iface % 2 == 1 && hi[idim] == boxhi[idim]) boundary = 1;
+  else boundary = 0;
+  if (bflag[iface] == PERIODIC) periodic = 1;
+  else periodic = 0;
+  if (dimension == 2 && (iface == ZLO || iface == ZHI))
+    periodic = 0;
+
+  // face = non-periodic boundary, neighbor is BOUND
+
+  if (boundary && !periodic) {
+    neigh[iface] = 0;
+    return neigh_encode(NBOUND,nmask,iface);
+  }
+
+  // neighID = ID of neighbor cell at same level as icell
+
+  neighID = id_neigh_same_parent(id,level,iface);
+  if (neighID == 0) neighID = id_neigh_same_level(id,level,iface);
+
+  // if in hash, neighbor is CHILD
+
+  if (hash->find(neighID) != hash->end()) {
+    neigh[iface] = (*hash)[neighID];
+    if (!boundary) return neigh_encode(NCHILD,nmask,iface);
+    return neigh_encode(NPBCHILD,nmask,iface);
+  }
+
+  // refine from neighID until reach maxlevel
+  // look for a child cell on touching face I do own (or ghost)
+  // if find one, neighbor is PARENT, add its ID and lo/hi to local pcells
+
+  face_touching = iface % 2 ? iface-1 : iface+1;
+  refineID = neighID;
+  ilevel = level;
+
+  while (ilevel < maxlevel) {
+    refineID = id_refine(refineID,ilevel,face_touching);
+    if (hash->find(refineID) != hash->end()) {
+      neigh[iface] = nparent;
+      if (!boundary) nmask = neigh_encode(NPARENT,nmask,iface);
+      else nmask = neigh_encode(NPBPARENT,nmask,iface);
+
+      if (nparent == maxparent) grow_pcells();
+      pcells[nparent].id = neighID;
+      id_lohi(neighID,level,boxlo,boxhi,pcells[nparent].lo,pcells[nparent].hi);
+      nparent++;
+      return nmask;
+    } else ilevel++;
+  }
+
+  // coarsen from neighID until reach top level
+  // if find one, neighbor is CHILD
+
+  coarsenID = neighID;
+  ilevel = level;
+
+  while (ilevel > 1) {
+    coarsenID = id_coarsen(coarsenID,ilevel);
+    if (hash->find(coarsenID) != hash->end()) {
+      neigh[iface] = (*hash)[coarsenID];
+      if (!boundary) return neigh_encode(NCHILD,nmask,iface);
+      return neigh_encode(NPBCHILD,nmask,iface);
+    } else ilevel--;
+  }
+
+  // found nothing, so UNKNOWN neighbor
+  // should never happend for an owned cell (error check in caller)
+  // can happen for a ghost cell
+
+  neigh[iface] = 0;
+  if (icell < nlocal) unknownflag = 1;
+  if (!boundary) return neigh_encode(NUNKNOWN,nmask,iface);
+  return neigh_encode(NPBUNKNOWN,nmask,iface);
+}
+
 /* ----------------------------------------------------------------------
    change neigh[] in owned cells that are local indices to global cell IDs
    nmask is not changed
@@ -1665,6 +2034,7 @@ void Grid::weight(int narg, char **arg)
     if (strcmp(arg[0],"none") == 0) cellweightflag = NOWEIGHT;
     else if (strcmp(arg[0],"volume") == 0) cellweightflag = VOLWEIGHT;
     else if (strcmp(arg[0],"radius") == 0) cellweightflag = RADWEIGHT;
+    else if (strcmp(arg[0],"uniform") == 0) cellweightflag = UNIFORMWEIGHT;
     else error->all(FLERR,"Illegal weight command");
   }
 
@@ -1677,28 +2047,66 @@ void Grid::weight(int narg, char **arg)
 }
 
 void Grid::weight_one(int icell)
+{
+  cinfo[icell].weight = weight_base(icell);
+}
+
+/* ----------------------------------------------------------------------
+   return weight of cell icell implied by cellweightflag
+   used by weight_one() and by fixes which modify cell weights
+------------------------------------------------------------------------- */
+
+double Grid::weight_base(int icell)
 {
   double *lo,*hi;
 
   int dimension = domain->dimension;
   int axisymmetric = domain->axisymmetric;
 
-  if (cellweightflag == NOWEIGHT) {
-    cinfo[icell].weight = 1.0;
-  } else if (cellweightflag == VOLWEIGHT) {
+  if (cellweightflag == VOLWEIGHT) {
     lo = cells[icell].lo;
     hi = cells[icell].hi;
     if (dimension == 3)
-      cinfo[icell].weight = (hi[0]-lo[0]) * (hi[1]-lo[1]) * (hi[2]-lo[2]);
+      return (hi[0]-lo[0]) * (hi[1]-lo[1]) * (hi[2]-lo[2]);
     else if (axisymmetric)
-      cinfo[icell].weight = MY_PI * (hi[1]*hi[1]-lo[1]*lo[1]) * (hi[0]-lo[0]);
+      return MY_PI * (hi[1]*hi[1]-lo[1]*lo[1]) * (hi[0]-lo[0]);
     else
-      cinfo[icell].weight = (hi[0]-lo[0]) * (hi[1]-lo[1]);
+      return (hi[0]-lo[0]) * (hi[1]-lo[1]);
   } else if (cellweightflag == RADWEIGHT) {
     lo = cells[icell].lo;
     hi = cells[icell].hi;
-    cinfo[icell].weight = 0.5*(hi[1]+lo[1]) * (hi[0]-lo[0]);
+    return 0.5*(hi[1]+lo[1]) * (hi[0]-lo[0]);
+  }
+
+  return 1.0;
+}
+
+/* ----------------------------------------------------------------------
+   return ratio of weight of cell icell to its base weight
+   ratio is > 1 if cell was merged by fix merge, else 1
+   for a split cell, average over its sub cells weighted by particle count
+   used by grid adaptation to carry merged weights to new cells
+------------------------------------------------------------------------- */
+
+double Grid::weight_ratio(int icell)
+{
+  if (cells[icell].nsplit <= 1)
+    return cinfo[icell].weight / weight_base(icell);
+
+  int *csubs = sinfo[cells[icell].isplit].csubs;
+  int nsplit = cells[icell].nsplit;
+  int jcell;
+  double count = 0.0;
+  double wsum = 0.0;
+
+  for (int i = 0; i < nsplit; i++) {
+    jcell = csubs[i];
+    count += cinfo[jcell].count;
+    wsum += cinfo[jcell].count * cinfo[jcell].weight / weight_base(jcell);
   }
+
+  if (count == 0.0) return cinfo[icell].weight / weight_base(icell);
+  return wsum/count;
 }
 
 ///////////////////////////////////////////////////////////////////////////
@@ -2196,6 +2604,10 @@ int Grid::size_restart()
   n = IROUNDUP(n);
   n += nlocal * sizeof(int);
   n = IROUNDUP(n);
+  if (cellweightflag) {
+    n += nlocal * sizeof(double);
+    n = IROUNDUP(n);
+  }
   return n;
 }
 
@@ -2214,6 +2626,10 @@ int Grid::size_restart(int nlocal_restart)
   n = IROUNDUP(n);
   n += nlocal_restart * sizeof(int);
   n = IROUNDUP(n);
+  if (weightrestartflag) {
+    n += nlocal_restart * sizeof(double);
+    n = IROUNDUP(n);
+  }
   return n;
 }
 
@@ -2221,6 +2637,7 @@ int Grid::size_restart(int nlocal_restart)
    pack my child grid info into buf
    nlocal, clumped as scalars
    ID, level, nsplit as vectors for all owned cells
+   weight as vector if cell weighting is used, so merged weights persist
    // NOTE: worry about N overflowing int, and in IROUNDUP ???
 ------------------------------------------------------------------------- */
 
@@ -2252,6 +2669,14 @@ int Grid::pack_restart(char *buf)
   n += nlocal * sizeof(int);
   n = IROUNDUP(n);
 
+  if (cellweightflag) {
+    double *dbuf = (double *) &buf[n];
+    for (int i = 0; i < nlocal; i++)
+      dbuf[i] = cinfo[i].weight;
+    n += nlocal * sizeof(double);
+    n = IROUNDUP(n);
+  }
+
   return n;
 }
 
@@ -2259,6 +2684,7 @@ int Grid::pack_restart(char *buf)
    unpack child grid info into restart storage
    nlocal_restart, clumped as scalars
    id_restart, nsplit_restart as vectors
+   weight_restart as vector if file stores cell weights
    allocate vectors here, will be deallocated by ReadRestart
 ------------------------------------------------------------------------- */
 
@@ -2294,6 +2720,15 @@ int Grid::unpack_restart(char *buf)
   n += nlocal_restart * sizeof(int);
   n = IROUNDUP(n);
 
+  if (weightrestartflag) {
+    memory->create(weight_restart,nlocal_restart,"grid:weight_restart");
+    double *dbuf = (double *) &buf[n];
+    for (int i = 0; i < nlocal_restart; i++)
+      weight_restart[i] = dbuf[i];
+    n += nlocal_restart * sizeof(double);
+    n = IROUNDUP(n);
+  }
+
   return n;
 }
 
@@ -2306,6 +2741,9 @@ bigint Grid::memory_usage()
   bytes += maxsplit * sizeof(SplitInfo);
   bytes += csurfs->size();
   bytes += csplits->size();
+  if (findindex)
+    bytes += (bigint) (findhi[0]-findlo[0]+1) * (findhi[1]-findlo[1]+1) *
+      (findhi[2]-findlo[2]+1) * sizeof(int);
 
   return bytes;
 }
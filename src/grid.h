@@ -71,6 +71,8 @@ class Grid : protected Pointers {
   int *inversemask;     // inverse mask for each group
 
   double tmap,tsplit;   // timing breakdowns of both grid2surf() algs
+  double tcut,tsub;     // breakdown of tsplit: cut cells, create sub cells
+  int nthreads;         // # of threads used by surf2grid() loops
   double tcomm1,tcomm2,tcomm3,tcomm4;
 
   int copy,copymode;    // 1 if copy of class (prevents deallocation of
@@ -233,6 +235,8 @@ class Grid : protected Pointers {
   int nlocal_restart;
   cellint *id_restart;
   int *level_restart,*nsplit_restart;
+  int weightrestartflag;      // 1 if restart file stores cell weights
+  double *weight_restart;
 
   class GridCommMacro* gridCommMacro;
   // methods
@@ -249,6 +253,7 @@ class Grid : protected Pointers {
   void set_maxlevel();
   void setup_owned();
   void remove_ghosts();
+  void stash_ghosts();
   void acquire_ghosts(int surfflag=1);
   void rehash();
   void find_neighbors();
@@ -259,6 +264,8 @@ class Grid : protected Pointers {
   void type_check(int flag=1);
   void weight(int, char **);
   void weight_one(int);
+  double weight_base(int);
+  double weight_ratio(int);
 
   void refine_cell(int, int *, class Cut2d *, class Cut3d *);
   void coarsen_cell(cellint, int, double *, double *,
@@ -293,8 +300,9 @@ class Grid : protected Pointers {
 
   // grid_surf.cpp
 
-  void surf2grid(int, int outflag=1);
-  void surf2grid_implicit(int, int outflag=1);
+  void surf2grid(int, int outflag=1, int *skipflag=NULL);
+  void surf2grid_implicit(int, int outflag=1, int *skipflag=NULL);
+  void surf2grid_restore_one(int, int, double *, int *, int *, int, double *);
   void surf2grid_one(int, int, int, int, class Cut3d *, class Cut2d *);
   void clear_surf();
   void clear_surf_restart();
@@ -351,6 +359,12 @@ class Grid : protected Pointers {
   class Cut2d *cut2d;
   class Cut3d *cut3d;
 
+  // per-thread copies used by threaded surf2grid() loops
+  // index 0 = cut2d or cut3d, others are created by create_thread_cuts()
+
+  class Cut2d **cut2d_thread;
+  class Cut3d **cut3d_thread;
+
   // connection between one of my cells and a neighbor cell on another proc
 
   struct Connect {
@@ -407,10 +421,13 @@ class Grid : protected Pointers {
 
   // private methods
 
-  void surf2grid_cell_algorithm(int);
-  void surf2grid_new_algorithm(int);
+  void surf2grid_cell_algorithm(int, int *skipflag=NULL);
+  void surf2grid_new_algorithm(int, int *skipflag=NULL);
   void surf2grid_surf_algorithm(int, int);
-  void surf2grid_split(int, int);
+  void surf2grid_split(int, int, int *skipflag=NULL);
+  void split_one(int, int, double *, int *, int, double *);
+  void create_thread_cuts();
+  void destroy_thread_cuts();
 
   void partition_grid(int, int, int, int, int, int, int, int, GridTree *);
   void mybox(int, int, int, int &, int &, int &, int &, int &, int &,
@@ -419,6 +436,11 @@ class Grid : protected Pointers {
 
   void acquire_ghosts_all(int);
   void acquire_ghosts_near(int);
+  void acquire_ghosts_delta(int);
+  void unstash_ghosts();
+  int nremove_below(int, int, int *);
+  void unknown_neighbors(int);
+  int find_neighbor(int, int, int, int &);
 
   void box_intersect(double *, double *, double *, double *,
                      double *, double *);
@@ -438,6 +460,43 @@ class Grid : protected Pointers {
   int unpack_ghosts_surfflag;
   static void unpack_ghosts(int, char *, void *);
 
+  // ghost cells stashed by stash_ghosts() before grid adaptation
+  // acquire_ghosts() patches them with each proc's changes
+
+  int allghost_surfflag;      // surfflag of ghosts acquired from all procs
+                              // -1 if ghosts are only nearby cells
+  int ghoststash;             // 1 if ghosts are stashed
+  int nstash;                 // # of stashed unsplit and split ghosts
+  char *stashbuf;             // packed stashed ghosts, in ghost order
+  int *stashoffset;           // offset of each stashed ghost in stashbuf
+  int *stashilocal;           // index of each stashed ghost on its owner
+  int *stashicell;            // index of each stashed ghost before adaptation
+                              // -1 if its neigh were not set on this proc
+  int *stashfirst,*stashcount;  // stashed ghosts from each proc
+  int *origin;                // index before adaptation of each owned cell
+                              // -1 if cell was created by adaptation
+  int ntrack;                 // # of owned cells with a valid origin
+  int norigin,maxorigin;      // # of owned cells before adaptation, length
+  int nprior;                 // # of owned + ghost cells before adaptation
+
+  // set by acquire_ghosts_delta(), used and freed by find_neighbors()
+  // so it only searches neighbors of faces adaptation may have changed
+
+  int *remap;                 // new index of each cell before adaptation
+                              // -1 if cell no longer exists
+  int nremap;                 // length of remap
+  int ghostneigh;             // 1 if ghost neigh are set by find_neighbors()
+
+  // dense index of the child grid of the root cell
+  // lets id_find_child() from the root skip the hash for level 1 cells
+  // rebuilt on demand after rehash(), entries are checked before use
+
+  int findflag;               // 1 if findindex is current
+  int findlo[3],findhi[3];    // bounds of indexed block of root child grid
+  int *findindex;             // local index of level 1 cell, -1 if none
+
+  void find_index();
+
   // callback functions for rendezvous communication
 
   static int rendezvous_surfrequest(int, char *, int &, int *&, char *&, void *);
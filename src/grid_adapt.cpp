@@ -52,6 +52,12 @@ void Grid::refine_cell(int icell, int *childlist, Cut2d *cut2d, Cut3d *cut3d)
   int ny = plevels[plevel].ny;
   int nz = plevels[plevel].nz;
 
+  // new child cells keep ratio of parent weight to its base weight
+  //   so particles of a merged parent represent the same # of molecules
+
+  double wratio = 1.0;
+  if (cellweightflag) wratio = weight_ratio(icell);
+
   // loop over creation of new child cells
   // add new children to hash, so id_find_child() for particles will work
   // set plo/phi inside loop b/c cells can be realloced by add_child_cell()
@@ -69,6 +75,7 @@ void Grid::refine_cell(int icell, int *childlist, Cut2d *cut2d, Cut3d *cut3d)
         add_child_cell(childID,plevel+1,lo,hi);
         cells[nlocal - 1].dt_weight = cells[icell].dt_weight;
         weight_one(nlocal-1);
+        cinfo[nlocal-1].weight *= wratio;
 	(*hash)[childID] = nlocal-1;
 	
         // update any per grid fixes for the new child cell
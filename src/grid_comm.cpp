@@ -687,6 +687,14 @@ void Grid::compress()
   int ncurrent = nlocal;
   nlocal = nunsplitlocal = nsplitlocal = nsublocal = 0;
 
+  // if ghosts are stashed, track pre-adaptation index of each kept cell
+  // cells added since last compress are new, flagged with -1
+
+  if (ghoststash && ncurrent > maxorigin) {
+    maxorigin = ncurrent;
+    memory->grow(origin,maxorigin,"grid:origin");
+  }
+
   for (int icell = 0; icell < ncurrent; icell++) {
 
     // unsplit and sub cells
@@ -705,6 +713,7 @@ void Grid::compress()
       }
 
       cells[nlocal].ilocal = nlocal;
+      if (ghoststash) origin[nlocal] = icell < ntrack ? origin[icell] : -1;
 
       // for unsplit cell, new copy of all csurfs indices
       // for sub cell, just copy csurfs ptr from its split cell
@@ -755,6 +764,7 @@ void Grid::compress()
       }
 
       cells[nlocal].ilocal = nlocal;
+      if (ghoststash) origin[nlocal] = icell < ntrack ? origin[icell] : -1;
 
       // new copy of all csurfs indices
 
@@ -798,6 +808,8 @@ void Grid::compress()
     }
   }
 
+  if (ghoststash) ntrack = nlocal;
+
   // reset final grid cell count in collide and fixes
 
   if (collide) collide->reset_grid_count(nlocal);
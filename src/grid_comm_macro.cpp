@@ -67,6 +67,7 @@ using namespace MathConst;
 enum { PERIODIC, OUTFLOW, REFLECT, SURFACE, AXISYM };  // same as Domain
 enum { XLO, XHI, YLO, YHI, ZLO, ZHI, INTERIOR };       // same as Domain
 enum { OUTSIDE, INSIDE, ONSURF2OUT, ONSURF2IN };      // several files
+enum { FAR, NEAR, CUT };                               // wall class of a cell
 /* ---------------------------------------------------------------------- */
 
 GridCommMacro::GridCommMacro(SPARTA* sparta) : Pointers(sparta) {
@@ -92,6 +93,15 @@ GridCommMacro::GridCommMacro(SPARTA* sparta) : Pointers(sparta) {
     irregular = new Irregular(sparta);
     count_sumInter = count_surfInter = count_originInter = count_neighInter =
         count_boundInter = count_outInter = count_warningInter = 0;
+    count_farInter = count_nearInter = count_cutInter = 0;
+
+    classflag = 0;
+    nwallclass = maxwallclass = 0;
+    wallclass = NULL;
+
+    nboxme = nboxall = nboxlist = 0;
+    boxall = NULL;
+    boxlist = NULL;
 }
 
 /* ---------------------------------------------------------------------- */
@@ -107,6 +117,9 @@ GridCommMacro::~GridCommMacro(){
     delete[] sbuf;
     delete irregular;
     delete random;
+    memory->destroy(wallclass);
+    delete[] boxall;
+    memory->destroy(boxlist);
 
 }
 
@@ -122,10 +135,206 @@ void GridCommMacro::acquire_macro_comm_list_near()
     //if (grid->cutoff >= 0.0) error->one(FLERR, "Macro Comm: cutoff >=0.0");
     if (!grid->exist_ghost) error->one(FLERR, "Macro Comm: Ghost cell not exist");
 
+    int i;
+    nboxme = owned_boxes(ownlo, ownhi, boxme);
+
+    // boxall = collection of boxes from all procs
+
+    int me = comm->me;
+    int nprocs = comm->nprocs;
+
+    MPI_Allreduce(&nboxme, &nboxall, 1, MPI_INT, MPI_SUM, world);
+
+    int* recvcounts, * displs;
+    memory->create(recvcounts, nprocs, "grid:recvcounts");
+    memory->create(displs, nprocs, "grid:displs");
+
+    int nsend = nboxme * sizeof(Grid::Box);
+    MPI_Allgather(&nsend, 1, MPI_INT, recvcounts, 1, MPI_INT, world);
+    displs[0] = 0;
+    for (i = 1; i < nprocs; i++) displs[i] = displs[i - 1] + recvcounts[i - 1];
+
+    delete[] boxall;
+    boxall = new Grid::Box[nboxall];
+    MPI_Allgatherv(boxme, nsend, MPI_CHAR, boxall, recvcounts, displs, MPI_CHAR, world);
+
+    memory->destroy(recvcounts);
+    memory->destroy(displs);
+
+    // nboxlist = # of boxes that overlap with my bbox, skipping self boxes
+    // boxlist = indices into boxall of overlaps
+    // overlap = true overlap or just touching
+
+    nboxlist = 0;
+    memory->destroy(boxlist);
+    memory->create(boxlist, nboxall, "grid:list");
+
+    for (i = 0; i < nboxall; i++) {
+        if (boxall[i].proc == me) continue;
+        if (grid->box_overlap(ownlo, ownhi, boxall[i].lo, boxall[i].hi)) boxlist[nboxlist++] = i;
+    }
+
+    setup_send();
+
+    // now cell list I send out is storaged in sbuf at intervals
+    // NOTE: sizeof(CommMacro) >= sizeof(cellint) must be guaranteed.
+    for (int i = 0; i < ncellsendall; ++i) {
+        memcpy(sbuf + i * sizeof(CommMacro), &(grid->cells[sendcelllist[i]].id), sizeof(cellint));
+    }
+
+    // perform irregular communication of list of neigh cells 
+    // whose V&T needed to be transfer.
+
+    nrecvproc = irregular->create_data_variable(nsendproc, proclist, sizelist,
+        recvsize, 1); // must sort, such that CommMacro I recv is in fixed order
+    nrecvcell = recvsize / sizeof(CommMacro);
+    memory->destroy(rbuf);
+    memory->create(rbuf, recvsize, "gridCommMacro:rbuf");
+    memset(rbuf, 0, recvsize);
+
+    irregular->exchange_variable(sbuf, sizelist, rbuf);
+    memory->destroy(recvicelllist);
+    memory->create(recvicelllist, nrecvcell,"GridCommMacro:recvicellist");
+    if (!grid->hashfilled) {
+        grid->rehash(); // need to be done when create_grid
+        grid->hashfilled = 1;
+    }
+    for (int i = 0; i < nrecvcell; ++i) {
+        cellint id = 0;
+        memcpy(&id, rbuf + i * sizeof(CommMacro), sizeof(cellint));
+        if (grid->hash->find(id) != grid->hash->end()) {
+            recvicelllist[i] = (*(grid->hash))[id];
+        }
+        else {
+            error->one(FLERR, "GridCommMacro : no such owned or ghost cell");
+        }
+    }
+
+    // grid or its ghosts changed, e.g. after surf2grid or adapt
+    // wall classes are recomputed at next interpolation
+
+    classflag = 0;
+}
+
+/* ----------------------------------------------------------------------
+   ghost cell I receive macro values of, sorted by owning proc and
+     index on owning proc, same order the sorted irregular comm delivers
+------------------------------------------------------------------------- */
+
+struct RecvSort {
+    int proc, ilocal, icell;
+};
+
+/* ----------------------------------------------------------------------
+   comparison function invoked by qsort() called by update_macro_comm_list()
+   this is not a class method
+------------------------------------------------------------------------- */
+
+static int compare_recvsort(const void* iptr, const void* jptr)
+{
+    const RecvSort* i = (const RecvSort*)iptr;
+    const RecvSort* j = (const RecvSort*)jptr;
+    if (i->proc != j->proc) return i->proc < j->proc ? -1 : 1;
+    if (i->ilocal != j->ilocal) return i->ilocal < j->ilocal ? -1 : 1;
+    return 0;
+}
+
+/* ----------------------------------------------------------------------
+   patch plan after ghosts were patched with an adaptation delta
+   if no proc's boxes changed, the cells each proc sends are found
+     locally from the kept boxes, so are the ghosts I receive,
+     since a ghost is sent to me iff it truly overlaps one of my boxes
+   the irregular plan is only recreated if any send count changed
+   else fall back to acquire_macro_comm_list_near()
+------------------------------------------------------------------------- */
+
+void GridCommMacro::update_macro_comm_list()
+{
+    if (!grid->exist_ghost) error->one(FLERR, "Macro Comm: Ghost cell not exist");
+
+    int i, j;
+    double bblo[3], bbhi[3];
+    Grid::Box box[27];
+    int nbox = owned_boxes(bblo, bbhi, box);
+
+    int flag = 0;
+    if (boxall == NULL || nbox != nboxme) flag = 1;
+    for (i = 0; i < 3 && !flag; i++)
+        if (bblo[i] != ownlo[i] || bbhi[i] != ownhi[i]) flag = 1;
+    for (i = 0; i < nbox && !flag; i++)
+        for (j = 0; j < 3; j++)
+            if (box[i].lo[j] != boxme[i].lo[j] || box[i].hi[j] != boxme[i].hi[j]) flag = 1;
+
+    int flagall;
+    MPI_Allreduce(&flag, &flagall, 1, MPI_INT, MPI_MAX, world);
+    if (flagall) {
+        acquire_macro_comm_list_near();
+        return;
+    }
+
+    // rebuild my send list, new plan only if any proc's counts changed
+
+    int* nsendold = new int[nprocs];
+    memcpy(nsendold, nsendeachproc, sizeof(int) * nprocs);
+    setup_send();
+    flag = memcmp(nsendold, nsendeachproc, sizeof(int) * nprocs) ? 1 : 0;
+    delete[] nsendold;
+
+    MPI_Allreduce(&flag, &flagall, 1, MPI_INT, MPI_MAX, world);
+    if (flagall) {
+        nrecvproc = irregular->create_data_variable(nsendproc, proclist, sizelist,
+            recvsize, 1);
+        nrecvcell = recvsize / sizeof(CommMacro);
+        memory->destroy(rbuf);
+        memory->create(rbuf, recvsize, "gridCommMacro:rbuf");
+        memset(rbuf, 0, recvsize);
+    }
+
+    // recv list = ghosts that truly overlap one of my boxes
+    // in order of sorted irregular comm: by proc, then by index on proc
+
+    Grid::ChildCell* cells = grid->cells;
+    int nlocal = grid->nlocal;
+    int nall = nlocal + grid->nghost;
+
+    RecvSort* rsort = new RecvSort[nrecvcell];
+
+    int n = 0;
+    for (int icell = nlocal; icell < nall; icell++) {
+        if (cells[icell].nsplit <= 0) continue;
+        for (i = 0; i < nboxme; i++)
+            if (grid->box_overlap(cells[icell].lo, cells[icell].hi,
+                boxme[i].lo, boxme[i].hi) == 1) break;
+        if (i == nboxme) continue;
+        if (n == nrecvcell) error->one(FLERR, "GridCommMacro : recv list mismatch");
+        rsort[n].proc = cells[icell].proc;
+        rsort[n].ilocal = cells[icell].ilocal;
+        rsort[n].icell = icell;
+        n++;
+    }
+    if (n != nrecvcell) error->one(FLERR, "GridCommMacro : recv list mismatch");
+
+    qsort(rsort, nrecvcell, sizeof(RecvSort), compare_recvsort);
+
+    memory->destroy(recvicelllist);
+    memory->create(recvicelllist, nrecvcell, "GridCommMacro:recvicellist");
+    for (i = 0; i < nrecvcell; i++) recvicelllist[i] = rsort[i].icell;
+    delete[] rsort;
+
+    classflag = 0;
+}
+
+/* ----------------------------------------------------------------------
+   bboxes of my owned cells, extended by size of my coarsest cells
+     and split across periodic BC
+   return # of boxes, bblo/bbhi = unextended bbox
+------------------------------------------------------------------------- */
+
+int GridCommMacro::owned_boxes(double* bblo, double* bbhi, Grid::Box* box)
+{
     // bb lo/hi = bounding box of my owned cells
 
     int i;
-    double bblo[3], bbhi[3];
     double* lo, * hi;
 
     for (i = 0; i < 3; i++) {
@@ -187,63 +396,34 @@ void GridCommMacro::acquire_macro_comm_list_near()
     // box = ebbox split across periodic BC
     // 27 is max number of periodic images in 3d
 
-    Grid::Box box[27];
-    int nbox = grid->box_periodic(ebblo, ebbhi, box);
-
-    // boxall = collection of boxes from all procs
-
-    int me = comm->me;
-    int nprocs = comm->nprocs;
-
-    int nboxall;
-    MPI_Allreduce(&nbox, &nboxall, 1, MPI_INT, MPI_SUM, world);
-
-    int* recvcounts, * displs;
-    memory->create(recvcounts, nprocs, "grid:recvcounts");
-    memory->create(displs, nprocs, "grid:displs");
-
-    int nsend = nbox * sizeof(Grid::Box);
-    MPI_Allgather(&nsend, 1, MPI_INT, recvcounts, 1, MPI_INT, world);
-    displs[0] = 0;
-    for (i = 1; i < nprocs; i++) displs[i] = displs[i - 1] + recvcounts[i - 1];
-
-    Grid::Box* boxall = new Grid::Box[nboxall];
-    MPI_Allgatherv(box, nsend, MPI_CHAR, boxall, recvcounts, displs, MPI_CHAR, world);
-
-    memory->destroy(recvcounts);
-    memory->destroy(displs);
-
-    // nlist = # of boxes that overlap with my bbox, skipping self boxes
-    // list = indices into boxall of overlaps
-    // overlap = true overlap or just touching
-
-    int nlist = 0;
-    int* list;
-    memory->create(list, nboxall, "grid:list");
+    return grid->box_periodic(ebblo, ebbhi, box);
+}
 
-    for (i = 0; i < nboxall; i++) {
-        if (boxall[i].proc == me) continue;
-        if (grid->box_overlap(bblo, bbhi, boxall[i].lo, boxall[i].hi)) list[nlist++] = i;
-    }
+/* ----------------------------------------------------------------------
+   set send plan of my owned cells from boxall and boxlist
+------------------------------------------------------------------------- */
 
+void GridCommMacro::setup_send()
+{
     // loop over my owned cells, not including sub cells
     // each may overlap with multiple boxes in list
     // on 1st pass, just tally memory to send copies of my cells
     // use lastproc to insure a cell only overlaps once per other proc
-    // if oflag = 2 = my cell just touches box,
-    // so flag grid cell as EMPTY ghost by setting nsurf = -1
 
-    int j, oflag, lastproc, nsurf_hold;
+    int i, j, oflag, lastproc;
+    double* lo, * hi;
+    Grid::ChildCell*& cells = grid->cells;
+    int& nlocal = grid->nlocal;
 
-    nsend = 0;
+    int nsend = 0;
     memset(nsendeachproc, 0, sizeof(int) * nprocs);
     for (int icell = 0; icell < nlocal; icell++) {
         if (cells[icell].nsplit <= 0) continue;
         lo = cells[icell].lo;
         hi = cells[icell].hi;
         lastproc = -1;
-        for (i = 0; i < nlist; i++) {
-            j = list[i];
+        for (i = 0; i < nboxlist; i++) {
+            j = boxlist[i];
             oflag = grid->box_overlap(lo, hi, boxall[j].lo, boxall[j].hi);
             if (oflag != 1) continue;
             if (boxall[j].proc == lastproc) continue;
@@ -282,8 +462,8 @@ void GridCommMacro::acquire_macro_comm_list_near()
         lo = cells[icell].lo;
         hi = cells[icell].hi;
         lastproc = -1;
-        for (i = 0; i < nlist; i++) {
-            j = list[i];
+        for (i = 0; i < nboxlist; i++) {
+            j = boxlist[i];
             oflag = grid->box_overlap(lo, hi, boxall[j].lo, boxall[j].hi);
             if (oflag != 1) continue;
             if (boxall[j].proc == lastproc) continue;
@@ -292,49 +472,144 @@ void GridCommMacro::acquire_macro_comm_list_near()
         }
     } 
 
-    // now cell list I send out is storaged in sbuf at intervals
-    // NOTE: sizeof(CommMacro) >= sizeof(cellint) must be guaranteed.
-    for (int i = 0; i < ncellsendall; ++i) {
-        memcpy(sbuf + i * sizeof(CommMacro), &(grid->cells[sendcelllist[i]].id), sizeof(cellint));
-    }
-
     //DEBUG
     for (int i = 0; i < nprocs - 1; ++i) {
         if (sf[i] != sendfirst[i + 1])
             error->one(FLERR, "sendcelllist set error!");
     }
 
-    // clean up
     delete[] sf;
-    memory->destroy(list);
-    delete[] boxall;
+}
 
-    // perform irregular communication of list of neigh cells 
-    // whose V&T needed to be transfer.
+/* ----------------------------------------------------------------------
+   classify each owned cell by distance to surfs, for interpolation()
+   a jitter moves a point at most 1/2 cell size in each dim,
+     so reach of a cell = its box expanded by 1/2 its size
+   CUT = cell has surfs
+   NEAR = reach overlaps or touches a cut owned/ghost cell,
+          or reaches the simulation box boundary
+   FAR = neither, interpolation can skip all boundary and surf tests
+   cut cells are binned so each cell only checks nearby cut cells
+------------------------------------------------------------------------- */
 
-    nrecvproc = irregular->create_data_variable(nsendproc, proclist, sizelist,
-        recvsize, 1); // must sort, such that CommMacro I recv is in fixed order
-    nrecvcell = recvsize / sizeof(CommMacro);
-    memory->create(rbuf, recvsize, "gridCommMacro:rbuf");
-    memset(rbuf, 0, recvsize);
+void GridCommMacro::classify_cells()
+{
+    int i, j, k, m, icell, flag;
+    int dim = domain->dimension;
+    double* boxlo = domain->boxlo;
+    double* boxhi = domain->boxhi;
 
-    irregular->exchange_variable(sbuf, sizelist, rbuf);
-    memory->destroy(recvicelllist);
-    memory->create(recvicelllist, nrecvcell,"GridCommMacro:recvicellist");
-    if (!grid->hashfilled) {
-        grid->rehash(); // need to be done when create_grid
-        grid->hashfilled = 1;
+    Grid::ChildCell* cells = grid->cells;
+    int nlocal = grid->nlocal;
+    int nall = nlocal + grid->nghost;
+
+    if (nlocal > maxwallclass) {
+        maxwallclass = nlocal;
+        memory->destroy(wallclass);
+        memory->create(wallclass, maxwallclass, "gridCommMacro:wallclass");
     }
-    for (int i = 0; i < nrecvcell; ++i) {
-        cellint id = 0;
-        memcpy(&id, rbuf + i * sizeof(CommMacro), sizeof(cellint));
-        if (grid->hash->find(id) != grid->hash->end()) {
-            recvicelllist[i] = (*(grid->hash))[id];
+    nwallclass = nlocal;
+    classflag = 1;
+    if (nlocal == 0) return;
+
+    // binsize = largest owned cell size in each dim
+    // bblo/bbhi = bounding box of reach of all owned cells
+
+    double half, binsize[3], bblo[3], bbhi[3], rlo[3], rhi[3];
+    for (i = 0; i < 3; i++) {
+        binsize[i] = 0.0;
+        bblo[i] = cells[0].lo[i];
+        bbhi[i] = cells[0].hi[i];
+    }
+
+    for (icell = 0; icell < nlocal; icell++) {
+        for (i = 0; i < dim; i++) {
+            half = 0.5 * (cells[icell].hi[i] - cells[icell].lo[i]);
+            binsize[i] = MAX(binsize[i], 2.0 * half);
+            bblo[i] = MIN(bblo[i], cells[icell].lo[i] - half);
+            bbhi[i] = MAX(bbhi[i], cells[icell].hi[i] + half);
         }
-        else {
-            error->one(FLERR, "GridCommMacro : no such owned or ghost cell");
+    }
+
+    int nbin[3] = { 1,1,1 };
+    for (i = 0; i < dim; i++)
+        nbin[i] = MAX(1, static_cast<int> ((bbhi[i] - bblo[i]) / binsize[i]));
+    bigint nbins = (bigint) nbin[0] * nbin[1] * nbin[2];
+    if (nbins > MAXSMALLINT) error->one(FLERR, "Too many bins for wall classes");
+
+    // bin each cut child cell, owned or ghost, that overlaps the reach bbox
+    // sub cells are skipped, their split cell has the same box
+    // a cut cell is linked only in the bin of its lo corner,
+    //   maxspan = most bins any cut cell spans, so search that far below
+
+    int* binhead, * next;
+    memory->create(binhead, nbins, "gridCommMacro:binhead");
+    memory->create(next, nall, "gridCommMacro:next");
+    for (m = 0; m < nbins; m++) binhead[m] = -1;
+
+    int lo[3], hi[3], maxspan[3];
+    for (i = 0; i < 3; i++) lo[i] = hi[i] = maxspan[i] = 0;
+
+    int ncut = 0;
+    for (icell = 0; icell < nall; icell++) {
+        if (cells[icell].nsurf <= 0 || cells[icell].nsplit <= 0) continue;
+        if (!grid->box_overlap(cells[icell].lo, cells[icell].hi, bblo, bbhi))
+            continue;
+        for (i = 0; i < dim; i++) {
+            lo[i] = static_cast<int> ((cells[icell].lo[i] - bblo[i]) / binsize[i]);
+            lo[i] = MAX(0, MIN(lo[i], nbin[i] - 1));
+            maxspan[i] = MAX(maxspan[i], static_cast<int>
+                ((cells[icell].hi[i] - cells[icell].lo[i]) / binsize[i]) + 1);
+        }
+        m = (lo[2] * nbin[1] + lo[1]) * nbin[0] + lo[0];
+        next[icell] = binhead[m];
+        binhead[m] = icell;
+        ncut++;
+    }
+
+    for (icell = 0; icell < nlocal; icell++) {
+        if (cells[icell].nsurf > 0) {
+            wallclass[icell] = CUT;
+            continue;
+        }
+
+        // reach of cell, NEAR if it touches the simulation box boundary
+
+        flag = FAR;
+        for (i = 0; i < 3; i++) {
+            rlo[i] = cells[icell].lo[i];
+            rhi[i] = cells[icell].hi[i];
+        }
+        for (i = 0; i < dim; i++) {
+            half = 0.5 * (cells[icell].hi[i] - cells[icell].lo[i]);
+            rlo[i] -= half;
+            rhi[i] += half;
+            if (rlo[i] <= boxlo[i] || rhi[i] >= boxhi[i]) flag = NEAR;
+        }
+
+        if (flag == FAR && ncut) {
+            for (i = 0; i < dim; i++) {
+                lo[i] = static_cast<int> ((rlo[i] - bblo[i]) / binsize[i]);
+                hi[i] = static_cast<int> ((rhi[i] - bblo[i]) / binsize[i]);
+                lo[i] = MAX(0, lo[i] - maxspan[i]);
+                hi[i] = MIN(nbin[i] - 1, hi[i]);
+            }
+            for (k = lo[2]; k <= hi[2] && flag == FAR; k++)
+                for (j = lo[1]; j <= hi[1] && flag == FAR; j++)
+                    for (i = lo[0]; i <= hi[0] && flag == FAR; i++)
+                        for (m = binhead[(k * nbin[1] + j) * nbin[0] + i];
+                             m >= 0; m = next[m])
+                            if (grid->box_overlap(rlo, rhi, cells[m].lo, cells[m].hi)) {
+                                flag = NEAR;
+                                break;
+                            }
         }
+
+        wallclass[icell] = flag;
     }
+
+    memory->destroy(binhead);
+    memory->destroy(next);
 }
 
 /* ----------------------------------------------------------------------
@@ -382,9 +657,60 @@ const CommMacro* GridCommMacro::interpolation(Particle::OnePart* ipart)
     }
     this->ipart = ipart;
     ++count_sumInter;
+
+    // cells far from any wall or boundary skip all geometry tests
+
+    if (!classflag) classify_cells();
+    if (ipart->icell < nwallclass) {
+        int flag = wallclass[ipart->icell];
+        if (flag == FAR) {
+            ++count_farInter;
+            return interpolation_far();
+        }
+        if (flag == NEAR) ++count_nearInter;
+        else ++count_cutInter;
+    }
     return (this->*interptr)();
 }
 
+/* ----------------------------------------------------------------------
+   interpolation for a cell with no surfs or boundary within reach
+   same result as interpolation_2d/3d, without the geometry tests
+------------------------------------------------------------------------- */
+
+const CommMacro* GridCommMacro::interpolation_far()
+{
+    Grid::ChildCell* icell = &grid->cells[ipart->icell];
+    Grid::ChildCell* intercell = NULL;
+    double* lo = icell->lo; double* hi = icell->hi;
+    int dim = domain->dimension;
+
+    int inside = 1;
+    for (int i = 0; i < dim; ++i)
+        if (xnew[i] <= lo[i] || xnew[i] >= hi[i]) inside = 0;
+    if (inside) {
+        ++count_originInter;
+        return &icell->macro;
+    }
+
+    int id = grid->id_find_child(0, 0, domain->boxlo, domain->boxhi, xnew);
+    if (id == -1) {
+        id = ipart->icell;
+        ++count_warningInter;
+    }
+    intercell = &grid->cells[id];
+
+    // only the 2d path falls back to icell if it is not relaxed
+
+    if (intercell == icell) ++count_originInter;
+    else if (dim == 2 && !grid->cinfo[ipart->icell].macro.do_relaxation) {
+        ++count_warningInter;
+        intercell = icell;
+    }
+    else ++count_neighInter;
+    return &intercell->macro;
+}
+
 /* ----------------------------------------------------------------------
    interpolation for 2d simulation
 ------------------------------------------------------------------------- */
@@ -28,6 +28,7 @@
 #define SPARTA_GRID_COMM_MACRO_H
 
 #include "pointers.h"
+#include "grid.h"
 
 namespace SPARTA_NS {
 
@@ -38,6 +39,7 @@ public:
     ~GridCommMacro();
     void runComm();
     void acquire_macro_comm_list_near();
+    void update_macro_comm_list();
     const CommMacro* interpolation(class Particle::OnePart*);
     
     int nprocs, me;
@@ -62,6 +64,8 @@ public:
     // status
     bigint count_sumInter, count_surfInter, count_originInter, count_neighInter,
         count_boundInter, count_outInter, count_warningInter;
+    // interpolations started from far-from-wall / near-wall / cut cells
+    bigint count_farInter, count_nearInter, count_cutInter;
 
 private:
     double xnew[3], xhold[3];
@@ -71,6 +75,27 @@ private:
     const CommMacro* interpolation_2d();
     const CommMacro* interpolation_axisym();
     const CommMacro* interpolation_3d();
+    const CommMacro* interpolation_far();
+
+    // per-cell wall class of owned cells, set lazily after each new plan
+    // FAR = no cut cell or domain boundary within reach of a jitter
+    // NEAR = a cut cell or boundary within reach, CUT = cell has surfs
+    int classflag;              // 1 if wallclass is current
+    int nwallclass, maxwallclass;
+    int* wallclass;
+    void classify_cells();
+
+    // extended bboxes of last plan, kept so update_macro_comm_list()
+    // can reuse them while no proc's bbox of owned cells changes
+    int nboxme;                 // # of my boxes, split across periodic BC
+    Grid::Box boxme[27];
+    double ownlo[3], ownhi[3];  // bbox of my owned cells
+    int nboxall;                // boxes of all procs
+    Grid::Box* boxall;
+    int nboxlist;               // indices of boxes overlapping my bbox
+    int* boxlist;
+    int owned_boxes(double*, double*, Grid::Box*);
+    void setup_send();
 };
 
 
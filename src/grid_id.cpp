@@ -14,12 +14,15 @@
 
 #include "string.h"
 #include "grid.h"
+#include "memory.h"
 #include "error.h"
 
 using namespace SPARTA_NS;
 
 enum{XLO,XHI,YLO,YHI,ZLO,ZHI,INTERIOR};         // same as Domain
 
+#define FINDFACTOR 4    // max ratio of find index size to owned+ghost cells
+
 // operations with grid cell IDs
 // IMPORTANT: must be careful to use cellint (32 or 64 bit) in these cases
 //   any cell ID, child or parent
@@ -35,6 +38,8 @@ enum{XLO,XHI,YLO,YHI,ZLO,ZHI,INTERIOR};         // same as Domain
    recurse from parent downward until find a child cell or reach maxlevel
    if find child cell this proc stores (owned or ghost), return its local index
    else return -1 for unknown
+   from the root, a level 1 child cell is looked up in findindex first,
+     entry is used only if that cell still has the expected ID
 ------------------------------------------------------------------------- */
 
 int Grid::id_find_child(cellint parentID, int plevel,
@@ -49,6 +54,36 @@ int Grid::id_find_child(cellint parentID, int plevel,
   double *lo = oplo;
   double *hi = ophi;
 
+  if (level == 0 && maxlevel > 0 && hashfilled) {
+    if (!findflag) find_index();
+    if (findindex) {
+      nx = plevels[0].nx;
+      ny = plevels[0].ny;
+      nz = plevels[0].nz;
+      ix = static_cast<int> ((x[0]-lo[0]) * nx/(hi[0]-lo[0]));
+      iy = static_cast<int> ((x[1]-lo[1]) * ny/(hi[1]-lo[1]));
+      iz = static_cast<int> ((x[2]-lo[2]) * nz/(hi[2]-lo[2]));
+      if (ix == nx) ix--;
+      if (iy == ny) iy--;
+      if (iz == nz) iz--;
+
+      if (ix >= findlo[0] && ix <= findhi[0] &&
+          iy >= findlo[1] && iy <= findhi[1] &&
+          iz >= findlo[2] && iz <= findhi[2]) {
+        int mx = findhi[0] - findlo[0] + 1;
+        int my = findhi[1] - findlo[1] + 1;
+        int icell = findindex[((bigint) (iz-findlo[2])*my +
+                               (iy-findlo[1]))*mx + ix-findlo[0]];
+        if (icell >= 0 && icell < nlocal+nghost) {
+          ichild = (cellint) iz*nx*ny + (cellint) iy*nx + ix + 1;
+          childID = ichild << plevels[0].nbits;
+          if (cells[icell].id == childID && cells[icell].nsplit > 0)
+            return icell;
+        }
+      }
+    }
+  }
+
   while (level < maxlevel) {
     nx = plevels[level].nx;
     ny = plevels[level].ny;
@@ -76,6 +111,69 @@ int Grid::id_find_child(cellint parentID, int plevel,
   return -1;
 }
 
+/* ----------------------------------------------------------------------
+   build findindex for owned + ghost child cells at level 1
+   index covers the block of the root child grid holding the level 1
+     ancestors of those cells, so points this proc cannot resolve are
+     mostly outside it
+   no index if the block is too sparse, id_find_child() then uses the hash
+------------------------------------------------------------------------- */
+
+void Grid::find_index()
+{
+  int i,ix,iy,iz;
+  cellint ichild;
+
+  findflag = 1;
+  memory->destroy(findindex);
+  findindex = NULL;
+
+  int nx = plevels[0].nx;
+  int ny = plevels[0].ny;
+  int nbits = plevels[0].nbits;
+  cellint mask = ((cellint) 1 << plevels[0].newbits) - 1;
+
+  findlo[0] = findlo[1] = findlo[2] = MAXSMALLINT;
+  findhi[0] = findhi[1] = findhi[2] = -1;
+
+  int nall = nlocal + nghost;
+
+  for (int icell = 0; icell < nall; icell++) {
+    if (cells[icell].nsplit <= 0) continue;
+    ichild = ((cells[icell].id >> nbits) & mask) - 1;
+    ix = ichild % nx;
+    iy = (ichild / nx) % ny;
+    iz = ichild / ((cellint) nx*ny);
+    findlo[0] = MIN(findlo[0],ix);
+    findlo[1] = MIN(findlo[1],iy);
+    findlo[2] = MIN(findlo[2],iz);
+    findhi[0] = MAX(findhi[0],ix);
+    findhi[1] = MAX(findhi[1],iy);
+    findhi[2] = MAX(findhi[2],iz);
+  }
+
+  if (findhi[0] < 0) return;
+
+  int mx = findhi[0] - findlo[0] + 1;
+  int my = findhi[1] - findlo[1] + 1;
+  int mz = findhi[2] - findlo[2] + 1;
+  bigint nfind = (bigint) mx*my*mz;
+  if (nfind > (bigint) FINDFACTOR*nall) return;
+
+  memory->create(findindex,nfind,"grid:findindex");
+  for (i = 0; i < nfind; i++) findindex[i] = -1;
+
+  for (int icell = 0; icell < nall; icell++) {
+    if (cells[icell].nsplit <= 0) continue;
+    if (cells[icell].level != 1) continue;
+    ichild = (cells[icell].id >> nbits) - 1;
+    ix = ichild % nx - findlo[0];
+    iy = (ichild / nx) % ny - findlo[1];
+    iz = ichild / ((cellint) nx*ny) - findlo[2];
+    findindex[((bigint) iz*my + iy)*mx + ix] = icell;
+  }
+}
+
 /* ----------------------------------------------------------------------
    compute cell ID of the child cell in a full-box uniform grid at level
    xyz grid = indices (0 to N-1) of the child cell within full-box grid
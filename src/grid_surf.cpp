@@ -32,6 +32,10 @@
 #include "memory.h"
 #include "error.h"
 
+#if defined(_OPENMP)
+#include "omp.h"
+#endif
+
 using namespace SPARTA_NS;
 using namespace MathConst;
 
@@ -43,6 +47,8 @@ int compare_surfIDs(const void *, const void *);
 #define CHUNK 16
 #define EPSSURF 1.0e-4
 #define DELTA_SEND 16384
+#define DELTA_THREAD 1024
+#define CHUNK_THREAD 8
 
 enum{UNKNOWN,OUTSIDE,INSIDE,OVERLAP};         // several files
 enum{PERAUTO,PERCELL,PERSURF};                // several files
@@ -60,36 +66,41 @@ enum{SOUTSIDE,SINSIDE,ONSURF2OUT,ONSURF2IN};  // several files (changed 2 words)
    for distributed surfs, have to use surf alg
    PERAUTO option chooses based on total nsurfs vs nprocs
    see info on subflag, outflag options with surf2grid_split()
+   skipflag = optional per-cell flags, cells with flag set are not mapped
+     or cut, caller has already restored their surf list and cut info,
+     only used for non-distributed surfs
    called from Readsurf, MoveSurf, RemoveSurf, ReadRestart, and FixMoveSurf
 ------------------------------------------------------------------------- */
 
-void Grid::surf2grid(int subflag, int outflag)
+void Grid::surf2grid(int subflag, int outflag, int *skipflag)
 {
   if (surf->distributed) {
-    surf2grid_new_algorithm(outflag);
+    surf2grid_new_algorithm(outflag,skipflag);
   } else if (surfgrid_algorithm == PERAUTO) {
-    if (comm->nprocs > surf->nsurf) surf2grid_cell_algorithm(outflag);
-    else surf2grid_new_algorithm(outflag);
+    if (comm->nprocs > surf->nsurf)
+      surf2grid_cell_algorithm(outflag,skipflag);
+    else surf2grid_new_algorithm(outflag,skipflag);
   } else if (surfgrid_algorithm == PERCELL) {
-    surf2grid_cell_algorithm(outflag);
+    surf2grid_cell_algorithm(outflag,skipflag);
   } else if (surfgrid_algorithm == PERSURF) {
-    surf2grid_new_algorithm(outflag);
+    surf2grid_new_algorithm(outflag,skipflag);
   }
 
   // now have nsurf,csurfs list of local surfs that overlap each cell
   // compute cut volume and split info for each cell
 
-  surf2grid_split(subflag,outflag);
+  surf2grid_split(subflag,outflag,skipflag);
 }
 
 /* ----------------------------------------------------------------------
    find surfs that overlap owned grid cells
    algorithm: for each of my cells, check all surfs
+   skipflag = optional per-cell flags, cells with flag set are skipped
    in cells: set nsurf, csurfs
    in cinfo: set type=OVERLAP for cells with surfs
 ------------------------------------------------------------------------- */
 
-void Grid::surf2grid_cell_algorithm(int outflag)
+void Grid::surf2grid_cell_algorithm(int outflag, int *skipflag)
 {
   int i,nsurf,nontrans;
   double t1,t2;
@@ -114,6 +125,65 @@ void Grid::surf2grid_cell_algorithm(int outflag)
   // compute overlap of surfs with each cell I own
   // info stored in nsurf,csurfs
   // skip if nsplit <= 0 b/c split cells could exist if restarting
+  // threaded over cells, each thread stores surf lists in its own tsurfs,
+  //   then copy them into csurfs in cell order, same as a serial loop
+
+  create_thread_cuts();
+
+  int *cellnsurf,*celloffset,*cellthread;
+  memory->create(cellnsurf,nlocal,"surf2grid:cellnsurf");
+  memory->create(celloffset,nlocal,"surf2grid:celloffset");
+  memory->create(cellthread,nlocal,"surf2grid:cellthread");
+
+  surfint **tsurfs = new surfint*[nthreads];
+  int *maxtsurfs = new int[nthreads];
+  for (i = 0; i < nthreads; i++) {
+    tsurfs[i] = NULL;
+    maxtsurfs[i] = 0;
+  }
+
+#if defined(_OPENMP)
+#pragma omp parallel private(i,nsurf,lo,hi)
+#endif
+  {
+    int tid = 0;
+#if defined(_OPENMP)
+    tid = omp_get_thread_num();
+#endif
+    int n = 0;
+
+#if defined(_OPENMP)
+#pragma omp for schedule(dynamic,CHUNK_THREAD)
+#endif
+    for (int icell = 0; icell < nlocal; icell++) {
+      cellnsurf[icell] = 0;
+      if (cells[icell].nsplit <= 0) continue;
+      if (skipflag && skipflag[icell]) continue;
+
+      lo = cells[icell].lo;
+      hi = cells[icell].hi;
+      if (!box_overlap(lo,hi,slo,shi)) continue;
+
+      if (n+maxsurfpercell > maxtsurfs[tid]) {
+        maxtsurfs[tid] = n+maxsurfpercell+DELTA_THREAD;
+        memory->grow(tsurfs[tid],maxtsurfs[tid],"surf2grid:tsurfs");
+      }
+
+      if (dim == 3)
+        nsurf = cut3d_thread[tid]->surf2grid(cells[icell].id,lo,hi,
+                                             &tsurfs[tid][n],maxsurfpercell);
+      else
+        nsurf = cut2d_thread[tid]->surf2grid(cells[icell].id,lo,hi,
+                                             &tsurfs[tid][n],maxsurfpercell);
+
+      cellnsurf[icell] = nsurf;
+      celloffset[icell] = n;
+      cellthread[icell] = tid;
+      if (nsurf <= maxsurfpercell) n += nsurf;
+    }
+  }
+
+  destroy_thread_cuts();
 
   Surf::Line *lines = surf->lines;
   Surf::Tri *tris = surf->tris;
@@ -121,25 +191,14 @@ void Grid::surf2grid_cell_algorithm(int outflag)
   int max = 0;
 
   for (int icell = 0; icell < nlocal; icell++) {
-    if (cells[icell].nsplit <= 0) continue;
-
-    lo = cells[icell].lo;
-    hi = cells[icell].hi;
-    if (!box_overlap(lo,hi,slo,shi)) continue;
-
-    ptr = csurfs->vget();
-
-    if (dim == 3)
-      nsurf = cut3d->surf2grid(cells[icell].id,cells[icell].lo,cells[icell].hi,
-                               ptr,maxsurfpercell);
-    else
-      nsurf = cut2d->surf2grid(cells[icell].id,cells[icell].lo,cells[icell].hi,
-                               ptr,maxsurfpercell);
+    nsurf = cellnsurf[icell];
 
     if (nsurf > maxsurfpercell) {
       max = MAX(max,nsurf);
-      csurfs->vgot(0);
     } else if (nsurf) {
+      ptr = csurfs->vget();
+      memcpy(ptr,&tsurfs[cellthread[icell]][celloffset[icell]],
+             nsurf*sizeof(surfint));
       csurfs->vgot(nsurf);
       cells[icell].nsurf = nsurf;
       cells[icell].csurfs = ptr;
@@ -165,6 +224,13 @@ void Grid::surf2grid_cell_algorithm(int outflag)
     }
   }
 
+  for (i = 0; i < nthreads; i++) memory->destroy(tsurfs[i]);
+  delete [] tsurfs;
+  delete [] maxtsurfs;
+  memory->destroy(cellnsurf);
+  memory->destroy(celloffset);
+  memory->destroy(cellthread);
+
   // error if surf count exceeds maxsurfpercell in any cell
 
   int maxall;
@@ -189,11 +255,13 @@ void Grid::surf2grid_cell_algorithm(int outflag)
 /* ----------------------------------------------------------------------
    find surfs that overlap owned grid cells
    algorithm:
+   skipflag = optional per-cell flags, cells with flag set are not sent
+     to the rendezvous procs and keep their current surf list
    in cells: set nsurf, csurfs
    in cinfo: set type=OVERLAP for cells with surfs
 ------------------------------------------------------------------------- */
 
-void Grid::surf2grid_new_algorithm(int outflag)
+void Grid::surf2grid_new_algorithm(int outflag, int *skipflag)
 {
   int i,j,n,ix,iy,iz,icell,isurf;
   int xlo,xhi,ylo,yhi,zlo,zhi;
@@ -252,6 +320,18 @@ void Grid::surf2grid_new_algorithm(int outflag)
   int **pairs = NULL;
   int maxpair = 0;
 
+  // per-thread lists of surf/cell pairs
+
+  create_thread_cuts();
+
+  int **tpairs = new int*[nthreads];
+  int *ntpair = new int[nthreads];
+  int *maxtpair = new int[nthreads];
+  for (i = 0; i < nthreads; i++) {
+    tpairs[i] = NULL;
+    ntpair[i] = maxtpair[i] = 0;
+  }
+
   // which set of Lines or Tris to process
 
   Surf::Line *lines;
@@ -384,6 +464,7 @@ void Grid::surf2grid_new_algorithm(int outflag)
     for (icell = 0; icell < nlocal; icell++) {
       if (cells[icell].level != level) continue;
       if (cells[icell].nsplit <= 0) continue;
+      if (skipflag && skipflag[icell]) continue;
 
       ctr[0] = 0.5 * (cells[icell].lo[0] + cells[icell].hi[0]);
       ctr[1] = 0.5 * (cells[icell].lo[1] + cells[icell].hi[1]);
@@ -453,40 +534,79 @@ void Grid::surf2grid_new_algorithm(int outflag)
     if (dim == 2) rcblines = (Surf::Line *) rbuf1;
     else rcbtris = (Surf::Tri *) rbuf1;
 
+    // threaded over surfs, each thread builds its own list of pairs
+    // static schedule gives each thread a contiguous range of surfs,
+    //   so appending thread lists in thread order gives serial order
+
     int npair = 0;
-    int overlap;
 
-    for (i = 0; i < nrecv1; i++) {
-      if (dim == 2) surf->bbox_one(&rcblines[i],bblo,bbhi);
-      else surf->bbox_one(&rcbtris[i],bblo,bbhi);
-      id_find_child_uniform_level(level,0,boxlo,boxhi,bblo,sxlo,sylo,szlo);
-      id_find_child_uniform_level(level,1,boxlo,boxhi,bbhi,sxhi,syhi,szhi);
+#if defined(_OPENMP)
+#pragma omp parallel private(i,j,ix,iy,iz,childID,bblo,bbhi) \
+  private(sxlo,sxhi,sylo,syhi,szlo,szhi)
+#endif
+    {
+      int tid = 0;
+#if defined(_OPENMP)
+      tid = omp_get_thread_num();
+#endif
+      int overlap;
+      int m = 0;
+
+#if defined(_OPENMP)
+#pragma omp for schedule(static)
+#endif
+      for (i = 0; i < nrecv1; i++) {
+        if (dim == 2) surf->bbox_one(&rcblines[i],bblo,bbhi);
+        else surf->bbox_one(&rcbtris[i],bblo,bbhi);
+        id_find_child_uniform_level(level,0,boxlo,boxhi,bblo,sxlo,sylo,szlo);
+        id_find_child_uniform_level(level,1,boxlo,boxhi,bbhi,sxhi,syhi,szhi);
+
+        for (iz = szlo; iz <= szhi; iz++) {
+          for (iy = sylo; iy <= syhi; iy++) {
+            for (ix = sxlo; ix <= sxhi; ix++) {
+              childID = id_uniform_level(level,ix,iy,iz);
+              MyHash::iterator it = rcbhash->find(childID);
+              if (it == rcbhash->end()) continue;
+              j = it->second;
+
+              if (dim == 2)
+                overlap = cut2d_thread[tid]->
+                  surf2grid_one(rcblines[i].p1,rcblines[i].p2,
+                                rcblohi[j].lo,rcblohi[j].hi);
+              else
+                overlap = cut3d_thread[tid]->
+                  surf2grid_one(rcbtris[i].p1,rcbtris[i].p2,rcbtris[i].p3,
+                                rcblohi[j].lo,rcblohi[j].hi);
+              if (!overlap) continue;
+
+              if (m == maxtpair[tid]) {
+                maxtpair[tid] += DELTA_THREAD;
+                memory->grow(tpairs[tid],2*maxtpair[tid],"surf2grid:tpairs");
+              }
+              tpairs[tid][2*m] = i;
+              tpairs[tid][2*m+1] = j;
+              m++;
+            }
+          }
+        }
+      }
 
-      for (iz = szlo; iz <= szhi; iz++) {
-	for (iy = sylo; iy <= syhi; iy++) {
-	  for (ix = sxlo; ix <= sxhi; ix++) {
-	    childID = id_uniform_level(level,ix,iy,iz);
-	    if (rcbhash->find(childID) == rcbhash->end()) continue;
-	    j = (*rcbhash)[childID];
-	
-	    if (dim == 2)
-	      overlap = cut2d->surf2grid_one(rcblines[i].p1,rcblines[i].p2,
-					     rcblohi[j].lo,rcblohi[j].hi);
-	    else
-	      overlap = cut3d->surf2grid_one(rcbtris[i].p1,rcbtris[i].p2,
-					     rcbtris[i].p3,
-					     rcblohi[j].lo,rcblohi[j].hi);
-	    if (!overlap) continue;
-	
-	    if (npair == maxpair) {
-	      maxpair += DELTA_SEND;
-	      memory->grow(pairs,maxpair,2,"surf2grid:pairs");
-	    }
-	    pairs[npair][0] = i;
-	    pairs[npair][1] = j;
-	    npair++;
-	  }
-	}
+      ntpair[tid] = m;
+    }
+
+    for (int t = 0; t < nthreads; t++) npair += ntpair[t];
+    if (npair > maxpair) {
+      maxpair = npair;
+      memory->destroy(pairs);
+      memory->create(pairs,maxpair,2,"surf2grid:pairs");
+    }
+
+    n = 0;
+    for (int t = 0; t < nthreads; t++) {
+      for (int m = 0; m < ntpair[t]; m++) {
+        pairs[n][0] = tpairs[t][2*m];
+        pairs[n][1] = tpairs[t][2*m+1];
+        n++;
       }
     }
 
@@ -542,6 +662,7 @@ void Grid::surf2grid_new_algorithm(int outflag)
     for (icell = 0; icell < nlocal; icell++) {
       if (cells[icell].level != level) continue;
       if (cells[icell].nsplit <= 0) continue;
+      if (skipflag && skipflag[icell]) continue;
       nsurf = cells[icell].nsurf;
       if (nsurf) {
 	if (nsurf > maxsurfpercell)
@@ -590,6 +711,12 @@ void Grid::surf2grid_new_algorithm(int outflag)
   memory->destroy(plist);
   memory->sfree(gtree);
 
+  for (i = 0; i < nthreads; i++) memory->destroy(tpairs[i]);
+  delete [] tpairs;
+  delete [] ntpair;
+  delete [] maxtpair;
+  destroy_thread_cuts();
+
   // non-distributed surfs:
   // each cell's csurf list currently stores surf IDs
   // convert to indices into global list stored by each proc
@@ -614,6 +741,7 @@ void Grid::surf2grid_new_algorithm(int outflag)
     for (icell = 0; icell < nlocal; icell++) {
       if (!cells[icell].nsurf) continue;
       if (cells[icell].nsplit <= 0) continue;
+      if (skipflag && skipflag[icell]) continue;
 
       list = cells[icell].csurfs;
       n = cells[icell].nsurf;
@@ -642,6 +770,7 @@ void Grid::surf2grid_new_algorithm(int outflag)
     for (icell = 0; icell < nlocal; icell++) {
       if (!cells[icell].nsurf) continue;
       if (cells[icell].nsplit <= 0) continue;
+      if (skipflag && skipflag[icell]) continue;
 
       list = cells[icell].csurfs;
       n = cells[icell].nsurf;
@@ -726,6 +855,7 @@ void Grid::surf2grid_new_algorithm(int outflag)
     for (icell = 0; icell < nlocal; icell++) {
       if (!cells[icell].nsurf) continue;
       if (cells[icell].nsplit <= 0) continue;
+      if (skipflag && skipflag[icell]) continue;
 
       list = cells[icell].csurfs;
       n = cells[icell].nsurf;
@@ -744,12 +874,21 @@ void Grid::surf2grid_new_algorithm(int outflag)
   surfint *list;
   int nontrans;
 
+#if defined(_OPENMP)
+#pragma omp parallel for schedule(dynamic,CHUNK_THREAD)
+#endif
   for (icell = 0; icell < nlocal; icell++) {
     if (!cells[icell].nsurf) continue;
     if (cells[icell].nsplit <= 0) continue;
-
+    if (skipflag && skipflag[icell]) continue;
     qsort(cells[icell].csurfs,cells[icell].nsurf,
 	  sizeof(surfint),compare_surfIDs);
+  }
+
+  for (icell = 0; icell < nlocal; icell++) {
+    if (!cells[icell].nsurf) continue;
+    if (cells[icell].nsplit <= 0) continue;
+    if (skipflag && skipflag[icell]) continue;
 
     list = cells[icell].csurfs;
     n = cells[icell].nsurf;
@@ -948,9 +1087,11 @@ int Grid::rendezvous_surfrequest(int n, char *inbuf, int &flag,
    compute split cells for implicit surfs
    surfs per cell already created
    called from ReadISurf and FixAblate
+   skipflag = optional per-cell flags, cells with flag set are not cut,
+     caller restores their cut info via surf2grid_restore_one()
 ------------------------------------------------------------------------- */
 
-void Grid::surf2grid_implicit(int subflag, int outflag)
+void Grid::surf2grid_implicit(int subflag, int outflag, int *skipflag)
 {
   int dim = domain->dimension;
   if (dim == 3) cut3d = new Cut3d(sparta);
@@ -959,7 +1100,7 @@ void Grid::surf2grid_implicit(int subflag, int outflag)
   tmap = tcomm1 = tcomm2 = tcomm3 = 0.0;
 
   if (outflag) surf2grid_stats();
-  surf2grid_split(subflag,outflag);
+  surf2grid_split(subflag,outflag,skipflag);
 }
 
 /* ----------------------------------------------------------------------
@@ -970,16 +1111,17 @@ void Grid::surf2grid_implicit(int subflag, int outflag)
    if subflag = 0, split/sub cells already exist
      called from ReadRestart
    outflag = 1 for timing and statistics info
+   skipflag = optional per-cell flags, cells with flag set are skipped
    in cells: set nsplit, isplit
    in cinfo: set corner, volume
    initialize sinfo as needed
 ------------------------------------------------------------------------- */
 
-void Grid::surf2grid_split(int subflag, int outflag)
+void Grid::surf2grid_split(int subflag, int outflag, int *skipflag)
 {
   int i,isub,nsurf,nsplitone,xsub;
   int *surfmap,*ptr;
-  double t1,t2;
+  double t1,t2,t3;
   double *lo,*hi,*vols;
   double xsplit[3];
   ChildCell *c;
@@ -992,69 +1134,124 @@ void Grid::surf2grid_split(int subflag, int outflag)
     t1 = MPI_Wtime();
   }
 
-  // compute cut volume and possible split of each grid cell by surfs
-  // decrement nunsplitlocal if convert an unsplit cell to split cell
-  // if nsplitone > 1, create new split cell sinfo and sub-cells
+  // list of OVERLAP cells to compute cut volume and possible split for
   // skip if nsplit <= 0 b/c split cells could exist if restarting
+  // offsets into per-cell storage for surfmap and vols results
 
-  int max = 0;
   int ncurrent = nlocal;
 
+  int noverlap = 0;
   for (int icell = 0; icell < ncurrent; icell++) {
     if (cells[icell].nsplit <= 0) continue;
     if (cinfo[icell].type != OVERLAP) continue;
+    if (skipflag && skipflag[icell]) continue;
+    noverlap++;
+  }
 
-    surfmap = csplits->vget();
-    c = &cells[icell];
+  int *olist,*onsplit,*oxsub,*omapoffset,*ovoloffset;
+  double *oxsplit;
+  memory->create(olist,noverlap,"surf2grid:olist");
+  memory->create(onsplit,noverlap,"surf2grid:onsplit");
+  memory->create(oxsub,noverlap,"surf2grid:oxsub");
+  memory->create(omapoffset,noverlap+1,"surf2grid:omapoffset");
+  memory->create(ovoloffset,noverlap+1,"surf2grid:ovoloffset");
+  memory->create(oxsplit,3*noverlap,"surf2grid:oxsplit");
 
-    if (dim == 3)
-      nsplitone = cut3d->split(c->id,c->lo,c->hi,c->nsurf,c->csurfs,
-                               vols,surfmap,cinfo[icell].corner,xsub,xsplit);
-    else
-      nsplitone = cut2d->split(c->id,c->lo,c->hi,c->nsurf,c->csurfs,
-                               vols,surfmap,cinfo[icell].corner,xsub,xsplit);
+  // a cell with N surfs has at most N sub cells
+  // allow for maxsplitpercell so a cell with too many is still detected
+
+  noverlap = 0;
+  omapoffset[0] = ovoloffset[0] = 0;
+  for (int icell = 0; icell < ncurrent; icell++) {
+    if (cells[icell].nsplit <= 0) continue;
+    if (cinfo[icell].type != OVERLAP) continue;
+    if (skipflag && skipflag[icell]) continue;
+    nsurf = cells[icell].nsurf;
+    olist[noverlap] = icell;
+    omapoffset[noverlap+1] = omapoffset[noverlap] + nsurf;
+    ovoloffset[noverlap+1] = ovoloffset[noverlap] + MAX(nsurf,maxsplitpercell);
+    noverlap++;
+  }
+
+  int *omap;
+  double *ovols;
+  memory->create(omap,omapoffset[noverlap],"surf2grid:omap");
+  memory->create(ovols,ovoloffset[noverlap],"surf2grid:ovols");
+
+  // compute cut volume and possible split of each OVERLAP cell by surfs
+  // threaded over cells, each thread uses its own Cut2d/Cut3d
+  // corner flags are set directly, other results are stored per cell
+
+  create_thread_cuts();
+
+#if defined(_OPENMP)
+#pragma omp parallel private(c,vols)
+#endif
+  {
+    int tid = 0;
+#if defined(_OPENMP)
+    tid = omp_get_thread_num();
+#endif
+
+#if defined(_OPENMP)
+#pragma omp for schedule(dynamic,CHUNK_THREAD)
+#endif
+    for (int m = 0; m < noverlap; m++) {
+      int icell = olist[m];
+      c = &cells[icell];
+
+      if (dim == 3)
+        onsplit[m] = cut3d_thread[tid]->
+          split(c->id,c->lo,c->hi,c->nsurf,c->csurfs,vols,
+                &omap[omapoffset[m]],cinfo[icell].corner,
+                oxsub[m],&oxsplit[3*m]);
+      else
+        onsplit[m] = cut2d_thread[tid]->
+          split(c->id,c->lo,c->hi,c->nsurf,c->csurfs,vols,
+                &omap[omapoffset[m]],cinfo[icell].corner,
+                oxsub[m],&oxsplit[3*m]);
+
+      int nvol = MIN(onsplit[m],ovoloffset[m+1]-ovoloffset[m]);
+      memcpy(&ovols[ovoloffset[m]],vols,nvol*sizeof(double));
+    }
+  }
+
+  destroy_thread_cuts();
+
+  if (outflag) {
+    t3 = MPI_Wtime();
+    tcut = t3-t1;
+  }
+
+  // create split and sub cells in cell order, same as a serial loop
+  // decrement nunsplitlocal if convert an unsplit cell to split cell
+  // if nsplitone > 1, create new split cell sinfo and sub-cells
+
+  int max = 0;
+
+  for (int m = 0; m < noverlap; m++) {
+    int icell = olist[m];
+    nsplitone = onsplit[m];
+    vols = &ovols[ovoloffset[m]];
+    xsub = oxsub[m];
+    xsplit[0] = oxsplit[3*m];
+    xsplit[1] = oxsplit[3*m+1];
+    xsplit[2] = oxsplit[3*m+2];
 
     if (nsplitone == 1) {
       cinfo[icell].volume = vols[0];
+      continue;
+    }
+
+    surfmap = csplits->vget();
+    memcpy(surfmap,&omap[omapoffset[m]],cells[icell].nsurf*sizeof(int));
 
-    } else if (subflag) {
+    if (subflag) {
       if (nsplitone > maxsplitpercell) {
 	max = MAX(max,nsplitone);
 	csplits->vgot(0);
 	
-      } else {
-	cells[icell].nsplit = nsplitone;
-	nunsplitlocal--;
-
-	cells[icell].isplit = nsplitlocal;
-	add_split_cell(1);
-	s = &sinfo[nsplitlocal-1];
-	s->icell = icell;
-	s->csplits = surfmap;
-	s->xsub = xsub;
-	s->xsplit[0] = xsplit[0];
-	s->xsplit[1] = xsplit[1];
-	if (dim == 3) s->xsplit[2] = xsplit[2];
-	else s->xsplit[2] = 0.0;
-
-	ptr = s->csubs = csubs->vget();
-
-        // add nsplitone sub cells
-        // collide and fixes also need to add cells
-
-	for (i = 0; i < nsplitone; i++) {
-	  isub = nlocal;
-	  add_sub_cell(icell,1);
-          if (collide) collide->add_grid_one();
-          if (modify->n_pergrid) modify->add_grid_one();
-	  cells[isub].nsplit = -i;
-	  cinfo[isub].volume = vols[i];
-	  ptr[i] = isub;
-	}
-	
-	csubs->vgot(nsplitone);
-	csplits->vgot(cells[icell].nsurf);
-      }
+      } else split_one(icell,nsplitone,vols,surfmap,xsub,xsplit);
 
     } else {
       if (cells[icell].nsplit != nsplitone) {
@@ -1084,6 +1281,17 @@ void Grid::surf2grid_split(int subflag, int outflag)
     }
   }
 
+  if (outflag) tsub = MPI_Wtime() - t3;
+
+  memory->destroy(olist);
+  memory->destroy(onsplit);
+  memory->destroy(oxsub);
+  memory->destroy(omapoffset);
+  memory->destroy(ovoloffset);
+  memory->destroy(oxsplit);
+  memory->destroy(omap);
+  memory->destroy(ovols);
+
   // error if split count exceeds maxsplitpercell for any cell
 
   int maxall;
@@ -1157,13 +1365,159 @@ void Grid::surf2grid_split(int subflag, int outflag)
   if (dim == 3) delete cut3d;
   else delete cut2d;
 
+  // timing breakdown, max across procs of threaded and serial parts
+
   if (outflag) {
     MPI_Barrier(world);
     t2 = MPI_Wtime();
     tsplit = t2-t1;
+
+    double tone[2],tall[2];
+    tone[0] = tcut;
+    tone[1] = tsub;
+    MPI_Allreduce(tone,tall,2,MPI_DOUBLE,MPI_MAX,world);
+
+    if (comm->me == 0) {
+      if (screen) fprintf(screen,"  %g %g = max cut/sub-cell split time "
+                          "(secs), %d threads per proc\n",
+                          tall[0],tall[1],nthreads);
+      if (logfile) fprintf(logfile,"  %g %g = max cut/sub-cell split time "
+                           "(secs), %d threads per proc\n",
+                           tall[0],tall[1],nthreads);
+    }
+  }
+}
+
+/* ----------------------------------------------------------------------
+   create one Cut2d or Cut3d per thread for threaded surf2grid() loops
+   cut2d or cut3d must already exist, it is used by thread 0
+   nthreads = 1 if SPARTA is not built with OpenMP
+------------------------------------------------------------------------- */
+
+void Grid::create_thread_cuts()
+{
+  nthreads = 1;
+#if defined(_OPENMP)
+  nthreads = omp_get_max_threads();
+#endif
+
+  if (domain->dimension == 3) {
+    cut3d_thread = new Cut3d*[nthreads];
+    cut3d_thread[0] = cut3d;
+    for (int i = 1; i < nthreads; i++) cut3d_thread[i] = new Cut3d(sparta);
+  } else {
+    cut2d_thread = new Cut2d*[nthreads];
+    cut2d_thread[0] = cut2d;
+    for (int i = 1; i < nthreads; i++)
+      cut2d_thread[i] = new Cut2d(sparta,domain->axisymmetric);
   }
 }
 
+/* ----------------------------------------------------------------------
+   delete per-thread cuts, except cut2d or cut3d used by thread 0
+   sum their tallies of pushed cells into cut2d or cut3d
+------------------------------------------------------------------------- */
+
+void Grid::destroy_thread_cuts()
+{
+  int i,j;
+
+  if (cut3d_thread) {
+    for (i = 1; i < nthreads; i++) {
+      for (j = 0; j <= cut3d->npushmax; j++)
+        cut3d->npushcell[j] += cut3d_thread[i]->npushcell[j];
+      delete cut3d_thread[i];
+    }
+    delete [] cut3d_thread;
+    cut3d_thread = NULL;
+  }
+
+  if (cut2d_thread) {
+    for (i = 1; i < nthreads; i++) {
+      for (j = 0; j <= cut2d->npushmax; j++)
+        cut2d->npushcell[j] += cut2d_thread[i]->npushcell[j];
+      delete cut2d_thread[i];
+    }
+    delete [] cut2d_thread;
+    cut2d_thread = NULL;
+  }
+}
+
+/* ----------------------------------------------------------------------
+   convert owned cell icell into a split cell with Nsplitone sub cells
+   surfmap = sub cell each surf in icell belongs to,
+     must be the vector just returned by csplits->vget()
+   vols = volume of each sub cell
+   xsub,xsplit = which sub cell contains point xsplit in icell
+------------------------------------------------------------------------- */
+
+void Grid::split_one(int icell, int nsplitone, double *vols, int *surfmap,
+                     int xsub, double *xsplit)
+{
+  int i,isub;
+  int *ptr;
+  SplitInfo *s;
+
+  cells[icell].nsplit = nsplitone;
+  nunsplitlocal--;
+
+  cells[icell].isplit = nsplitlocal;
+  add_split_cell(1);
+  s = &sinfo[nsplitlocal-1];
+  s->icell = icell;
+  s->csplits = surfmap;
+  s->xsub = xsub;
+  s->xsplit[0] = xsplit[0];
+  s->xsplit[1] = xsplit[1];
+  if (domain->dimension == 3) s->xsplit[2] = xsplit[2];
+  else s->xsplit[2] = 0.0;
+
+  ptr = s->csubs = csubs->vget();
+
+  // add nsplitone sub cells
+  // collide and fixes also need to add cells
+
+  for (i = 0; i < nsplitone; i++) {
+    isub = nlocal;
+    add_sub_cell(icell,1);
+    if (collide) collide->add_grid_one();
+    if (modify->n_pergrid) modify->add_grid_one();
+    cells[isub].nsplit = -i;
+    cinfo[isub].volume = vols[i];
+    ptr[i] = isub;
+  }
+
+  csubs->vgot(nsplitone);
+  csplits->vgot(cells[icell].nsurf);
+}
+
+/* ----------------------------------------------------------------------
+   restore cut info for owned cell icell without re-cutting it
+   values were saved by caller from a previous cut of identical surfs
+   nsplitone,vols,surfmap,xsub,xsplit are same as returned by Cut2d/Cut3d
+   corner = corner flags of cell
+   called by FixAblate for cells skipped by surf2grid_implicit()
+     and by MoveSurf for cells skipped by surf2grid()
+------------------------------------------------------------------------- */
+
+void Grid::surf2grid_restore_one(int icell, int nsplitone, double *vols,
+                                 int *surfmap, int *corner,
+                                 int xsub, double *xsplit)
+{
+  int ncorner = 8;
+  if (domain->dimension == 2) ncorner = 4;
+  for (int m = 0; m < ncorner; m++) cinfo[icell].corner[m] = corner[m];
+
+  if (nsplitone == 1) {
+    cinfo[icell].volume = vols[0];
+    return;
+  }
+
+  int *ptr = csplits->vget();
+  memcpy(ptr,surfmap,cells[icell].nsurf*sizeof(int));
+  split_one(icell,nsplitone,vols,ptr,xsub,xsplit);
+}
+
 /* ----------------------------------------------------------------------
    map surf elements into a single grid cell = icell
    flag = 0 for grid refinement, 1 for grid coarsening
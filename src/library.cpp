@@ -24,12 +24,22 @@
 #include "input.h"
 #include "update.h"
 #include "particle.h"
+#include "grid.h"
 #include "modify.h"
 #include "compute.h"
+#include "fix.h"
 #include "variable.h"
+#include "memory.h"
 
 using namespace SPARTA_NS;
 
+// data types returned in info[0] by extract_particle() and extract_grid()
+
+enum{INT,DOUBLE,BIGINT,UINT,UBIGINT};
+
+static void *extract_field(SPARTA *, int, char *, int *);
+static void *extract_compute_fix(SPARTA *, int, char *, int *);
+
 /* ----------------------------------------------------------------------
    create an instance of SPARTA and return pointer to it
    pass in command-line args and MPI communicator to run on
@@ -291,3 +301,390 @@ void *sparta_extract_variable(void *ptr, char *name)
 
   return NULL;
 }
+
+/* ----------------------------------------------------------------------
+   extract a pointer to a per-particle quantity for the particles I own
+   name = particle field: id, type, icell, x, v, erot, evib, flag,
+            dtremain, weight
+          or name of a custom per-particle vector or array
+          or c_ID, c_ID[N], f_ID, f_ID[N] for a per-particle compute or fix
+   info = 4 ints returned to caller which describe the data
+     info[0] = data type: 0 = int, 1 = double, 2 = 64-bit int,
+                          3 = unsigned int, 4 = unsigned 64-bit int
+     info[1] = # of rows = # of particles I own
+     info[2] = # of columns, 1 for a scalar field or vector
+     info[3] = stride in bytes between successive rows
+   returns a pointer to the value(s) of the first particle
+     which can be wrapped by caller without copying the data
+   returns NULL and info[0] = -1 if name is not recognized
+   returns NULL and info[0] >= 0 if I own no particles
+   IMPORTANT: pointer is only valid until particles are next
+     created, deleted, migrated, or sorted, e.g. by the next run
+   IMPORTANT: if a compute is not current it will be invoked
+     SPARTA cannot easily check here if it is valid to invoke the compute,
+     so caller must insure that it is OK
+------------------------------------------------------------------------- */
+
+void *sparta_extract_particle(void *ptr, char *name, int *info)
+{
+  SPARTA *sparta = (SPARTA *) ptr;
+  return extract_field(sparta,0,name,info);
+}
+
+/* ----------------------------------------------------------------------
+   extract a pointer to a per-grid quantity for the grid cells I own
+   name = cell field: id, level, proc, lo, hi, nsurf, nsplit,
+            count, first, mask, type, volume, weight
+          or CommMacro field: v, Temp
+          or NoCommMacro field: do_relaxation, sum_vi, sum_vij, sum_C2vi,
+            sigma_ij, qi, Wmax, coef_A, coef_B, tao
+          or c_ID, c_ID[N], f_ID, f_ID[N] for a per-grid compute or fix
+   info = same as for sparta_extract_particle()
+     info[1] = # of rows = # of owned grid cells, including split/sub cells
+   returns a pointer to the value(s) of the first owned grid cell
+   IMPORTANT: pointer is only valid until the grid is next
+     changed, e.g. by adapt_grid or balance_grid
+   IMPORTANT: same caveat as for sparta_extract_particle() on computes
+------------------------------------------------------------------------- */
+
+void *sparta_extract_grid(void *ptr, char *name, int *info)
+{
+  SPARTA *sparta = (SPARTA *) ptr;
+  return extract_field(sparta,1,name,info);
+}
+
+/* ----------------------------------------------------------------------
+   gather a per-particle or per-grid quantity from all procs into data
+   style = 0 for per particle, 1 for per grid
+   name = any name accepted by sparta_extract_particle/grid()
+   data = allocated by caller, Nglobal rows x info[2] columns
+     of the data type returned in info[0] by extract
+     rows are ordered by proc, then by local index on each proc
+   if data = NULL, just return global # of rows
+   returns global # of rows, -1 if name is not recognized
+------------------------------------------------------------------------- */
+
+int sparta_gather(void *ptr, int style, char *name, void *data)
+{
+  SPARTA *sparta = (SPARTA *) ptr;
+  MPI_Comm world = sparta->world;
+
+  int info[4];
+  char *src = (char *) extract_field(sparta,style,name,info);
+  if (info[0] < 0) return -1;
+
+  int nlocal = info[1];
+  int ntotal;
+  MPI_Allreduce(&nlocal,&ntotal,1,MPI_INT,MPI_SUM,world);
+  if (data == NULL) return ntotal;
+
+  // pack my values into a contiguous buffer, skipping any stride
+
+  int nprocs;
+  MPI_Comm_size(world,&nprocs);
+
+  int width;
+  if (info[0] == INT || info[0] == UINT) width = info[2]*sizeof(int);
+  else width = info[2]*sizeof(double);
+  int nbytes = nlocal*width;
+
+  char *mine;
+  sparta->memory->create(mine,nbytes,"library:mine");
+  for (int i = 0; i < nlocal; i++)
+    memcpy(&mine[i*width],&src[(bigint) i*info[3]],width);
+
+  int *recvcounts,*displs;
+  sparta->memory->create(recvcounts,nprocs,"library:recvcounts");
+  sparta->memory->create(displs,nprocs,"library:displs");
+  MPI_Allgather(&nbytes,1,MPI_INT,recvcounts,1,MPI_INT,world);
+  displs[0] = 0;
+  for (int i = 1; i < nprocs; i++)
+    displs[i] = displs[i-1] + recvcounts[i-1];
+
+  MPI_Allgatherv(mine,nbytes,MPI_CHAR,data,recvcounts,displs,MPI_CHAR,world);
+
+  sparta->memory->destroy(mine);
+  sparta->memory->destroy(recvcounts);
+  sparta->memory->destroy(displs);
+  return ntotal;
+}
+
+/* ----------------------------------------------------------------------
+   scatter a per-particle or per-grid quantity from data to all procs
+   inverse of sparta_gather(), data must be ordered in the same way
+     and have the same global # of rows on every proc
+   each proc copies its own rows into the internal SPARTA data
+   returns global # of rows, -1 if name is not recognized
+   IMPORTANT: SPARTA does not check that changed values are consistent,
+     e.g. new particle coords must still be inside the particle's cell
+------------------------------------------------------------------------- */
+
+int sparta_scatter(void *ptr, int style, char *name, void *data)
+{
+  SPARTA *sparta = (SPARTA *) ptr;
+  MPI_Comm world = sparta->world;
+
+  int info[4];
+  char *dest = (char *) extract_field(sparta,style,name,info);
+  if (info[0] < 0) return -1;
+
+  int nlocal = info[1];
+  int ntotal,offset;
+  MPI_Allreduce(&nlocal,&ntotal,1,MPI_INT,MPI_SUM,world);
+  MPI_Scan(&nlocal,&offset,1,MPI_INT,MPI_SUM,world);
+  offset -= nlocal;
+
+  int width;
+  if (info[0] == INT || info[0] == UINT) width = info[2]*sizeof(int);
+  else width = info[2]*sizeof(double);
+
+  char *src = (char *) data + (bigint) offset*width;
+  for (int i = 0; i < nlocal; i++)
+    memcpy(&dest[(bigint) i*info[3]],&src[i*width],width);
+
+  return ntotal;
+}
+
+/* ----------------------------------------------------------------------
+   set info for a field of a struct with nrows elements of nbytes each
+   return ptr to the field of the first element
+------------------------------------------------------------------------- */
+
+static void *field(void *first, int type, int nrows, int ncols, int nbytes,
+                   int *info)
+{
+  info[0] = type;
+  info[1] = nrows;
+  info[2] = ncols;
+  info[3] = nbytes;
+  if (nrows == 0) return NULL;
+  return first;
+}
+
+/* ----------------------------------------------------------------------
+   set info for a per-particle or per-grid quantity and return ptr to it
+   style = 0 for particles, 1 for grid cells
+   info[0] = -1 if name is not recognized
+   customize by adding names
+------------------------------------------------------------------------- */
+
+static void *extract_field(SPARTA *sparta, int style, char *name, int *info)
+{
+  info[0] = -1;
+  info[1] = info[2] = info[3] = 0;
+
+  if (strncmp(name,"c_",2) == 0 || strncmp(name,"f_",2) == 0)
+    return extract_compute_fix(sparta,style,name,info);
+
+  int cellid = sizeof(cellint) == sizeof(int) ? UINT : UBIGINT;
+
+  if (style == 0) {
+    Particle *particle = sparta->particle;
+    Particle::OnePart *p = particle->particles;
+    int n = particle->nlocal;
+    int nbytes = sizeof(Particle::OnePart);
+    if (p == NULL) n = 0;
+
+    if (strcmp(name,"id") == 0)
+      return field(&p->id,INT,n,1,nbytes,info);
+    if (strcmp(name,"type") == 0)
+      return field(&p->ispecies,INT,n,1,nbytes,info);
+    if (strcmp(name,"icell") == 0)
+      return field(&p->icell,INT,n,1,nbytes,info);
+    if (strcmp(name,"x") == 0)
+      return field(p->x,DOUBLE,n,3,nbytes,info);
+    if (strcmp(name,"v") == 0)
+      return field(p->v,DOUBLE,n,3,nbytes,info);
+    if (strcmp(name,"erot") == 0)
+      return field(&p->erot,DOUBLE,n,1,nbytes,info);
+    if (strcmp(name,"evib") == 0)
+      return field(&p->evib,DOUBLE,n,1,nbytes,info);
+    if (strcmp(name,"flag") == 0)
+      return field(&p->flag,INT,n,1,nbytes,info);
+    if (strcmp(name,"dtremain") == 0)
+      return field(&p->dtremain,DOUBLE,n,1,nbytes,info);
+    if (strcmp(name,"weight") == 0)
+      return field(&p->weight,DOUBLE,n,1,nbytes,info);
+
+    // custom per-particle vectors and arrays are contiguous
+
+    int index = particle->find_custom(name);
+    if (index < 0) return NULL;
+    n = particle->nlocal;
+    int ncols = particle->esize[index];
+    int iwhich = particle->ewhich[index];
+
+    if (particle->etype[index] == INT) {
+      if (ncols == 0)
+        return field(particle->eivec[iwhich],INT,n,1,sizeof(int),info);
+      int **array = particle->eiarray[iwhich];
+      return field(array ? array[0] : NULL,INT,n,ncols,ncols*sizeof(int),info);
+    }
+    if (ncols == 0)
+      return field(particle->edvec[iwhich],DOUBLE,n,1,sizeof(double),info);
+    double **array = particle->edarray[iwhich];
+    return field(array ? array[0] : NULL,DOUBLE,n,ncols,
+                 ncols*sizeof(double),info);
+  }
+
+  Grid *grid = sparta->grid;
+  int n = grid->nlocal;
+
+  Grid::ChildCell *c = grid->cells;
+  int nbytes = sizeof(Grid::ChildCell);
+  if (c == NULL) n = 0;
+
+  if (strcmp(name,"id") == 0)
+    return field(&c->id,cellid,n,1,nbytes,info);
+  if (strcmp(name,"level") == 0)
+    return field(&c->level,INT,n,1,nbytes,info);
+  if (strcmp(name,"proc") == 0)
+    return field(&c->proc,INT,n,1,nbytes,info);
+  if (strcmp(name,"lo") == 0)
+    return field(c->lo,DOUBLE,n,3,nbytes,info);
+  if (strcmp(name,"hi") == 0)
+    return field(c->hi,DOUBLE,n,3,nbytes,info);
+  if (strcmp(name,"nsurf") == 0)
+    return field(&c->nsurf,INT,n,1,nbytes,info);
+  if (strcmp(name,"nsplit") == 0)
+    return field(&c->nsplit,INT,n,1,nbytes,info);
+  if (strcmp(name,"v") == 0)
+    return field(c->macro.v,DOUBLE,n,3,nbytes,info);
+  if (strcmp(name,"Temp") == 0)
+    return field(&c->macro.Temp,DOUBLE,n,1,nbytes,info);
+
+  Grid::ChildInfo *ci = grid->cinfo;
+  nbytes = sizeof(Grid::ChildInfo);
+  if (ci == NULL) n = 0;
+
+  if (strcmp(name,"count") == 0)
+    return field(&ci->count,INT,n,1,nbytes,info);
+  if (strcmp(name,"first") == 0)
+    return field(&ci->first,INT,n,1,nbytes,info);
+  if (strcmp(name,"mask") == 0)
+    return field(&ci->mask,INT,n,1,nbytes,info);
+  if (strcmp(name,"type") == 0)
+    return field(&ci->type,INT,n,1,nbytes,info);
+  if (strcmp(name,"volume") == 0)
+    return field(&ci->volume,DOUBLE,n,1,nbytes,info);
+  if (strcmp(name,"weight") == 0)
+    return field(&ci->weight,DOUBLE,n,1,nbytes,info);
+
+  NoCommMacro *m = &ci->macro;
+
+  if (strcmp(name,"do_relaxation") == 0)
+    return field(&m->do_relaxation,INT,n,1,nbytes,info);
+  if (strcmp(name,"sum_vi") == 0)
+    return field(m->sum_vi,DOUBLE,n,3,nbytes,info);
+  if (strcmp(name,"sum_vij") == 0)
+    return field(m->sum_vij,DOUBLE,n,6,nbytes,info);
+  if (strcmp(name,"sum_C2vi") == 0)
+    return field(m->sum_C2vi,DOUBLE,n,3,nbytes,info);
+  if (strcmp(name,"sigma_ij") == 0)
+    return field(m->sigma_ij,DOUBLE,n,6,nbytes,info);
+  if (strcmp(name,"qi") == 0)
+    return field(m->qi,DOUBLE,n,3,nbytes,info);
+  if (strcmp(name,"Wmax") == 0)
+    return field(&m->Wmax,DOUBLE,n,1,nbytes,info);
+  if (strcmp(name,"coef_A") == 0)
+    return field(&m->coef_A,DOUBLE,n,1,nbytes,info);
+  if (strcmp(name,"coef_B") == 0)
+    return field(&m->coef_B,DOUBLE,n,1,nbytes,info);
+  if (strcmp(name,"tao") == 0)
+    return field(&m->tao,DOUBLE,n,1,nbytes,info);
+
+  return NULL;
+}
+
+/* ----------------------------------------------------------------------
+   set info for a per-particle or per-grid compute or fix and return ptr
+   name = c_ID or f_ID for entire vector or array
+          c_ID[N] or f_ID[N] for column N of an array, N = 1 to Ncols
+   per-grid computes which post-process their output into vector_grid
+     require a column for an array
+------------------------------------------------------------------------- */
+
+static void *extract_compute_fix(SPARTA *sparta, int style, char *name,
+                                 int *info)
+{
+  // parse ID and optional column index
+
+  int n = strlen(name) + 1;
+  char *id = new char[n];
+  strcpy(id,&name[2]);
+
+  int icol = 0;
+  char *ptr = strchr(id,'[');
+  if (ptr) {
+    if (id[strlen(id)-1] != ']') {
+      delete [] id;
+      return NULL;
+    }
+    icol = atoi(ptr+1);
+    *ptr = '\0';
+  }
+
+  bigint ntimestep = sparta->update->ntimestep;
+  int nrows = style ? sparta->grid->nlocal : sparta->particle->nlocal;
+  int ncols;
+  double *vector = NULL;
+  double **array = NULL;
+
+  if (name[0] == 'c') {
+    int icompute = sparta->modify->find_compute(id);
+    delete [] id;
+    if (icompute < 0) return NULL;
+    Compute *compute = sparta->modify->compute[icompute];
+
+    if (style == 0) {
+      if (!compute->per_particle_flag) return NULL;
+      if (compute->invoked_per_particle != ntimestep)
+        compute->compute_per_particle();
+      ncols = compute->size_per_particle_cols;
+      vector = compute->vector_particle;
+      array = compute->array_particle;
+    } else {
+      if (!compute->per_grid_flag) return NULL;
+      if (compute->invoked_per_grid != ntimestep)
+        compute->compute_per_grid();
+      ncols = compute->size_per_grid_cols;
+      if (compute->post_process_grid_flag) {
+        if (icol > ncols || icol < 0) return NULL;
+        if (ncols && icol == 0) return NULL;
+        compute->post_process_grid(icol,1,NULL,NULL,NULL,1);
+        ncols = icol = 0;
+      } else if (compute->post_process_isurf_grid_flag)
+        compute->post_process_isurf_grid();
+      vector = compute->vector_grid;
+      array = compute->array_grid;
+    }
+
+  } else {
+    int ifix = sparta->modify->find_fix(id);
+    delete [] id;
+    if (ifix < 0) return NULL;
+    Fix *fix = sparta->modify->fix[ifix];
+
+    if (style == 0) {
+      if (!fix->per_particle_flag) return NULL;
+      ncols = fix->size_per_particle_cols;
+      vector = fix->vector_particle;
+      array = fix->array_particle;
+    } else {
+      if (!fix->per_grid_flag) return NULL;
+      ncols = fix->size_per_grid_cols;
+      vector = fix->vector_grid;
+      array = fix->array_grid;
+    }
+  }
+
+  // per-particle and per-grid arrays are contiguous, so stride = ncols
+
+  if (icol > ncols || icol < 0) return NULL;
+  if (ncols == 0) return field(vector,DOUBLE,nrows,1,sizeof(double),info);
+  if (array == NULL) nrows = 0;
+  if (icol) return field(nrows ? &array[0][icol-1] : NULL,DOUBLE,nrows,1,
+                         ncols*sizeof(double),info);
+  return field(nrows ? array[0] : NULL,DOUBLE,nrows,ncols,
+               ncols*sizeof(double),info);
+}
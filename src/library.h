@@ -36,6 +36,11 @@ void *sparta_extract_global(void *, char *);
 void *sparta_extract_compute(void *, char *, int, int);
 void *sparta_extract_variable(void *, char *);
 
+void *sparta_extract_particle(void *, char *, int *);
+void *sparta_extract_grid(void *, char *, int *);
+int sparta_gather(void *, int, char *, void *);
+int sparta_scatter(void *, int, char *, void *);
+
 #ifdef __cplusplus
 }
 #endif
@@ -67,9 +67,12 @@ MarchingCubes::MarchingCubes(SPARTA *sparta, int ggroup_caller,
    order 2 points in each line segment to give normal into flow volume
    treat two saddle point cases (my 9,6) (Wiki 5,10)
      based on ave value at cell center
+   skipflag = optional per-cell flags, cells with flag set are skipped,
+     caller is responsible for their surfs and mcflags
 ------------------------------------------------------------------------- */
 
-void MarchingCubes::invoke(double **cvalues, int *svalues, int **mcflags)
+void MarchingCubes::invoke(double **cvalues, int *svalues, int **mcflags,
+                           int *skipflag)
 {
   int i,j,ipt,isurf,nsurf,icase,which;
   surfint *ptr;
@@ -83,6 +86,7 @@ void MarchingCubes::invoke(double **cvalues, int *svalues, int **mcflags)
   for (int icell = 0; icell < nglocal; icell++) {
     if (!(cinfo[icell].mask & groupbit)) continue;
     if (cells[icell].nsplit <= 0) continue;
+    if (skipflag && skipflag[icell]) continue;
     lo = cells[icell].lo;
     hi = cells[icell].hi;
 
@@ -474,9 +478,12 @@ double MarchingCubes::interpolate(double v0, double v1, double lo, double hi)
      each proc loops over its recv list:
        if my cell face has 2 tris: delete them
        if my cell face has 0 tris: skip or add 2 tris depending on norm
+   faceproc = optional owning proc of neighbor across each face of my cells
+     if set, ghost cells need not exist, neigh of my cells are cell IDs
+     as set by Grid::unset_neighbors() and cells are found via grid hash
  ------------------------------------------------------------------------- */
 
-void MarchingCubes::cleanup()
+void MarchingCubes::cleanup(int **faceproc)
 {
   int i,j,k,m,icell,iface,nsurf,idim,nflag,inwardnorm;
   int ntri_other,othercell,otherface,otherproc,otherlocal,othernsurf;
@@ -491,6 +498,8 @@ void MarchingCubes::cleanup()
   MyPage<surfint> *csurfs = grid->csurfs;
   int nglocal = grid->nlocal;
 
+  if (faceproc) grid->rehash();
+
   Surf::Tri *tlist = NULL;
   int nlist = 0;
   int maxlist = 0;
@@ -583,9 +592,17 @@ void MarchingCubes::cleanup()
       else inwardnorm = 0;
       if (iface % 2) otherface = iface-1;
       else otherface = iface+1;
-      othercell = (int) cells[icell].neigh[iface];
-      otherproc = cells[othercell].proc;
-      otherlocal = cells[othercell].ilocal;
+      if (faceproc) {
+        cellID = cells[icell].neigh[iface];
+        otherproc = faceproc[icell][iface];
+        if (otherproc == me) othercell = (*grid->hash)[cellID];
+        otherlocal = -1;
+      } else {
+        othercell = (int) cells[icell].neigh[iface];
+        cellID = cells[othercell].id;
+        otherproc = cells[othercell].proc;
+        otherlocal = cells[othercell].ilocal;
+      }
 
       // if I own the adjacent cell, make decision about shared tris
       // if both cells have 2 tris on face, delete all of them
@@ -693,6 +710,7 @@ void MarchingCubes::cleanup()
         bufsend[nsend].sendcell = icell;
         bufsend[nsend].sendface = iface;
         bufsend[nsend].othercell = otherlocal;
+        bufsend[nsend].otherid = cellID;
         bufsend[nsend].otherface = otherface;
         bufsend[nsend].inwardnorm = inwardnorm;
         memcpy(&bufsend[nsend].tri1,&tris[facetris[icell][iface][0]],
@@ -751,7 +769,8 @@ void MarchingCubes::cleanup()
   // if my matching face has 0 tris, skip or add 2 tris depending on norm
 
   for (i = 0; i < nrecv; i++) {
-    icell = bufrecv[i].othercell;
+    if (faceproc) icell = (*grid->hash)[bufrecv[i].otherid];
+    else icell = bufrecv[i].othercell;
     iface = bufrecv[i].otherface;
 
     // my icell is not affected, sender cell keeps its 2 tris
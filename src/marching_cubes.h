@@ -24,8 +24,8 @@ class MarchingCubes : protected Pointers {
  public:
   MarchingCubes(class SPARTA *, int, double);
   ~MarchingCubes() {}
-  void invoke(double **, int *, int **);
-  void cleanup();
+  void invoke(double **, int *, int **, int *skipflag=NULL);
+  void cleanup(int **faceproc=NULL);
 
  private:
   int me,ggroup;
@@ -45,6 +45,7 @@ class MarchingCubes : protected Pointers {
   struct SendDatum {
     int sendcell,sendface;
     int othercell,otherface;
+    cellint otherid;           // ID of othercell, if no ghost cells
     int inwardnorm;            // for sending cell
     Surf::Tri tri1,tri2;
   };
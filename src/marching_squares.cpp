@@ -45,9 +45,11 @@ MarchingSquares::MarchingSquares(SPARTA *sparta, int ggroup_caller,
    order 2 points in each line segment to give normal into flow volume
    treat two saddle point cases (my 9,6) (Wiki 5,10)
      based on ave value at cell center
+   skipflag = optional per-cell flags, cells with flag set are skipped,
+     caller is responsible for their surfs
 ------------------------------------------------------------------------- */
 
-void MarchingSquares::invoke(double **cvalues, int *svalues)
+void MarchingSquares::invoke(double **cvalues, int *svalues, int *skipflag)
 {
   int i,ipt,isurf,nsurf,which,splitflag;
   double v00,v01,v10,v11;
@@ -68,6 +70,7 @@ void MarchingSquares::invoke(double **cvalues, int *svalues)
   for (int icell = 0; icell < nglocal; icell++) {
     if (!(cinfo[icell].mask & groupbit)) continue;
     if (cells[icell].nsplit <= 0) continue;
+    if (skipflag && skipflag[icell]) continue;
     lo = cells[icell].lo;
     hi = cells[icell].hi;
 
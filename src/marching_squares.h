@@ -23,7 +23,7 @@ class MarchingSquares : protected Pointers {
  public:
   MarchingSquares(class SPARTA *, int, double);
   ~MarchingSquares() {}
-  void invoke(double **, int *);
+  void invoke(double **, int *, int *skipflag=NULL);
 
  private:
   int ggroup;
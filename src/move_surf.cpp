@@ -34,6 +34,8 @@ enum{READFILE,TRANSLATE,ROTATE};
 enum{UNKNOWN,OUTSIDE,INSIDE,OVERLAP};           // several files
 
 #define MAXLINE 256
+#define DELTASTASH 1024
+#define BIG 1.0e20
 
 /* ---------------------------------------------------------------------- */
 
@@ -44,10 +46,33 @@ MoveSurf::MoveSurf(SPARTA *sparta) : Pointers(sparta)
 
   // pselect = 1 if point is moved, else 0
 
-  if (domain->dimension == 2)
+  // oldlines/oldtris = copy of surfs before each move
+
+  oldlines = NULL;
+  oldtris = NULL;
+
+  if (domain->dimension == 2) {
     memory->create(pselect,2*surf->nsurf,"move_surf:pselect");
-  else
+    oldlines = (Surf::Line *)
+      memory->smalloc(surf->nsurf*sizeof(Surf::Line),"move_surf:oldlines");
+  } else {
     memory->create(pselect,3*surf->nsurf,"move_surf:pselect");
+    oldtris = (Surf::Tri *)
+      memory->smalloc(surf->nsurf*sizeof(Surf::Tri),"move_surf:oldtris");
+  }
+
+  nsweep = 0;
+  cskip = NULL;
+  nskip = maxskip = 0;
+
+  shash = new MyCellHash();
+  stash = NULL;
+  nstash = maxstash = 0;
+  ssurfs = NULL;
+  smap = NULL;
+  maxssurf = 0;
+  svols = NULL;
+  maxsvol = 0;
 
   file = NULL;
   fp = NULL;
@@ -58,6 +83,14 @@ MoveSurf::MoveSurf(SPARTA *sparta) : Pointers(sparta)
 MoveSurf::~MoveSurf()
 {
   memory->destroy(pselect);
+  memory->sfree(oldlines);
+  memory->sfree(oldtris);
+  memory->destroy(cskip);
+  delete shash;
+  memory->sfree(stash);
+  memory->destroy(ssurfs);
+  memory->destroy(smap);
+  memory->destroy(svols);
   delete [] file;
   if (fp) fclose(fp);
 }
@@ -114,6 +147,7 @@ void MoveSurf::command(int narg, char **arg)
   // remake list of surf elements I own
   // assign split cell particles to parent split cell
   // assign surfs to grid cells
+  // only cells overlapping box swept by moved surfs are re-mapped and re-cut
 
   grid->unset_neighbors();
   grid->remove_ghosts();
@@ -126,8 +160,9 @@ void MoveSurf::command(int narg, char **arg)
 	grid->combine_split_cell_particles(icell,1);
   }
 
+  stash_cells();
   grid->clear_surf();
-  grid->surf2grid(1);
+  bigint ncut = surf2grid_local(1);
 
   if (dim == 2) surf->check_point_near_surf_2d();
   else surf->check_point_near_surf_3d();
@@ -173,6 +208,8 @@ void MoveSurf::command(int narg, char **arg)
 
   if (comm->me == 0) {
     if (screen) {
+      fprintf(screen,"  " BIGINT_FORMAT " cells re-cut by moved surfs\n",
+              ncut);
       if (particle->exist)
 	fprintf(screen,"  " BIGINT_FORMAT " deleted particles\n",ndeleted);
       fprintf(screen,"  CPU time = %g secs\n",time_total);
@@ -183,6 +220,8 @@ void MoveSurf::command(int narg, char **arg)
 	      100.0*(time6-time5)/time_total);
     }
     if (logfile) {
+      fprintf(logfile,"  " BIGINT_FORMAT " cells re-cut by moved surfs\n",
+              ncut);
       if (particle->exist)
 	fprintf(logfile,"  " BIGINT_FORMAT " deleted particles\n",ndeleted);
       fprintf(logfile,"  CPU time = %g secs\n",time_total);
@@ -264,6 +303,8 @@ void MoveSurf::process_args(int narg, char **arg)
 
 void MoveSurf::move_lines(double fraction, Surf::Line *origlines)
 {
+  save_old();
+
   if (connectflag && groupbit != 1) connect_2d_pre();
 
   if (action == READFILE) {
@@ -280,6 +321,8 @@ void MoveSurf::move_lines(double fraction, Surf::Line *origlines)
   // check that all points are still inside simulation box
 
   surf->check_point_inside(0);
+
+  sweep_box();
 }
 
 /* ----------------------------------------------------------------------
@@ -290,6 +333,8 @@ void MoveSurf::move_lines(double fraction, Surf::Line *origlines)
 
 void MoveSurf::move_tris(double fraction, Surf::Tri *origtris)
 {
+  save_old();
+
   if (connectflag && groupbit != 1) connect_3d_pre();
 
   if (action == READFILE) {
@@ -306,6 +351,8 @@ void MoveSurf::move_tris(double fraction, Surf::Tri *origtris)
   // check that all points are still inside simulation box
 
   surf->check_point_inside(0);
+
+  sweep_box();
 }
 
 /* ----------------------------------------------------------------------
@@ -808,6 +855,222 @@ void MoveSurf::connect_3d_post()
   delete hash;
 }
 
+/* ----------------------------------------------------------------------
+   save copy of lines or tris before they are moved
+------------------------------------------------------------------------- */
+
+void MoveSurf::save_old()
+{
+  if (domain->dimension == 2)
+    memcpy(oldlines,surf->lines,surf->nsurf*sizeof(Surf::Line));
+  else
+    memcpy(oldtris,surf->tris,surf->nsurf*sizeof(Surf::Tri));
+}
+
+/* ----------------------------------------------------------------------
+   compute box swept by moved surfs = bbox of their old and new points
+   a surf is moved if pselect is set for any of its points
+   surfs are not distributed, so box is the same on all procs
+------------------------------------------------------------------------- */
+
+void MoveSurf::sweep_box()
+{
+  int i,j,m,npt;
+  double *pts[6];
+
+  int dimension = domain->dimension;
+  int nsurf = surf->nsurf;
+  Surf::Line *lines = surf->lines;
+  Surf::Tri *tris = surf->tris;
+
+  nsweep = 0;
+  sweeplo[0] = sweeplo[1] = sweeplo[2] = BIG;
+  sweephi[0] = sweephi[1] = sweephi[2] = -BIG;
+
+  for (i = 0; i < nsurf; i++) {
+    if (dimension == 2) {
+      if (!pselect[2*i] && !pselect[2*i+1]) continue;
+      pts[0] = oldlines[i].p1;
+      pts[1] = oldlines[i].p2;
+      pts[2] = lines[i].p1;
+      pts[3] = lines[i].p2;
+      npt = 4;
+    } else {
+      if (!pselect[3*i] && !pselect[3*i+1] && !pselect[3*i+2]) continue;
+      pts[0] = oldtris[i].p1;
+      pts[1] = oldtris[i].p2;
+      pts[2] = oldtris[i].p3;
+      pts[3] = tris[i].p1;
+      pts[4] = tris[i].p2;
+      pts[5] = tris[i].p3;
+      npt = 6;
+    }
+
+    nsweep++;
+    for (m = 0; m < npt; m++)
+      for (j = 0; j < 3; j++) {
+        sweeplo[j] = MIN(sweeplo[j],pts[m][j]);
+        sweephi[j] = MAX(sweephi[j],pts[m][j]);
+      }
+  }
+}
+
+/* ----------------------------------------------------------------------
+   return 1 if cell with LO,HI does not touch swept box, else 0
+   touching counts as overlap, same as Cut2d/Cut3d::surf2grid()
+------------------------------------------------------------------------- */
+
+int MoveSurf::outside_sweep(double *lo, double *hi)
+{
+  if (nsweep == 0) return 1;
+  for (int j = 0; j < domain->dimension; j++) {
+    if (hi[j] < sweeplo[j]) return 1;
+    if (lo[j] > sweephi[j]) return 1;
+  }
+  return 0;
+}
+
+/* ----------------------------------------------------------------------
+   save surfs and cut info of each owned cell with surfs outside swept box
+   their surfs did not move, so neither did their overlap or cut
+   called after surfs are moved and before clear_surf()
+------------------------------------------------------------------------- */
+
+void MoveSurf::stash_cells()
+{
+  int i,m,nsurf,nsplit;
+  Stash *st;
+
+  Grid::ChildCell *cells = grid->cells;
+  Grid::ChildInfo *cinfo = grid->cinfo;
+  Grid::SplitInfo *sinfo = grid->sinfo;
+  int nglocal = grid->nlocal;
+  int ncorner = 8;
+  if (domain->dimension == 2) ncorner = 4;
+
+  shash->clear();
+  nstash = 0;
+  int nssurf = 0;
+  int nsvol = 0;
+
+  for (int icell = 0; icell < nglocal; icell++) {
+    if (cells[icell].nsplit <= 0) continue;
+    nsurf = cells[icell].nsurf;
+    if (nsurf == 0) continue;
+    if (!outside_sweep(cells[icell].lo,cells[icell].hi)) continue;
+    nsplit = cells[icell].nsplit;
+
+    if (nstash == maxstash) {
+      maxstash += DELTASTASH;
+      stash = (Stash *)
+        memory->srealloc(stash,maxstash*sizeof(Stash),"move_surf:stash");
+    }
+    if (nssurf+nsurf > maxssurf) {
+      while (nssurf+nsurf > maxssurf) maxssurf += DELTASTASH;
+      memory->grow(ssurfs,maxssurf,"move_surf:ssurfs");
+      memory->grow(smap,maxssurf,"move_surf:smap");
+    }
+    if (nsvol+nsplit > maxsvol) {
+      while (nsvol+nsplit > maxsvol) maxsvol += DELTASTASH;
+      memory->grow(svols,maxsvol,"move_surf:svols");
+    }
+
+    st = &stash[nstash];
+    st->nsurf = nsurf;
+    st->isurf = nssurf;
+    st->overlap = (cinfo[icell].type == OVERLAP);
+    st->nsplit = nsplit;
+    st->ivol = nsvol;
+    for (m = 0; m < ncorner; m++) st->corner[m] = cinfo[icell].corner[m];
+
+    if (nsplit == 1) {
+      st->xsub = 0;
+      st->xsplit[0] = st->xsplit[1] = st->xsplit[2] = 0.0;
+      svols[nsvol] = cinfo[icell].volume;
+    } else {
+      Grid::SplitInfo *s = &sinfo[cells[icell].isplit];
+      st->xsub = s->xsub;
+      st->xsplit[0] = s->xsplit[0];
+      st->xsplit[1] = s->xsplit[1];
+      st->xsplit[2] = s->xsplit[2];
+      for (i = 0; i < nsplit; i++)
+        svols[nsvol+i] = cinfo[s->csubs[i]].volume;
+      for (i = 0; i < nsurf; i++)
+        smap[nssurf+i] = s->csplits[i];
+    }
+
+    memcpy(&ssurfs[nssurf],cells[icell].csurfs,nsurf*sizeof(surfint));
+
+    nssurf += nsurf;
+    nsvol += nsplit;
+    (*shash)[cells[icell].id] = nstash++;
+  }
+}
+
+/* ----------------------------------------------------------------------
+   assign surfs to owned grid cells after clear_surf()
+   only cells which overlap swept box are re-mapped to surfs and re-cut
+   all other cells restore surfs and cut info saved by stash_cells()
+     before surf2grid() is called, so its statistics cover all cells
+   outflag = 1 for surf2grid timing and statistics
+   return # of cells re-mapped across all procs
+------------------------------------------------------------------------- */
+
+bigint MoveSurf::surf2grid_local(int outflag)
+{
+  int nsurf;
+  surfint *ptr;
+  Stash *st;
+
+  // cskip = 1 for owned cells outside swept box
+
+  Grid::ChildCell *cells = grid->cells;
+  nskip = grid->nlocal;
+  if (nskip > maxskip) {
+    maxskip = nskip;
+    memory->destroy(cskip);
+    memory->create(cskip,maxskip,"move_surf:cskip");
+  }
+
+  int ncut = 0;
+  for (int icell = 0; icell < nskip; icell++) {
+    cskip[icell] = outside_sweep(cells[icell].lo,cells[icell].hi);
+    if (!cskip[icell]) ncut++;
+  }
+
+  // restore saved info for skipped cells with surfs
+  // split_one() can reallocate cells and cinfo
+  // sub cells it adds are not in cskip, surf2grid() ignores them
+
+  for (int icell = 0; icell < nskip; icell++) {
+    if (!cskip[icell]) continue;
+    cells = grid->cells;
+    MyCellHash::iterator it = shash->find(cells[icell].id);
+    if (it == shash->end()) continue;
+    st = &stash[it->second];
+
+    nsurf = st->nsurf;
+    ptr = grid->csurfs->vget();
+    memcpy(ptr,&ssurfs[st->isurf],nsurf*sizeof(surfint));
+    grid->csurfs->vgot(nsurf);
+    cells[icell].nsurf = nsurf;
+    cells[icell].csurfs = ptr;
+
+    if (!st->overlap) continue;
+    grid->cinfo[icell].type = OVERLAP;
+    grid->surf2grid_restore_one(icell,st->nsplit,&svols[st->ivol],
+                                &smap[st->isurf],st->corner,
+                                st->xsub,st->xsplit);
+  }
+
+  grid->surf2grid(1,outflag,cskip);
+
+  bigint bncut = ncut;
+  bigint ncutall;
+  MPI_Allreduce(&bncut,&ncutall,1,MPI_SPARTA_BIGINT,MPI_SUM,world);
+  return ncutall;
+}
+
 /* ----------------------------------------------------------------------
    remove particles in any cell that is now INSIDE or contains moved surfs
    surfs that moved determined by pselect for any of its points
@@ -843,6 +1106,13 @@ bigint MoveSurf::remove_particles()
     // cell has surfs or is split
     // if m < nsurf, loop over csurfs did not finish
     // which means cell contains a moved surf, so delete all its particles
+    // cells outside swept box cannot contain a moved surf
+
+    if (icell < nskip && cskip[icell]) {
+      if (cells[icell].nsplit > 1)
+        grid->assign_split_cell_particles(icell);
+      continue;
+    }
 
     if (cells[icell].nsurf && cells[icell].nsplit >= 1) {
       nsurf = cells[icell].nsurf;
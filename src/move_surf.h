@@ -53,6 +53,8 @@ class MoveSurf : protected Pointers {
   void process_args(int, char **);
   void move_lines(double, Surf::Line *);
   void move_tris(double, Surf::Tri *);
+  void stash_cells();
+  bigint surf2grid_local(int);
   bigint remove_particles();
 
  private:
@@ -65,12 +67,58 @@ class MoveSurf : protected Pointers {
 
   int *pselect;                    // 1 if point is moved, else 0
 
+  // box swept by moved surfs, union of their bboxes before and after move
+  // only grid cells which overlap it are re-mapped to surfs and re-cut
+
+  Surf::Line *oldlines;            // copy of lines or tris before move
+  Surf::Tri *oldtris;
+  int nsweep;                      // # of moved surfs
+  double sweeplo[3],sweephi[3];
+
+  int *cskip;                      // 1 if owned cell is outside swept box
+  int nskip,maxskip;
+
+  // surf and cut info of each owned cell with surfs outside swept box,
+  //   saved before clear_surf() and restored after it
+  // stash is accessed by cell ID since clear_surf() compresses cell list
+
+#ifdef SPARTA_MAP
+  typedef std::map<cellint,int> MyCellHash;
+#elif SPARTA_UNORDERED_MAP
+  typedef std::unordered_map<cellint,int> MyCellHash;
+#else
+  typedef std::tr1::unordered_map<cellint,int> MyCellHash;
+#endif
+
+  struct Stash {
+    int nsurf;                     // # of surfs in cell
+    int isurf;                     // index of 1st surf in ssurfs and smap
+    int overlap;                   // 1 if cell was OVERLAP, else 0
+    int nsplit;                    // # of sub cells, 1 if unsplit
+    int ivol;                      // index of 1st volume in svols
+    int xsub;                      // sub cell containing xsplit
+    double xsplit[3];              // point in split cell
+    int corner[8];                 // corner flags of cell
+  };
+
+  MyCellHash *shash;               // cell ID -> index in stash
+  Stash *stash;
+  int nstash,maxstash;
+  surfint *ssurfs;                 // saved surf indices of each cell
+  int *smap;                       // sub cell of each saved surf
+  int maxssurf;
+  double *svols;                   // volume of cell or each of its sub cells
+  int maxsvol;
+
   int nread;
   int *readindex;
   double **oldcoord,**newcoord;
 
   void readfile();
   void update_points(double);
+  void save_old();
+  void sweep_box();
+  int outside_sweep(double *, double *);
   void translate_2d(double, Surf::Line *);
   void translate_3d(double, Surf::Tri *);
   void rotate_2d(double, Surf::Line *);
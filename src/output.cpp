@@ -376,6 +376,16 @@ void Output::write_dump(bigint ntimestep)
   }
 }
 
+/* ----------------------------------------------------------------------
+   wait for all dumps to finish any background writes
+   called at end of run so files are complete when run returns
+------------------------------------------------------------------------- */
+
+void Output::wait_dump()
+{
+  for (int idump = 0; idump < ndump; idump++) dump[idump]->async_wait();
+}
+
 /* ----------------------------------------------------------------------
    force restart file(s) to be written
 ------------------------------------------------------------------------- */
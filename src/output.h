@@ -64,6 +64,7 @@ class Output : protected Pointers {
   void setup(int);                   // initial output before run/min
   void write(bigint);                // output for current timestep
   void write_dump(bigint);           // force output of dump snapshots
+  void wait_dump();                  // complete background dump writes
   void write_restart(bigint);        // force output of a restart file
   void reset_timestep(bigint);       // reset next timestep for all output
 
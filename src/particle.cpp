@@ -25,6 +25,7 @@
 #include "collide.h"
 #include "random_mars.h"
 #include "random_park.h"
+#include "random_counter.h"
 #include "memory.h"
 #include "error.h"
 #include "fix_vibmode.h"
@@ -1004,9 +1005,11 @@ int Particle::find_mixture(char *id)
 /* ----------------------------------------------------------------------
    generate random rotational energy for a particle
    only a function of species index and species properties
+   templated on RNG so serial and counter-based RNGs share the sampling
 ------------------------------------------------------------------------- */
 
-double Particle::erot(int isp, double temp_thermal, RanPark *erandom)
+template < class RNG >
+double Particle::erot_sample(int isp, double temp_thermal, RNG *erandom)
 {
  double eng,a,erm,b;
  int rotstyle = NONE;
@@ -1042,7 +1045,8 @@ double Particle::erot(int isp, double temp_thermal, RanPark *erandom)
      -1 if not defined for this model
 ------------------------------------------------------------------------- */
 
-double Particle::evib(int isp, double temp_thermal, RanPark *erandom)
+template < class RNG >
+double Particle::evib_sample(int isp, double temp_thermal, RNG *erandom)
 {
   double eng,a,erm,b;
 
@@ -1077,6 +1081,34 @@ double Particle::evib(int isp, double temp_thermal, RanPark *erandom)
   return eng;
 }
 
+/* ---------------------------------------------------------------------- */
+
+double Particle::erot(int isp, double temp_thermal, RanPark *erandom)
+{
+  return erot_sample(isp,temp_thermal,erandom);
+}
+
+/* ---------------------------------------------------------------------- */
+
+double Particle::erot(int isp, double temp_thermal, RanCounter *erandom)
+{
+  return erot_sample(isp,temp_thermal,erandom);
+}
+
+/* ---------------------------------------------------------------------- */
+
+double Particle::evib(int isp, double temp_thermal, RanPark *erandom)
+{
+  return evib_sample(isp,temp_thermal,erandom);
+}
+
+/* ---------------------------------------------------------------------- */
+
+double Particle::evib(int isp, double temp_thermal, RanCounter *erandom)
+{
+  return evib_sample(isp,temp_thermal,erandom);
+}
+
 /* ----------------------------------------------------------------------
    read list of species defined in species file
    store info in filespecies and nfile
@@ -157,6 +157,8 @@ class Particle : protected Pointers {
   int find_mixture(char *);
   double erot(int, double, class RanPark *);
   double evib(int, double, class RanPark *);
+  double erot(int, double, class RanCounter *);
+  double evib(int, double, class RanCounter *);
 
   void write_restart_species(FILE *fp);
   void read_restart_species(FILE *fp);
@@ -200,6 +202,9 @@ class Particle : protected Pointers {
 
   class RanPark *wrandom;   // RNG for particle weighting
 
+  template < class RNG > double erot_sample(int, double, RNG *);
+  template < class RNG > double evib_sample(int, double, RNG *);
+
   // extra custom vectors/arrays for per-particle data
   // ncustom > 0 if there are any extra arrays
   // these varaiables are private, others above are public
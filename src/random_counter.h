@@ -0,0 +1,110 @@
+/* ----------------------------------------------------------------------
+   SPARTA - Stochastic PArallel Rarefied-gas Time-accurate Analyzer
+   http://sparta.sandia.gov
+   Steve Plimpton, sjplimp@sandia.gov, Michael Gallis, magalli@sandia.gov
+   Sandia National Laboratories
+
+   Copyright (2014) Sandia Corporation.  Under the terms of Contract
+   DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+   certain rights in this software.  This software is distributed under
+   the GNU General Public License.
+
+   See the README file in the top-level SPARTA directory.
+------------------------------------------------------------------------- */
+
+#ifndef SPARTA_RAN_COUNTER_H
+#define SPARTA_RAN_COUNTER_H
+
+#include "stdint.h"
+
+namespace SPARTA_NS {
+
+/* ----------------------------------------------------------------------
+   counter-based Philox4x32-10 RNG (Salmon et al, SC11)
+   output is a pure function of (seed, stream, id, index, draw #)
+   so a particle's random numbers do not depend on which proc creates it
+     or on the order in which cells are visited
+   seed = same value on all procs, e.g. drawn from update->ranmaster
+   stream = caller-chosen 64-bit value, e.g. timestep and face/species
+   id = 64-bit entity ID, e.g. grid cell ID
+   index = 32-bit sub-index, e.g. particle # within the cell
+------------------------------------------------------------------------- */
+
+class RanCounter {
+ public:
+  RanCounter(double rseed) {
+    seedkey = mix64(static_cast<uint64_t> (rseed*4294967296.0) *
+                    0x9E3779B97F4A7C15ULL);
+    key[0] = key[1] = 0;
+    ctr[0] = ctr[1] = ctr[2] = ctr[3] = 0;
+    nbuf = 0;
+  }
+  ~RanCounter() {}
+
+  // start a new sequence of draws for (stream,id,index)
+
+  void reset(uint64_t stream, uint64_t id, uint32_t index) {
+    uint64_t k = mix64(seedkey ^ mix64(stream + 0x632BE59BD9B4E019ULL));
+    key[0] = static_cast<uint32_t> (k);
+    key[1] = static_cast<uint32_t> (k >> 32);
+    ctr[0] = static_cast<uint32_t> (id);
+    ctr[1] = static_cast<uint32_t> (id >> 32);
+    ctr[2] = index;
+    ctr[3] = 0;
+    nbuf = 0;
+  }
+
+  // uniform RN in open interval (0,1) with 53 bits of precision
+  // each Philox block of 4 words yields 2 doubles
+
+  double uniform() {
+    if (nbuf == 0) {
+      block();
+      ctr[3]++;
+      nbuf = 2;
+    }
+    nbuf--;
+    uint64_t r = ((static_cast<uint64_t> (out[2*nbuf]) << 32) |
+                  out[2*nbuf+1]) >> 11;
+    return (r + 0.5) * (1.0/9007199254740992.0);
+  }
+
+ private:
+  uint64_t seedkey;
+  uint32_t key[2],ctr[4],out[4];
+  int nbuf;
+
+  // splitmix64 finalizer, used to spread seed and stream into the key
+
+  static uint64_t mix64(uint64_t z) {
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+  }
+
+  // 10 Philox rounds on current counter, result in out
+
+  void block() {
+    uint32_t c0 = ctr[0], c1 = ctr[1], c2 = ctr[2], c3 = ctr[3];
+    uint32_t k0 = key[0], k1 = key[1];
+    for (int r = 0; r < 10; r++) {
+      uint64_t p0 = static_cast<uint64_t> (0xD2511F53U) * c0;
+      uint64_t p1 = static_cast<uint64_t> (0xCD9E8D57U) * c2;
+      uint32_t hi0 = static_cast<uint32_t> (p0 >> 32);
+      uint32_t lo0 = static_cast<uint32_t> (p0);
+      uint32_t hi1 = static_cast<uint32_t> (p1 >> 32);
+      uint32_t lo1 = static_cast<uint32_t> (p1);
+      c0 = hi1 ^ c1 ^ k0;
+      c1 = lo1;
+      c2 = hi0 ^ c3 ^ k1;
+      c3 = lo0;
+      k0 += 0x9E3779B9U;
+      k1 += 0xBB67AE85U;
+    }
+    out[0] = c0; out[1] = c1; out[2] = c2; out[3] = c3;
+  }
+};
+
+}
+
+#endif
@@ -18,7 +18,8 @@
 //   all dots will be inside or on surface of 3-d box defined by lo/hi
 //   if defined, input weights must be real numbers > 0.0
 // NOTE: worry about 2d vs 3d
-// if want to have resue flag need to sum Tree across procs
+//   if keeptree is set, compute() gives all procs a copy of the cut tree,
+//     used by adjust()
 
 #include "mpi.h"
 #include "math.h"
@@ -34,6 +35,7 @@ using namespace SPARTA_NS;
 
 #define MYHUGE 1.0e30
 #define TINY 1.0e-6
+#define MAXITER 100
 
 // set this to bigger number after debugging
 
@@ -77,6 +79,9 @@ RCB::RCB(SPARTA *sparta) : Pointers(sparta)
   MPI_Op_create(median_merge,1,&med_op);
 
   reuse = 0;
+  keeptree = 0;
+  treeflag = 0;
+  nmoved = niterate = 0;
 }
 
 /* ---------------------------------------------------------------------- */
@@ -467,6 +472,7 @@ void RCB::compute(int n, double **x, double *wt, char *eligible, int flip)
     if (me == procmid) {
       tree[me].dim = dim;
       tree[me].cut = valuehalf;
+      tree[me].tie[0] = tree[me].tie[1] = MYHUGE;
     }
 
     // use cut to shrink RCB bounding box
@@ -600,6 +606,420 @@ void RCB::compute(int n, double **x, double *wt, char *eligible, int flip)
 
   lo = rcbbox.lo;
   hi = rcbbox.hi;
+
+  // give every proc a copy of the full cut tree so adjust() can use it
+  // tree[0] is unused, proc 0 is never the 1st proc of an upper half
+  // cuts made on flipped coords cannot be re-used
+
+  treeflag = 0;
+  if (keeptree && !flip) {
+    MPI_Allgather(MPI_IN_PLACE,sizeof(Tree),MPI_CHAR,
+                  tree,sizeof(Tree),MPI_CHAR,world);
+    treeflag = 1;
+  }
+}
+
+/* ----------------------------------------------------------------------
+   incremental rebalance using the cut tree from a previous compute()
+   tree topology and cut dimensions are kept, only cut positions move
+   a cut within tolerance of its target weight is left where it is,
+     others are searched for in their sub-domain, one tree level at a time
+     with all cuts of a level searched for together
+   dots do not move between procs, each proc just routes its own dots
+     down the tree, so only dots on the wrong side of a moved cut
+     change owner
+   if the cut lands on a plane of dots with the same coord, the plane is
+     split by a cut in the next dim, and a line of dots in the plane by
+     a cut in the 3rd dim, so balance is as good as for compute()
+   a kept cut splits dots at its coord the same way as before,
+     which compute() may have done in any order, so use current owner
+     of the dot to decide its side, see below_owner()
+   sets noriginal, nkeep, sendproc, lo, hi
+   sendindex is not set, recv info is not set, invert() is not needed
+------------------------------------------------------------------------- */
+
+void RCB::adjust(int n, double **x, double *wt)
+{
+  int i,k,m,s,dim,sdim,flag;
+  int proclower,procupper,procmid;
+  double w,range,tolerance,target;
+
+  if (!treeflag) error->all(FLERR,"RCB adjust called before compute");
+
+  noriginal = n;
+  nmoved = niterate = 0;
+
+  // dotlist/dotmark = lower/upper proc of partition each dot is in
+
+  if (n > maxlist) {
+    memory->destroy(dotlist);
+    memory->destroy(dotmark);
+    maxlist = n;
+    memory->create(dotlist,maxlist,"RCB:dotlist");
+    memory->create(dotmark,maxlist,"RCB:dotmark");
+  }
+
+  if (n > maxsend) {
+    memory->destroy(sendproc);
+    memory->destroy(sendindex);
+    maxsend = n;
+    memory->create(sendproc,maxsend,"RCB:sendproc");
+    memory->create(sendindex,maxsend,"RCB:sendindex");
+  }
+
+  // per-partition info, indexed by lowest proc in partition
+  // partitions at any level are disjoint, so index is unique
+  // trial = cut being tested, stage = which of its 3 values is searched for
+  // vlo,vhi = bracket on that value, wvlo,wvhi = weight below each end
+
+  BBox *box = (BBox *) memory->smalloc(nprocs*sizeof(BBox),"RCB:box");
+  Tree *trial = (Tree *) memory->smalloc(nprocs*sizeof(Tree),"RCB:trial");
+  double *wtlocal,*wtglobal,*tgt,*vlo,*vhi,*wvlo,*wvhi;
+  int *active,*stage,*niter,*partlo,*parthi,*newlo,*newhi;
+  memory->create(wtlocal,2*nprocs,"RCB:wtlocal");
+  memory->create(wtglobal,2*nprocs,"RCB:wtglobal");
+  memory->create(tgt,nprocs,"RCB:tgt");
+  memory->create(vlo,nprocs,"RCB:vlo");
+  memory->create(vhi,nprocs,"RCB:vhi");
+  memory->create(wvlo,nprocs,"RCB:wvlo");
+  memory->create(wvhi,nprocs,"RCB:wvhi");
+  memory->create(active,nprocs,"RCB:active");
+  memory->create(stage,nprocs,"RCB:stage");
+  memory->create(niter,nprocs,"RCB:niter");
+  memory->create(partlo,nprocs,"RCB:partlo");
+  memory->create(parthi,nprocs,"RCB:parthi");
+  memory->create(newlo,nprocs,"RCB:newlo");
+  memory->create(newhi,nprocs,"RCB:newhi");
+
+  // shrink-wrap bounding box around all dots, same as compute()
+  // tolerance = largest single weight, same as compute()
+
+  BBox boxtmp;
+  boxtmp.lo[0] = boxtmp.lo[1] = boxtmp.lo[2] = MYHUGE;
+  boxtmp.hi[0] = boxtmp.hi[1] = boxtmp.hi[2] = -MYHUGE;
+
+  double wtmax = 0.0;
+  for (i = 0; i < n; i++) {
+    for (k = 0; k < 3; k++) {
+      if (x[i][k] < boxtmp.lo[k]) boxtmp.lo[k] = x[i][k];
+      if (x[i][k] > boxtmp.hi[k]) boxtmp.hi[k] = x[i][k];
+    }
+    w = wt ? wt[i] : 1.0;
+    if (w > wtmax) wtmax = w;
+    dotlist[i] = 0;
+    dotmark[i] = nprocs-1;
+  }
+
+  MPI_Allreduce(&boxtmp,&box[0],1,box_type,box_op,world);
+  MPI_Allreduce(&wtmax,&tolerance,1,MPI_DOUBLE,MPI_MAX,world);
+  tolerance *= 1.0 + TINY;
+
+  int npart = 1;
+  partlo[0] = 0;
+  parthi[0] = nprocs-1;
+
+  // loop over levels of the tree until every partition is a single proc
+  // every proc has identical tree and Allreduce results,
+  //   so all loops below end on all procs together
+
+  while (1) {
+    int nactive = 0;
+    for (m = 0; m < npart; m++) {
+      proclower = partlo[m];
+      active[proclower] = 0;
+      if (proclower == parthi[m]) continue;
+      procmid = proclower + (parthi[m] - proclower) / 2 + 1;
+      trial[proclower] = tree[procmid];
+      active[proclower] = 1;
+      nactive++;
+    }
+    if (!nactive) break;
+
+    // weight of each partition and weight below its previous cut
+
+    for (k = 0; k < 2*nprocs; k++) wtlocal[k] = 0.0;
+    for (i = 0; i < n; i++) {
+      proclower = dotlist[i];
+      if (proclower == dotmark[i]) continue;
+      w = wt ? wt[i] : 1.0;
+      wtlocal[2*proclower] += w;
+      if (below_owner(x[i],trial[proclower],proclower,dotmark[i]))
+        wtlocal[2*proclower+1] += w;
+    }
+    MPI_Allreduce(wtlocal,wtglobal,2*nprocs,MPI_DOUBLE,MPI_SUM,world);
+    niterate++;
+
+    // keep cuts that are close enough, flag them with stage = -1
+    // else search for new cut position in the same dim,
+    //   with old position as 1st guess
+
+    for (m = 0; m < npart; m++) {
+      proclower = partlo[m];
+      stage[proclower] = -1;
+      if (!active[proclower]) continue;
+      procupper = parthi[m];
+      procmid = proclower + (procupper - proclower) / 2 + 1;
+      dim = trial[proclower].dim;
+
+      w = wtglobal[2*proclower];
+      tgt[proclower] = w * (procmid - proclower) / (procupper + 1 - proclower);
+      range = box[proclower].hi[dim] - box[proclower].lo[dim];
+
+      if (w <= 0.0 || range <= 0.0 ||
+          fabs(wtglobal[2*proclower+1] - tgt[proclower]) <= tolerance) {
+        active[proclower] = 0;
+        nactive--;
+        continue;
+      }
+
+      stage[proclower] = 0;
+      niter[proclower] = 0;
+      trial[proclower].tie[0] = trial[proclower].tie[1] = MYHUGE;
+      vlo[proclower] = box[proclower].lo[dim] - range;
+      wvlo[proclower] = 0.0;
+      vhi[proclower] = box[proclower].hi[dim];
+      wvhi[proclower] = w;
+      nmoved++;
+    }
+
+    // search for moved cuts
+    // alternate weight-interpolated guesses with bisection to insure
+    //   bracket shrinks geometrically
+    // when bracket is too small to hold dots at 2 different coords,
+    //   find that coord, fix cut there, and search in next dim
+
+    int first = 1;
+
+    while (nactive) {
+      for (m = 0; m < npart; m++) {
+        proclower = partlo[m];
+        if (!active[proclower] || first) continue;
+        s = stage[proclower];
+        double *value = s ? &trial[proclower].tie[s-1] : &trial[proclower].cut;
+        if (niter[proclower] % 2) *value = 0.5 * (vlo[proclower] + vhi[proclower]);
+        else {
+          double frac = (tgt[proclower] - wvlo[proclower]) /
+            (wvhi[proclower] - wvlo[proclower]);
+          if (frac < 0.05) frac = 0.05;
+          if (frac > 0.95) frac = 0.95;
+          *value = vlo[proclower] + frac * (vhi[proclower] - vlo[proclower]);
+        }
+      }
+      first = 0;
+
+      for (k = 0; k < nprocs; k++) wtlocal[k] = 0.0;
+      for (i = 0; i < n; i++) {
+        proclower = dotlist[i];
+        if (!active[proclower] || proclower == dotmark[i]) continue;
+        if (below(x[i],trial[proclower])) wtlocal[proclower] += wt ? wt[i] : 1.0;
+      }
+      MPI_Allreduce(wtlocal,wtglobal,nprocs,MPI_DOUBLE,MPI_SUM,world);
+      niterate++;
+
+      int ncollapse = 0;
+
+      for (m = 0; m < npart; m++) {
+        proclower = partlo[m];
+        if (!active[proclower]) continue;
+        s = stage[proclower];
+        double *value = s ? &trial[proclower].tie[s-1] : &trial[proclower].cut;
+        target = tgt[proclower];
+        w = wtglobal[proclower];
+        niter[proclower]++;
+
+        if (fabs(w - target) <= tolerance) {
+          active[proclower] = 0;
+          nactive--;
+          continue;
+        }
+
+        if (w < target) {
+          vlo[proclower] = *value;
+          wvlo[proclower] = w;
+        } else {
+          vhi[proclower] = *value;
+          wvhi[proclower] = w;
+        }
+
+        sdim = (trial[proclower].dim + s) % 3;
+        range = box[proclower].hi[sdim] - box[proclower].lo[sdim];
+        if (vhi[proclower] - vlo[proclower] <= TINY*range ||
+            niter[proclower] >= MAXITER) {
+          active[proclower] = 2;
+          ncollapse++;
+        }
+      }
+
+      if (!ncollapse) continue;
+
+      // for each collapsed bracket, find coord of the dots inside it
+      // wtlocal is re-used as min coord
+
+      for (k = 0; k < nprocs; k++) wtlocal[k] = MYHUGE;
+      for (i = 0; i < n; i++) {
+        proclower = dotlist[i];
+        if (active[proclower] != 2 || proclower == dotmark[i]) continue;
+        s = stage[proclower];
+        sdim = (trial[proclower].dim + s) % 3;
+        if (x[i][sdim] <= vlo[proclower] || x[i][sdim] > vhi[proclower]) continue;
+        if (s >= 1 && x[i][trial[proclower].dim] != trial[proclower].cut)
+          continue;
+        if (s == 2 && x[i][(trial[proclower].dim+1) % 3] !=
+            trial[proclower].tie[0]) continue;
+        if (x[i][sdim] < wtlocal[proclower]) wtlocal[proclower] = x[i][sdim];
+      }
+      MPI_Allreduce(wtlocal,wtglobal,nprocs,MPI_DOUBLE,MPI_MIN,world);
+      niterate++;
+
+      // put cut at that coord
+      // if dots there have more than target weight, search in next dim
+      //   of non-zero extent, else put cut just below them and stop
+
+      for (m = 0; m < npart; m++) {
+        proclower = partlo[m];
+        if (active[proclower] != 2) continue;
+        s = stage[proclower];
+        double *value = s ? &trial[proclower].tie[s-1] : &trial[proclower].cut;
+        target = tgt[proclower];
+
+        *value = wtglobal[proclower];
+        while (s < 2) {
+          sdim = (trial[proclower].dim + s + 1) % 3;
+          range = box[proclower].hi[sdim] - box[proclower].lo[sdim];
+          if (range > 0.0) break;
+          trial[proclower].tie[s] = box[proclower].lo[sdim];
+          s++;
+        }
+
+        if (s == 2 || niter[proclower] >= MAXITER) {
+          if (target - wvlo[proclower] <= wvhi[proclower] - target)
+            *value = vlo[proclower];
+          active[proclower] = 0;
+          nactive--;
+          continue;
+        }
+
+        s++;
+        stage[proclower] = s;
+        sdim = (trial[proclower].dim + s) % 3;
+        range = box[proclower].hi[sdim] - box[proclower].lo[sdim];
+        vlo[proclower] = box[proclower].lo[sdim] - range;
+        vhi[proclower] = box[proclower].hi[sdim];
+        active[proclower] = 1;
+        niter[proclower] = 0;
+      }
+    }
+
+    // store new cuts, route dots to one half of their partition,
+    //   split each partition and its bounding box
+
+    for (i = 0; i < n; i++) {
+      proclower = dotlist[i];
+      if (proclower == dotmark[i]) continue;
+      procmid = proclower + (dotmark[i] - proclower) / 2 + 1;
+      if (stage[proclower] < 0)
+        flag = below_owner(x[i],trial[proclower],proclower,dotmark[i]);
+      else flag = below(x[i],trial[proclower]);
+      if (flag) dotmark[i] = procmid-1;
+      else dotlist[i] = procmid;
+    }
+
+    int npartnew = 0;
+    for (m = 0; m < npart; m++) {
+      proclower = partlo[m];
+      procupper = parthi[m];
+      if (proclower == procupper) {
+        newlo[npartnew] = proclower;
+        newhi[npartnew++] = procupper;
+        continue;
+      }
+      procmid = proclower + (procupper - proclower) / 2 + 1;
+      dim = trial[proclower].dim;
+      tree[procmid] = trial[proclower];
+      box[procmid] = box[proclower];
+      box[procmid].lo[dim] = trial[proclower].cut;
+      box[proclower].hi[dim] = trial[proclower].cut;
+      newlo[npartnew] = proclower;
+      newhi[npartnew++] = procmid-1;
+      newlo[npartnew] = procmid;
+      newhi[npartnew++] = procupper;
+    }
+
+    int *tmp = partlo;
+    partlo = newlo;
+    newlo = tmp;
+    tmp = parthi;
+    parthi = newhi;
+    newhi = tmp;
+    npart = npartnew;
+  }
+
+  // set public variables with results of rebalance
+
+  nkeep = 0;
+  for (i = 0; i < n; i++) {
+    sendproc[i] = dotlist[i];
+    if (dotlist[i] == me) nkeep++;
+  }
+
+  rcbbox = box[me];
+  lo = rcbbox.lo;
+  hi = rcbbox.hi;
+
+  memory->sfree(box);
+  memory->sfree(trial);
+  memory->destroy(wtlocal);
+  memory->destroy(wtglobal);
+  memory->destroy(tgt);
+  memory->destroy(vlo);
+  memory->destroy(vhi);
+  memory->destroy(wvlo);
+  memory->destroy(wvhi);
+  memory->destroy(active);
+  memory->destroy(stage);
+  memory->destroy(niter);
+  memory->destroy(partlo);
+  memory->destroy(parthi);
+  memory->destroy(newlo);
+  memory->destroy(newhi);
+}
+
+/* ----------------------------------------------------------------------
+   return 1 if point X is in lower half of cut T, else 0
+   dots exactly at the cut coord are ordered by their coords in the
+     next 2 dims, which are compared to the tie values of the cut
+------------------------------------------------------------------------- */
+
+int RCB::below(double *x, Tree &t)
+{
+  int dim = t.dim;
+  if (x[dim] < t.cut) return 1;
+  if (x[dim] > t.cut) return 0;
+  dim = (dim+1) % 3;
+  if (x[dim] < t.tie[0]) return 1;
+  if (x[dim] > t.tie[0]) return 0;
+  dim = (dim+1) % 3;
+  if (x[dim] <= t.tie[1]) return 1;
+  return 0;
+}
+
+/* ----------------------------------------------------------------------
+   return 1 if point X is in lower half of kept cut T, else 0
+   cut T splits partition of procs PROCLOWER to PROCUPPER
+   all input dots are owned by me, so a dot exactly at the cut coord
+     is in the half that contains me, which is where the previous
+     compute() or adjust() put it
+   if I am not in the partition, use tie values of the cut
+------------------------------------------------------------------------- */
+
+int RCB::below_owner(double *x, Tree &t, int proclower, int procupper)
+{
+  if (x[t.dim] < t.cut) return 1;
+  if (x[t.dim] > t.cut) return 0;
+  if (me < proclower || me > procupper) return below(x,t);
+  int procmid = proclower + (procupper - proclower) / 2 + 1;
+  if (me < procmid) return 1;
+  return 0;
 }
 
 /* ----------------------------------------------------------------------
@@ -38,9 +38,20 @@ class RCB : protected Pointers {
   int *sendproc;              // proc to send each of my noriginal dots to
   int *sendindex;             // index of dot in receiver's nfinal list
 
+  // set by caller before compute()
+
+  int keeptree;               // 1 if compute() keeps cut tree for adjust()
+
+  // set by adjust()
+
+  int treeflag;               // 1 if cut tree from a previous call exists
+  int nmoved;                 // # of cuts adjust() had to move
+  int niterate;               // # of cut search iterations in adjust()
+
   RCB(class SPARTA *);
   ~RCB();
   void compute(int, double **, double *, char *, int flip=0);
+  void adjust(int, double **, double *);
   void invert();
   void check();
   void stats(int);
@@ -79,6 +90,8 @@ class RCB : protected Pointers {
   struct Tree {
     double cut;        	// position of cut
     int dim;	        // dimension = 0/1/2 of cut
+    double tie[2];      // cuts in next 2 dims for dots exactly at cut
+                        // used by adjust() to split a plane of dots
   };
 
   // inversion message
@@ -112,7 +125,11 @@ class RCB : protected Pointers {
   int reuse;        // 1/0 to use/not use previous cuts
   int dottop;       // dots >= this index are new
   BBox rcbbox;      // bounding box of final RCB sub-domain
-  Tree *tree;       // tree of RCB cuts, used by reuse()
+  Tree *tree;       // tree of RCB cuts, used by reuse() and adjust()
+                    // tree[p] = cut whose upper half starts with proc p
+  int below(double *, Tree &);
+  int below_owner(double *, Tree &, int, int);
+
   int counters[7];  // diagnostic counts
 		    // 0 = # of median iterations
 		    // 1 = # of points sent
@@ -36,6 +36,9 @@ React::React(SPARTA *sparta, int, char **arg) : Pointers(sparta)
   recomb_boost = 1000.0;
   recomb_boost_inverse = 0.001;
 
+  ntable = 0;
+  table_emax = 0.0;
+
   random = new RanPark(update->ranmaster->uniform());
   double seed = update->ranmaster->uniform();
   random->reset(seed,comm->me,100);
@@ -73,6 +76,14 @@ void React::modify_params(int narg, char **arg)
       if (recomb_boost < 1.0) error->all(FLERR,"Illegal react_modify command");
       recomb_boost_inverse = 1.0 / recomb_boost;
       iarg += 2;
+    } else if (strcmp(arg[iarg],"table") == 0) {
+      if (iarg+3 > narg) error->all(FLERR,"Illegal react_modify command");
+      ntable = input->inumeric(FLERR,arg[iarg+1]);
+      table_emax = input->numeric(FLERR,arg[iarg+2]);
+      if (ntable < 0) error->all(FLERR,"Illegal react_modify command");
+      if (ntable && table_emax <= 0.0)
+        error->all(FLERR,"Illegal react_modify command");
+      iarg += 3;
     } else error->all(FLERR,"Illegal react_modify command");
   }
 }
@@ -33,10 +33,16 @@ class React : protected Pointers {
   double recomb_boost_inverse;   // inverse of boost parameter
   Particle::OnePart *recomb_part3;  // ptr to 3rd particle in recomb reaction
 
+  int ntable;                // # of points per octave of collision energy
+                             //   in reaction probability tables,
+                             //   0 = evaluate formula for every collision
+  double table_emax;         // max collision energy above threshold in table
+
   int copy,copymode;         // 1 if class copy
 
   React(class SPARTA *, int, char **);
-  React(class SPARTA *sparta) : Pointers(sparta) { style = NULL; random = NULL; }
+  React(class SPARTA *sparta) : Pointers(sparta)
+    { style = NULL; random = NULL; ntable = 0; table_emax = 0.0; }
   virtual ~React();
   virtual void init() {}
   virtual int recomb_exist(int, int) = 0;
@@ -41,6 +41,7 @@ enum{ARRHENIUS,QUANTUM};                               // other react files
 
 #define MAXLINE 1024
 #define DELTALIST 16
+#define TABLE_TOLERANCE 1.0e-3   // max relative error allowed in ptable
 
 /* ---------------------------------------------------------------------- */
 
@@ -61,6 +62,9 @@ ReactBird::ReactBird(SPARTA *sparta, int narg, char **arg) :
   reactions = NULL;
   list_ij = NULL;
   sp2recomb_ij = NULL;
+
+  ptable = NULL;
+  ptable_flag = NULL;
 }
 
 /* ---------------------------------------------------------------------- */
@@ -71,6 +75,9 @@ ReactBird::ReactBird(SPARTA *sparta) : React(sparta)
   reactions = NULL;
   list_ij = NULL;
   sp2recomb_ij = NULL;
+
+  ptable = NULL;
+  ptable_flag = NULL;
 }
 
 /* ---------------------------------------------------------------------- */
@@ -101,6 +108,9 @@ ReactBird::~ReactBird()
   memory->destroy(reactions);
   memory->destroy(list_ij);
   memory->destroy(sp2recomb_ij);
+
+  memory->destroy(ptable);
+  memory->destroy(ptable_flag);
 }
 
 /* ---------------------------------------------------------------------- */
@@ -406,6 +416,109 @@ void ReactBird::init()
     }
 }
 
+/* ----------------------------------------------------------------------
+   tabulate TCE reaction probability for each active reaction
+   table covers collision energy above threshold from
+     table_emax/2^TABLE_OCTAVES to table_emax, with Ntable points per octave,
+     so relative resolution is the same near threshold and far above it
+   check interpolated values at interval midpoints against formula,
+     reactions exceeding TABLE_TOLERANCE fall back to formula
+   called from init() of TCE-based child classes after ReactBird::init()
+------------------------------------------------------------------------- */
+
+void ReactBird::create_tables()
+{
+  memory->destroy(ptable);
+  memory->destroy(ptable_flag);
+  ptable = NULL;
+  ptable_flag = NULL;
+  if (!ntable) return;
+
+  ptable_size = TABLE_OCTAVES*ntable + 1;
+  memory->create(ptable,nlist,ptable_size,"react/bird:ptable");
+  memory->create(ptable_flag,nlist,"react/bird:ptable_flag");
+  table_scale = 1.0 / table_emax;
+
+  // energy above threshold at table point K and halfway to point K+1
+
+  double *excess,*excess_mid;
+  memory->create(excess,ptable_size,"react/bird:excess");
+  memory->create(excess_mid,ptable_size,"react/bird:excess_mid");
+
+  for (int octave = 0; octave < TABLE_OCTAVES; octave++) {
+    double base = table_emax * pow(2.0,octave-TABLE_OCTAVES);
+    for (int j = 0; j < ntable; j++) {
+      excess[octave*ntable+j] = base * (1.0 + (double) j/ntable);
+      excess_mid[octave*ntable+j] = base * (1.0 + (j+0.5)/ntable);
+    }
+  }
+  excess[ptable_size-1] = table_emax;
+
+  int nactive = 0;
+  int ntabulated = 0;
+  double errmax_all = 0.0;
+
+  for (int m = 0; m < nlist; m++) {
+    OneReaction *r = &rlist[m];
+    ptable_flag[m] = 0;
+    if (!r->active) continue;
+    nactive++;
+
+    double *p = ptable[m];
+    int finite = 1;
+    for (int k = 0; k < ptable_size; k++) {
+      p[k] = tce_prob(r,r->coeff[1] + excess[k]);
+      if (!isfinite(p[k])) finite = 0;
+    }
+    if (!finite) continue;
+
+    double errmax = 0.0;
+    for (int k = 0; k < ptable_size-1; k++) {
+      double exact = tce_prob(r,r->coeff[1] + excess_mid[k]);
+      if (exact <= 0.0) continue;
+      double err = fabs(0.5*(p[k]+p[k+1]) - exact) / exact;
+      errmax = MAX(errmax,err);
+    }
+
+    if (errmax > TABLE_TOLERANCE) continue;
+    ptable_flag[m] = 1;
+    ntabulated++;
+    errmax_all = MAX(errmax_all,errmax);
+  }
+
+  memory->destroy(excess);
+  memory->destroy(excess_mid);
+
+  if (comm->me == 0) {
+    if (screen)
+      fprintf(screen,"Reaction tables: %d of %d reactions tabulated, "
+              "max relative error = %g\n",ntabulated,nactive,errmax_all);
+    if (logfile)
+      fprintf(logfile,"Reaction tables: %d of %d reactions tabulated, "
+              "max relative error = %g\n",ntabulated,nactive,errmax_all);
+  }
+
+  if (ntabulated < nactive && comm->me == 0)
+    error->warning(FLERR,"Some reaction tables exceed accuracy tolerance, "
+                   "using formula for them");
+}
+
+/* ----------------------------------------------------------------------
+   TCE reaction probability for reaction R at collision energy ecc
+   recombination probability excludes boost and density factors
+   coeffs were converted by init(): C1 = coeff[2], C2 = coeff[3]
+------------------------------------------------------------------------- */
+
+double ReactBird::tce_prob(OneReaction *r, double ecc)
+{
+  if (r->type == RECOMBINATION)
+    return r->coeff[2] * pow(ecc,r->coeff[3]) *
+      pow(1.0-r->coeff[1]/ecc,r->coeff[5]);
+
+  return r->coeff[2] * pow(ecc-r->coeff[1],r->coeff[3]) *
+    pow(1.0-r->coeff[1]/ecc,r->coeff[5]);
+}
+
 /* ----------------------------------------------------------------------
    return 1 if any recombination reactions are defined for species pair ISP,JSP
    else return 0
@@ -16,11 +16,14 @@
 #define SPARTA_REACT_BIRD_H
 
 #include "stdio.h"
+#include "math.h"
 #include "react.h"
 #include "particle.h"
 
 namespace SPARTA_NS {
 
+#define TABLE_OCTAVES 40         // range of ptable = factor of 2^40 in energy
+
 class ReactBird : public React {
  public:
   ReactBird(class SPARTA *, int, char **);
@@ -86,6 +89,39 @@ class ReactBird : public React {
                               //   length of each chunk is # of species
                               // pointed into by reactions[i][k].sp2recomb
 
+  // tabulated TCE reaction probabilities, enabled by react_modify table
+
+  double **ptable;            // per-reaction probability vs collision energy
+                              //   above threshold, Ntable points per octave
+  int *ptable_flag;           // 1 if reaction uses its table, 0 if formula
+  int ptable_size;            // # of points in each table
+  double table_scale;         // 1/table_emax
+
+  void create_tables();
+  double tce_prob(OneReaction *, double);
+
+  // TCE probability for reaction M at collision energy ecc > threshold
+  // frexp() of scaled excess energy gives octave and position within it,
+  //   so table spacing is geometric across and linear within octaves
+  // linear interpolation in table, formula outside of table range
+
+  inline double tce_prob_lookup(int m, double ecc)
+  {
+    OneReaction *r = &rlist[m];
+    if (ntable && ptable_flag[m]) {
+      int ex;
+      double mant = frexp((ecc - r->coeff[1]) * table_scale,&ex);
+      int octave = ex + TABLE_OCTAVES - 1;
+      if (octave >= 0 && octave < TABLE_OCTAVES) {
+        double x = (2.0*mant - 1.0) * ntable;
+        int j = static_cast<int> (x);
+        double *p = &ptable[m][octave*ntable + j];
+        return p[0] + (x-j)*(p[1]-p[0]);
+      }
+    }
+    return tce_prob(r,ecc);
+  }
+
   void readfile(char *);
   int readone(char *, char *, int &, int &);
   void check_duplicate();
@@ -140,4 +176,9 @@ E: Invalid reaction coefficients in file
 
 Self-explanatory.
 
+W: Some reaction tables exceed accuracy tolerance, using formula for them
+
+Interpolation in the table set by react_modify table was not accurate
+enough for some reactions.  Use more table points or a smaller emax.
+
 */
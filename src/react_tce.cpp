@@ -38,6 +38,7 @@ void ReactTCE::init()
     error->all(FLERR,"React tce can only be used with collide vss");
 
   ReactBird::init();
+  create_tables();
 }
 
 /* ---------------------------------------------------------------------- */
@@ -86,9 +87,7 @@ int ReactTCE::attempt(Particle::OnePart *ip, Particle::OnePart *jp,
     case IONIZATION:
     case EXCHANGE:
       {
-        react_prob += r->coeff[2] *
-          pow(ecc-r->coeff[1],r->coeff[3]) *
-          pow(1.0-r->coeff[1]/ecc,r->coeff[5]);
+        react_prob += tce_prob_lookup(list[i],ecc);
         break;
       }
 
@@ -106,9 +105,8 @@ int ReactTCE::attempt(Particle::OnePart *ip, Particle::OnePart *jp,
         int *sp2recomb = reactions[isp][jsp].sp2recomb;
         if (sp2recomb[recomb_species] != list[i]) continue;
 
-        react_prob += recomb_boost * recomb_density * r->coeff[2] *
-          pow(ecc,r->coeff[3]) *
-          pow(1.0-r->coeff[1]/ecc,r->coeff[5]);
+        react_prob += recomb_boost * recomb_density *
+          tce_prob_lookup(list[i],ecc);
         break;
       }
 
@@ -40,6 +40,7 @@ void ReactTCEQK::init()
     error->all(FLERR,"React tce/qk can only be used with collide vss");
 
   ReactBird::init();
+  create_tables();
 
   // do not allow recombination reactions for now
 
@@ -131,9 +132,7 @@ int ReactTCEQK::attempt_tce(Particle::OnePart *ip, Particle::OnePart *jp,
   case DISSOCIATION:
   case EXCHANGE:
     {
-      react_prob += r->coeff[2] *
-        pow(ecc-r->coeff[1],r->coeff[3]) *
-        pow(1.0-r->coeff[1]/ecc,r->coeff[5]);
+      react_prob += tce_prob_lookup(r-rlist,ecc);
       break;
     }
 
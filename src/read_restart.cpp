@@ -45,7 +45,8 @@ enum{VERSION,SMALLINT,CELLINT,BIGINT,
      DIMENSION,AXISYMMETRIC,BOXLO,BOXHI,BFLAG,
      NPARTICLE,NUNSPLIT,NSPLIT,NSUB,NPOINT,NSURF,
      SPECIES,MIXTURE,PARTICLE_CUSTOM,GRID,SURF,
-     MULTIPROC,PROCSPERFILE,PERPROC};    // new fields added after PERPROC
+     MULTIPROC,PROCSPERFILE,PERPROC,     // new fields added after PERPROC
+     MPIIO,CELL_WEIGHT};
 
 /* ---------------------------------------------------------------------- */
 
@@ -84,6 +85,13 @@ void ReadRestart::command(int narg, char **arg)
   if (strchr(arg[0],'%')) multiproc = 1;
   else multiproc = 0;
 
+  // check for MPI-IO file
+
+  char *suffix = file + strlen(file) - strlen(".mpiio");
+  if (suffix > file && strcmp(suffix,".mpiio") == 0) mpiio = 1;
+  else mpiio = 0;
+  mpiio_file = 0;
+
   // open single restart file or base file for multiproc case
 
   if (me == 0) {
@@ -134,7 +142,9 @@ void ReadRestart::command(int narg, char **arg)
   // read header info which creates simulation box
   // also read particle params: species, mixture, custom attributes
   // also read parent grid and surfs
+  // files written before cell weights were stored do not set the flag
 
+  grid->weightrestartflag = 0;
   header(incompatible);
 
   box_params();
@@ -153,6 +163,11 @@ void ReadRestart::command(int narg, char **arg)
 
   file_layout();
 
+  if (mpiio && !mpiio_file)
+    error->all(FLERR,"Restart file is not an MPI-IO file");
+  if (!mpiio && mpiio_file)
+    error->all(FLERR,"Restart file is an MPI-IO file");
+
   // close header file if in multiproc mode
 
   if (multiproc && me == 0) fclose(fp);
@@ -181,7 +196,11 @@ void ReadRestart::command(int narg, char **arg)
   particle->exist = 1;
   procmatch_check = 0;
 
-  if (multiproc == 0 && nprocs_file == nprocs) {
+  // input of MPI-IO file, see read_mpiio()
+
+  if (mpiio) read_mpiio(file);
+
+  else if (multiproc == 0 && nprocs_file == nprocs) {
 
     if (me == 0) {
       for (int iproc = 0; iproc < nprocs_file; iproc++) {
@@ -715,7 +734,9 @@ void ReadRestart::command(int narg, char **arg)
 
   // setup the grid
 
-  if (grid->cellweightflag) grid->weight(-1,NULL);
+  // cell weights stored in file were set by create_child_cells()
+
+  if (grid->cellweightflag && !grid->weightrestartflag) grid->weight(-1,NULL);
   grid->set_maxlevel();
   grid->setup_owned();
 
@@ -800,6 +821,11 @@ void ReadRestart::command(int narg, char **arg)
   // gridcut can be reset to negative value
   // re-balance can be triggered (with no output)
 
+  // MPI-IO file read on a different # of procs leaves cell counts uneven
+  // unless a balance is requested below, spread cells evenly in file order
+
+  if (mpiio && nprocs_file != nprocs && !balanceflag) redistribute_cells();
+
   if (surf->exist && grid->cutoff >= 0.0 && grid->clumped == 0) {
     if (gridcutflag) grid->cutoff = input->numeric(FLERR,arg[gridcutflag]);
     else if (balanceflag) {
@@ -853,6 +879,125 @@ void ReadRestart::command(int narg, char **arg)
   }
 }
 
+/* ----------------------------------------------------------------------
+   read per-proc chunks of an MPI-IO restart file written on nprocs_file procs
+   all procs read chunk size index after header, then their own chunks
+   proc I reads contiguous chunks I*Pfile/P to (I+1)*Pfile/P - 1,
+     so if Pfile = P each proc reads back exactly what it wrote
+   reads are collective, so all procs loop over same # of chunks
+------------------------------------------------------------------------- */
+
+void ReadRestart::read_mpiio(char *file)
+{
+  // header size = current position of proc 0 in header file
+
+  bigint hsize;
+  if (me == 0) {
+    hsize = ftell(fp);
+    fclose(fp);
+  }
+  MPI_Bcast(&hsize,1,MPI_SPARTA_BIGINT,0,world);
+
+  MPI_File fh;
+  int err = MPI_File_open(world,file,MPI_MODE_RDONLY,MPI_INFO_NULL,&fh);
+  if (err != MPI_SUCCESS) error->all(FLERR,"Cannot open MPI-IO restart file");
+
+  bigint *chunksize;
+  memory->create(chunksize,nprocs_file,"read_restart:chunksize");
+  err = MPI_File_read_at_all(fh,hsize,chunksize,nprocs_file,MPI_SPARTA_BIGINT,
+                             MPI_STATUS_IGNORE);
+  if (err != MPI_SUCCESS) error->all(FLERR,"Cannot read MPI-IO restart file");
+
+  int first = static_cast<int> ((bigint) me*nprocs_file/nprocs);
+  int last = static_cast<int> ((bigint) (me+1)*nprocs_file/nprocs);
+  int nchunk_max = nprocs_file/nprocs + 1;
+
+  MPI_Offset offset = hsize + (MPI_Offset) nprocs_file*sizeof(bigint);
+  for (int i = 0; i < first; i++) offset += chunksize[i];
+
+  int n;
+  int maxbuf = 0;
+  char *buf = NULL;
+
+  for (int ichunk = 0; ichunk < nchunk_max; ichunk++) {
+    int iproc = first + ichunk;
+    if (iproc < last) {
+      if (chunksize[iproc] > MAXSMALLINT)
+        error->one(FLERR,"Restart file read buffer too large");
+      n = chunksize[iproc];
+    } else n = 0;
+
+    if (n > maxbuf) {
+      maxbuf = n;
+      memory->destroy(buf);
+      memory->create(buf,maxbuf,"read_restart:buf");
+    }
+
+    err = MPI_File_read_at_all(fh,offset,buf,n,MPI_CHAR,MPI_STATUS_IGNORE);
+    if (err != MPI_SUCCESS) error->one(FLERR,"Cannot read MPI-IO restart file");
+    offset += n;
+
+    if (iproc < last) {
+      n = grid->unpack_restart(buf);
+      create_child_cells(0);
+      n += particle->unpack_restart(&buf[n]);
+      assign_particles(0);
+    }
+  }
+
+  MPI_File_close(&fh);
+  memory->destroy(buf);
+  memory->destroy(chunksize);
+}
+
+/* ----------------------------------------------------------------------
+   reassign owned cells so each proc has an equal share
+   unsplit and split cells are numbered in proc order, which is file order,
+     and proc I gets a contiguous range of them
+   sub cells and particles move with their cell in one migrate_cells() call
+------------------------------------------------------------------------- */
+
+void ReadRestart::redistribute_cells()
+{
+  Grid::ChildCell *cells = grid->cells;
+  int nglocal = grid->nlocal;
+
+  bigint nme = 0;
+  for (int icell = 0; icell < nglocal; icell++)
+    if (cells[icell].nsplit > 0) nme++;
+
+  bigint nupto,ntotal;
+  MPI_Scan(&nme,&nupto,1,MPI_SPARTA_BIGINT,MPI_SUM,world);
+  MPI_Allreduce(&nme,&ntotal,1,MPI_SPARTA_BIGINT,MPI_SUM,world);
+
+  bigint index = nupto - nme;
+  int nmigrate = 0;
+
+  for (int icell = 0; icell < nglocal; icell++) {
+    if (cells[icell].nsplit <= 0) continue;
+    int newproc = static_cast<int> (index*nprocs/ntotal);
+    index++;
+    if (newproc != me) {
+      cells[icell].proc = newproc;
+      nmigrate++;
+    }
+  }
+
+  // same sequence as BalanceGrid, ghosts do not yet exist
+
+  particle->sort();
+
+  domain->boundary_collision_check = 0;
+  surf->surf_collision_check = 0;
+  sparta->init();
+  domain->boundary_collision_check = 1;
+  surf->surf_collision_check = 1;
+
+  comm->migrate_cells(nmigrate);
+  grid->hashfilled = 0;
+  grid->setup_owned();
+}
+
 /* ----------------------------------------------------------------------
    infile contains a "*"
    search for all files which match the infile pattern
@@ -1022,6 +1167,8 @@ void ReadRestart::header(int incompatible)
       comm->commpartstyle = read_int();
     } else if (flag == GRID_WEIGHT) {
       grid->cellweightflag = read_int();
+    } else if (flag == CELL_WEIGHT) {
+      grid->weightrestartflag = read_int();
 
     } else if (flag == NPARTICLE) {
       nparticle_file = read_bigint();
@@ -1143,6 +1290,9 @@ void ReadRestart::file_layout()
       if (multiproc && multiproc_file == 0)
         error->all(FLERR,"Restart file is a multi-proc file");
 
+    } else if (flag == MPIIO) {
+      mpiio_file = read_int();
+
     } else error->all(FLERR,"Invalid flag in layout section of restart file");
 
     flag = read_int();
@@ -1195,6 +1345,8 @@ void ReadRestart::create_child_cells(int skipflag)
       icell = grid->nlocal - 1;
       (*hash)[id] = icell;
       grid->cells[icell].nsplit = nsplit;
+      if (grid->weightrestartflag)
+        grid->cinfo[icell].weight = grid->weight_restart[i];
       if (nsplit > 1) {
         grid->nunsplitlocal--;
         grid->add_split_cell(1);
@@ -1215,6 +1367,8 @@ void ReadRestart::create_child_cells(int skipflag)
       grid->add_sub_cell(index,1);
       icell = grid->nlocal - 1;
       grid->cells[icell].nsplit = nsplit;
+      if (grid->weightrestartflag)
+        grid->cinfo[icell].weight = grid->weight_restart[i];
       isplit = grid->cells[icell].isplit;
       grid->sinfo[isplit].csubs[-nsplit] = icell;
     }
@@ -1225,6 +1379,7 @@ void ReadRestart::create_child_cells(int skipflag)
   memory->destroy(grid->id_restart);
   memory->destroy(grid->level_restart);
   memory->destroy(grid->nsplit_restart);
+  if (grid->weightrestartflag) memory->destroy(grid->weight_restart);
 }
 
 /* ----------------------------------------------------------------------
@@ -38,6 +38,8 @@ class ReadRestart : protected Pointers {
 
   int multiproc;             // 0 = proc 0 writes for all
                              // else # of procs writing files
+  int mpiio;                 // 1 if reading a file written via MPI-IO
+  int mpiio_file;            // 1 if file layout says it is an MPI-IO file
 
   bigint nparticle_file;
   bigint nunsplit_file;
@@ -51,6 +53,8 @@ class ReadRestart : protected Pointers {
   void grid_params();
   int surf_params();
   void file_layout();
+  void read_mpiio(char *);
+  void redistribute_cells();
 
   void create_child_cells(int);
   void assign_particles(int);
@@ -176,6 +180,27 @@ E: Restart file is a multi-proc file
 
 The file is inconsistent with the filename specified for it.
 
+E: Restart file is not an MPI-IO file
+
+The file is inconsistent with the filename specified for it.
+
+E: Restart file is an MPI-IO file
+
+The file is inconsistent with the filename specified for it.  Files
+written via MPI-IO must keep their .mpiio suffix.
+
+E: Cannot open MPI-IO restart file
+
+The file could not be opened collectively by all processors.
+
+E: Cannot read MPI-IO restart file
+
+A collective read from the file failed, or the file is truncated.
+
+E: Restart file read buffer too large
+
+One per-processor chunk in the file is larger than 2 GB.
+
 E: Invalid flag in layout section of restart file
 
 Unrecognized entry in restart file.
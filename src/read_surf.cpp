@@ -17,6 +17,9 @@
 #include "stdlib.h"
 #include "ctype.h"
 #include "dirent.h"
+#include "fcntl.h"
+#include "unistd.h"
+#include "sys/mman.h"
 #include "read_surf.h"
 #include "math_extra.h"
 #include "surf.h"
@@ -37,6 +40,7 @@ enum{NEITHER,BAD,GOOD};
 enum{NONE,CHECK,KEEP};
 enum{UNKNOWN,OUTSIDE,INSIDE,OVERLAP};           // several files
 enum{LOCAL,MINE,TEMPALL,TEMPSTRIDE};
+enum{TEXT,BINARY,STL};                         // surf file formats
 
 #define MAXLINE 256
 #define CHUNK 16384
@@ -44,6 +48,8 @@ enum{LOCAL,MINE,TEMPALL,TEMPSTRIDE};
 #define BIG 1.0e20
 #define DELTA 128           // must be 2 or greater
 #define DELTA_DISCARD 128
+#define MAGIC_BINARY "SPARTASF"   // must match WriteSurf
+#define VERSION_BINARY 1
 
 /* ---------------------------------------------------------------------- */
 
@@ -99,6 +105,20 @@ void ReadSurf::command(int narg, char **arg)
   if (strchr(arg[0],'%')) multiproc = 1;
   else multiproc = 0;
 
+  // check for binary file formats, detected by suffix
+
+  binary = TEXT;
+  char *suffix = file + strlen(file) - strlen(".bin");
+  if (suffix > file && strcmp(suffix,".bin") == 0) binary = BINARY;
+  suffix = file + strlen(file) - strlen(".stl");
+  if (suffix > file &&
+      (strcmp(suffix,".stl") == 0 || strcmp(suffix,".STL") == 0)) binary = STL;
+
+  if (binary && multiproc)
+    error->all(FLERR,"Read_surf binary file cannot be multiple files");
+  if (binary == STL && dim == 2)
+    error->all(FLERR,"Read_surf STL file requires 3d simulation");
+
   if (me == 0)
     if (screen) fprintf(screen,"Reading surface file ...\n");
 
@@ -113,7 +133,8 @@ void ReadSurf::command(int narg, char **arg)
   // files may list Points or not
   // store surfs as distributed or all
 
-  if (!multiproc) read_single(file);
+  if (binary) read_binary(file);
+  else if (!multiproc) read_single(file);
   else read_multiple(file);
 
   delete [] file;
@@ -447,14 +468,270 @@ void ReadSurf::read_multiple(char *file)
   delete [] procfile;
 
   // communicate surf data from tmplines/tmptris to lines/tris or mylines/mytris
+
+  distribute_temporary(nsurf_basefile);
+
+  // clean-up
+
+  MPI_Comm_free(&filecomm);
+  memory->sfree(surf->tmplines);
+  memory->sfree(surf->tmptris);
+
+  // surf counts, stats, error check
+
+  surf_counts();
+}
+
+/* ----------------------------------------------------------------------
+   read a single binary file, either SPARTA binary surf format or binary STL
+   each proc memory-maps and parses a contiguous chunk of the elements
+   store surfs initially in distributed tmplines/tmptris
+   communicate to populate lines/tris (all) or mylines/mytris (distributed)
+------------------------------------------------------------------------- */
+
+void ReadSurf::read_binary(char *file)
+{
+  // surf counts before new read
+
+  nsurf_total_old = surf->nsurf;
+  if (distributed) nsurf_old = surf->nown;
+  else nsurf_old = surf->nlocal;
+
+  // proc 0 reads and checks header, bcasts element count
+
+  bigint nfile,hsize,recsize;
+  if (me == 0) binary_header(file,nfile,hsize,recsize);
+  MPI_Bcast(&nfile,1,MPI_SPARTA_BIGINT,0,world);
+  MPI_Bcast(&hsize,1,MPI_SPARTA_BIGINT,0,world);
+  MPI_Bcast(&recsize,1,MPI_SPARTA_BIGINT,0,world);
+
+  if (nfile > MAXSMALLINT) error->all(FLERR,"Read surf nsurf is too large");
+  nsurf_file = nfile;
+  npoint_file = 0;
+
+  // setup for read into temporary tmplines/tmptris
+  // my chunk = elements ilo to ihi-1 in file
+
+  surf->ntmp = surf->nmaxtmp = 0;
+  surf->tmplines = NULL;
+  surf->tmptris = NULL;
+
+  bigint ilo = nfile*me/nprocs;
+  bigint ihi = nfile*(me+1)/nprocs;
+  int nmine = ihi - ilo;
+
+  if (nmine) {
+    surf->nmaxtmp = nmine;
+    surf->grow_temporary(0);
+
+    // map only the pages spanning my chunk
+
+    bigint offset = hsize + ilo*recsize;
+    bigint pagesize = sysconf(_SC_PAGESIZE);
+    bigint mapstart = offset - offset % pagesize;
+    size_t maplen = offset - mapstart + nmine*recsize;
+
+    int fd = ::open(file,O_RDONLY);
+    if (fd < 0) {
+      char str[128];
+      sprintf(str,"Cannot open file %s",file);
+      error->one(FLERR,str);
+    }
+    void *map = mmap(NULL,maplen,PROT_READ,MAP_PRIVATE,fd,(off_t) mapstart);
+    if (map == MAP_FAILED) error->one(FLERR,"Cannot memory-map surf file");
+    madvise(map,maplen,MADV_SEQUENTIAL);
+
+    char *ptr = (char *) map + (offset - mapstart);
+
+    // binary STL: 12 floats + 2-byte attribute per tri, IDs are implicit
+    // SPARTA binary: int64 ID and type, 4 or 9 doubles per element
+
+    int i,j,type;
+    int64_t ivalues[2];
+    float fvalues[12];
+    double x[9];
+    surfint id;
+
+    if (binary == STL) {
+      for (i = 0; i < nmine; i++) {
+        memcpy(fvalues,ptr,12*sizeof(float));
+        for (j = 0; j < 9; j++) x[j] = fvalues[j+3];
+        id = nsurf_total_old + ilo + i + 1;
+        surf->add_tri_temporary(id,1,&x[0],&x[3],&x[6]);
+        ptr += recsize;
+      }
+
+    } else {
+      int nvalues;
+      if (dim == 2) nvalues = 4;
+      else nvalues = 9;
+      for (i = 0; i < nmine; i++) {
+        memcpy(ivalues,ptr,2*sizeof(int64_t));
+        memcpy(x,ptr+2*sizeof(int64_t),nvalues*sizeof(double));
+        if (ivalues[0] < 1 || ivalues[0] > nfile)
+          error->one(FLERR,"Invalid surf ID in read_surf file");
+        id = nsurf_total_old + ivalues[0];
+        type = ivalues[1];
+        if (dim == 2) {
+          double x1[2] = {x[0],x[1]};
+          double x2[2] = {x[2],x[3]};
+          surf->add_line_temporary(id,type,x1,x2);
+        } else surf->add_tri_temporary(id,type,&x[0],&x[3],&x[6]);
+        ptr += recsize;
+      }
+    }
+
+    munmap(map,maplen);
+    close(fd);
+  }
+
+  // communicate surf data from tmplines/tmptris to lines/tris or mylines/mytris
+  // for all: file order need not be ID order if it was written by
+  //   distributed procs, so put each new surf at index of its ID
+  //   every ID from 1 to nfile must then appear exactly once
+
+  distribute_temporary(nfile);
+
+  if (!distributed) {
+    int n = nfile;
+    int sorted = 1;
+    int *hit = NULL;
+    if (dim == 2) {
+      Surf::Line *lines = &surf->lines[nsurf_old];
+      for (int i = 0; i < n; i++)
+        if (lines[i].id != nsurf_total_old+i+1) sorted = 0;
+      if (!sorted) {
+        memory->create(hit,n,"read_surf:hit");
+        for (int i = 0; i < n; i++) hit[i] = 0;
+        for (int i = 0; i < n; i++) hit[lines[i].id-nsurf_total_old-1]++;
+        for (int i = 0; i < n; i++)
+          if (hit[i] != 1)
+            error->all(FLERR,"Duplicate or missing surf ID in read_surf file");
+        memory->destroy(hit);
+
+        Surf::Line *copy = (Surf::Line *)
+          memory->smalloc(n*sizeof(Surf::Line),"read_surf:copy");
+        memcpy(copy,lines,n*sizeof(Surf::Line));
+        for (int i = 0; i < n; i++)
+          memcpy(&lines[copy[i].id-nsurf_total_old-1],&copy[i],
+                 sizeof(Surf::Line));
+        memory->sfree(copy);
+      }
+    } else {
+      Surf::Tri *tris = &surf->tris[nsurf_old];
+      for (int i = 0; i < n; i++)
+        if (tris[i].id != nsurf_total_old+i+1) sorted = 0;
+      if (!sorted) {
+        memory->create(hit,n,"read_surf:hit");
+        for (int i = 0; i < n; i++) hit[i] = 0;
+        for (int i = 0; i < n; i++) hit[tris[i].id-nsurf_total_old-1]++;
+        for (int i = 0; i < n; i++)
+          if (hit[i] != 1)
+            error->all(FLERR,"Duplicate or missing surf ID in read_surf file");
+        memory->destroy(hit);
+
+        Surf::Tri *copy = (Surf::Tri *)
+          memory->smalloc(n*sizeof(Surf::Tri),"read_surf:copy");
+        memcpy(copy,tris,n*sizeof(Surf::Tri));
+        for (int i = 0; i < n; i++)
+          memcpy(&tris[copy[i].id-nsurf_total_old-1],&copy[i],
+                 sizeof(Surf::Tri));
+        memory->sfree(copy);
+      }
+    }
+  }
+
+  // clean-up
+
+  memory->sfree(surf->tmplines);
+  memory->sfree(surf->tmptris);
+
+  // surf counts, stats, error check
+
+  surf_counts();
+}
+
+/* ----------------------------------------------------------------------
+   read and check header of a binary surf file
+   return element count, header size, and bytes per element
+   only called by proc 0
+------------------------------------------------------------------------- */
+
+void ReadSurf::binary_header(char *file, bigint &nfile,
+                             bigint &hsize, bigint &recsize)
+{
+  FILE *fbin = fopen(file,"rb");
+  if (fbin == NULL) {
+    char str[128];
+    sprintf(str,"Cannot open file %s",file);
+    error->one(FLERR,str);
+  }
+
+  fseek(fbin,0,SEEK_END);
+  bigint filesize = ftell(fbin);
+  fseek(fbin,0,SEEK_SET);
+
+  // binary STL = 80-byte header, uint32 count, 50 bytes per triangle
+  // an ASCII STL file will not match the expected size
+
+  if (binary == STL) {
+    char header[80];
+    uint32_t ntri;
+    if (fread(header,80,1,fbin) != 1 || fread(&ntri,sizeof(uint32_t),1,fbin) != 1)
+      error->one(FLERR,"Unexpected end of STL file");
+    nfile = ntri;
+    hsize = 80 + sizeof(uint32_t);
+    recsize = 12*sizeof(float) + sizeof(uint16_t);
+    if (filesize != hsize + nfile*recsize)
+      error->one(FLERR,"STL file is not a valid binary STL file");
+
+  // SPARTA binary = magic string, int version, int dim, int64 count
+
+  } else {
+    char magic[8];
+    int version,fdim;
+    int64_t n;
+    if (fread(magic,8,1,fbin) != 1 || fread(&version,sizeof(int),1,fbin) != 1 ||
+        fread(&fdim,sizeof(int),1,fbin) != 1 ||
+        fread(&n,sizeof(int64_t),1,fbin) != 1)
+      error->one(FLERR,"Unexpected end of surf file");
+    if (strncmp(magic,MAGIC_BINARY,8) != 0)
+      error->one(FLERR,"Invalid binary surf file header");
+    if (version != VERSION_BINARY)
+      error->one(FLERR,"Unsupported binary surf file version");
+    if (fdim != dim)
+      error->one(FLERR,"Binary surf file dimension does not match simulation");
+    nfile = n;
+    hsize = 8 + 2*sizeof(int) + sizeof(int64_t);
+    if (dim == 2) recsize = 2*sizeof(int64_t) + 4*sizeof(double);
+    else recsize = 2*sizeof(int64_t) + 9*sizeof(double);
+    if (filesize < hsize + nfile*recsize)
+      error->one(FLERR,"Unexpected end of surf file");
+  }
+
+  if (nfile == 0) {
+    if (dim == 2) error->one(FLERR,"Surf file does not contain lines");
+    else error->one(FLERR,"Surf file does not contain triangles");
+  }
+
+  fclose(fbin);
+}
+
+/* ----------------------------------------------------------------------
+   communicate surf data from tmplines/tmptris to lines/tris or mylines/mytris
+   nsurf_read = total # of surfs read from file(s) into tmplines/tmptris
+------------------------------------------------------------------------- */
+
+void ReadSurf::distribute_temporary(bigint nsurf_read)
+{
   // for all: perform MPI_Allgatherv
   // for distributed: rendezvous comm, each proc fills its mylines/mytris
 
   if (!distributed) {
 
     bigint nbytes;
-    if (dim == 2) nbytes = (bigint) nsurf_basefile * sizeof(Surf::Line);
-    else nbytes = (bigint) nsurf_basefile * sizeof(Surf::Tri);
+    if (dim == 2) nbytes = (bigint) nsurf_read * sizeof(Surf::Line);
+    else nbytes = (bigint) nsurf_read * sizeof(Surf::Tri);
     if (nbytes > MAXSMALLINT)
       error->all(FLERR,"Aggregate surf byte count is too large");
 
@@ -473,9 +750,9 @@ void ReadSurf::read_multiple(char *file)
     // allocate space in lines/tris for newly read surfs
     // Allgatherv() puts new surfs at end of old surfs in lines/tris
 
-    if (nsurf_total_old + nsurf_basefile > surf->nmax) {
+    if (nsurf_total_old + nsurf_read > surf->nmax) {
       int old = surf->nmax;
-      surf->nmax = nsurf_total_old + nsurf_basefile;
+      surf->nmax = nsurf_total_old + nsurf_read;
       surf->grow(old);
     }
 
@@ -488,7 +765,7 @@ void ReadSurf::read_multiple(char *file)
 
     // set surf->nlocal to aggregate size of Allgatherv()
 
-    surf->nlocal = nsurf_total_old + nsurf_basefile;
+    surf->nlocal = nsurf_total_old + nsurf_read;
 
     memory->destroy(recvcounts);
     memory->destroy(displs);
@@ -497,9 +774,11 @@ void ReadSurf::read_multiple(char *file)
     // NOTE: this is a big fat kludge
     // but need to worry about more surfs in P files than in basefile
     // could check for that earlier
+    // nnew includes previously read surfs, since owner is (id-1) % nprocs
     bigint ntmp = surf->ntmp;
     bigint nall;
     MPI_Allreduce(&ntmp,&nall,1,MPI_SPARTA_BIGINT,MPI_SUM,world);
+    nall += nsurf_total_old;
     bigint nnew = nall / nprocs;
     if (me < nall % nprocs) nnew++;
     if (nnew > MAXSMALLINT)
@@ -509,16 +788,6 @@ void ReadSurf::read_multiple(char *file)
     if (dim == 2) surf->redistribute_lines_temporary(nown_new);
     else surf->redistribute_tris_temporary(nown_new);
   }
-
-  // clean-up
-
-  MPI_Comm_free(&filecomm);
-  memory->sfree(surf->tmplines);
-  memory->sfree(surf->tmptris);
-
-  // surf counts, stats, error check
-
-  surf_counts();
 }
 
 /* ----------------------------------------------------------------------
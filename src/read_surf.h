@@ -43,6 +43,7 @@ class ReadSurf : protected Pointers {
   int distributed;
   int partflag,filearg;
 
+  int binary;               // TEXT or BINARY/STL file format
   int multiproc;            // 1 if multiple files to read from
   int nfiles;               // # of proc files along with base file
   bigint nsurf_basefile;    // surface count in base file
@@ -79,6 +80,9 @@ class ReadSurf : protected Pointers {
 
   void read_single(char *);
   void read_multiple(char *);
+  void read_binary(char *);
+  void binary_header(char *, bigint &, bigint &, bigint &);
+  void distribute_temporary(bigint);
 
   void surf_counts();
   void header();
@@ -272,6 +276,54 @@ W: Surface check found %d points nearly on triangles
 One or more points are nearly on a triangle they are not an end point
 of, which indicates an ill-formed surface.
 
+E: Read_surf binary file cannot be multiple files
+
+A filename ending in .bin or .stl cannot contain a "%" character.
+
+E: Read_surf STL file requires 3d simulation
+
+Self-explanatory.
+
+E: Read surf nsurf is too large
+
+The element count in a binary surf file cannot exceed a 32-bit int.
+
+E: Cannot memory-map surf file
+
+The operating system could not map the file into memory.
+
+E: Unexpected end of STL file
+
+Self-explanatory.
+
+E: STL file is not a valid binary STL file
+
+The file size does not match the triangle count in its header.  ASCII
+STL files must be converted with the tools/stl2surf.py script.
+
+E: Invalid binary surf file header
+
+The file does not start with the string written by write_surf for a
+binary surf file.
+
+E: Unsupported binary surf file version
+
+The file was written by a newer version of SPARTA.
+
+E: Binary surf file dimension does not match simulation
+
+Self-explanatory.
+
+E: Invalid surf ID in read_surf file
+
+Element IDs in a binary surf file must be from 1 to the element count
+in its header.
+
+E: Duplicate or missing surf ID in read_surf file
+
+Each element ID from 1 to the element count in the header of a binary
+surf file must appear exactly once.
+
 E: Cannot open gzipped file
 
 SPARTA was compiled without support for reading and writing gzipped
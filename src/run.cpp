@@ -174,6 +174,7 @@ void Run::command(int narg, char **arg)
     timer->init();
     timer->barrier_start(TIME_LOOP);
     update->run(nsteps);
+    output->wait_dump();
     timer->barrier_stop(TIME_LOOP);
 
     Finish finish(sparta);
@@ -212,6 +213,7 @@ void Run::command(int narg, char **arg)
       timer->init();
       timer->barrier_start(TIME_LOOP);
       update->run(nsteps);
+      output->wait_dump();
       timer->barrier_stop(TIME_LOOP);
       time_multiple_runs += timer->array[TIME_LOOP];
 
@@ -0,0 +1,331 @@
+/* ----------------------------------------------------------------------
+   SPARTA - Stochastic PArallel Rarefied-gas Time-accurate Analyzer
+   http://sparta.sandia.gov
+   Steve Plimpton, sjplimp@sandia.gov, Michael Gallis, magalli@sandia.gov
+   Sandia National Laboratories
+
+   Copyright (2014) Sandia Corporation.  Under the terms of Contract
+   DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+   certain rights in this software.  This software is distributed under
+   the GNU General Public License.
+
+   See the README file in the top-level SPARTA directory.
+------------------------------------------------------------------------- */
+
+// Notes:
+//   dots are mapped to a key along a Hilbert or Morton space-filling curve
+//   the curve is cut into nprocs contiguous pieces of equal weight
+//   cuts are found by a parallel bisection in key space, all cuts at once,
+//     so each iteration is one Allreduce of nprocs-1 values
+//   dots are never communicated, only their weight sums
+//   cuts from the previous call are kept, a cut whose weight is still
+//     within tolerance is not moved, others are searched for only between
+//     the bracketing previous cuts, so a small change in weights only
+//     moves cells near the boundaries of each proc's piece of the curve
+
+#include "mpi.h"
+#include "math.h"
+#include "stdlib.h"
+#include "sfc.h"
+#include "domain.h"
+#include "memory.h"
+#include "error.h"
+
+using namespace SPARTA_NS;
+
+#define DELTA 1024
+#define SFCTOL 0.001     // fraction of per-proc weight a cut can be off by
+
+// prototype for non-class function
+
+int compare_keys(const void *, const void *);
+
+/* ---------------------------------------------------------------------- */
+
+SFC::SFC(SPARTA *sparta, int which) : Pointers(sparta)
+{
+  MPI_Comm_rank(world,&me);
+  MPI_Comm_size(world,&nprocs);
+
+  curve = which;
+  dimension = domain->dimension;
+  if (dimension == 3) nbits = 21;
+  else nbits = 31;
+  keymax = ((uint64_t) 1) << (dimension*nbits);
+
+  ndot = maxdot = 0;
+  dots = NULL;
+  prefix = NULL;
+  proc = NULL;
+
+  ncut = 0;
+  niterate = nreuse = 0;
+
+  int n = MAX(nprocs-1,1);
+  cut = new uint64_t[n];
+  cutlo = new uint64_t[n];
+  cuthi = new uint64_t[n];
+  memory->create(wtlo,n,"sfc:wtlo");
+  memory->create(wthi,n,"sfc:wthi");
+  memory->create(target,n,"sfc:target");
+  memory->create(active,n,"sfc:active");
+  memory->create(wlocal,n,"sfc:wlocal");
+  memory->create(wglobal,n,"sfc:wglobal");
+}
+
+/* ---------------------------------------------------------------------- */
+
+SFC::~SFC()
+{
+  memory->sfree(dots);
+  memory->destroy(prefix);
+  memory->destroy(proc);
+
+  delete [] cut;
+  delete [] cutlo;
+  delete [] cuthi;
+  memory->destroy(wtlo);
+  memory->destroy(wthi);
+  memory->destroy(target);
+  memory->destroy(active);
+  memory->destroy(wlocal);
+  memory->destroy(wglobal);
+}
+
+/* ----------------------------------------------------------------------
+   partition N dots with coords X and optional weights WT across procs
+   on return, proc[i] = new owning proc of dot I
+------------------------------------------------------------------------- */
+
+void SFC::compute(int n, double **x, double *wt)
+{
+  if (n > maxdot || prefix == NULL) {
+    maxdot = (n/DELTA + 1) * DELTA;
+    dots = (Dot *) memory->srealloc(dots,maxdot*sizeof(Dot),"sfc:dots");
+    memory->destroy(prefix);
+    memory->destroy(proc);
+    memory->create(prefix,maxdot+1,"sfc:prefix");
+    memory->create(proc,maxdot,"sfc:proc");
+  }
+
+  // sort my dots by curve key, prefix sum their weights
+
+  ndot = n;
+  for (int i = 0; i < n; i++) {
+    dots[i].key = key(x[i]);
+    if (wt) {
+      if (wt[i] <= 0.0) error->one(FLERR,"Balance weight <= 0.0");
+      dots[i].wt = wt[i];
+    } else dots[i].wt = 1.0;
+    dots[i].index = i;
+  }
+
+  if (n) qsort(dots,n,sizeof(Dot),compare_keys);
+
+  prefix[0] = 0.0;
+  for (int i = 0; i < n; i++) prefix[i+1] = prefix[i] + dots[i].wt;
+
+  double wtotal;
+  MPI_Allreduce(&prefix[n],&wtotal,1,MPI_DOUBLE,MPI_SUM,world);
+
+  // find nprocs-1 cuts along the curve
+
+  niterate = nreuse = 0;
+  if (nprocs > 1) search(wtotal,SFCTOL*wtotal/nprocs);
+
+  // dots and cuts are both sorted, so assign procs in one pass
+
+  int p = 0;
+  for (int i = 0; i < n; i++) {
+    while (p < nprocs-1 && dots[i].key >= cut[p]) p++;
+    proc[dots[i].index] = p;
+  }
+}
+
+/* ----------------------------------------------------------------------
+   set cut[p] so weight of all dots with key < cut[p] is (p+1)/nprocs
+     of WTOTAL, to within TOL
+   bisect in key space for all unconverged cuts at once
+   if previous cuts exist, keep ones within TOL and use the others
+     to bracket the search
+------------------------------------------------------------------------- */
+
+void SFC::search(double wtotal, double tol)
+{
+  int p,q;
+  uint64_t mid;
+  double w;
+
+  int n = nprocs-1;
+
+  for (p = 0; p < n; p++) {
+    target[p] = wtotal*(p+1)/nprocs;
+    active[p] = 1;
+    cutlo[p] = 0;
+    cuthi[p] = keymax;
+    wtlo[p] = 0.0;
+    wthi[p] = wtotal;
+  }
+
+  if (ncut == n) {
+    for (p = 0; p < n; p++) wlocal[p] = weight_below(cut[p]);
+    MPI_Allreduce(wlocal,wglobal,n,MPI_DOUBLE,MPI_SUM,world);
+    niterate++;
+
+    for (p = 0; p < n; p++) {
+      if (fabs(wglobal[p]-target[p]) <= tol) {
+        active[p] = 0;
+        nreuse++;
+        continue;
+      }
+      for (q = 0; q < n; q++) {
+        if (wglobal[q] < target[p]) {
+          if (cut[q] >= cutlo[p]) {
+            cutlo[p] = cut[q];
+            wtlo[p] = wglobal[q];
+          }
+        } else if (cut[q] <= cuthi[p]) {
+          cuthi[p] = cut[q];
+          wthi[p] = wglobal[q];
+        }
+      }
+    }
+  }
+
+  // every proc has identical active flags, so loop ends on all procs
+
+  int nactive = n - nreuse;
+
+  while (nactive) {
+    for (p = 0; p < n; p++) {
+      if (active[p]) {
+        mid = cutlo[p] + (cuthi[p]-cutlo[p])/2;
+        wlocal[p] = weight_below(mid);
+      } else wlocal[p] = 0.0;
+    }
+    MPI_Allreduce(wlocal,wglobal,n,MPI_DOUBLE,MPI_SUM,world);
+    niterate++;
+
+    for (p = 0; p < n; p++) {
+      if (!active[p]) continue;
+      mid = cutlo[p] + (cuthi[p]-cutlo[p])/2;
+      w = wglobal[p];
+      if (fabs(w-target[p]) <= tol) {
+        cut[p] = mid;
+        active[p] = 0;
+        nactive--;
+        continue;
+      }
+      if (w < target[p]) {
+        cutlo[p] = mid;
+        wtlo[p] = w;
+      } else {
+        cuthi[p] = mid;
+        wthi[p] = w;
+      }
+      if (cuthi[p]-cutlo[p] <= 1) {
+        if (target[p]-wtlo[p] <= wthi[p]-target[p]) cut[p] = cutlo[p];
+        else cut[p] = cuthi[p];
+        active[p] = 0;
+        nactive--;
+      }
+    }
+  }
+
+  // insure cuts are non-decreasing, can be violated within TOL
+
+  for (p = 1; p < n; p++)
+    if (cut[p] < cut[p-1]) cut[p] = cut[p-1];
+
+  ncut = n;
+}
+
+/* ----------------------------------------------------------------------
+   return weight of my dots with key < K
+------------------------------------------------------------------------- */
+
+double SFC::weight_below(uint64_t k)
+{
+  int lo = 0;
+  int hi = ndot;
+  int m;
+
+  while (lo < hi) {
+    m = (lo+hi)/2;
+    if (dots[m].key < k) lo = m+1;
+    else hi = m;
+  }
+  return prefix[lo];
+}
+
+/* ----------------------------------------------------------------------
+   return key of point X along the space-filling curve
+   coords are scaled to integers with nbits per dimension
+   Hilbert transform is the transpose method of J. Skilling,
+     AIP Conf Proc 707, 381 (2004), then bits are interleaved
+   Morton key is the interleaved bits alone
+------------------------------------------------------------------------- */
+
+uint64_t SFC::key(double *x)
+{
+  int i,bit;
+  uint64_t q,p,t;
+  uint64_t coord[3];
+
+  double *boxlo = domain->boxlo;
+  double *prd = domain->prd;
+  uint64_t nmax = ((uint64_t) 1) << nbits;
+
+  for (i = 0; i < dimension; i++) {
+    double frac = (x[i]-boxlo[i]) / prd[i];
+    if (frac <= 0.0) coord[i] = 0;
+    else {
+      coord[i] = static_cast<uint64_t> (frac*nmax);
+      if (coord[i] >= nmax) coord[i] = nmax-1;
+    }
+  }
+
+  if (curve == HILBERT) {
+    uint64_t m = ((uint64_t) 1) << (nbits-1);
+
+    for (q = m; q > 1; q >>= 1) {
+      p = q-1;
+      for (i = 0; i < dimension; i++) {
+        if (coord[i] & q) coord[0] ^= p;
+        else {
+          t = (coord[0] ^ coord[i]) & p;
+          coord[0] ^= t;
+          coord[i] ^= t;
+        }
+      }
+    }
+
+    for (i = 1; i < dimension; i++) coord[i] ^= coord[i-1];
+    t = 0;
+    for (q = m; q > 1; q >>= 1)
+      if (coord[dimension-1] & q) t ^= q-1;
+    for (i = 0; i < dimension; i++) coord[i] ^= t;
+  }
+
+  uint64_t k = 0;
+  for (bit = nbits-1; bit >= 0; bit--)
+    for (i = 0; i < dimension; i++)
+      k = (k << 1) | ((coord[i] >> bit) & 1);
+
+  return k;
+}
+
+/* ----------------------------------------------------------------------
+   comparison function invoked by qsort() called by compute()
+   sorts Dots by key, which is their first field
+   this is not a class method
+------------------------------------------------------------------------- */
+
+int compare_keys(const void *iptr, const void *jptr)
+{
+  uint64_t i = *((uint64_t *) iptr);
+  uint64_t j = *((uint64_t *) jptr);
+  if (i < j) return -1;
+  if (i > j) return 1;
+  return 0;
+}
@@ -0,0 +1,85 @@
+/* ----------------------------------------------------------------------
+   SPARTA - Stochastic PArallel Rarefied-gas Time-accurate Analyzer
+   http://sparta.sandia.gov
+   Steve Plimpton, sjplimp@sandia.gov, Michael Gallis, magalli@sandia.gov
+   Sandia National Laboratories
+
+   Copyright (2014) Sandia Corporation.  Under the terms of Contract
+   DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+   certain rights in this software.  This software is distributed under
+   the GNU General Public License.
+
+   See the README file in the top-level SPARTA directory.
+------------------------------------------------------------------------- */
+
+#ifndef SPARTA_SFC_H
+#define SPARTA_SFC_H
+
+#include "stdint.h"
+#include "pointers.h"
+
+namespace SPARTA_NS {
+
+class SFC : protected Pointers {
+ public:
+  enum{HILBERT,MORTON};
+
+  // set by compute()
+
+  int *proc;                  // new owning proc of each input dot
+  int niterate;               // # of cut search iterations
+  int nreuse;                 // # of previous cuts kept as-is
+
+  SFC(class SPARTA *, int);
+  ~SFC();
+  void compute(int, double **, double *);
+  void reset() {ncut = 0;}
+
+ private:
+  int me,nprocs;
+  int curve;                  // HILBERT or MORTON
+  int dimension;
+  int nbits;                  // bits per dimension in a curve key
+  uint64_t keymax;            // all keys are < keymax
+
+  // point to balance on, sorted by key
+
+  struct Dot {
+    uint64_t key;             // position along curve
+    double wt;                // weight of point
+    int index;                // index in input list
+  };
+
+  Dot *dots;
+  int ndot,maxdot;
+  double *prefix;             // prefix[i] = weight of sorted dots 0 to i-1
+
+  // cuts along the curve, dots with cut[p-1] <= key < cut[p] go to proc p
+  // kept between calls so an incremental rebalance can start from them
+
+  int ncut;                   // 0 if no previous cuts
+  uint64_t *cut;
+
+  // per-cut search state
+
+  uint64_t *cutlo,*cuthi;
+  double *wtlo,*wthi,*target;
+  int *active;
+  double *wlocal,*wglobal;
+
+  uint64_t key(double *);
+  double weight_below(uint64_t);
+  void search(double, double);
+};
+
+}
+
+#endif
+
+/* ERROR/WARNING messages:
+
+E: Balance weight <= 0.0
+
+User-specified weight for a grid cell must be > 0.0.
+
+*/
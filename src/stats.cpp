@@ -598,6 +598,12 @@ void Stats::set_fields(int narg, char **arg)
     addfield("outInter", &Stats::compute_interOutfrac, FLOAT);
     } else if (strcmp(arg[i], "warningInter") == 0) {
     addfield("warningInter", &Stats::compute_interWarningfrac, FLOAT);    
+    } else if (strcmp(arg[i], "farInter") == 0) {
+    addfield("farInter", &Stats::compute_interFarfrac, FLOAT);
+    } else if (strcmp(arg[i], "nearInter") == 0) {
+    addfield("nearInter", &Stats::compute_interNearfrac, FLOAT);
+    } else if (strcmp(arg[i], "cutInter") == 0) {
+    addfield("cutInter", &Stats::compute_interCutfrac, FLOAT);
     // surf collide value = s_ID, surf react value = r_ID
     // count trailing [] and store int arguments
     // copy = at most 8 chars of ID to pass to addfield
@@ -973,6 +979,9 @@ int Stats::evaluate_keyword(char *word, double *answer)
   else if (strcmp(word, "boundInter") == 0) compute_interBoundfrac(); 
   else if (strcmp(word, "outInter") == 0) compute_interOutfrac(); 
   else if (strcmp(word, "warningInter") == 0) compute_interWarningfrac();
+  else if (strcmp(word, "farInter") == 0) compute_interFarfrac();
+  else if (strcmp(word, "nearInter") == 0) compute_interNearfrac();
+  else if (strcmp(word, "cutInter") == 0) compute_interCutfrac();
 
   else return 1;
 
@@ -1505,4 +1514,34 @@ void Stats::compute_interWarningfrac() {
     MPI_Allreduce(&n, &bivalue, 1, MPI_SPARTA_BIGINT, MPI_SUM, world);
     n = bivalue;  bivalue = 0;
     dvalue = 100.0 * n / m;
+}
+void Stats::compute_interFarfrac() {
+    bigint m = grid->gridCommMacro->count_sumInter; bivalue = 0;
+    MPI_Allreduce(&m, &bivalue, 1, MPI_SPARTA_BIGINT, MPI_SUM, world);
+    if (bivalue == 0) { dvalue = 0.0; return; }
+    m = bivalue; bivalue = 0;
+    bigint n = grid->gridCommMacro->count_farInter;
+    MPI_Allreduce(&n, &bivalue, 1, MPI_SPARTA_BIGINT, MPI_SUM, world);
+    n = bivalue;  bivalue = 0;
+    dvalue = 100.0 * n / m;
+}
+void Stats::compute_interNearfrac() {
+    bigint m = grid->gridCommMacro->count_sumInter; bivalue = 0;
+    MPI_Allreduce(&m, &bivalue, 1, MPI_SPARTA_BIGINT, MPI_SUM, world);
+    if (bivalue == 0) { dvalue = 0.0; return; }
+    m = bivalue; bivalue = 0;
+    bigint n = grid->gridCommMacro->count_nearInter;
+    MPI_Allreduce(&n, &bivalue, 1, MPI_SPARTA_BIGINT, MPI_SUM, world);
+    n = bivalue;  bivalue = 0;
+    dvalue = 100.0 * n / m;
+}
+void Stats::compute_interCutfrac() {
+    bigint m = grid->gridCommMacro->count_sumInter; bivalue = 0;
+    MPI_Allreduce(&m, &bivalue, 1, MPI_SPARTA_BIGINT, MPI_SUM, world);
+    if (bivalue == 0) { dvalue = 0.0; return; }
+    m = bivalue; bivalue = 0;
+    bigint n = grid->gridCommMacro->count_cutInter;
+    MPI_Allreduce(&n, &bivalue, 1, MPI_SPARTA_BIGINT, MPI_SUM, world);
+    n = bivalue;  bivalue = 0;
+    dvalue = 100.0 * n / m;
 }
\ No newline at end of file
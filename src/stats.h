@@ -164,6 +164,9 @@ class Stats : protected Pointers {
   void compute_interBoundfrac();
   void compute_interOutfrac();
   void compute_interWarningfrac();
+  void compute_interFarfrac();
+  void compute_interNearfrac();
+  void compute_interCutfrac();
 };
 
 }
@@ -44,6 +44,7 @@ enum{LT,LE,GT,GE,EQ,NEQ,BETWEEN};
 #define EPSILON_GRID 1.0e-3
 #define BIG 1.0e20
 #define MAXGROUP 32
+#define MAXPLAN 4
 
 /* ---------------------------------------------------------------------- */
 
@@ -88,6 +89,13 @@ Surf::Surf(SPARTA *sparta) : Pointers(sparta)
 
   tally_comm = TALLYAUTO;
 
+  nplan = 0;
+  plans = (CollatePlan *) memory->smalloc(MAXPLAN*sizeof(CollatePlan),
+                                          "surf:plans");
+  ncollate = 0;
+  maxslot = 0;
+  plan_slot = NULL;
+
   // allocate hash for surf IDs
 
   hash = new MySurfHash();
@@ -115,6 +123,17 @@ Surf::~Surf()
 
   hash->clear();
   delete hash;
+
+  for (int i = 0; i < nplan; i++) {
+    memory->destroy(plans[i].sendcount);
+    memory->destroy(plans[i].senddispl);
+    memory->destroy(plans[i].recvcount);
+    memory->destroy(plans[i].recvdispl);
+    memory->destroy(plans[i].recvindex);
+    delete plans[i].hash;
+  }
+  memory->sfree(plans);
+  memory->destroy(plan_slot);
 }
 
 /* ---------------------------------------------------------------------- */
@@ -2710,91 +2729,45 @@ void Surf::collate_vector_reduce(int nrow, surfint *tally2surf,
 
 /* ----------------------------------------------------------------------
    rendezvous version of collate
+   tallies are sent to owning procs via the persistent collate plan
 ------------------------------------------------------------------------- */
 
 void Surf::collate_vector_rendezvous(int nrow, surfint *tally2surf,
                                      double *in, int instride, double *out)
 {
-  // allocate memory for rvous input
+  int i,m;
 
-  int *proclist;
-  memory->create(proclist,nrow,"surf:proclist");
-  InRvousVec *in_rvous =
-    (InRvousVec *) memory->smalloc((bigint) nrow*sizeof(InRvousVec),
-                                   "surf:in_rvous");
+  CollatePlan *plan = collate_plan(nrow,tally2surf);
 
-  // create rvous inputs
-  // proclist = owner of each surf
-  // logic of (id-1) % nprocs sends
-  //   surf IDs 1,11,21,etc on 10 procs to proc 0
+  // pack tallies into send slots of the plan
 
-  Surf::Line *lines = surf->lines;
-  Surf::Tri *tris = surf->tris;
-  int dim = domain->dimension;
-
-  surfint id;
+  double *sendbuf,*recvbuf;
+  memory->create(sendbuf,nrow,"surf:sendbuf");
+  memory->create(recvbuf,plan->nrecv,"surf:recvbuf");
 
-  int m = 0;
-  for (int i = 0; i < nrow; i++) {
-    id = tally2surf[i];
-    proclist[i] = (id-1) % nprocs;
-    in_rvous[i].id = id;
-    in_rvous[i].value = in[m];
+  m = 0;
+  for (i = 0; i < nrow; i++) {
+    sendbuf[plan_slot[i]] = in[m];
     m += instride;
   }
 
-  // perform rendezvous operation
   // each proc owns subset of surfs
   // receives all tally contributions to surfs it owns
 
-  out_rvous = out;
-
-  char *buf;
-  int nout = comm->rendezvous(1,nrow,(char *) in_rvous,sizeof(InRvousVec),
-			      0,proclist,rendezvous_vector,
-			      0,buf,0,(void *) this);
-
-  memory->destroy(proclist);
-  memory->destroy(in_rvous);
-}
-
-/* ----------------------------------------------------------------------
-   callback from rendezvous operation
-   process tallies for surfs assigned to me
-   inbuf = list of N Inbuf datums
-   no outbuf
-------------------------------------------------------------------------- */
-
-int Surf::rendezvous_vector(int n, char *inbuf, int &flag, int *&proclist,
-                            char *&outbuf, void *ptr)
-{
-  Surf *sptr = (Surf *) ptr;
-  Memory *memory = sptr->memory;
-  int nown = sptr->nown;
-  double *out = sptr->out_rvous;
-  int nprocs = sptr->comm->nprocs;
-  int me = sptr->comm->me;
+  MPI_Alltoallv(sendbuf,plan->sendcount,plan->senddispl,MPI_DOUBLE,
+                recvbuf,plan->recvcount,plan->recvdispl,MPI_DOUBLE,world);
 
   // zero my owned surf values
-
-  for (int i = 0; i < nown; i++) out[i] = 0.0;
-
   // accumulate per-surf values from different procs to my owned surfs
-  // logic of (id-1-me) / nprocs maps
-  //   surf IDs [1,11,21,...] on 10 procs to [0,1,2,...] on proc 0
 
-  Surf::InRvousVec *in_rvous = (Surf::InRvousVec *) inbuf;
+  int *recvindex = plan->recvindex;
+  int nrecv = plan->nrecv;
 
-  int m;
-  for (int i = 0; i < n; i++) {
-    m = (in_rvous[i].id-1-me) / nprocs;
-    out[m] += in_rvous[i].value;
-  }
+  for (i = 0; i < nown; i++) out[i] = 0.0;
+  for (i = 0; i < nrecv; i++) out[recvindex[i]] += recvbuf[i];
 
-  // flag = 0: no second comm needed in rendezvous
-
-  flag = 0;
-  return 0;
+  memory->destroy(sendbuf);
+  memory->destroy(recvbuf);
 }
 
 /* ----------------------------------------------------------------------
@@ -2879,102 +2852,206 @@ void Surf::collate_array_reduce(int nrow, int ncol, surfint *tally2surf,
 
 /* ----------------------------------------------------------------------
    rendezvous version of collate
+   tallies are sent to owning procs via the persistent collate plan
 ------------------------------------------------------------------------- */
 
 void Surf::collate_array_rendezvous(int nrow, int ncol, surfint *tally2surf,
                                     double **in, double **out)
 {
-  int i,j,m;
+  int i,j,k,m;
 
-  // allocate memory for rvous input
+  CollatePlan *plan = collate_plan(nrow,tally2surf);
 
-  int *proclist;
-  memory->create(proclist,nrow,"surf:proclist");
-  double *in_rvous = (double *)     // worry about overflow
-    memory->smalloc(nrow*(ncol+1)*sizeof(double*),"surf:in_rvous");
+  // pack tallies into send slots of the plan
 
-  // create rvous inputs
-  // proclist = owner of each surf
-  // logic of (id-1) % nprocs sends
-  //   surf IDs 1,11,21,etc on 10 procs to proc 0
+  double *sendbuf,*recvbuf;
+  memory->create(sendbuf,nrow*ncol,"surf:sendbuf");
+  memory->create(recvbuf,plan->nrecv*ncol,"surf:recvbuf");
 
-  Surf::Line *lines = surf->lines;
-  Surf::Tri *tris = surf->tris;
-  int dim = domain->dimension;
-  surfint id;
-
-  m = 0;
-  for (int i = 0; i < nrow; i++) {
-    id = tally2surf[i];
-    proclist[i] = (id-1) % nprocs;
-    in_rvous[m++] = ubuf(id).d;
+  for (i = 0; i < nrow; i++) {
+    m = plan_slot[i]*ncol;
     for (j = 0; j < ncol; j++)
-      in_rvous[m++] = in[i][j];
+      sendbuf[m++] = in[i][j];
   }
 
-  // perform rendezvous operation
   // each proc owns subset of surfs
   // receives all tally contributions to surfs it owns
+  // one datum = one row of ncol values
 
-  ncol_rvous = ncol;
-  if (out == NULL) out_rvous = NULL;
-  else out_rvous = &out[0][0];
-  int size = (ncol+1) * sizeof(double);
+  MPI_Datatype rowtype;
+  MPI_Type_contiguous(ncol,MPI_DOUBLE,&rowtype);
+  MPI_Type_commit(&rowtype);
+  MPI_Alltoallv(sendbuf,plan->sendcount,plan->senddispl,rowtype,
+                recvbuf,plan->recvcount,plan->recvdispl,rowtype,world);
+  MPI_Type_free(&rowtype);
 
-  char *buf;
-  int nout = comm->rendezvous(1,nrow,(char *) in_rvous,size,
-			      0,proclist,rendezvous_array,
-			      0,buf,0,(void *) this);
+  // zero my owned surf values
+  // accumulate per-surf values from different procs to my owned surfs
 
-  memory->destroy(proclist);
-  memory->sfree(in_rvous);
+  for (i = 0; i < nown; i++)
+    for (j = 0; j < ncol; j++)
+      out[i][j] = 0.0;
+
+  int *recvindex = plan->recvindex;
+  int nrecv = plan->nrecv;
+
+  m = 0;
+  for (i = 0; i < nrecv; i++) {
+    k = recvindex[i];
+    for (j = 0; j < ncol; j++)
+      out[k][j] += recvbuf[m++];
+  }
+
+  memory->destroy(sendbuf);
+  memory->destroy(recvbuf);
 }
 
 /* ----------------------------------------------------------------------
-   callback from rendezvous operation
-   process tallies for surfs assigned to me
-   inbuf = list of N Inbuf datums
-   no outbuf
+   return a collate plan for the tallies in tally2surf
+   a stored plan is reused if every proc tallies the same set of surf IDs
+     as when the plan was created, in any order
+   else create a new plan, all procs do this together
+   on return, plan_slot[i] = send buffer slot for tally I
 ------------------------------------------------------------------------- */
 
-int Surf::rendezvous_array(int n, char *inbuf,
-                           int &flag, int *&proclist, char *&outbuf,
-                           void *ptr)
+Surf::CollatePlan *Surf::collate_plan(int nrow, surfint *tally2surf)
 {
-  int i,j,k,m;
+  int i,p;
+  surfint id;
+  CollatePlan *plan;
 
-  Surf *sptr = (Surf *) ptr;
-  Memory *memory = sptr->memory;
-  int nown = sptr->nown;
-  int ncol = sptr->ncol_rvous;
-  double *out = sptr->out_rvous;
-  int nprocs = sptr->comm->nprocs;
-  int me = sptr->comm->me;
+  if (nrow > maxslot) {
+    memory->destroy(plan_slot);
+    maxslot = nrow;
+    memory->create(plan_slot,maxslot,"surf:plan_slot");
+  }
 
-  // zero my owned surf values
+  ncollate++;
 
-  int ntotal = nown*ncol;
-  for (m = 0; m < ntotal; m++) out[m] = 0.0;
+  // flag = 1 for each plan that has all my tallied surf IDs
+  // plan surf IDs are unique, so same count means same set
+
+  int flag[MAXPLAN],flagall[MAXPLAN];
+
+  for (int iplan = 0; iplan < nplan; iplan++) {
+    plan = &plans[iplan];
+    flag[iplan] = 1;
+    if (nrow != plan->nsend) flag[iplan] = 0;
+    else {
+      for (i = 0; i < nrow; i++)
+        if (plan->hash->find(tally2surf[i]) == plan->hash->end()) {
+          flag[iplan] = 0;
+          break;
+        }
+    }
+  }
+
+  if (nplan)
+    MPI_Allreduce(flag,flagall,nplan,MPI_INT,MPI_MIN,world);
+
+  for (int iplan = 0; iplan < nplan; iplan++) {
+    if (!flagall[iplan]) continue;
+    plan = &plans[iplan];
+    plan->lastuse = ncollate;
+    for (i = 0; i < nrow; i++)
+      plan_slot[i] = (*plan->hash)[tally2surf[i]];
+    return plan;
+  }
+
+  // no match, create new plan
+  // replace least recently used plan if already have MAXPLAN of them
+
+  if (nplan < MAXPLAN) {
+    plan = &plans[nplan++];
+    memory->create(plan->sendcount,nprocs,"surf:plan_sendcount");
+    memory->create(plan->senddispl,nprocs,"surf:plan_senddispl");
+    memory->create(plan->recvcount,nprocs,"surf:plan_recvcount");
+    memory->create(plan->recvdispl,nprocs,"surf:plan_recvdispl");
+    plan->maxrecv = 0;
+    plan->recvindex = NULL;
+    plan->hash = new MySurfHash();
+  } else {
+    plan = &plans[0];
+    for (int iplan = 1; iplan < nplan; iplan++)
+      if (plans[iplan].lastuse < plan->lastuse) plan = &plans[iplan];
+  }
+
+  plan->lastuse = ncollate;
+
+  // proclist = owner of each surf
+  // logic of (id-1) % nprocs sends
+  //   surf IDs 1,11,21,etc on 10 procs to proc 0
+  // send slots are grouped by owning proc
+
+  int *sendcount = plan->sendcount;
+  int *senddispl = plan->senddispl;
+  int *recvcount = plan->recvcount;
+  int *recvdispl = plan->recvdispl;
+
+  int *proclist;
+  memory->create(proclist,nrow,"surf:proclist");
+
+  for (p = 0; p < nprocs; p++) sendcount[p] = 0;
+  for (i = 0; i < nrow; i++) {
+    proclist[i] = (tally2surf[i]-1) % nprocs;
+    sendcount[proclist[i]]++;
+  }
+
+  senddispl[0] = 0;
+  for (p = 1; p < nprocs; p++)
+    senddispl[p] = senddispl[p-1] + sendcount[p-1];
+
+  // use recvdispl as counter of slots filled for each proc
+
+  for (p = 0; p < nprocs; p++) recvdispl[p] = senddispl[p];
+
+  double *sendid;
+  memory->create(sendid,nrow,"surf:sendid");
+
+  plan->hash->clear();
+  for (i = 0; i < nrow; i++) {
+    id = tally2surf[i];
+    plan_slot[i] = recvdispl[proclist[i]]++;
+    (*plan->hash)[id] = plan_slot[i];
+    sendid[plan_slot[i]] = ubuf(id).d;
+  }
+  plan->nsend = nrow;
+
+  memory->destroy(proclist);
+
+  // owning procs receive surf IDs they will accumulate tallies for
+
+  MPI_Alltoall(sendcount,1,MPI_INT,recvcount,1,MPI_INT,world);
+
+  recvdispl[0] = 0;
+  for (p = 1; p < nprocs; p++)
+    recvdispl[p] = recvdispl[p-1] + recvcount[p-1];
+  plan->nrecv = recvdispl[nprocs-1] + recvcount[nprocs-1];
+
+  if (plan->nrecv > plan->maxrecv) {
+    memory->destroy(plan->recvindex);
+    plan->maxrecv = plan->nrecv;
+    memory->create(plan->recvindex,plan->maxrecv,"surf:plan_recvindex");
+  }
+
+  double *recvid;
+  memory->create(recvid,plan->nrecv,"surf:recvid");
+
+  MPI_Alltoallv(sendid,sendcount,senddispl,MPI_DOUBLE,
+                recvid,recvcount,recvdispl,MPI_DOUBLE,world);
 
-  // accumulate per-surf values from different procs to my owned surfs
   // logic of (id-1-me) / nprocs maps
   //   surf IDs [1,11,21,...] on 10 procs to [0,1,2,...] on proc 0
 
-  double *in_rvous = (double *) inbuf;
-  surfint id;
-
-  m = 0;
-  for (int i = 0; i < n; i++) {
-    id = (surfint) ubuf(in_rvous[m++]).i;
-    k = (id-1-me) / nprocs * ncol;
-    for (j = 0; j < ncol; j++)
-      out[k++] += in_rvous[m++];
+  for (i = 0; i < plan->nrecv; i++) {
+    id = (surfint) ubuf(recvid[i]).i;
+    plan->recvindex[i] = (id-1-me) / nprocs;
   }
 
-  // flag = 0: no second comm needed in rendezvous
+  memory->destroy(sendid);
+  memory->destroy(recvid);
 
-  flag = 0;
-  return 0;
+  return plan;
 }
 
 /* ----------------------------------------------------------------------
@@ -3787,5 +3864,12 @@ bigint Surf::memory_usage()
     bytes += nlocal * sizeof(int);
   }
 
+  bytes += maxslot * sizeof(int);
+  for (int i = 0; i < nplan; i++) {
+    bytes += 4*nprocs * sizeof(int);
+    bytes += plans[i].maxrecv * sizeof(int);
+    bytes += plans[i].nsend * (sizeof(surfint)+sizeof(int));
+  }
+
   return bytes;
 }
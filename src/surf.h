@@ -230,15 +230,30 @@ class Surf : protected Pointers {
   int maxsc;                // max # of models in sc
   int maxsr;                // max # of models in sr
 
-  // collate vector rendezvous data
+  // collate implicit rendezvous data
 
-  struct InRvousVec {
-    surfint id;             // surface ID
-    double value;           // compute value
+  int ncol_rvous;
+
+  // persistent plans for collate rendezvous via MPI_Alltoallv()
+  // a plan is reused while every proc tallies the same set of surfs
+  // several are kept so callers with different tallies can alternate
+
+  struct CollatePlan {
+    int nsend;                // # of surfs I tally in plan
+    int nrecv;                // # of tallies I recv for surfs I own
+    int maxrecv;              // allocated length of recvindex
+    int *sendcount,*senddispl;   // per-proc # and offset of sends
+    int *recvcount,*recvdispl;   // per-proc # and offset of recvs
+    int *recvindex;           // owned surf index of each received tally
+    MySurfHash *hash;         // surf ID -> send buffer slot
+    bigint lastuse;           // value of ncollate when plan was last used
   };
 
-  double *out_rvous;
-  int ncol_rvous;
+  int nplan;                  // # of stored plans
+  CollatePlan *plans;         // list of plans, least recently used is replaced
+  bigint ncollate;            // # of rendezvous collates performed
+  int maxslot;                // allocated length of plan_slot
+  int *plan_slot;             // send buffer slot of each tally
 
   // watertight rendezvous data
 
@@ -281,6 +296,7 @@ class Surf : protected Pointers {
   void collate_vector_irregular(int, int *, double *, int, double *);
   void collate_array_allreduce(int, int, int *, double **, double **);
   void collate_array_irregular(int, int, int *, double **, double **);
+  CollatePlan *collate_plan(int, surfint *);
 
   void check_watertight_2d_all();
   void check_watertight_2d_distributed();
@@ -289,8 +305,6 @@ class Surf : protected Pointers {
 
   // callback functions for rendezvous communication
 
-  static int rendezvous_vector(int, char *, int &, int *&, char *&, void *);
-  static int rendezvous_array(int, char *, int &, int *&, char *&, void *);
   static int rendezvous_implicit(int, char *, int &, int *&, char *&, void *);
   static int rendezvous_watertight_2d(int, char *,
                                       int &, int *&, char *&, void *);
@@ -2435,6 +2435,7 @@ void Update::global(int narg, char **arg)
       if (iarg+2 > narg) error->all(FLERR,"Illegal global command");
       if (strcmp(arg[iarg+1],"neigh") == 0) comm->commpartstyle = 1;
       else if (strcmp(arg[iarg+1],"all") == 0) comm->commpartstyle = 0;
+      else if (strcmp(arg[iarg+1],"graph") == 0) comm->commpartstyle = 2;
       else error->all(FLERR,"Illegal global command");
       iarg += 2;
     } else if (strcmp(arg[iarg],"surftally") == 0) {
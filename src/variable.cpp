@@ -46,6 +46,7 @@ using namespace MathConst;
 #define MAXLEVEL 4
 #define MAXLINE 256
 #define CHUNK 1024
+#define VECBLOCK 256        // # of particles or cells per compiled eval pass
 #define VALUELENGTH 64
 
 #define MYROUND(a) (( a-floor(a) ) >= .5) ? ceil(a) : floor(a)
@@ -63,7 +64,12 @@ enum{DONE,ADD,SUBTRACT,MULTIPLY,DIVIDE,CARAT,MODULO,UNARY,
      SQRT,EXP,LN,LOG,ABS,SIN,COS,TAN,ASIN,ACOS,ATAN,ATAN2,
      RANDOM,NORMAL,CEIL,FLOOR,ROUND,RAMP,STAGGER,LOGFREQ,STRIDE,
      VDISPLACE,SWIGGLE,CWIGGLE,
-     VALUE,ARRAY,PARTARRAYDOUBLE,PARTARRAYINT,SPECARRAY};
+     VALUE,REFVALUE,ARRAY,PARTARRAYDOUBLE,PARTARRAYINT,SPECARRAY};
+
+// kinds of formula inputs a compiled program refreshes on each evaluation
+
+enum{COMPUTEREF,FIXREF,SURFCOLLIDEREF,SURFREACTREF,VARIABLEREF,KEYWORDREF,
+     PARTICLEREF};
 
 // customize by adding a special function
 
@@ -115,6 +121,19 @@ Variable::Variable(SPARTA *sparta) : Pointers(sparta)
   maxvec_storage = 0;
   vec_storage = NULL;
   maxlen_storage = NULL;
+
+  // compiled form of formulas, cached per variable
+
+  program = NULL;
+  cachestamp = 0;
+  compileflag = 0;
+  cacheflag = 1;
+  nref = maxref = 0;
+  refs = NULL;
+  ninstr = maxinstr = 0;
+  instr = NULL;
+  maxdepth = 0;
+  vstack = NULL;
 }
 
 /* ---------------------------------------------------------------------- */
@@ -127,6 +146,7 @@ Variable::~Variable()
     if (style[i] == LOOP || style[i] == ULOOP) delete [] data[i][0];
     else for (int j = 0; j < num[i]; j++) delete [] data[i][j];
     delete [] data[i];
+    free_program(program[i]);
   }
   memory->sfree(names);
   memory->destroy(style);
@@ -146,6 +166,11 @@ Variable::~Variable()
     memory->destroy(vec_storage[i]);
   memory->sfree(vec_storage);
   memory->sfree(maxlen_storage);
+
+  memory->sfree(program);
+  memory->sfree(refs);
+  memory->sfree(instr);
+  memory->destroy(vstack);
 }
 
 /* ----------------------------------------------------------------------
@@ -471,6 +496,11 @@ void Variable::set(int narg, char **arg)
 
   } else error->all(FLERR,"Illegal variable command");
 
+  // any (re)definition invalidates cached programs,
+  // since a formula inlines the formulas of variables it references
+
+  cachestamp++;
+
   // set name of variable, if not replacing one flagged with replaceflag
   // name must be all alphanumeric chars or underscores
 
@@ -674,7 +704,7 @@ char *Variable::retrieve(char *name)
     strcpy(data[ivar][0],result);
     str = data[ivar][0];
   } else if (style[ivar] == EQUAL) {
-    double answer = evaluate(data[ivar][0],NULL);
+    double answer = evaluate_equal(ivar);
     sprintf(data[ivar][1],"%.15g",answer);
     str = data[ivar][1];
   } else if (style[ivar] == FORMAT) {
@@ -715,13 +745,30 @@ double Variable::compute_equal(int ivar)
   eval_in_progress[ivar] = 1;
 
   double value;
-  if (style[ivar] == EQUAL) value = evaluate(data[ivar][0],NULL);
+  if (style[ivar] == EQUAL) value = evaluate_equal(ivar);
   else if (style[ivar] == INTERNAL) value = dvalue[ivar];
 
   eval_in_progress[ivar] = 0;
   return value;
 }
 
+/* ----------------------------------------------------------------------
+   evaluate formula of equal-style ivar
+   use its cached program if formula can be compiled,
+     else evaluate formula string directly
+------------------------------------------------------------------------- */
+
+double Variable::evaluate_equal(int ivar)
+{
+  Program *p = compile_program(ivar);
+  if (p == NULL) return evaluate(data[ivar][0],NULL);
+
+  double value;
+  refresh(p);
+  eval_compiled(p,1,&value,1,0);
+  return value;
+}
+
 /* ----------------------------------------------------------------------
    return result of immediate equal-style variable evaluation
    called from Input::substitute()
@@ -747,12 +794,24 @@ void Variable::compute_particle(int ivar, double *result,
     error->all(FLERR,"Variable has circular dependency");
   eval_in_progress[ivar] = 1;
 
+  int nlocal = particle->nlocal;
+
+  // evaluate cached compiled program in blocks of particles or cells
+  //   if formula can be compiled
+  // else parse formula and recurse thru tree for each particle or cell
+
+  Program *p = compile_program(ivar);
+  if (p) {
+    refresh(p);
+    eval_compiled(p,nlocal,result,stride,sumflag);
+    eval_in_progress[ivar] = 0;
+    return;
+  }
+
   treestyle = PARTICLE;
   evaluate(data[ivar][0],&tree);
   collapse_tree(tree);
 
-  int nlocal = particle->nlocal;
-
   if (sumflag == 0) {
     int m = 0;
     for (int i = 0; i < nlocal; i++) {
@@ -788,13 +847,25 @@ void Variable::compute_grid(int ivar, double *result,
     error->all(FLERR,"Variable has circular dependency");
   eval_in_progress[ivar] = 1;
 
+  int nglocal = grid->nlocal;
+
+  // evaluate cached compiled program in blocks of particles or cells
+  //   if formula can be compiled
+  // else parse formula and recurse thru tree for each particle or cell
+
   nvec_storage = 0;
+  Program *p = compile_program(ivar);
+  if (p) {
+    refresh(p);
+    eval_compiled(p,nglocal,result,stride,sumflag);
+    eval_in_progress[ivar] = 0;
+    return;
+  }
+
   treestyle = GRID;
   evaluate(data[ivar][0],&tree);
   collapse_tree(tree);
 
-  int nglocal = grid->nlocal;
-
   if (sumflag == 0) {
     int m = 0;
     for (int i = 0; i < nglocal; i++) {
@@ -899,6 +970,7 @@ void Variable::remove(int n)
   else for (int i = 0; i < num[n]; i++) delete [] data[n][i];
   delete [] data[n];
   delete reader[n];
+  free_program(program[n]);
 
   for (int i = n+1; i < nvar; i++) {
     names[i-1] = names[i];
@@ -908,8 +980,14 @@ void Variable::remove(int n)
     pad[i-1] = pad[i];
     reader[i-1] = reader[i];
     data[i-1] = data[i];
+    program[i-1] = program[i];
   }
+  program[nvar-1] = NULL;
   nvar--;
+
+  // cached programs may have inlined the removed variable
+
+  cachestamp++;
 }
 
 /* ----------------------------------------------------------------------
@@ -935,6 +1013,10 @@ void Variable::grow()
 
   memory->grow(eval_in_progress,maxvar,"var:eval_in_progress");
   for (int i = 0; i < maxvar; i++) eval_in_progress[i] = 0;
+
+  program = (Program **)
+    memory->srealloc(program,maxvar*sizeof(Program *),"var:program");
+  for (int i = old; i < maxvar; i++) program[i] = NULL;
 }
 
 /* ----------------------------------------------------------------------
@@ -1084,22 +1166,18 @@ double Variable::evaluate(char *str, Tree **tree)
 	  error->all(FLERR,
 		     "Variable evaluation before simulation box is defined");
 
-	n = strlen(word) - 2 + 1;
-	char *id = new char[n];
-	strcpy(id,&word[2]);
-
-	int icompute = modify->find_compute(id);
+	int icompute = modify->find_compute(&word[2]);
 	if (icompute < 0)
           error->all(FLERR,"Invalid compute ID in variable formula");
 	Compute *compute = modify->compute[icompute];
-	delete [] id;
 
 	// parse zero or one or two trailing brackets
 	// point i beyond last bracket
 	// nbracket = # of bracket pairs
 	// index1,index2 = int inside each bracket pair
 
-	int nbracket,index1,index2;
+	int nbracket;
+	int index1 = 0, index2 = 0;
 	if (str[i] != '[') nbracket = 0;
 	else {
 	  nbracket = 1;
@@ -1114,206 +1192,47 @@ double Variable::evaluate(char *str, Tree **tree)
 	  }
 	}
 
-        // c_ID = scalar from global scalar
-
-	if (nbracket == 0 && compute->scalar_flag) {
-
-	  if (update->runflag == 0) {
-	    if (compute->invoked_scalar != update->ntimestep)
-	      error->all(FLERR,"Compute used in variable between runs "
-			 "is not current");
-	  } else if (!(compute->invoked_flag & INVOKED_SCALAR)) {
-	    compute->compute_scalar();
-	    compute->invoked_flag |= INVOKED_SCALAR;
-	  }
-
-	  value1 = compute->scalar;
-	  if (tree) {
-	    Tree *newtree = new Tree();
-	    newtree->type = VALUE;
-	    newtree->value = value1;
-	    newtree->left = newtree->middle = newtree->right = NULL;
-	    treestack[ntreestack++] = newtree;
-	  } else argstack[nargstack++] = value1;
-
-        // c_ID[i] = scalar from global vector
+	Ref ref;
+	ref.kind = COMPUTEREF;
+	ref.nbracket = nbracket;
+	ref.index1 = index1;
+	ref.index2 = index2;
+	ref.id = &word[2];
 
-	} else if (nbracket == 1 && compute->vector_flag) {
+        // c_ID = scalar from global scalar, c_ID[i] from global vector,
+        //   c_ID[i][j] from global array
 
-	  if (index1 > compute->size_vector)
-	    error->all(FLERR,"Variable formula compute vector "
-		       "is accessed out-of-range");
-	  if (update->runflag == 0) {
-	    if (compute->invoked_vector != update->ntimestep)
-	      error->all(FLERR,"Compute used in variable between runs "
-			 "is not current");
-	  } else if (!(compute->invoked_flag & INVOKED_VECTOR)) {
-	    compute->compute_vector();
-	    compute->invoked_flag |= INVOKED_VECTOR;
-	  }
-
-	  value1 = compute->vector[index1-1];
-	  if (tree) {
-	    Tree *newtree = new Tree();
-	    newtree->type = VALUE;
-	    newtree->value = value1;
-	    newtree->left = newtree->middle = newtree->right = NULL;
-	    treestack[ntreestack++] = newtree;
-	  } else argstack[nargstack++] = value1;
-
-        // c_ID[i][j] = scalar from global array
-
-	} else if (nbracket == 2 && compute->array_flag) {
-
-	  if (index1 > compute->size_array_rows)
-	    error->all(FLERR,"Variable formula compute array "
-		       "is accessed out-of-range");
-	  if (index2 > compute->size_array_cols)
-	    error->all(FLERR,"Variable formula compute array "
-		       "is accessed out-of-range");
-	  if (update->runflag == 0) {
-	    if (compute->invoked_array != update->ntimestep)
-	      error->all(FLERR,"Compute used in variable between runs "
-			 "is not current");
-	  } else if (!(compute->invoked_flag & INVOKED_ARRAY)) {
-	    compute->compute_array();
-	    compute->invoked_flag |= INVOKED_ARRAY;
-	  }
-
-	  value1 = compute->array[index1-1][index2-1];
-	  if (tree) {
-	    Tree *newtree = new Tree();
-	    newtree->type = VALUE;
-	    newtree->value = value1;
-	    newtree->left = newtree->middle = newtree->right = NULL;
-	    treestack[ntreestack++] = newtree;
-	  } else argstack[nargstack++] = value1;
+	if ((nbracket == 0 && compute->scalar_flag) ||
+	    (nbracket == 1 && compute->vector_flag) ||
+	    (nbracket == 2 && compute->array_flag)) {
+	  ref.per = 0;
+	  push_ref(&ref,VALUE,tree,treestack,ntreestack,argstack,nargstack);
 
         // c_ID = vector from per-particle vector
-
-	} else if (nbracket == 0 && compute->per_particle_flag &&
-		   compute->size_per_particle_cols == 0) {
-
-	  if (tree == NULL || treestyle != PARTICLE)
-	    error->all(FLERR,"Per-particle compute in "
-                       "non particle-style variable formula");
-	  if (update->runflag == 0) {
-	    if (compute->invoked_per_particle != update->ntimestep)
-	      error->all(FLERR,"Compute used in variable between runs "
-			 "is not current");
-	  } else if (!(compute->invoked_flag & INVOKED_PER_PARTICLE)) {
-	    compute->compute_per_particle();
-	    compute->invoked_flag |= INVOKED_PER_PARTICLE;
-	  }
-
-	  Tree *newtree = new Tree();
-	  newtree->type = ARRAY;
-	  newtree->array = compute->vector_particle;
-	  newtree->nstride = 1;
-          newtree->selfalloc = 0;
-	  newtree->left = newtree->middle = newtree->right = NULL;
-	  treestack[ntreestack++] = newtree;
-
         // c_ID[i] = vector from per-particle array
 
-	} else if (nbracket == 1 && compute->per_particle_flag &&
-		   compute->size_per_particle_cols > 0) {
+	} else if (compute->per_particle_flag &&
+		   ((nbracket == 0 && compute->size_per_particle_cols == 0) ||
+		    (nbracket == 1 && compute->size_per_particle_cols > 0))) {
 
 	  if (tree == NULL || treestyle != PARTICLE)
 	    error->all(FLERR,"Per-particle compute in "
                        "non particle-style variable formula");
-	  if (index1 > compute->size_per_particle_cols)
-	    error->all(FLERR,"Variable formula compute array "
-		       "is accessed out-of-range");
-	  if (update->runflag == 0) {
-	    if (compute->invoked_per_particle != update->ntimestep)
-	      error->all(FLERR,"Compute used in variable between runs "
-			 "is not current");
-	  } else if (!(compute->invoked_flag & INVOKED_PER_PARTICLE)) {
-	    compute->compute_per_particle();
-	    compute->invoked_flag |= INVOKED_PER_PARTICLE;
-	  }
-
-	  Tree *newtree = new Tree();
-	  newtree->type = ARRAY;
-	  newtree->array = &compute->array_particle[0][index1-1];
-	  newtree->nstride = compute->size_per_particle_cols;
-          newtree->selfalloc = 0;
-	  newtree->left = newtree->middle = newtree->right = NULL;
-	  treestack[ntreestack++] = newtree;
+	  ref.per = PARTICLE;
+	  push_ref(&ref,ARRAY,tree,treestack,ntreestack,argstack,nargstack);
 
         // c_ID = vector from per-grid vector
-
-	} else if (nbracket == 0 && compute->per_grid_flag &&
-		   compute->size_per_grid_cols == 0) {
-
-	  if (tree == NULL || treestyle != GRID)
-	    error->all(FLERR,"Per-grid compute in "
-                       "non grid-style variable formula");
-	  if (update->runflag == 0) {
-	    if (compute->invoked_per_grid != update->ntimestep)
-	      error->all(FLERR,"Compute used in variable between runs "
-			 "is not current");
-	  } else if (!(compute->invoked_flag & INVOKED_PER_GRID)) {
-	    compute->compute_per_grid();
-	    compute->invoked_flag |= INVOKED_PER_GRID;
-	  }
-
-          if (compute->post_process_grid_flag)
-            compute->post_process_grid(0,1,NULL,NULL,NULL,1);
-          else if (compute->post_process_isurf_grid_flag)
-            compute->post_process_isurf_grid();
-
-	  Tree *newtree = new Tree();
-	  newtree->type = ARRAY;
-	  newtree->array = compute->vector_grid;
-	  newtree->nstride = 1;
-          newtree->selfalloc = 0;
-	  newtree->left = newtree->middle = newtree->right = NULL;
-	  treestack[ntreestack++] = newtree;
-
         // c_ID[i] = vector from per-grid array
-        // if compute sets post_process_grid_flag:
-        //   then values are in computes's vector_grid,
-        //   must store them locally via add_vector()
-        //   since compute's vector_grid be overwritten
-        //   if this variable accesses multiple columns from compute's array
 
-	} else if (nbracket == 1 && compute->per_grid_flag &&
-		   compute->size_per_grid_cols > 0) {
+	} else if (compute->per_grid_flag &&
+		   ((nbracket == 0 && compute->size_per_grid_cols == 0) ||
+		    (nbracket == 1 && compute->size_per_grid_cols > 0))) {
 
 	  if (tree == NULL || treestyle != GRID)
 	    error->all(FLERR,"Per-grid compute in "
                        "non grid-style variable formula");
-	  if (index1 > compute->size_per_grid_cols)
-	    error->all(FLERR,"Variable formula compute array "
-		       "is accessed out-of-range");
-	  if (update->runflag == 0) {
-	    if (compute->invoked_per_grid != update->ntimestep)
-	      error->all(FLERR,"Compute used in variable between runs "
-			 "is not current");
-	  } else if (!(compute->invoked_flag & INVOKED_PER_GRID)) {
-	    compute->compute_per_grid();
-	    compute->invoked_flag |= INVOKED_PER_GRID;
-	  }
-
-          if (compute->post_process_grid_flag)
-            compute->post_process_grid(index1,1,NULL,NULL,NULL,1);
-          else if (compute->post_process_isurf_grid_flag)
-            compute->post_process_isurf_grid();
-
-	  Tree *newtree = new Tree();
-	  newtree->type = ARRAY;
-          if (compute->post_process_grid_flag) {
-            newtree->array = add_storage(compute->vector_grid);
-            newtree->nstride = 1;
-          } else {
-            newtree->array = &compute->array_grid[0][index1-1];
-            newtree->nstride = compute->size_per_grid_cols;
-          }
-          newtree->selfalloc = 0;
-	  newtree->left = newtree->middle = newtree->right = NULL;
-	  treestack[ntreestack++] = newtree;
+	  ref.per = GRID;
+	  push_ref(&ref,ARRAY,tree,treestack,ntreestack,argstack,nargstack);
 
 	} else error->all(FLERR,"Mismatched compute in variable formula");
 
@@ -1326,21 +1245,17 @@ double Variable::evaluate(char *str, Tree **tree)
 	  error->all(FLERR,
 		     "Variable evaluation before simulation box is defined");
 
-	n = strlen(word) - 2 + 1;
-	char *id = new char[n];
-	strcpy(id,&word[2]);
-
-	int ifix = modify->find_fix(id);
+	int ifix = modify->find_fix(&word[2]);
 	if (ifix < 0) error->all(FLERR,"Invalid fix ID in variable formula");
 	Fix *fix = modify->fix[ifix];
-	delete [] id;
 
 	// parse zero or one or two trailing brackets
 	// point i beyond last bracket
 	// nbracket = # of bracket pairs
 	// index1,index2 = int inside each bracket pair
 
-	int nbracket,index1,index2;
+	int nbracket;
+	int index1 = 0, index2 = 0;
 	if (str[i] != '[') nbracket = 0;
 	else {
 	  nbracket = 1;
@@ -1355,146 +1270,47 @@ double Variable::evaluate(char *str, Tree **tree)
 	  }
 	}
 
-	if (nbracket == 0 && fix->scalar_flag) {
-
-	  if (update->runflag > 0 && update->ntimestep % fix->global_freq)
-	    error->all(FLERR,"Fix in variable not computed at compatible time");
-
-	  value1 = fix->compute_scalar();
-	  if (tree) {
-	    Tree *newtree = new Tree();
-	    newtree->type = VALUE;
-	    newtree->value = value1;
-	    newtree->left = newtree->middle = newtree->right = NULL;
-	    treestack[ntreestack++] = newtree;
-	  } else argstack[nargstack++] = value1;
-
-        // f_ID[i] = scalar from global vector
-
-	} else if (nbracket == 1 && fix->vector_flag) {
-
-	  if (index1 > fix->size_vector)
-	    error->all(FLERR,
-		       "Variable formula fix vector is accessed out-of-range");
-	  if (update->runflag > 0 && update->ntimestep % fix->global_freq)
-	    error->all(FLERR,"Fix in variable not computed at compatible time");
-
-	  value1 = fix->compute_vector(index1-1);
-	  if (tree) {
-	    Tree *newtree = new Tree();
-	    newtree->type = VALUE;
-	    newtree->value = value1;
-	    newtree->left = newtree->middle = newtree->right = NULL;
-	    treestack[ntreestack++] = newtree;
-	  } else argstack[nargstack++] = value1;
-
-        // f_ID[i][j] = scalar from global array
+	Ref ref;
+	ref.kind = FIXREF;
+	ref.nbracket = nbracket;
+	ref.index1 = index1;
+	ref.index2 = index2;
+	ref.id = &word[2];
 
-	} else if (nbracket == 2 && fix->array_flag) {
-
-	  if (index1 > fix->size_array_rows)
-	    error->all(FLERR,
-		       "Variable formula fix array is accessed out-of-range");
-	  if (index2 > fix->size_array_cols)
-	    error->all(FLERR,
-		       "Variable formula fix array is accessed out-of-range");
-	  if (update->runflag > 0 && update->ntimestep % fix->global_freq)
-	    error->all(FLERR,"Fix in variable not computed at compatible time");
+        // f_ID = scalar from global scalar, f_ID[i] from global vector,
+        //   f_ID[i][j] from global array
 
-	  value1 = fix->compute_array(index1-1,index2-1);
-	  if (tree) {
-	    Tree *newtree = new Tree();
-	    newtree->type = VALUE;
-	    newtree->value = value1;
-	    newtree->left = newtree->middle = newtree->right = NULL;
-	    treestack[ntreestack++] = newtree;
-	  } else argstack[nargstack++] = value1;
+	if ((nbracket == 0 && fix->scalar_flag) ||
+	    (nbracket == 1 && fix->vector_flag) ||
+	    (nbracket == 2 && fix->array_flag)) {
+	  ref.per = 0;
+	  push_ref(&ref,VALUE,tree,treestack,ntreestack,argstack,nargstack);
 
         // f_ID = vector from per-particle vector
-
-	} else if (nbracket == 0 && fix->per_particle_flag &&
-		   fix->size_per_particle_cols == 0) {
-
-	  if (tree == NULL)
-	    error->all(FLERR,
-		       "Per-particle fix in equal-style variable formula");
-	  if (update->runflag > 0 &&
-	      update->ntimestep % fix->per_particle_freq)
-	    error->all(FLERR,"Fix in variable not computed at compatible time");
-
-	  Tree *newtree = new Tree();
-	  newtree->type = ARRAY;
-	  newtree->array = fix->vector_particle;
-	  newtree->nstride = 1;
-          newtree->selfalloc = 0;
-	  newtree->left = newtree->middle = newtree->right = NULL;
-	  treestack[ntreestack++] = newtree;
-
         // f_ID[i] = vector from per-particle array
 
-	} else if (nbracket == 1 && fix->per_particle_flag &&
-		   fix->size_per_particle_cols > 0) {
+	} else if (fix->per_particle_flag &&
+		   ((nbracket == 0 && fix->size_per_particle_cols == 0) ||
+		    (nbracket == 1 && fix->size_per_particle_cols > 0))) {
 
-	  if (tree == NULL)
+	  if (tree == NULL || treestyle == EQUAL)
 	    error->all(FLERR,
 		       "Per-particle fix in equal-style variable formula");
-	  if (index1 > fix->size_per_particle_cols)
-	    error->all(FLERR,
-		       "Variable formula fix array is accessed out-of-range");
-	  if (update->runflag > 0 &&
-	      update->ntimestep % fix->per_particle_freq)
-	    error->all(FLERR,"Fix in variable not computed at compatible time");
-
-	  Tree *newtree = new Tree();
-	  newtree->type = ARRAY;
-	  newtree->array = &fix->array_particle[0][index1-1];
-	  newtree->nstride = fix->size_per_particle_cols;
-          newtree->selfalloc = 0;
-	  newtree->left = newtree->middle = newtree->right = NULL;
-	  treestack[ntreestack++] = newtree;
+	  ref.per = PARTICLE;
+	  push_ref(&ref,ARRAY,tree,treestack,ntreestack,argstack,nargstack);
 
         // f_ID = vector from per-grid vector
-
-	} else if (nbracket == 0 && fix->per_grid_flag &&
-		   fix->size_per_grid_cols == 0) {
-
-	  if (tree == NULL || treestyle != GRID)
-	    error->all(FLERR,"Per-grid fix in "
-                       "non grid-style variable formula");
-	  if (update->runflag > 0 &&
-	      update->ntimestep % fix->per_grid_freq)
-	    error->all(FLERR,"Fix in variable not computed at compatible time");
-
-	  Tree *newtree = new Tree();
-	  newtree->type = ARRAY;
-	  newtree->array = fix->vector_grid;
-	  newtree->nstride = 1;
-          newtree->selfalloc = 0;
-	  newtree->left = newtree->middle = newtree->right = NULL;
-	  treestack[ntreestack++] = newtree;
-
         // f_ID[i] = vector from per-grid array
 
-	} else if (nbracket == 1 && fix->per_grid_flag &&
-		   fix->size_per_grid_cols > 0) {
+	} else if (fix->per_grid_flag &&
+		   ((nbracket == 0 && fix->size_per_grid_cols == 0) ||
+		    (nbracket == 1 && fix->size_per_grid_cols > 0))) {
 
 	  if (tree == NULL || treestyle != GRID)
 	    error->all(FLERR,"Per-grid fix in "
                        "non grid-style variable formula");
-	  if (index1 > fix->size_per_grid_cols)
-	    error->all(FLERR,
-		       "Variable formula fix array is accessed out-of-range");
-	  if (update->runflag > 0 &&
-	      update->ntimestep % fix->per_grid_freq)
-	    error->all(FLERR,"Fix in variable not computed at compatible time");
-
-	  Tree *newtree = new Tree();
-	  newtree->type = ARRAY;
-	  newtree->array = &fix->array_grid[0][index1-1];
-	  newtree->nstride = fix->size_per_grid_cols;
-          newtree->selfalloc = 0;
-	  newtree->left = newtree->middle = newtree->right = NULL;
-	  treestack[ntreestack++] = newtree;
+	  ref.per = GRID;
+	  push_ref(&ref,ARRAY,tree,treestack,ntreestack,argstack,nargstack);
 
 	} else error->all(FLERR,"Mismatched fix in variable formula");
 
@@ -1507,15 +1323,10 @@ double Variable::evaluate(char *str, Tree **tree)
 	  error->all(FLERR,
 		     "Variable evaluation before simulation box is defined");
 
-	n = strlen(word) - 2 + 1;
-	char *id = new char[n];
-	strcpy(id,&word[2]);
-
-	int isc = surf->find_collide(id);
+	int isc = surf->find_collide(&word[2]);
 	if (isc < 0)
           error->all(FLERR,"Invalid surf collide ID in variable formula");
 	SurfCollide *sc = surf->sc[isc];
-	delete [] id;
 
 	// parse zero or one or two trailing brackets
 	// point i beyond last bracket
@@ -1539,18 +1350,14 @@ double Variable::evaluate(char *str, Tree **tree)
         // s_ID[i] = scalar from global vector
 
 	if (nbracket == 1 && sc->vector_flag) {
-	  if (index1 > sc->size_vector)
-	    error->all(FLERR,"Variable formula surf collide vector "
-		       "is accessed out-of-range");
-
-          value1 = sc->compute_vector(index1-1);
-	  if (tree) {
-	    Tree *newtree = new Tree();
-	    newtree->type = VALUE;
-	    newtree->value = value1;
-	    newtree->left = newtree->middle = newtree->right = NULL;
-	    treestack[ntreestack++] = newtree;
-	  } else argstack[nargstack++] = value1;
+	  Ref ref;
+	  ref.kind = SURFCOLLIDEREF;
+	  ref.per = 0;
+	  ref.nbracket = nbracket;
+	  ref.index1 = index1;
+	  ref.index2 = 0;
+	  ref.id = &word[2];
+	  push_ref(&ref,VALUE,tree,treestack,ntreestack,argstack,nargstack);
 
 	} else error->all(FLERR,"Mismatched surf collide in variable formula");
 
@@ -1563,15 +1370,10 @@ double Variable::evaluate(char *str, Tree **tree)
 	  error->all(FLERR,
 		     "Variable evaluation before simulation box is defined");
 
-	n = strlen(word) - 2 + 1;
-	char *id = new char[n];
-	strcpy(id,&word[2]);
-
-	int isr = surf->find_collide(id);
+	int isr = surf->find_react(&word[2]);
 	if (isr < 0)
           error->all(FLERR,"Invalid surf reaction ID in variable formula");
 	SurfReact *sr = surf->sr[isr];
-	delete [] id;
 
 	// parse zero or one or two trailing brackets
 	// point i beyond last bracket
@@ -1593,21 +1395,17 @@ double Variable::evaluate(char *str, Tree **tree)
 	  }
 	}
 
-        // s_ID[i] = scalar from global vector
+        // r_ID[i] = scalar from global vector
 
 	if (nbracket == 1 && sr->vector_flag) {
-	  if (index1 > sr->size_vector)
-	    error->all(FLERR,"Variable formula surf reaction vector "
-		       "is accessed out-of-range");
-
-          value1 = sr->compute_vector(index1-1);
-	  if (tree) {
-	    Tree *newtree = new Tree();
-	    newtree->type = VALUE;
-	    newtree->value = value1;
-	    newtree->left = newtree->middle = newtree->right = NULL;
-	    treestack[ntreestack++] = newtree;
-	  } else argstack[nargstack++] = value1;
+	  Ref ref;
+	  ref.kind = SURFREACTREF;
+	  ref.per = 0;
+	  ref.nbracket = nbracket;
+	  ref.index1 = index1;
+	  ref.index2 = 0;
+	  ref.id = &word[2];
+	  push_ref(&ref,VALUE,tree,treestack,ntreestack,argstack,nargstack);
 
 	} else error->all(FLERR,"Mismatched surf reaction in variable formula");
 
@@ -1616,11 +1414,7 @@ double Variable::evaluate(char *str, Tree **tree)
       // ----------------
 
       } else if (strncmp(word,"v_",2) == 0) {
-	n = strlen(word) - 2 + 1;
-	char *id = new char[n];
-	strcpy(id,&word[2]);
-
-	int ivar = find(id);
+	int ivar = find(&word[2]);
 	if (ivar < 0)
 	  error->all(FLERR,"Invalid variable name in variable formula");
         if (eval_in_progress[ivar])
@@ -1639,36 +1433,18 @@ double Variable::evaluate(char *str, Tree **tree)
 	  i = ptr-str+1;
 	}
 
-        // v_name = scalar from internal-style variable
-        // access value directly
-
-        if (nbracket == 0 && style[ivar] == INTERNAL) {
+        // v_name = scalar from internal-style or other non particle/grid
+        //   variable, access value directly or via retrieve() in fetch()
 
-          value1 = dvalue[ivar];
-          if (tree) {
-            Tree *newtree = new Tree();
-            newtree->type = VALUE;
-            newtree->value = value1;
-	    newtree->left = newtree->middle = newtree->right = NULL;
-            treestack[ntreestack++] = newtree;
-          } else argstack[nargstack++] = value1;
-
-        // v_name = scalar from non particle/grid variable
-        // access value via retrieve()
-
-	} else if (nbracket == 0 && style[ivar] != PARTICLE &&
-                   style[ivar] != GRID) {
-
-	  char *var = retrieve(id);
-	  if (var == NULL)
-	    error->all(FLERR,"Invalid variable evaluation in variable formula");
-	  if (tree) {
-	    Tree *newtree = new Tree();
-	    newtree->type = VALUE;
-	    newtree->value = atof(var);
-	    newtree->left = newtree->middle = newtree->right = NULL;
-	    treestack[ntreestack++] = newtree;
-	  } else argstack[nargstack++] = atof(var);
+	if (nbracket == 0 && style[ivar] != PARTICLE &&
+            style[ivar] != GRID) {
+	  Ref ref;
+	  ref.kind = VARIABLEREF;
+	  ref.per = 0;
+	  ref.nbracket = 0;
+	  ref.index1 = ref.index2 = 0;
+	  ref.id = &word[2];
+	  push_ref(&ref,VALUE,tree,treestack,ntreestack,argstack,nargstack);
 
         // v_name = per-particle vector from particle-style variable
         // evaluate the particle-style variable as newtree
@@ -1696,8 +1472,6 @@ double Variable::evaluate(char *str, Tree **tree)
 
 	} else error->all(FLERR,"Mismatched variable in variable formula");
 
-	delete [] id;
-
       // ----------------
       // math/special function or particle vector or constant or stats keyword
       // ----------------
@@ -1729,7 +1503,7 @@ double Variable::evaluate(char *str, Tree **tree)
 	  if (domain->box_exist == 0)
 	    error->all(FLERR,
 		       "Variable evaluation before simulation box is defined");
-	  particle_vector(word,tree,treestack,ntreestack);
+	  particle_vector(word,tree,treestack,ntreestack,argstack,nargstack);
 
 	// ----------------
 	// constant
@@ -1754,16 +1528,13 @@ double Variable::evaluate(char *str, Tree **tree)
 	    error->all(FLERR,
 		       "Variable evaluation before simulation box is defined");
 
-	  int flag = output->stats->evaluate_keyword(word,&value1);
-	  if (flag)
-            error->all(FLERR,"Invalid stats keyword in variable formula");
-	  if (tree) {
-	    Tree *newtree = new Tree();
-	    newtree->type = VALUE;
-	    newtree->value = value1;
-	    newtree->left = newtree->middle = newtree->right = NULL;
-	    treestack[ntreestack++] = newtree;
-	  } else argstack[nargstack++] = value1;
+	  Ref ref;
+	  ref.kind = KEYWORDREF;
+	  ref.per = 0;
+	  ref.nbracket = 0;
+	  ref.index1 = ref.index2 = 0;
+	  ref.id = word;
+	  push_ref(&ref,VALUE,tree,treestack,ntreestack,argstack,nargstack);
 	}
       }
 
@@ -1929,6 +1700,375 @@ double Variable::evaluate(char *str, Tree **tree)
   }
 }
 
+/* ----------------------------------------------------------------------
+   push a formula input described by ref onto argstack or treestack
+   type = VALUE for a scalar input, else ARRAY or a particle array type
+   equal-style evaluation fetches the value immediately
+   tree parsing fetches the value or array ptr into the new leaf,
+     unless a cached program is being compiled,
+     in which case a copy of ref is stored and the leaf is
+     refreshed from it by fetch() each time the program is evaluated
+------------------------------------------------------------------------- */
+
+void Variable::push_ref(Ref *ref, int type, Tree **tree,
+                        Tree **treestack, int &ntreestack,
+                        double *argstack, int &nargstack)
+{
+  if (tree == NULL) {
+    double value = 0.0;
+    double *array;
+    char *carray;
+    int nstride;
+    fetch(ref,value,array,carray,nstride);
+    argstack[nargstack++] = value;
+    return;
+  }
+
+  Tree *newtree = new Tree();
+  newtree->type = type;
+  newtree->selfalloc = 0;
+  newtree->left = newtree->middle = newtree->right = NULL;
+  treestack[ntreestack++] = newtree;
+
+  if (!compileflag) {
+    fetch(ref,newtree->value,newtree->array,newtree->carray,newtree->nstride);
+    return;
+  }
+
+  // REFVALUE is not collapsed into a constant by collapse_tree()
+
+  if (type == VALUE) newtree->type = REFVALUE;
+
+  if (nref == maxref) {
+    maxref += VARDELTA;
+    refs = (Ref *) memory->srealloc(refs,maxref*sizeof(Ref),"variable:refs");
+  }
+  refs[nref] = *ref;
+  int n = strlen(ref->id) + 1;
+  refs[nref].id = new char[n];
+  strcpy(refs[nref].id,ref->id);
+  newtree->ref = nref++;
+}
+
+/* ----------------------------------------------------------------------
+   fetch current value or array ptr of formula input described by ref
+   compute, fix, etc is looked up by its ID each time,
+     so ref stays valid if it is deleted and re-defined
+   global value is returned in value
+   per-particle or per-grid array is returned in array with nstride,
+     particle attribute in carray with nstride
+   computes are invoked if needed, same as when formula is parsed
+------------------------------------------------------------------------- */
+
+void Variable::fetch(Ref *ref, double &value, double *&array, char *&carray,
+                     int &nstride)
+{
+  int index1 = ref->index1;
+  int index2 = ref->index2;
+
+  // compute
+
+  if (ref->kind == COMPUTEREF) {
+    int icompute = modify->find_compute(ref->id);
+    if (icompute < 0)
+      error->all(FLERR,"Invalid compute ID in variable formula");
+    Compute *compute = modify->compute[icompute];
+
+    // c_ID = scalar from global scalar
+
+    if (ref->per == 0 && ref->nbracket == 0 && compute->scalar_flag) {
+
+      if (update->runflag == 0) {
+        if (compute->invoked_scalar != update->ntimestep)
+          error->all(FLERR,"Compute used in variable between runs "
+                     "is not current");
+      } else if (!(compute->invoked_flag & INVOKED_SCALAR)) {
+        compute->compute_scalar();
+        compute->invoked_flag |= INVOKED_SCALAR;
+      }
+
+      value = compute->scalar;
+
+    // c_ID[i] = scalar from global vector
+
+    } else if (ref->per == 0 && ref->nbracket == 1 && compute->vector_flag) {
+
+      if (index1 > compute->size_vector)
+        error->all(FLERR,"Variable formula compute vector "
+                   "is accessed out-of-range");
+      if (update->runflag == 0) {
+        if (compute->invoked_vector != update->ntimestep)
+          error->all(FLERR,"Compute used in variable between runs "
+                     "is not current");
+      } else if (!(compute->invoked_flag & INVOKED_VECTOR)) {
+        compute->compute_vector();
+        compute->invoked_flag |= INVOKED_VECTOR;
+      }
+
+      value = compute->vector[index1-1];
+
+    // c_ID[i][j] = scalar from global array
+
+    } else if (ref->per == 0 && ref->nbracket == 2 && compute->array_flag) {
+
+      if (index1 > compute->size_array_rows)
+        error->all(FLERR,"Variable formula compute array "
+                   "is accessed out-of-range");
+      if (index2 > compute->size_array_cols)
+        error->all(FLERR,"Variable formula compute array "
+                   "is accessed out-of-range");
+      if (update->runflag == 0) {
+        if (compute->invoked_array != update->ntimestep)
+          error->all(FLERR,"Compute used in variable between runs "
+                     "is not current");
+      } else if (!(compute->invoked_flag & INVOKED_ARRAY)) {
+        compute->compute_array();
+        compute->invoked_flag |= INVOKED_ARRAY;
+      }
+
+      value = compute->array[index1-1][index2-1];
+
+    // c_ID = vector from per-particle vector
+    // c_ID[i] = vector from per-particle array
+
+    } else if (ref->per == PARTICLE && compute->per_particle_flag &&
+               ((ref->nbracket == 0 && compute->size_per_particle_cols == 0) ||
+                (ref->nbracket == 1 && compute->size_per_particle_cols > 0))) {
+
+      if (index1 > compute->size_per_particle_cols)
+        error->all(FLERR,"Variable formula compute array "
+                   "is accessed out-of-range");
+      if (update->runflag == 0) {
+        if (compute->invoked_per_particle != update->ntimestep)
+          error->all(FLERR,"Compute used in variable between runs "
+                     "is not current");
+      } else if (!(compute->invoked_flag & INVOKED_PER_PARTICLE)) {
+        compute->compute_per_particle();
+        compute->invoked_flag |= INVOKED_PER_PARTICLE;
+      }
+
+      if (ref->nbracket == 0) {
+        array = compute->vector_particle;
+        nstride = 1;
+      } else {
+        array = &compute->array_particle[0][index1-1];
+        nstride = compute->size_per_particle_cols;
+      }
+
+    // c_ID = vector from per-grid vector
+    // c_ID[i] = vector from per-grid array
+    // if compute sets post_process_grid_flag:
+    //   then values are in computes's vector_grid,
+    //   must store them locally via add_vector()
+    //   since compute's vector_grid be overwritten
+    //   if this variable accesses multiple columns from compute's array
+
+    } else if (ref->per == GRID && compute->per_grid_flag &&
+               ((ref->nbracket == 0 && compute->size_per_grid_cols == 0) ||
+                (ref->nbracket == 1 && compute->size_per_grid_cols > 0))) {
+
+      if (index1 > compute->size_per_grid_cols)
+        error->all(FLERR,"Variable formula compute array "
+                   "is accessed out-of-range");
+      if (update->runflag == 0) {
+        if (compute->invoked_per_grid != update->ntimestep)
+          error->all(FLERR,"Compute used in variable between runs "
+                     "is not current");
+      } else if (!(compute->invoked_flag & INVOKED_PER_GRID)) {
+        compute->compute_per_grid();
+        compute->invoked_flag |= INVOKED_PER_GRID;
+      }
+
+      if (compute->post_process_grid_flag)
+        compute->post_process_grid(index1,1,NULL,NULL,NULL,1);
+      else if (compute->post_process_isurf_grid_flag)
+        compute->post_process_isurf_grid();
+
+      if (ref->nbracket == 0) {
+        array = compute->vector_grid;
+        nstride = 1;
+      } else if (compute->post_process_grid_flag) {
+        array = add_storage(compute->vector_grid);
+        nstride = 1;
+      } else {
+        array = &compute->array_grid[0][index1-1];
+        nstride = compute->size_per_grid_cols;
+      }
+
+    } else error->all(FLERR,"Mismatched compute in variable formula");
+
+  // fix
+
+  } else if (ref->kind == FIXREF) {
+    int ifix = modify->find_fix(ref->id);
+    if (ifix < 0) error->all(FLERR,"Invalid fix ID in variable formula");
+    Fix *fix = modify->fix[ifix];
+
+    // f_ID = scalar from global scalar
+
+    if (ref->per == 0 && ref->nbracket == 0 && fix->scalar_flag) {
+
+      if (update->runflag > 0 && update->ntimestep % fix->global_freq)
+        error->all(FLERR,"Fix in variable not computed at compatible time");
+
+      value = fix->compute_scalar();
+
+    // f_ID[i] = scalar from global vector
+
+    } else if (ref->per == 0 && ref->nbracket == 1 && fix->vector_flag) {
+
+      if (index1 > fix->size_vector)
+        error->all(FLERR,
+                   "Variable formula fix vector is accessed out-of-range");
+      if (update->runflag > 0 && update->ntimestep % fix->global_freq)
+        error->all(FLERR,"Fix in variable not computed at compatible time");
+
+      value = fix->compute_vector(index1-1);
+
+    // f_ID[i][j] = scalar from global array
+
+    } else if (ref->per == 0 && ref->nbracket == 2 && fix->array_flag) {
+
+      if (index1 > fix->size_array_rows)
+        error->all(FLERR,
+                   "Variable formula fix array is accessed out-of-range");
+      if (index2 > fix->size_array_cols)
+        error->all(FLERR,
+                   "Variable formula fix array is accessed out-of-range");
+      if (update->runflag > 0 && update->ntimestep % fix->global_freq)
+        error->all(FLERR,"Fix in variable not computed at compatible time");
+
+      value = fix->compute_array(index1-1,index2-1);
+
+    // f_ID = vector from per-particle vector
+    // f_ID[i] = vector from per-particle array
+
+    } else if (ref->per == PARTICLE && fix->per_particle_flag &&
+               ((ref->nbracket == 0 && fix->size_per_particle_cols == 0) ||
+                (ref->nbracket == 1 && fix->size_per_particle_cols > 0))) {
+
+      if (index1 > fix->size_per_particle_cols)
+        error->all(FLERR,
+                   "Variable formula fix array is accessed out-of-range");
+      if (update->runflag > 0 &&
+          update->ntimestep % fix->per_particle_freq)
+        error->all(FLERR,"Fix in variable not computed at compatible time");
+
+      if (ref->nbracket == 0) {
+        array = fix->vector_particle;
+        nstride = 1;
+      } else {
+        array = &fix->array_particle[0][index1-1];
+        nstride = fix->size_per_particle_cols;
+      }
+
+    // f_ID = vector from per-grid vector
+    // f_ID[i] = vector from per-grid array
+
+    } else if (ref->per == GRID && fix->per_grid_flag &&
+               ((ref->nbracket == 0 && fix->size_per_grid_cols == 0) ||
+                (ref->nbracket == 1 && fix->size_per_grid_cols > 0))) {
+
+      if (index1 > fix->size_per_grid_cols)
+        error->all(FLERR,
+                   "Variable formula fix array is accessed out-of-range");
+      if (update->runflag > 0 &&
+          update->ntimestep % fix->per_grid_freq)
+        error->all(FLERR,"Fix in variable not computed at compatible time");
+
+      if (ref->nbracket == 0) {
+        array = fix->vector_grid;
+        nstride = 1;
+      } else {
+        array = &fix->array_grid[0][index1-1];
+        nstride = fix->size_per_grid_cols;
+      }
+
+    } else error->all(FLERR,"Mismatched fix in variable formula");
+
+  // s_ID[i] = scalar from surface collide model global vector
+
+  } else if (ref->kind == SURFCOLLIDEREF) {
+    int isc = surf->find_collide(ref->id);
+    if (isc < 0)
+      error->all(FLERR,"Invalid surf collide ID in variable formula");
+    SurfCollide *sc = surf->sc[isc];
+    if (!sc->vector_flag)
+      error->all(FLERR,"Mismatched surf collide in variable formula");
+    if (index1 > sc->size_vector)
+      error->all(FLERR,"Variable formula surf collide vector "
+                 "is accessed out-of-range");
+
+    value = sc->compute_vector(index1-1);
+
+  // r_ID[i] = scalar from surface reaction model global vector
+
+  } else if (ref->kind == SURFREACTREF) {
+    int isr = surf->find_react(ref->id);
+    if (isr < 0)
+      error->all(FLERR,"Invalid surf reaction ID in variable formula");
+    SurfReact *sr = surf->sr[isr];
+    if (!sr->vector_flag)
+      error->all(FLERR,"Mismatched surf reaction in variable formula");
+    if (index1 > sr->size_vector)
+      error->all(FLERR,"Variable formula surf reaction vector "
+                 "is accessed out-of-range");
+
+    value = sr->compute_vector(index1-1);
+
+  // v_name = scalar from internal-style variable, access value directly
+  // v_name = scalar from other non particle/grid variable via retrieve()
+
+  } else if (ref->kind == VARIABLEREF) {
+    int ivar = find(ref->id);
+    if (ivar < 0)
+      error->all(FLERR,"Invalid variable name in variable formula");
+    if (eval_in_progress[ivar])
+      error->all(FLERR,"Variable has circular dependency");
+
+    if (style[ivar] == INTERNAL) value = dvalue[ivar];
+    else if (style[ivar] != PARTICLE && style[ivar] != GRID) {
+      char *var = retrieve(ref->id);
+      if (var == NULL)
+        error->all(FLERR,"Invalid variable evaluation in variable formula");
+      value = atof(var);
+    } else error->all(FLERR,"Mismatched variable in variable formula");
+
+  // stats keyword
+
+  } else if (ref->kind == KEYWORDREF) {
+    int flag = output->stats->evaluate_keyword(ref->id,&value);
+    if (flag)
+      error->all(FLERR,"Invalid stats keyword in variable formula");
+
+  // particle vector
+  // particles are re-allocated as they are created, so ptr is found each time
+
+  } else if (ref->kind == PARTICLEREF) {
+    Particle::OnePart *particles = particle->particles;
+    nstride = sizeof(Particle::OnePart);
+    carray = NULL;
+
+    if (strcmp(ref->id,"mass") == 0) {
+      nstride = sizeof(Particle::Species);
+      carray = (char *) &particle->species[0].mass;
+    } else if (strcmp(ref->id,"type") == 0)
+      carray = (char *) &particles[0].ispecies;
+    else if (strcmp(ref->id,"x") == 0)
+      carray = (char *) &particles[0].x[0];
+    else if (strcmp(ref->id,"y") == 0)
+      carray = (char *) &particles[0].x[1];
+    else if (strcmp(ref->id,"z") == 0)
+      carray = (char *) &particles[0].x[2];
+    else if (strcmp(ref->id,"vx") == 0)
+      carray = (char *) &particles[0].v[0];
+    else if (strcmp(ref->id,"vy") == 0)
+      carray = (char *) &particles[0].v[1];
+    else if (strcmp(ref->id,"vz") == 0)
+      carray = (char *) &particles[0].v[2];
+  }
+}
+
 /* ----------------------------------------------------------------------
    one-time collapse of a particle-style or grid-style variable parse tree
    tree was created by one-time parsing of formula string via evaulate()
@@ -1947,6 +2087,7 @@ double Variable::collapse_tree(Tree *tree)
   double arg1,arg2;
 
   if (tree->type == VALUE) return tree->value;
+  if (tree->type == REFVALUE) return 0.0;
   if (tree->type == ARRAY) return 0.0;
   if (tree->type == PARTARRAYDOUBLE) return 0.0;
   if (tree->type == PARTARRAYINT) return 0.0;
@@ -2621,6 +2762,364 @@ double Variable::eval_tree(Tree *tree, int i)
   return 0.0;
 }
 
+/* ----------------------------------------------------------------------
+   compile a collapsed tree into a list of instructions in postfix order
+   level = stack level the result of this tree will be stored at
+   each instruction pops its operands off the stack and pushes its result
+   return 1 if successful
+   return 0 if tree contains an operation which must be evaluated
+     one particle or cell at a time, e.g. a random number so that
+     the sequence of random numbers is unchanged
+   also return 0 if right operand of AND,OR has a domain check,
+     since eval_tree() only evaluates it where the left operand
+     does not decide the result, e.g. (v_x>0)&&(1/v_x>2)
+------------------------------------------------------------------------- */
+
+int Variable::compile_tree(Tree *tree, int level)
+{
+  int type = tree->type;
+
+  if (type == RANDOM || type == NORMAL || type == RAMP || type == STAGGER ||
+      type == LOGFREQ || type == STRIDE || type == VDISPLACE ||
+      type == SWIGGLE || type == CWIGGLE) return 0;
+
+  if ((type == AND || type == OR) && tree->right &&
+      domain_check(tree->right)) return 0;
+
+  // collapsed VALUE nodes may still have children, ignore them
+
+  if (type < VALUE) {
+    if (tree->left && !compile_tree(tree->left,level)) return 0;
+    if (tree->right && !compile_tree(tree->right,level+1)) return 0;
+  }
+  depth = MAX(depth,level+1);
+
+  if (ninstr == maxinstr) {
+    maxinstr += VARDELTA;
+    instr = (Instr *)
+      memory->srealloc(instr,maxinstr*sizeof(Instr),"variable:instr");
+  }
+
+  Instr *in = &instr[ninstr++];
+  in->type = type;
+  in->value = tree->value;
+  in->array = tree->array;
+  in->carray = tree->carray;
+  in->nstride = tree->nstride;
+  in->ref = tree->ref;
+  return 1;
+}
+
+/* ----------------------------------------------------------------------
+   return cached program for formula of ivar, compile it if needed
+   formula is parsed once into a tree whose leaves are refs to
+     computes, fixes, variables, etc by ID or name,
+     then collapsed and compiled
+   refresh() updates the program's operands on each evaluation
+   return NULL if formula cannot be compiled,
+     that result is also cached until a variable is (re)defined
+------------------------------------------------------------------------- */
+
+Variable::Program *Variable::compile_program(int ivar)
+{
+  Program *p = program[ivar];
+  if (p && p->stamp == cachestamp) return p->ninstr ? p : NULL;
+
+  free_program(p);
+  p = program[ivar] = new Program();
+  p->stamp = cachestamp;
+
+  // parse may be nested inside immediate evaluation of another formula
+
+  int treestyle_saved = treestyle;
+  int compileflag_saved = compileflag;
+  treestyle = style[ivar];
+  compileflag = 1;
+  cacheflag = 1;
+  nref = 0;
+
+  Tree *tree;
+  evaluate(data[ivar][0],&tree);
+  collapse_tree(tree);
+  ninstr = depth = 0;
+  int flag = cacheflag && compile_tree(tree,0);
+  free_tree(tree);
+
+  treestyle = treestyle_saved;
+  compileflag = compileflag_saved;
+
+  if (!flag) {
+    for (int i = 0; i < nref; i++) delete [] refs[i].id;
+    nref = 0;
+    return NULL;
+  }
+
+  p->ninstr = ninstr;
+  p->instr = (Instr *)
+    memory->smalloc(ninstr*sizeof(Instr),"variable:program_instr");
+  memcpy(p->instr,instr,ninstr*sizeof(Instr));
+  p->depth = depth;
+  p->nref = nref;
+  p->refs = (Ref *) memory->smalloc(nref*sizeof(Ref),"variable:program_refs");
+  memcpy(p->refs,refs,nref*sizeof(Ref));
+  nref = 0;
+
+  return p;
+}
+
+/* ----------------------------------------------------------------------
+   refresh operands of a cached program before it is evaluated
+   invokes computes as needed and re-reads values and array ptrs
+------------------------------------------------------------------------- */
+
+void Variable::refresh(Program *p)
+{
+  for (int m = 0; m < p->ninstr; m++) {
+    Instr *in = &p->instr[m];
+    if (in->type > VALUE)
+      fetch(&p->refs[in->ref],in->value,in->array,in->carray,in->nstride);
+  }
+}
+
+/* ---------------------------------------------------------------------- */
+
+void Variable::free_program(Program *p)
+{
+  if (p == NULL) return;
+  for (int i = 0; i < p->nref; i++) delete [] p->refs[i].id;
+  memory->sfree(p->refs);
+  memory->sfree(p->instr);
+  delete p;
+}
+
+/* ----------------------------------------------------------------------
+   return 1 if uncollapsed part of tree has an operation whose
+     argument is checked for validity by eval_compiled(), else 0
+------------------------------------------------------------------------- */
+
+int Variable::domain_check(Tree *tree)
+{
+  int type = tree->type;
+  if (type >= VALUE) return 0;
+
+  if (type == DIVIDE || type == MODULO || type == CARAT || type == SQRT ||
+      type == LN || type == LOG || type == ASIN || type == ACOS) return 1;
+
+  if (tree->left && domain_check(tree->left)) return 1;
+  if (tree->middle && domain_check(tree->middle)) return 1;
+  if (tree->right && domain_check(tree->right)) return 1;
+  return 0;
+}
+
+/* ----------------------------------------------------------------------
+   evaluate compiled program p for n particles or grid cells
+   n = 1 for an equal-style formula
+   each instruction is applied to VECBLOCK particles or cells at a time
+     which removes the per-value recursion and lets the compiler
+     vectorize the inner loops
+   answers are placed every stride locations into result
+   if sumflag, add variable values to existing result
+------------------------------------------------------------------------- */
+
+void Variable::eval_compiled(Program *p, int n, double *result,
+                             int stride, int sumflag)
+{
+  int k,nb,top,flag;
+  double *a,*b;
+
+  int ninstr = p->ninstr;
+  Instr *instr = p->instr;
+
+  if (p->depth > maxdepth) {
+    maxdepth = p->depth;
+    memory->destroy(vstack);
+    memory->create(vstack,maxdepth*VECBLOCK,"variable:vstack");
+  }
+
+  Particle::OnePart *particles = particle->particles;
+
+  for (int ifirst = 0; ifirst < n; ifirst += VECBLOCK) {
+    nb = MIN(VECBLOCK,n-ifirst);
+    top = -1;
+    flag = 0;
+
+    for (int m = 0; m < ninstr; m++) {
+      Instr *in = &instr[m];
+      int type = in->type;
+
+      // operands: push onto stack
+
+      if (type >= VALUE) {
+        a = &vstack[(++top)*VECBLOCK];
+        if (type == VALUE || type == REFVALUE) {
+          double value = in->value;
+          for (k = 0; k < nb; k++) a[k] = value;
+        } else if (type == ARRAY) {
+          double *array = &in->array[ifirst*in->nstride];
+          int nstride = in->nstride;
+          for (k = 0; k < nb; k++) a[k] = array[k*nstride];
+        } else if (type == PARTARRAYDOUBLE) {
+          char *carray = &in->carray[(bigint) ifirst*in->nstride];
+          int nstride = in->nstride;
+          for (k = 0; k < nb; k++) a[k] = *((double *) &carray[k*nstride]);
+        } else if (type == PARTARRAYINT) {
+          char *carray = &in->carray[(bigint) ifirst*in->nstride];
+          int nstride = in->nstride;
+          for (k = 0; k < nb; k++) a[k] = *((int *) &carray[k*nstride]);
+        } else if (type == SPECARRAY) {
+          for (k = 0; k < nb; k++)
+            a[k] = *((double *) &in->carray[particles[ifirst+k].ispecies *
+                                            in->nstride]);
+        }
+        continue;
+      }
+
+      // binary operators: pop 2, push 1, result overwrites left operand
+
+      if ((type <= OR && type != UNARY && type != NOT) || type == ATAN2) {
+        b = &vstack[(top--)*VECBLOCK];
+        a = &vstack[top*VECBLOCK];
+
+        switch (type) {
+        case ADD:
+          for (k = 0; k < nb; k++) a[k] += b[k];
+          break;
+        case SUBTRACT:
+          for (k = 0; k < nb; k++) a[k] -= b[k];
+          break;
+        case MULTIPLY:
+          for (k = 0; k < nb; k++) a[k] *= b[k];
+          break;
+        case DIVIDE:
+          for (k = 0; k < nb; k++) flag |= (b[k] == 0.0);
+          if (flag) error->one(FLERR,"Divide by 0 in variable formula");
+          for (k = 0; k < nb; k++) a[k] /= b[k];
+          break;
+        case MODULO:
+          for (k = 0; k < nb; k++) flag |= (b[k] == 0.0);
+          if (flag) error->one(FLERR,"Modulo 0 in variable formula");
+          for (k = 0; k < nb; k++) a[k] = fmod(a[k],b[k]);
+          break;
+        case CARAT:
+          for (k = 0; k < nb; k++) flag |= (b[k] == 0.0);
+          if (flag) error->one(FLERR,"Power by 0 in variable formula");
+          for (k = 0; k < nb; k++) a[k] = pow(a[k],b[k]);
+          break;
+        case EQ:
+          for (k = 0; k < nb; k++) a[k] = (a[k] == b[k]) ? 1.0 : 0.0;
+          break;
+        case NE:
+          for (k = 0; k < nb; k++) a[k] = (a[k] != b[k]) ? 1.0 : 0.0;
+          break;
+        case LT:
+          for (k = 0; k < nb; k++) a[k] = (a[k] < b[k]) ? 1.0 : 0.0;
+          break;
+        case LE:
+          for (k = 0; k < nb; k++) a[k] = (a[k] <= b[k]) ? 1.0 : 0.0;
+          break;
+        case GT:
+          for (k = 0; k < nb; k++) a[k] = (a[k] > b[k]) ? 1.0 : 0.0;
+          break;
+        case GE:
+          for (k = 0; k < nb; k++) a[k] = (a[k] >= b[k]) ? 1.0 : 0.0;
+          break;
+        case AND:
+          for (k = 0; k < nb; k++)
+            a[k] = (a[k] != 0.0 && b[k] != 0.0) ? 1.0 : 0.0;
+          break;
+        case OR:
+          for (k = 0; k < nb; k++)
+            a[k] = (a[k] != 0.0 || b[k] != 0.0) ? 1.0 : 0.0;
+          break;
+        case ATAN2:
+          for (k = 0; k < nb; k++) a[k] = atan2(a[k],b[k]);
+          break;
+        }
+        continue;
+      }
+
+      // unary operators and math functions: operate in place
+
+      a = &vstack[top*VECBLOCK];
+
+      switch (type) {
+      case UNARY:
+        for (k = 0; k < nb; k++) a[k] = -a[k];
+        break;
+      case NOT:
+        for (k = 0; k < nb; k++) a[k] = (a[k] == 0.0) ? 1.0 : 0.0;
+        break;
+      case SQRT:
+        for (k = 0; k < nb; k++) flag |= (a[k] < 0.0);
+        if (flag)
+          error->one(FLERR,"Sqrt of negative value in variable formula");
+        for (k = 0; k < nb; k++) a[k] = sqrt(a[k]);
+        break;
+      case EXP:
+        for (k = 0; k < nb; k++) a[k] = exp(a[k]);
+        break;
+      case LN:
+        for (k = 0; k < nb; k++) flag |= (a[k] <= 0.0);
+        if (flag)
+          error->one(FLERR,"Log of zero/negative value in variable formula");
+        for (k = 0; k < nb; k++) a[k] = log(a[k]);
+        break;
+      case LOG:
+        for (k = 0; k < nb; k++) flag |= (a[k] <= 0.0);
+        if (flag)
+          error->one(FLERR,"Log of zero/negative value in variable formula");
+        for (k = 0; k < nb; k++) a[k] = log10(a[k]);
+        break;
+      case ABS:
+        for (k = 0; k < nb; k++) a[k] = fabs(a[k]);
+        break;
+      case SIN:
+        for (k = 0; k < nb; k++) a[k] = sin(a[k]);
+        break;
+      case COS:
+        for (k = 0; k < nb; k++) a[k] = cos(a[k]);
+        break;
+      case TAN:
+        for (k = 0; k < nb; k++) a[k] = tan(a[k]);
+        break;
+      case ASIN:
+        for (k = 0; k < nb; k++) flag |= (a[k] < -1.0 || a[k] > 1.0);
+        if (flag)
+          error->one(FLERR,"Arcsin of invalid value in variable formula");
+        for (k = 0; k < nb; k++) a[k] = asin(a[k]);
+        break;
+      case ACOS:
+        for (k = 0; k < nb; k++) flag |= (a[k] < -1.0 || a[k] > 1.0);
+        if (flag)
+          error->one(FLERR,"Arccos of invalid value in variable formula");
+        for (k = 0; k < nb; k++) a[k] = acos(a[k]);
+        break;
+      case ATAN:
+        for (k = 0; k < nb; k++) a[k] = atan(a[k]);
+        break;
+      case CEIL:
+        for (k = 0; k < nb; k++) a[k] = ceil(a[k]);
+        break;
+      case FLOOR:
+        for (k = 0; k < nb; k++) a[k] = floor(a[k]);
+        break;
+      case ROUND:
+        for (k = 0; k < nb; k++) a[k] = MYROUND(a[k]);
+        break;
+      }
+    }
+
+    // result is the one value left on the stack
+
+    a = vstack;
+    double *r = &result[(bigint) ifirst*stride];
+    if (sumflag == 0)
+      for (k = 0; k < nb; k++) r[k*stride] = a[k];
+    else
+      for (k = 0; k < nb; k++) r[k*stride] += a[k];
+  }
+}
+
 /* ---------------------------------------------------------------------- */
 
 void Variable::free_tree(Tree *tree)
@@ -2759,6 +3258,18 @@ int Variable::math_function(char *word, char *contents, Tree **tree,
       strcmp(word,"swiggle") && strcmp(word,"cwiggle"))
     return 0;
 
+  // random and time-dependent functions with constant args are
+  // evaluated once when the tree is collapsed,
+  // so a formula using one cannot be cached as a compiled program
+
+  if (tree && compileflag &&
+      (strcmp(word,"random") == 0 || strcmp(word,"normal") == 0 ||
+       strcmp(word,"ramp") == 0 || strcmp(word,"stagger") == 0 ||
+       strcmp(word,"logfreq") == 0 || strcmp(word,"stride") == 0 ||
+       strcmp(word,"vdisplace") == 0 || strcmp(word,"swiggle") == 0 ||
+       strcmp(word,"cwiggle") == 0))
+    cacheflag = 0;
+
   // parse contents for arg1,arg2,arg3 separated by commas
   // ptr1,ptr2 = location of 1st and 2nd comma, NULL if none
 
@@ -3103,6 +3614,20 @@ int Variable::special_function(char *word, char *contents, Tree **tree,
       strcmp(word,"next"))
     return 0;
 
+  // special functions reduce a vector or read a file when parsed,
+  // so a formula using one cannot be cached as a compiled program
+  // push a placeholder without side effects, formula is re-parsed by caller
+
+  if (tree && compileflag) {
+    cacheflag = 0;
+    Tree *newtree = new Tree();
+    newtree->type = VALUE;
+    newtree->value = 0.0;
+    newtree->left = newtree->middle = newtree->right = NULL;
+    treestack[ntreestack++] = newtree;
+    return 1;
+  }
+
   // parse contents for arg1,arg2,arg3 separated by commas
   // ptr1,ptr2 = location of 1st and 2nd comma, NULL if none
 
@@ -3361,46 +3886,29 @@ int Variable::is_particle_vector(char *word)
 /* ----------------------------------------------------------------------
    process a particle vector in formula
    push result onto tree
-   word = particle vector
-   customize by adding a particle vector:
+   word = particle vector, ptr into particles is set by fetch()
+   customize by adding a particle vector here and in fetch():
      mass,type,x,y,z,vx,vy,vz,fx,fy,fz
 ------------------------------------------------------------------------- */
 
 void Variable::particle_vector(char *word, Tree **tree,
-			       Tree **treestack, int &ntreestack)
+			       Tree **treestack, int &ntreestack,
+			       double *argstack, int &nargstack)
 {
   if (tree == NULL || treestyle != PARTICLE)
     error->all(FLERR,"Particle vector in non particle-style variable formula");
 
-  Particle::OnePart *particles = particle->particles;
-  Particle::Species *species = particle->species;
-
-  Tree *newtree = new Tree();
-  newtree->type = PARTARRAYDOUBLE;
-  newtree->nstride = sizeof(Particle::OnePart);
-  newtree->left = newtree->middle = newtree->right = NULL;
-  treestack[ntreestack++] = newtree;
-
-  if (strcmp(word,"mass") == 0) {
-    newtree->type = SPECARRAY;
-    newtree->nstride = sizeof(Particle::Species);
-    newtree->carray = (char *) &species[0].mass;
-  } else if (strcmp(word,"type") == 0) {
-    newtree->type = PARTARRAYINT;
-    newtree->carray = (char *) &particles[0].ispecies;
-  }
-  else if (strcmp(word,"x") == 0)
-    newtree->carray = (char *) &particles[0].x[0];
-  else if (strcmp(word,"y") == 0)
-    newtree->carray = (char *) &particles[0].x[1];
-  else if (strcmp(word,"z") == 0)
-    newtree->carray = (char *) &particles[0].x[2];
-  else if (strcmp(word,"vx") == 0)
-    newtree->carray = (char *) &particles[0].v[0];
-  else if (strcmp(word,"vy") == 0)
-    newtree->carray = (char *) &particles[0].v[1];
-  else if (strcmp(word,"vz") == 0)
-    newtree->carray = (char *) &particles[0].v[2];
+  int type = PARTARRAYDOUBLE;
+  if (strcmp(word,"mass") == 0) type = SPECARRAY;
+  else if (strcmp(word,"type") == 0) type = PARTARRAYINT;
+
+  Ref ref;
+  ref.kind = PARTICLEREF;
+  ref.per = PARTICLE;
+  ref.nbracket = 0;
+  ref.index1 = ref.index2 = 0;
+  ref.id = word;
+  push_ref(&ref,type,tree,treestack,ntreestack,argstack,nargstack);
 }
 
 /* ----------------------------------------------------------------------
@@ -83,22 +83,70 @@ class Variable : protected Pointers {
     int nstride;           // stride between atoms if array is a 2d array
     int selfalloc;         // 1 if array is allocated here, else 0
     int ivalue1,ivalue2;   // extra values for needed for gmask,rmask,grmask
+    int ref;               // index of Ref that refreshes a compiled leaf
     Tree *left,*middle,*right;    // ptrs further down tree
   };
 
+  struct Ref {             // symbolic reference to one input of a formula
+    int kind;              // compute, fix, variable, etc, see enum{}
+    int per;               // 0 for global value, else PARTICLE or GRID
+    int nbracket;          // # of trailing brackets
+    int index1,index2;     // ints inside the brackets
+    char *id;              // ID, variable name, or keyword, found each time
+  };
+
+  struct Instr {           // one step of a tree compiled into postfix order
+    int type;              // same as Tree type
+    double value;          // single scalar
+    double *array;         // same as in Tree
+    char *carray;          // same as in Tree
+    int nstride;           // same as in Tree
+    int ref;               // same as in Tree
+  };
+
+  struct Program {         // compiled formula cached for one variable
+    int stamp;             // cachestamp when program was compiled
+    int ninstr;            // # of instructions, 0 if formula not compilable
+    Instr *instr;          // list of instructions
+    int depth;             // depth of evaluation stack
+    int nref;              // # of refs used to refresh operands
+    Ref *refs;             // list of refs
+  };
+
+  Program **program;       // cached program for each variable, NULL if none
+  int cachestamp;          // incremented when any variable is (re)defined
+  int compileflag;         // 1 if parsing a formula into a cached program
+  int cacheflag;           // 0 if formula uses an item that cannot be cached
+
+  int nref,maxref;         // # of refs for program being compiled
+  Ref *refs;               // list of refs
+  int ninstr,maxinstr;     // # of instructions in compiled tree
+  Instr *instr;            // list of instructions
+  int depth,maxdepth;      // depth of evaluation stack for compiled tree
+  double *vstack;          // evaluation stack, VECBLOCK values per level
+
   void remove(int);
   void grow();
   void copy(int, char **, char **);
   double evaluate(char *, Tree **);
+  double evaluate_equal(int);
+  void push_ref(Ref *, int, Tree **, Tree **, int &, double *, int &);
+  void fetch(Ref *, double &, double *&, char *&, int &);
+  Program *compile_program(int);
+  void refresh(Program *);
+  void free_program(Program *);
   double collapse_tree(Tree *);
   double eval_tree(Tree *, int);
   void free_tree(Tree *);
+  int compile_tree(Tree *, int);
+  int domain_check(Tree *);
+  void eval_compiled(Program *, int, double *, int, int);
   int find_matching_paren(char *, int, char *&);
   int math_function(char *, char *, Tree **, Tree **, int &, double *, int &);
   int special_function(char *, char *, Tree **, Tree **,
 		       int &, double *, int &);
   int is_particle_vector(char *);
-  void particle_vector(char *, Tree **, Tree **, int &);
+  void particle_vector(char *, Tree **, Tree **, int &, double *, int &);
   int is_constant(char *);
   double constant(char *);
   char *find_next_comma(char *);
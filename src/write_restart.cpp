@@ -42,7 +42,8 @@ enum{VERSION,SMALLINT,CELLINT,BIGINT,
      DIMENSION,AXISYMMETRIC,BOXLO,BOXHI,BFLAG,
      NPARTICLE,NUNSPLIT,NSPLIT,NSUB,NPOINT,NSURF,
      SPECIES,MIXTURE,PARTICLE_CUSTOM,GRID,SURF,
-     MULTIPROC,PROCSPERFILE,PERPROC};    // new fields added after PERPROC
+     MULTIPROC,PROCSPERFILE,PERPROC,     // new fields added after PERPROC
+     MPIIO,CELL_WEIGHT};
 
 /* ---------------------------------------------------------------------- */
 
@@ -51,6 +52,7 @@ WriteRestart::WriteRestart(SPARTA *sparta) : Pointers(sparta)
   MPI_Comm_rank(world,&me);
   MPI_Comm_size(world,&nprocs);
   multiproc = 0;
+  mpiio = 0;
 }
 
 /* ----------------------------------------------------------------------
@@ -174,6 +176,18 @@ void WriteRestart::multiproc_options(int multiproc_caller,
 
 void WriteRestart::write(char *file)
 {
+  // file ending in .mpiio is written collectively by all procs
+
+  char *suffix = file + strlen(file) - strlen(".mpiio");
+  if (suffix > file && strcmp(suffix,".mpiio") == 0) mpiio = 1;
+  else mpiio = 0;
+
+  if (mpiio) {
+    if (multiproc)
+      error->all(FLERR,"Restart file with .mpiio suffix cannot use %");
+    return write_mpiio(file);
+  }
+
   if (update->mem_limit_grid_flag)
     update->set_mem_limit_grid();
   if (update->global_mem_limit > 0 ||
@@ -495,6 +509,89 @@ void WriteRestart::write_less_memory(char *file)
   memory->destroy(buf);
 }
 
+/* ----------------------------------------------------------------------
+   write restart file collectively via MPI-IO
+   proc 0 writes header sections with stdio, same as a native file
+   then all procs write an index of per-proc chunk sizes
+     followed by their chunks, at offsets from a prefix sum of the sizes
+   no per-proc data is sent to proc 0
+------------------------------------------------------------------------- */
+
+void WriteRestart::write_mpiio(char *file)
+{
+  if (update->global_mem_limit > 0 || update->mem_limit_grid_flag)
+    error->all(FLERR,"Cannot use global mem/limit with MPI-IO restart file");
+
+  // proc 0 writes magic string, endian flag, numeric version, header info
+
+  bigint btmp = particle->nlocal;
+  MPI_Allreduce(&btmp,&particle->nglobal,1,MPI_SPARTA_BIGINT,MPI_SUM,world);
+
+  bigint hsize;
+
+  if (me == 0) {
+    fp = fopen(file,"wb");
+    if (fp == NULL) {
+      char str[128];
+      sprintf(str,"Cannot open restart file %s",file);
+      error->one(FLERR,str);
+    }
+    magic_string();
+    endian();
+    version_numeric();
+    header();
+    box_params();
+    particle_params();
+    grid_params();
+    surf_params();
+  }
+
+  file_layout(0);
+
+  if (me == 0) {
+    hsize = ftell(fp);
+    fclose(fp);
+  }
+  MPI_Bcast(&hsize,1,MPI_SPARTA_BIGINT,0,world);
+
+  // pack my child grid and particle data into buf
+
+  bigint send_size_big = grid->size_restart();
+  send_size_big += particle->size_restart_big();
+  if (send_size_big > MAXSMALLINT)
+    error->one(FLERR,"Restart file write buffer too large");
+  int send_size = send_size_big;
+
+  char *buf;
+  memory->create(buf,send_size,"write_restart:buf");
+  memset(buf,0,send_size);
+
+  int n = grid->pack_restart(buf);
+  n += particle->pack_restart(&buf[n]);
+
+  // offset of my chunk = index + sizes of chunks on lower procs
+
+  bigint nupto;
+  MPI_Scan(&send_size_big,&nupto,1,MPI_SPARTA_BIGINT,MPI_SUM,world);
+  MPI_Offset offset = hsize + (MPI_Offset) nprocs*sizeof(bigint) +
+    nupto - send_size_big;
+
+  MPI_File fh;
+  int err = MPI_File_open(world,file,MPI_MODE_WRONLY,MPI_INFO_NULL,&fh);
+  if (err != MPI_SUCCESS) error->all(FLERR,"Cannot open MPI-IO restart file");
+
+  err = MPI_File_write_at_all(fh,hsize + (MPI_Offset) me*sizeof(bigint),
+                              &send_size_big,1,MPI_SPARTA_BIGINT,
+                              MPI_STATUS_IGNORE);
+  if (err == MPI_SUCCESS)
+    err = MPI_File_write_at_all(fh,offset,buf,send_size,MPI_CHAR,
+                                MPI_STATUS_IGNORE);
+  if (err != MPI_SUCCESS) error->one(FLERR,"Cannot write MPI-IO restart file");
+
+  MPI_File_close(&fh);
+  memory->destroy(buf);
+}
+
 /* ----------------------------------------------------------------------
    proc 0 writes out problem description
 ------------------------------------------------------------------------- */
@@ -519,6 +616,7 @@ void WriteRestart::header()
   write_int(COMM_SORT,comm->commsortflag);
   write_int(COMM_STYLE,comm->commpartstyle);
   write_int(GRID_WEIGHT,grid->cellweightflag);
+  write_int(CELL_WEIGHT,grid->cellweightflag ? 1 : 0);
 
   write_bigint(NPARTICLE,particle->nglobal);
   write_bigint(NUNSPLIT,grid->nunsplit);
@@ -597,6 +695,7 @@ void WriteRestart::surf_params()
 void WriteRestart::file_layout(int)
 {
   if (me == 0) write_int(MULTIPROC,multiproc);
+  if (me == 0 && mpiio) write_int(MPIIO,1);
 
   // -1 flag signals end of file layout info
 
@@ -33,6 +33,7 @@ class WriteRestart : protected Pointers {
   void multiproc_options(int, int, char **);
   void write(char *);
   void write_less_memory(char *);
+  void write_mpiio(char *);
 
  private:
   int me,nprocs;
@@ -44,6 +45,7 @@ class WriteRestart : protected Pointers {
   int filewriter;            // 1 if this proc writes a file, else 0
   int fileproc;              // ID of proc in my cluster who writes to file
   int icluster;              // which cluster I am in
+  int mpiio;                 // 1 if file is written collectively via MPI-IO
 
   void header();
   void box_params();
@@ -98,4 +100,27 @@ The specified file cannot be opened.  Check that the path and name are
 correct.  If the file is a compressed file, also check that the gzip
 executable can be found and run.
 
+E: Restart file with .mpiio suffix cannot use %
+
+An MPI-IO restart file is a single file written by all processors.
+
+E: Cannot use global mem/limit with MPI-IO restart file
+
+Each processor writes its own data directly, so the limited-memory
+mode is not needed.  Unset global mem/limit or use a native file.
+
+E: Restart file write buffer too large
+
+The grid cells and particles owned by one processor must fit in a
+buffer of at most 2 GB.
+
+E: Cannot open MPI-IO restart file
+
+The file could not be opened collectively by all processors.
+
+E: Cannot write MPI-IO restart file
+
+A collective write to the MPI-IO restart file failed.  Check that the
+file system has space and supports MPI-IO.
+
 */
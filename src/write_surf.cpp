@@ -27,6 +27,8 @@
 using namespace SPARTA_NS;
 
 #define MAXLINE 256
+#define MAGIC_BINARY "SPARTASF"   // must match ReadSurf
+#define VERSION_BINARY 1
 
 /* ---------------------------------------------------------------------- */
 
@@ -67,6 +69,14 @@ void WriteSurf::command(int narg, char **arg)
   if (strchr(arg[0],'%')) multiproc = nprocs;
   else multiproc = 0;
 
+  // check for binary output, detected by suffix
+
+  binary = 0;
+  char *suffix = file + strlen(file) - strlen(".bin");
+  if (suffix > file && strcmp(suffix,".bin") == 0) binary = 1;
+  if (binary && multiproc)
+    error->all(FLERR,"Write_surf binary file cannot be multiple files");
+
   // optional args
 
   pointflag = 1;
@@ -171,7 +181,8 @@ void WriteSurf::command(int narg, char **arg)
 
 void WriteSurf::write_file(char *file)
 {
-  if (surf->distributed) {
+  if (binary) write_file_binary(file);
+  else if (surf->distributed) {
     if (pointflag) write_file_distributed_points(file);
     else write_file_distributed_nopoints(file);
   } else {
@@ -679,6 +690,124 @@ void WriteSurf::write_file_distributed_nopoints(char *file)
   memory->sfree(buf);
 }
 
+/* ----------------------------------------------------------------------
+   write surf file in SPARTA binary format via MPI-IO
+   header = magic string, int version, int dim, int64 element count
+   element = int64 ID, int64 type, 4 (2d) or 9 (3d) double coords
+   each proc writes a contiguous chunk, file order need not be ID order
+   implicit surf IDs are cell IDs, so renumber them 1 to N in proc order
+------------------------------------------------------------------------- */
+
+void WriteSurf::write_file_binary(char *file)
+{
+  // nmine = # of surfs I write
+  // all: my fraction of all surfs
+  // distributed: nown/nlocal depending on explicit/implicit
+
+  int first = 0;
+  int nmine;
+  Surf::Line *lines;
+  Surf::Tri *tris;
+
+  if (surf->distributed) {
+    if (surf->implicit) {
+      nmine = surf->nlocal;
+      lines = surf->lines;
+      tris = surf->tris;
+    } else {
+      nmine = surf->nown;
+      lines = surf->mylines;
+      tris = surf->mytris;
+    }
+  } else {
+    first = static_cast<int> (1.0*me/nprocs * surf->nlocal);
+    int next = static_cast<int> (1.0*(me+1)/nprocs * surf->nlocal);
+    nmine = next - first;
+    lines = surf->lines;
+    tris = surf->tris;
+  }
+
+  int nvalues;
+  if (dim == 2) nvalues = 4;
+  else nvalues = 9;
+  int recsize = 2*sizeof(int64_t) + nvalues*sizeof(double);
+
+  bigint nbytes = (bigint) nmine * recsize;
+  if (nbytes > MAXSMALLINT)
+    error->one(FLERR,"Too much distributed data to communicate");
+
+  // idfirst = # of surfs on lower procs, used to renumber implicit surfs
+
+  bigint bnmine = nmine;
+  bigint idfirst;
+  MPI_Scan(&bnmine,&idfirst,1,MPI_SPARTA_BIGINT,MPI_SUM,world);
+  idfirst -= bnmine;
+
+  // pack my surfs into buf
+
+  char *buf;
+  memory->create(buf,nmine*recsize,"writesurf:buf");
+
+  int64_t ivalues[2];
+  double x[9];
+  char *ptr = buf;
+
+  for (int i = first; i < first+nmine; i++) {
+    if (dim == 2) {
+      ivalues[0] = lines[i].id;
+      ivalues[1] = lines[i].type;
+      x[0] = lines[i].p1[0];
+      x[1] = lines[i].p1[1];
+      x[2] = lines[i].p2[0];
+      x[3] = lines[i].p2[1];
+    } else {
+      ivalues[0] = tris[i].id;
+      ivalues[1] = tris[i].type;
+      memcpy(&x[0],tris[i].p1,3*sizeof(double));
+      memcpy(&x[3],tris[i].p2,3*sizeof(double));
+      memcpy(&x[6],tris[i].p3,3*sizeof(double));
+    }
+    if (surf->implicit) ivalues[0] = idfirst + (i-first) + 1;
+    memcpy(ptr,ivalues,2*sizeof(int64_t));
+    memcpy(ptr+2*sizeof(int64_t),x,nvalues*sizeof(double));
+    ptr += recsize;
+  }
+
+  // offset of my chunk = header + sizes of chunks on lower procs
+
+  int hsize = 8 + 2*sizeof(int) + sizeof(int64_t);
+  bigint nupto;
+  MPI_Scan(&nbytes,&nupto,1,MPI_SPARTA_BIGINT,MPI_SUM,world);
+  MPI_Offset offset = hsize + (MPI_Offset) (nupto - nbytes);
+
+  MPI_File fh;
+  int err = MPI_File_open(world,file,MPI_MODE_CREATE | MPI_MODE_WRONLY,
+                          MPI_INFO_NULL,&fh);
+  if (err != MPI_SUCCESS) {
+    char str[128];
+    sprintf(str,"Cannot open surface file %s",file);
+    error->all(FLERR,str);
+  }
+  MPI_File_set_size(fh,0);
+
+  if (me == 0) {
+    char header[24];
+    int ivalue[2] = {VERSION_BINARY,dim};
+    int64_t nsurf = surf->nsurf;
+    memcpy(header,MAGIC_BINARY,8);
+    memcpy(&header[8],ivalue,2*sizeof(int));
+    memcpy(&header[8+2*sizeof(int)],&nsurf,sizeof(int64_t));
+    MPI_File_write_at(fh,0,header,hsize,MPI_CHAR,MPI_STATUS_IGNORE);
+  }
+
+  err = MPI_File_write_at_all(fh,offset,buf,nmine*recsize,MPI_CHAR,
+                              MPI_STATUS_IGNORE);
+  if (err != MPI_SUCCESS) error->one(FLERR,"Cannot write binary surf file");
+
+  MPI_File_close(&fh);
+  memory->destroy(buf);
+}
+
 /* ----------------------------------------------------------------------
    write base file for multiproc output
    only called by proc 0
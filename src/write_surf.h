@@ -39,6 +39,7 @@ class WriteSurf : protected Pointers {
   FILE *fp;
 
   int pointflag;             // 1/0 to include/exclude Points section in file
+  int binary;                // 1 if writing SPARTA binary file, else text
   int multiproc;             // 0 = proc 0 writes for all
                              // else # of procs writing files
   int filewriter;            // 1 if this proc writes to file, else 0
@@ -56,6 +57,7 @@ class WriteSurf : protected Pointers {
   void write_file_all_nopoints(char *);
   void write_file_distributed_points(char *);
   void write_file_distributed_nopoints(char *);
+  void write_file_binary(char *);
 
   void write_base(char *);
   void open(char *);
@@ -75,4 +77,17 @@ Self-explanatory.  Check the input script syntax and compare to the
 documentation for the command.  You can use -echo screen as a
 command-line option when running SPARTA to see the offending line.
 
+E: Write_surf binary file cannot be multiple files
+
+A filename ending in .bin cannot contain a "%" character.
+
+E: Cannot open surface file %s
+
+The specified file cannot be opened.  Check that the path and name are
+correct.
+
+E: Cannot write binary surf file
+
+An MPI-IO write to the file failed.
+
 */
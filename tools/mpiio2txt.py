@@ -0,0 +1,118 @@
+#!/usr/bin/env python
+
+# Script:  mpiio2txt.py
+# Purpose: convert a binary dump file written by the dump command with
+#          a .mpiio suffix into a text dump file in the standard format
+# Syntax:  mpiio2txt.py mpiiofile txtfile
+#          mpiiofile = read this dump file written via MPI-IO
+#          txtfile = write this text dump file
+# Author:  SPARTA developers
+
+# NOTE: file must be read on a machine with the same endianness and
+#       int/bigint sizes as the one that wrote it (SPARTA_SMALL is not
+#       supported, bigint must be 8 bytes)
+# NOTE: values are written with %d or %g, dump_modify format settings
+#       used in the original run are not stored in the file
+
+from __future__ import print_function
+
+# error message
+
+def error(str=None):
+  if str: print("ERROR:",str)
+  else: print("Syntax: mpiio2txt.py mpiiofile txtfile")
+  sys.exit()
+
+# convert a cell ID to its dash-separated string form, same as Grid::id_num2str
+
+def id_num2str(id,levelbits):
+  words = []
+  level = 0
+  while 1:
+    newbits = levelbits[level]
+    words.append(str(id & ((1 << newbits) - 1)))
+    id >>= newbits
+    if not id: return '-'.join(words)
+    level += 1
+
+# read n bytes from data starting at offset, return bytes and new offset
+
+def take(data,offset,n):
+  if offset + n > len(data): error("MPI-IO dump file is truncated")
+  return data[offset:offset+n],offset+n
+
+# ----------------------------------------------------------------------
+# main program
+
+import sys,struct
+
+if len(sys.argv) != 3: error()
+
+INT,DOUBLE,BIGINT,STRING = 0,1,2,3
+
+data = open(sys.argv[1],"rb").read()
+fp = open(sys.argv[2],"w")
+
+offset = 0
+nsnaps = 0
+
+while offset < len(data):
+  magic,offset = take(data,offset,8)
+  if magic != b"SPARTAIO": error("Invalid MPI-IO dump file header")
+  s,offset = take(data,offset,4)
+  version = struct.unpack("i",s)[0]
+  if version != 1: error("Unsupported MPI-IO dump file version %d" % version)
+
+  s,offset = take(data,offset,4)
+  n = struct.unpack("i",s)[0]
+  s,offset = take(data,offset,n)
+  itemname = s.decode()
+  s,offset = take(data,offset,4)
+  n = struct.unpack("i",s)[0]
+  s,offset = take(data,offset,n)
+  columns = s.decode()
+
+  s,offset = take(data,offset,16)
+  ntimestep,nrows = struct.unpack("qq",s)
+  s,offset = take(data,offset,8)
+  boundstr = s.decode().rstrip("\0")
+  s,offset = take(data,offset,48)
+  box = struct.unpack("6d",s)
+
+  s,offset = take(data,offset,4)
+  size_one = struct.unpack("i",s)[0]
+  s,offset = take(data,offset,4*size_one)
+  vtype = struct.unpack("%di" % size_one,s)
+  s,offset = take(data,offset,4)
+  nlevels = struct.unpack("i",s)[0]
+  s,offset = take(data,offset,4*nlevels)
+  levelbits = struct.unpack("%di" % nlevels,s)
+
+  print("ITEM: TIMESTEP",file=fp)
+  print(ntimestep,file=fp)
+  print("ITEM: NUMBER OF %s" % itemname,file=fp)
+  print(nrows,file=fp)
+  print("ITEM: BOX BOUNDS %s" % boundstr,file=fp)
+  print("%g %g" % (box[0],box[1]),file=fp)
+  print("%g %g" % (box[2],box[3]),file=fp)
+  print("%g %g" % (box[4],box[5]),file=fp)
+  print("ITEM: %s %s" % (itemname,columns),file=fp)
+
+  s,offset = take(data,offset,8*size_one*nrows)
+  values = struct.unpack("%dd" % (size_one*nrows),s)
+
+  m = 0
+  for i in range(nrows):
+    words = []
+    for j in range(size_one):
+      value = values[m]
+      if vtype[j] == DOUBLE: words.append("%g" % value)
+      elif vtype[j] == STRING: words.append(id_num2str(int(value),levelbits))
+      else: words.append("%d" % int(value))
+      m += 1
+    print(' '.join(words) + ' ',file=fp)
+
+  nsnaps += 1
+
+fp.close()
+print("Converted %d snapshots" % nsnaps)